@@ -0,0 +1,1991 @@
+/*
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/queue.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/event_groups.h"
+#include "soc/soc_caps.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_memory_utils.h"
+#endif
+
+#include "usb/usb_host.h"
+#include "usb/cdc_acm_host.h"
+#include "cdc_host_descriptor_parsing.h"
+#include "cdc_host_common.h"
+#include "cdc_host_acm_compliant.h"
+
+static const char *TAG = "cdc_acm";
+
+// Control transfer constants
+#define CDC_ACM_CTRL_TRANSFER_SIZE (64)   // All standard CTRL requests and responses fit in this size
+#define CDC_ACM_CTRL_TIMEOUT_MS    (5000) // Every CDC device should be able to respond to CTRL transfer in 5 seconds
+
+// CDC-ACM spinlock
+static portMUX_TYPE cdc_acm_lock = portMUX_INITIALIZER_UNLOCKED;
+#define CDC_ACM_ENTER_CRITICAL()   portENTER_CRITICAL(&cdc_acm_lock)
+#define CDC_ACM_EXIT_CRITICAL()    portEXIT_CRITICAL(&cdc_acm_lock)
+
+// CDC-ACM events
+#define CDC_ACM_TEARDOWN          BIT0
+#define CDC_ACM_TEARDOWN_COMPLETE BIT1
+#define CDC_ACM_NEW_DEV           BIT2  // A device was enumerated since the bit was last cleared
+
+// Transfers kept from closed devices when keep_transfers is set: CTRL, notification, all IN (with RX loans) and OUT (with asynchronous) of one device
+#define CDC_ACM_SPARE_XFERS_MAX   (3 + CDC_ACM_IN_XFERS_MAX + CDC_ACM_RX_LOANS_MAX + CDC_ACM_TX_XFERS_MAX)
+
+// Parsed interface layouts kept when cache_descriptors is set
+#define CDC_ACM_DESC_CACHE_SIZE   (4)
+
+// Open on arrival registration
+typedef struct {
+    bool used;
+    uint16_t vid;
+    uint16_t pid;
+    uint8_t interface_idx;
+    cdc_acm_host_device_config_t dev_config;
+    cdc_acm_arrival_callback_t arrival_cb;
+    void *arrival_arg;
+} cdc_acm_arrival_t;
+
+// CDC-ACM driver object
+typedef struct {
+    usb_host_client_handle_t cdc_acm_client_hdl;        /*!< USB Host handle reused for all CDC-ACM devices in the system */
+    SemaphoreHandle_t open_close_mutex;
+    EventGroupHandle_t event_group;
+    cdc_acm_new_dev_callback_t new_dev_cb;
+    SLIST_HEAD(list_dev, cdc_dev_s) cdc_devices_list;   /*!< List of open pseudo devices */
+    bool keep_transfers;                                /*!< Park transfers of closed devices instead of freeing them */
+    struct {
+        usb_transfer_t *xfer;
+        size_t size;                                    /*!< Buffer size requested when the transfer was allocated */
+    } spare_xfers[CDC_ACM_SPARE_XFERS_MAX];             /*!< Protected by open_close_mutex */
+    bool cache_descriptors;                             /*!< Reuse parsed interface layouts on the next open */
+    cdc_parse_cache_entry_t desc_cache[CDC_ACM_DESC_CACHE_SIZE]; /*!< Protected by open_close_mutex */
+    cdc_acm_arrival_t arrivals[CDC_ACM_ARRIVALS_MAX];   /*!< Protected by open_close_mutex */
+    uint8_t arrivals_used;                              /*!< Used entries of arrivals[]. Written with open_close_mutex taken and in critical section,
+                                                             read in critical section only, so the driver task can check it without the mutex */
+    uint8_t open_waiters;                               /*!< cdc_acm_host_open() calls waiting for a new device. Protected by open_close_mutex */
+} cdc_acm_obj_t;
+
+static cdc_acm_obj_t *p_cdc_acm_obj = NULL;
+
+/**
+ * @brief Default CDC-ACM driver configuration
+ *
+ * This configuration is used when user passes NULL to config pointer during device open.
+ */
+static const cdc_acm_host_driver_config_t cdc_acm_driver_config_default = {
+    .driver_task_stack_size = 4096,
+    .driver_task_priority = 10,
+    .xCoreID = 0,
+    .new_dev_cb = NULL,
+    .keep_transfers = false,
+    .cache_descriptors = false,
+};
+
+/**
+ * @brief Notification received callback
+ *
+ * Notification (interrupt) IN transfer is submitted at the end of this function to ensure periodic poll of IN endpoint.
+ *
+ * @param[in] transfer Transfer that triggered the callback
+ */
+static void notif_xfer_cb(usb_transfer_t *transfer);
+
+/**
+ * @brief Data received callback
+ *
+ * Data (bulk) IN transfers are delivered to the user in submission order and each is resubmitted after its delivery
+ * to ensure continuous poll of IN endpoint.
+ *
+ * @param[in] transfer Transfer that triggered the callback
+ */
+static void in_xfer_cb(usb_transfer_t *transfer);
+
+/**
+ * @brief Data send callback
+ *
+ * Reused for bulk OUT and CTRL transfers
+ *
+ * @param[in] transfer Transfer that triggered the callback
+ */
+static void out_xfer_cb(usb_transfer_t *transfer);
+
+/**
+ * @brief Asynchronous data send callback
+ *
+ * Returns the bulk OUT transfer to the free ones and calls the user's completion callback
+ *
+ * @param[in] transfer Transfer that triggered the callback
+ */
+static void tx_async_xfer_cb(usb_transfer_t *transfer);
+
+/**
+ * @brief USB Host Client event callback
+ *
+ * Handling of USB device connection/disconnection to/from root HUB.
+ *
+ * @param[in] event_msg Event message type
+ * @param[in] arg Caller's argument (not used in this driver)
+ */
+static void usb_event_cb(const usb_host_client_event_msg_t *event_msg, void *arg);
+
+/**
+ * @brief Reset IN transfer
+ *
+ * In in_xfer_cb() we can modify IN transfer parameters, this function resets the transfer to its defaults
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ * @param[in] idx     Index of the IN transfer
+ */
+static void cdc_acm_reset_in_transfer(cdc_dev_t *cdc_dev, int idx)
+{
+    assert(cdc_dev->data.in_xfers[idx]);
+    usb_transfer_t *transfer = cdc_dev->data.in_xfers[idx];
+    uint8_t **ptr = (uint8_t **)(&(transfer->data_buffer));
+    *ptr = cdc_dev->data.in_data_buffer_base[idx];
+    transfer->num_bytes = transfer->data_buffer_size;
+    // This is a hotfix for IDF changes, where 'transfer->data_buffer_size' does not contain actual buffer length,
+    // but *allocated* buffer length, which can be larger if CONFIG_HEAP_POISONING_COMPREHENSIVE is enabled
+    transfer->num_bytes -= transfer->data_buffer_size % cdc_dev->data.in_mps;
+}
+
+/**
+ * @brief Record the resubmission of an IN transfer slot in the statistics
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ * @param[in] idx     Index of the IN transfer slot, about to be submitted
+ */
+static void cdc_acm_stats_in_resubmit(cdc_dev_t *cdc_dev, int idx)
+{
+    const int64_t now_us = esp_timer_get_time();
+
+    // With RX loans, this runs in the user's task too
+    CDC_ACM_ENTER_CRITICAL();
+    if (!(cdc_dev->in_done_timed & (1U << idx))) {
+        CDC_ACM_EXIT_CRITICAL();
+        return; // First submission after open or resume
+    }
+    cdc_dev->in_done_timed &= ~(1U << idx);
+    const uint32_t gap_us = (uint32_t)(now_us - cdc_dev->in_done_us[idx]);
+    cdc_dev->stats.in.resubmits++;
+    cdc_dev->stats.in.resubmit_gap_total_us += gap_us;
+    if (gap_us > cdc_dev->stats.in.resubmit_gap_max_us) {
+        cdc_dev->stats.in.resubmit_gap_max_us = gap_us;
+    }
+    CDC_ACM_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Record a data_cb run time in the statistics
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ * @param[in] time_us Run time in [us]
+ */
+static void cdc_acm_stats_data_cb_time(cdc_dev_t *cdc_dev, uint32_t time_us)
+{
+    // Bin of the highest set bit: 0-1 us in bin 0, 2-3 us in bin 1, 4-7 us in bin 2...
+    int bin = (time_us < 2) ? 0 : 31 - __builtin_clz(time_us);
+    if (bin >= CDC_ACM_STATS_HIST_BINS) {
+        bin = CDC_ACM_STATS_HIST_BINS - 1;
+    }
+
+    CDC_ACM_ENTER_CRITICAL();
+    cdc_dev->stats.in.data_cb_hist[bin]++;
+    if (time_us > cdc_dev->stats.in.data_cb_max_us) {
+        cdc_dev->stats.in.data_cb_max_us = time_us;
+    }
+    CDC_ACM_EXIT_CRITICAL();
+}
+
+/**
+ * @brief CDC-ACM driver handling task
+ *
+ * USB host client registration and deregistration is handled here.
+ *
+ * @param[in] arg User's argument. Handle of a task that started this task.
+ */
+static void cdc_acm_client_task(void *arg)
+{
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    cdc_acm_obj_t *cdc_acm_obj = p_cdc_acm_obj; // Make local copy of the driver's handle
+    assert(cdc_acm_obj->cdc_acm_client_hdl);
+
+    // Start handling client's events
+    while (1) {
+        usb_host_client_handle_events(cdc_acm_obj->cdc_acm_client_hdl, portMAX_DELAY);
+        EventBits_t events = xEventGroupGetBits(cdc_acm_obj->event_group);
+        if (events & CDC_ACM_TEARDOWN) {
+            break;
+        }
+    }
+
+    ESP_LOGD(TAG, "Deregistering client");
+    ESP_ERROR_CHECK(usb_host_client_deregister(cdc_acm_obj->cdc_acm_client_hdl));
+    xEventGroupSetBits(cdc_acm_obj->event_group, CDC_ACM_TEARDOWN_COMPLETE);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Cancel transfer and reset endpoint
+ *
+ * This function will cancel ongoing transfer a reset its endpoint to ready state.
+ *
+ * @param[in] dev_hdl USB device handle
+ * @param[in] transfer Transfer to be cancelled
+ * @return esp_err_t
+ */
+static esp_err_t cdc_acm_reset_transfer_endpoint(usb_device_handle_t dev_hdl, usb_transfer_t *transfer)
+{
+    assert(dev_hdl);
+    assert(transfer);
+
+    ESP_RETURN_ON_ERROR(usb_host_endpoint_halt(dev_hdl, transfer->bEndpointAddress), TAG,);
+    ESP_RETURN_ON_ERROR(usb_host_endpoint_flush(dev_hdl, transfer->bEndpointAddress), TAG,);
+    usb_host_endpoint_clear(dev_hdl, transfer->bEndpointAddress);
+    return ESP_OK;
+}
+
+/**
+ * @brief Start CDC device
+ *
+ * After this call, USB host peripheral will continuously poll IN endpoints.
+ *
+ * @param cdc_dev
+ * @param[in] event_cb  Device event callback
+ * @param[in] in_cb     Data received callback
+ * @param[in] user_arg  Optional user's argument, that will be passed to the callbacks
+ * @return esp_err_t
+ */
+static esp_err_t cdc_acm_start(cdc_dev_t *cdc_dev, cdc_acm_host_dev_callback_t event_cb, cdc_acm_data_callback_t in_cb, void *user_arg)
+{
+    esp_err_t ret = ESP_OK;
+    assert(cdc_dev);
+
+    CDC_ACM_ENTER_CRITICAL();
+    cdc_dev->notif.cb = event_cb;
+    cdc_dev->data.in_cb = in_cb;
+    cdc_dev->cb_arg = user_arg;
+    CDC_ACM_EXIT_CRITICAL();
+
+    // Claim data interface and start polling its IN endpoint
+    ESP_GOTO_ON_ERROR(
+        usb_host_interface_claim(
+            p_cdc_acm_obj->cdc_acm_client_hdl,
+            cdc_dev->dev_hdl,
+            cdc_dev->data.intf_desc->bInterfaceNumber,
+            cdc_dev->data.intf_desc->bAlternateSetting),
+        err, TAG, "Could not claim interface");
+    for (int i = 0; i < cdc_dev->data.in_xfer_count; i++) {
+        ESP_LOGD(TAG, "Submitting poll for BULK IN transfer %d", i);
+        ESP_ERROR_CHECK(usb_host_transfer_submit(cdc_dev->data.in_xfers[i]));
+    }
+
+    // If notification are supported, claim its interface and start polling its IN endpoint
+    if (cdc_dev->notif.xfer) {
+        if (cdc_dev->notif.intf_desc != cdc_dev->data.intf_desc) {
+            ESP_GOTO_ON_ERROR(
+                usb_host_interface_claim(
+                    p_cdc_acm_obj->cdc_acm_client_hdl,
+                    cdc_dev->dev_hdl,
+                    cdc_dev->notif.intf_desc->bInterfaceNumber,
+                    cdc_dev->notif.intf_desc->bAlternateSetting),
+                err, TAG, "Could not claim interface");
+        }
+        ESP_LOGD(TAG, "Submitting poll for INTR IN transfer");
+        ESP_ERROR_CHECK(usb_host_transfer_submit(cdc_dev->notif.xfer));
+    }
+
+    // Everything OK, add the device into list and return
+    CDC_ACM_ENTER_CRITICAL();
+    SLIST_INSERT_HEAD(&p_cdc_acm_obj->cdc_devices_list, cdc_dev, list_entry);
+    CDC_ACM_EXIT_CRITICAL();
+    return ret;
+
+err:
+    usb_host_interface_release(p_cdc_acm_obj->cdc_acm_client_hdl, cdc_dev->dev_hdl, cdc_dev->data.intf_desc->bInterfaceNumber);
+    if (cdc_dev->notif.xfer && (cdc_dev->notif.intf_desc != cdc_dev->data.intf_desc)) {
+        usb_host_interface_release(p_cdc_acm_obj->cdc_acm_client_hdl, cdc_dev->dev_hdl, cdc_dev->notif.intf_desc->bInterfaceNumber);
+    }
+    return ret;
+}
+
+static void cdc_acm_transfers_free(cdc_dev_t *cdc_dev);
+/**
+ * @brief Helper function that releases resources claimed by CDC device
+ *
+ * Close underlying USB device, free device driver memory
+ *
+ * @note All interfaces claimed by this device must be release before calling this function
+ * @param cdc_dev CDC device handle to be removed
+ */
+static void cdc_acm_device_remove(cdc_dev_t *cdc_dev)
+{
+    assert(cdc_dev);
+    cdc_acm_transfers_free(cdc_dev);
+    free(cdc_dev->cdc_func_desc);
+    // We don't check the error code of usb_host_device_close, as the close might fail, if someone else is still using the device (not all interfaces are released)
+    usb_host_device_close(p_cdc_acm_obj->cdc_acm_client_hdl, cdc_dev->dev_hdl); // Gracefully continue on error
+    free(cdc_dev);
+}
+
+/**
+ * @brief Open USB device with requested VID/PID
+ *
+ * This function has two regular return paths:
+ * 1. USB device with matching VID/PID is already opened by this driver: allocate new CDC device on top of the already opened USB device.
+ * 2. USB device with matching VID/PID is NOT opened by this driver yet: scan USB connected devices, and scan again
+ *    each time a new device is enumerated, until it is found.
+ *
+ * @note This function will block for timeout_ms, if the device is not enumerated at the moment of calling this function.
+ *       It must not be called from the driver task, which delivers the new device events.
+ * @note Must be called with open_close_mutex taken. The mutex is given while waiting for a new device, so the driver task
+ *       can open devices on arrival meanwhile; both lists are scanned again after each new device.
+ * @param[in] vid Vendor ID
+ * @param[in] pid Product ID
+ * @param[in] timeout_ms Connection timeout [ms]
+ * @param[out] dev CDC-ACM device
+ * @return esp_err_t
+ */
+static esp_err_t cdc_acm_find_and_open_usb_device(uint16_t vid, uint16_t pid, int timeout_ms, cdc_dev_t **dev)
+{
+    assert(p_cdc_acm_obj);
+    assert(dev);
+
+    *dev = calloc(1, sizeof(cdc_dev_t));
+    if (*dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    TickType_t timeout_ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    TimeOut_t connection_timeout;
+    vTaskSetTimeOutState(&connection_timeout);
+
+    do {
+        // Clear before the scan: a device enumerated during the scan sets it again
+        xEventGroupClearBits(p_cdc_acm_obj->event_group, CDC_ACM_NEW_DEV);
+
+        // First, check list of already opened CDC devices. Checked on every pass: the driver task may have opened the device on arrival
+        ESP_LOGD(TAG, "Checking list of opened USB devices");
+        cdc_dev_t *cdc_dev;
+        SLIST_FOREACH(cdc_dev, &p_cdc_acm_obj->cdc_devices_list, list_entry) {
+            const usb_device_desc_t *device_desc;
+            ESP_ERROR_CHECK(usb_host_get_device_descriptor(cdc_dev->dev_hdl, &device_desc));
+            if ((vid == device_desc->idVendor || vid == CDC_HOST_ANY_VID) &&
+                    (pid == device_desc->idProduct || pid == CDC_HOST_ANY_PID)) {
+                // Return path 1:
+                (*dev)->dev_hdl = cdc_dev->dev_hdl;
+                return ESP_OK;
+            }
+        }
+
+        // Second, scan connected devices
+        ESP_LOGD(TAG, "Checking list of connected USB devices");
+        uint8_t dev_addr_list[10];
+        int num_of_devices;
+        ESP_ERROR_CHECK(usb_host_device_addr_list_fill(sizeof(dev_addr_list), dev_addr_list, &num_of_devices));
+
+        // Go through device address list and find the one we are looking for
+        for (int i = 0; i < num_of_devices; i++) {
+            usb_device_handle_t current_device;
+            // Open USB device
+            if (usb_host_device_open(p_cdc_acm_obj->cdc_acm_client_hdl, dev_addr_list[i], &current_device) == ESP_OK) {
+                assert(current_device);
+                const usb_device_desc_t *device_desc;
+                ESP_ERROR_CHECK(usb_host_get_device_descriptor(current_device, &device_desc));
+                if ((device_desc->bDeviceClass != USB_CLASS_HUB) &&
+                        (vid == device_desc->idVendor || vid == CDC_HOST_ANY_VID) &&
+                        (pid == device_desc->idProduct || pid == CDC_HOST_ANY_PID)) {
+                    // Return path 2:
+                    (*dev)->dev_hdl = current_device;
+                    return ESP_OK;
+                }
+                usb_host_device_close(p_cdc_acm_obj->cdc_acm_client_hdl, current_device);
+            }
+        }
+        // Sleep until the next device is enumerated, instead of polling the bus. The driver task takes open_close_mutex
+        // for open on arrival while delivering the new device event, so it must not be held here
+        p_cdc_acm_obj->open_waiters++;
+        xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+        xEventGroupWaitBits(p_cdc_acm_obj->event_group, CDC_ACM_NEW_DEV, pdFALSE, pdFALSE, timeout_ticks);
+        xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+        p_cdc_acm_obj->open_waiters--;
+    } while (xTaskCheckForTimeOut(&connection_timeout, &timeout_ticks) == pdFALSE);
+
+    // Timeout was reached, clean-up
+    free(*dev);
+    *dev = NULL;
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t cdc_acm_host_install(const cdc_acm_host_driver_config_t *driver_config)
+{
+    CDC_ACM_CHECK(!p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+
+    // Check driver configuration, use default if NULL is passed
+    if (driver_config == NULL) {
+        driver_config = &cdc_acm_driver_config_default;
+    }
+
+    // Allocate all we need for this driver
+    esp_err_t ret;
+    cdc_acm_obj_t *cdc_acm_obj = heap_caps_calloc(1, sizeof(cdc_acm_obj_t), MALLOC_CAP_DEFAULT);
+    EventGroupHandle_t event_group = xEventGroupCreate();
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    TaskHandle_t driver_task_h = NULL;
+    xTaskCreatePinnedToCore(
+        cdc_acm_client_task, "USB-CDC", driver_config->driver_task_stack_size, NULL,
+        driver_config->driver_task_priority, &driver_task_h, driver_config->xCoreID);
+
+    if (cdc_acm_obj == NULL || driver_task_h == NULL || event_group == NULL || mutex == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto err;
+    }
+
+    // Register USB Host client
+    usb_host_client_handle_t usb_client = NULL;
+    const usb_host_client_config_t client_config = {
+        .is_synchronous = false,
+        .max_num_event_msg = 3,
+        .async.client_event_callback = usb_event_cb,
+        .async.callback_arg = NULL
+    };
+    ESP_GOTO_ON_ERROR(usb_host_client_register(&client_config, &usb_client), err, TAG, "Failed to register USB host client");
+
+    // Initialize CDC-ACM driver structure
+    SLIST_INIT(&(cdc_acm_obj->cdc_devices_list));
+    cdc_acm_obj->event_group = event_group;
+    cdc_acm_obj->open_close_mutex = mutex;
+    cdc_acm_obj->cdc_acm_client_hdl = usb_client;
+    cdc_acm_obj->new_dev_cb = driver_config->new_dev_cb;
+    cdc_acm_obj->keep_transfers = driver_config->keep_transfers;
+    cdc_acm_obj->cache_descriptors = driver_config->cache_descriptors;
+
+    // Between 1st call of this function and following section, another task might try to install this driver:
+    // Make sure that there is only one instance of this driver in the system
+    CDC_ACM_ENTER_CRITICAL();
+    if (p_cdc_acm_obj) {
+        // Already created
+        ret = ESP_ERR_INVALID_STATE;
+        CDC_ACM_EXIT_CRITICAL();
+        goto client_err;
+    } else {
+        p_cdc_acm_obj = cdc_acm_obj;
+    }
+    CDC_ACM_EXIT_CRITICAL();
+
+    // Everything OK: Start CDC-Driver task and return
+    xTaskNotifyGive(driver_task_h);
+    return ESP_OK;
+
+client_err:
+    usb_host_client_deregister(usb_client);
+err: // Clean-up
+    free(cdc_acm_obj);
+    if (event_group) {
+        vEventGroupDelete(event_group);
+    }
+    if (driver_task_h) {
+        vTaskDelete(driver_task_h);
+    }
+    if (mutex) {
+        vSemaphoreDelete(mutex);
+    }
+    return ret;
+}
+
+esp_err_t cdc_acm_host_uninstall()
+{
+    esp_err_t ret;
+
+    CDC_ACM_ENTER_CRITICAL();
+    CDC_ACM_CHECK_FROM_CRIT(p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+    cdc_acm_obj_t *cdc_acm_obj = p_cdc_acm_obj; // Save Driver's handle to temporary handle
+    CDC_ACM_EXIT_CRITICAL();
+
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY); // Wait for all open/close calls to finish
+
+    CDC_ACM_ENTER_CRITICAL();
+    // Check that device list is empty (all devices closed) and no open is waiting for a device without the mutex
+    if (SLIST_EMPTY(&p_cdc_acm_obj->cdc_devices_list) && p_cdc_acm_obj->open_waiters == 0) {
+        p_cdc_acm_obj = NULL; // NULL static driver pointer: No open/close calls form this point
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+        CDC_ACM_EXIT_CRITICAL();
+        goto unblock;
+    }
+    CDC_ACM_EXIT_CRITICAL();
+
+    // Signal to CDC task to stop, unblock it and wait for its deletion
+    xEventGroupSetBits(cdc_acm_obj->event_group, CDC_ACM_TEARDOWN);
+    usb_host_client_unblock(cdc_acm_obj->cdc_acm_client_hdl);
+    ESP_GOTO_ON_FALSE(
+        xEventGroupWaitBits(cdc_acm_obj->event_group, CDC_ACM_TEARDOWN_COMPLETE, pdFALSE, pdFALSE, pdMS_TO_TICKS(100)),
+        ESP_ERR_NOT_FINISHED, unblock, TAG,);
+
+    // Free remaining resources and return
+    for (int i = 0; i < CDC_ACM_SPARE_XFERS_MAX; i++) {
+        if (cdc_acm_obj->spare_xfers[i].xfer != NULL) {
+            usb_host_transfer_free(cdc_acm_obj->spare_xfers[i].xfer);
+        }
+    }
+    vEventGroupDelete(cdc_acm_obj->event_group);
+    xSemaphoreGive(cdc_acm_obj->open_close_mutex);
+    vSemaphoreDelete(cdc_acm_obj->open_close_mutex);
+    free(cdc_acm_obj);
+    return ESP_OK;
+
+unblock:
+    xSemaphoreGive(cdc_acm_obj->open_close_mutex);
+    return ret;
+}
+
+esp_err_t cdc_acm_host_register_new_dev_callback(cdc_acm_new_dev_callback_t new_dev_cb)
+{
+    CDC_ACM_ENTER_CRITICAL();
+    p_cdc_acm_obj->new_dev_cb = new_dev_cb;
+    CDC_ACM_EXIT_CRITICAL();
+    return ESP_OK;
+}
+
+/**
+ * @brief Allocate a USB transfer, reusing a spare one of the same size if there is one
+ *
+ * @note Must be called with open_close_mutex taken
+ * @param[in]  size     Data buffer size
+ * @param[out] transfer Allocated transfer
+ * @return
+ *     - ESP_OK:         Success
+ *     - ESP_ERR_NO_MEM: Not enough memory for the transfer
+ */
+static esp_err_t cdc_acm_transfer_get(size_t size, usb_transfer_t **transfer)
+{
+    for (int i = 0; i < CDC_ACM_SPARE_XFERS_MAX; i++) {
+        if (p_cdc_acm_obj->spare_xfers[i].xfer != NULL && p_cdc_acm_obj->spare_xfers[i].size == size) {
+            *transfer = p_cdc_acm_obj->spare_xfers[i].xfer;
+            p_cdc_acm_obj->spare_xfers[i].xfer = NULL;
+            return ESP_OK;
+        }
+    }
+    return usb_host_transfer_alloc(size, 0, transfer);
+}
+
+/**
+ * @brief Release a USB transfer: park it for the next open if keep_transfers is set, free it otherwise
+ *
+ * @note Must be called with open_close_mutex taken. The transfer must not be in flight.
+ * @param[in] transfer Transfer to release
+ * @param[in] size     Data buffer size it was allocated with
+ */
+static void cdc_acm_transfer_put(usb_transfer_t *transfer, size_t size)
+{
+    if (p_cdc_acm_obj->keep_transfers) {
+        for (int i = 0; i < CDC_ACM_SPARE_XFERS_MAX; i++) {
+            if (p_cdc_acm_obj->spare_xfers[i].xfer == NULL) {
+                p_cdc_acm_obj->spare_xfers[i].xfer = transfer;
+                p_cdc_acm_obj->spare_xfers[i].size = size;
+                return;
+            }
+        }
+    }
+    usb_host_transfer_free(transfer);
+}
+
+/**
+ * @brief Free USB transfers used by this device
+ *
+ * @note There can be no transfers in flight, at the moment of calling this function.
+ * @param[in] cdc_dev Pointer to CDC device
+ */
+static void cdc_acm_transfers_free(cdc_dev_t *cdc_dev)
+{
+    assert(cdc_dev);
+    if (cdc_dev->notif.xfer != NULL) {
+        cdc_acm_transfer_put(cdc_dev->notif.xfer, cdc_dev->notif.buf_len);
+    }
+    if (cdc_dev->data.rx_loan.count > 0) {
+        // With RX loans the IN transfer slots only borrow transfers from the pool, which owns them
+        for (int i = 0; i < cdc_dev->data.rx_loan.count; i++) {
+            if (cdc_dev->data.rx_loan.xfers[i] != NULL) {
+                cdc_acm_transfer_put(cdc_dev->data.rx_loan.xfers[i], cdc_dev->data.in_buf_len);
+                cdc_dev->data.rx_loan.xfers[i] = NULL;
+            }
+        }
+        memset(cdc_dev->data.in_xfers, 0, sizeof(cdc_dev->data.in_xfers));
+        if (cdc_dev->data.rx_loan.filled != NULL) {
+            vQueueDelete(cdc_dev->data.rx_loan.filled);
+        }
+    }
+    if (cdc_dev->data.rx_buf.stream != NULL) {
+        vStreamBufferDelete(cdc_dev->data.rx_buf.stream);
+    }
+    for (int i = 0; i < CDC_ACM_IN_XFERS_MAX; i++) {
+        if (cdc_dev->data.in_xfers[i] != NULL) {
+            cdc_acm_reset_in_transfer(cdc_dev, i);
+            cdc_acm_transfer_put(cdc_dev->data.in_xfers[i], cdc_dev->data.in_buf_len);
+            cdc_dev->data.in_xfers[i] = NULL;
+        }
+    }
+    if (cdc_dev->data.out_xfer != NULL) {
+        if (cdc_dev->data.out_xfer->context != NULL) {
+            vSemaphoreDelete((SemaphoreHandle_t)cdc_dev->data.out_xfer->context);
+        }
+        if (cdc_dev->data.out_mux != NULL) {
+            vSemaphoreDelete(cdc_dev->data.out_mux);
+        }
+        cdc_acm_transfer_put(cdc_dev->data.out_xfer, cdc_dev->data.out_buf_len);
+    }
+    for (int i = 0; i < cdc_dev->data.tx_async.count; i++) {
+        // A zero-copy transfer cancelled by close still points to the user's buffer
+        uint8_t **ptr = (uint8_t **)(&(cdc_dev->data.tx_async.xfers[i]->data_buffer));
+        *ptr = cdc_dev->data.tx_async.data_buffer_base[i];
+        cdc_acm_transfer_put(cdc_dev->data.tx_async.xfers[i], cdc_dev->data.out_buf_len);
+        cdc_dev->data.tx_async.xfers[i] = NULL;
+    }
+    cdc_dev->data.tx_async.count = 0;
+    if (cdc_dev->ctrl_transfer != NULL) {
+        if (cdc_dev->ctrl_transfer->context != NULL) {
+            vSemaphoreDelete((SemaphoreHandle_t)cdc_dev->ctrl_transfer->context);
+        }
+        if (cdc_dev->ctrl_mux != NULL) {
+            vSemaphoreDelete(cdc_dev->ctrl_mux);
+        }
+        cdc_acm_transfer_put(cdc_dev->ctrl_transfer, CDC_ACM_CTRL_TRANSFER_SIZE);
+    }
+}
+
+/**
+ * @brief Allocate CDC transfers
+ *
+ * @param[in] cdc_dev       Pointer to CDC device
+ * @param[in] notif_ep_desc Pointer to notification EP descriptor
+ * @param[in] in_ep_desc-   Pointer to data IN EP descriptor
+ * @param[in] in_buf_len    Length of data IN buffer
+ * @param[in] in_xfer_count Number of data IN transfers kept in flight
+ * @param[in] rx_loan_count Number of additional data IN transfers that can be lent to the user, 0 if the user gets data from in_cb
+ * @param[in] rx_buf_size   Size of the RX ring buffer, 0 if the user gets data from in_cb
+ * @param[in] out_ep_desc   Pointer to data OUT EP descriptor
+ * @param[in] out_buf_len   Length of data OUT buffer
+ * @param[in] tx_xfer_count Number of data OUT transfers for asynchronous sending
+ * @return
+ *     - ESP_OK:            Success
+ *     - ESP_ERR_NO_MEM:    Not enough memory for transfers and semaphores allocation
+ *     - ESP_ERR_NOT_FOUND: IN or OUT endpoints were not found in the selected interface
+ */
+static esp_err_t cdc_acm_transfers_allocate(cdc_dev_t *cdc_dev, const usb_ep_desc_t *notif_ep_desc, const usb_ep_desc_t *in_ep_desc, size_t in_buf_len, uint8_t in_xfer_count, uint8_t rx_loan_count, size_t rx_buf_size, const usb_ep_desc_t *out_ep_desc, size_t out_buf_len, uint8_t tx_xfer_count)
+{
+    assert(in_ep_desc);
+    assert(out_ep_desc);
+    esp_err_t ret;
+
+    // 1. Setup notification transfer if it is supported
+    if (notif_ep_desc) {
+        ESP_GOTO_ON_ERROR(
+            cdc_acm_transfer_get(USB_EP_DESC_GET_MPS(notif_ep_desc), &cdc_dev->notif.xfer),
+            err, TAG,);
+        cdc_dev->notif.buf_len = USB_EP_DESC_GET_MPS(notif_ep_desc);
+        cdc_dev->notif.xfer->device_handle = cdc_dev->dev_hdl;
+        cdc_dev->notif.xfer->bEndpointAddress = notif_ep_desc->bEndpointAddress;
+        cdc_dev->notif.xfer->callback = notif_xfer_cb;
+        cdc_dev->notif.xfer->context = cdc_dev;
+        cdc_dev->notif.xfer->num_bytes = USB_EP_DESC_GET_MPS(notif_ep_desc);
+    }
+
+    // 2. Setup control transfer
+    ESP_GOTO_ON_ERROR(
+        cdc_acm_transfer_get(CDC_ACM_CTRL_TRANSFER_SIZE, &cdc_dev->ctrl_transfer),
+        err, TAG,);
+    cdc_dev->ctrl_transfer->timeout_ms = 1000;
+    cdc_dev->ctrl_transfer->bEndpointAddress = 0;
+    cdc_dev->ctrl_transfer->device_handle = cdc_dev->dev_hdl;
+    cdc_dev->ctrl_transfer->callback = out_xfer_cb;
+    cdc_dev->ctrl_transfer->context = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(cdc_dev->ctrl_transfer->context, ESP_ERR_NO_MEM, err, TAG,);
+    cdc_dev->ctrl_mux = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(cdc_dev->ctrl_mux, ESP_ERR_NO_MEM, err, TAG,);
+
+    // 3. Setup IN data transfers (if they are required (in_buf_len > 0))
+    //    With RX loans, all of them are allocated into the pool; the first in_xfer_count go into the IN transfer slots
+    if (in_buf_len != 0) {
+        cdc_dev->data.in_buf_len = in_buf_len;
+        cdc_dev->data.in_mps = USB_EP_DESC_GET_MPS(in_ep_desc);
+        const int total = (rx_loan_count > 0) ? in_xfer_count + rx_loan_count : in_xfer_count;
+        if (rx_loan_count > 0) {
+            cdc_dev->data.rx_loan.filled = xQueueCreate(total, sizeof(usb_transfer_t *));
+            ESP_GOTO_ON_FALSE(cdc_dev->data.rx_loan.filled, ESP_ERR_NO_MEM, err, TAG,);
+        }
+        if (rx_buf_size > 0) {
+            cdc_dev->data.rx_buf.stream = xStreamBufferCreate(rx_buf_size, 1);
+            ESP_GOTO_ON_FALSE(cdc_dev->data.rx_buf.stream, ESP_ERR_NO_MEM, err, TAG,);
+            cdc_dev->data.rx_buf.size = rx_buf_size;
+        }
+        for (int i = 0; i < total; i++) {
+            usb_transfer_t *in_xfer;
+            ESP_GOTO_ON_ERROR(
+                cdc_acm_transfer_get(in_buf_len, &in_xfer),
+                err, TAG,
+            );
+            assert(in_xfer);
+            in_xfer->callback = in_xfer_cb;
+            in_xfer->num_bytes = in_buf_len;
+            in_xfer->bEndpointAddress = in_ep_desc->bEndpointAddress;
+            in_xfer->device_handle = cdc_dev->dev_hdl;
+            in_xfer->context = cdc_dev;
+            if (rx_loan_count > 0) {
+                cdc_dev->data.rx_loan.xfers[i] = in_xfer;
+                cdc_dev->data.rx_loan.count = i + 1;
+            }
+            if (i < in_xfer_count) {
+                cdc_dev->data.in_xfers[i] = in_xfer;
+                cdc_dev->data.in_data_buffer_base[i] = in_xfer->data_buffer;
+            } else {
+                cdc_dev->data.rx_loan.free |= (1U << i);
+            }
+        }
+        cdc_dev->data.in_xfer_count = in_xfer_count;
+    }
+
+    // 4. Setup OUT bulk transfer (if it is required (out_buf_len > 0))
+    if (out_buf_len != 0) {
+        ESP_GOTO_ON_ERROR(
+            cdc_acm_transfer_get(out_buf_len, &cdc_dev->data.out_xfer),
+            err, TAG,
+        );
+        cdc_dev->data.out_buf_len = out_buf_len;
+        assert(cdc_dev->data.out_xfer);
+        cdc_dev->data.out_xfer->device_handle = cdc_dev->dev_hdl;
+        cdc_dev->data.out_xfer->context = xSemaphoreCreateBinary();
+        ESP_GOTO_ON_FALSE(cdc_dev->data.out_xfer->context, ESP_ERR_NO_MEM, err, TAG,);
+        cdc_dev->data.out_mux = xSemaphoreCreateMutex();
+        ESP_GOTO_ON_FALSE(cdc_dev->data.out_mux, ESP_ERR_NO_MEM, err, TAG,);
+        cdc_dev->data.out_xfer->bEndpointAddress = out_ep_desc->bEndpointAddress;
+        cdc_dev->data.out_xfer->callback = out_xfer_cb;
+
+        // 5. Setup OUT bulk transfers for asynchronous sending
+        for (int i = 0; i < tx_xfer_count; i++) {
+            usb_transfer_t *tx_xfer;
+            ESP_GOTO_ON_ERROR(
+                cdc_acm_transfer_get(out_buf_len, &tx_xfer),
+                err, TAG,
+            );
+            assert(tx_xfer);
+            tx_xfer->device_handle = cdc_dev->dev_hdl;
+            tx_xfer->bEndpointAddress = out_ep_desc->bEndpointAddress;
+            tx_xfer->callback = tx_async_xfer_cb;
+            tx_xfer->context = cdc_dev;
+            cdc_dev->data.tx_async.xfers[i] = tx_xfer;
+            cdc_dev->data.tx_async.data_buffer_base[i] = tx_xfer->data_buffer;
+            cdc_dev->data.tx_async.free |= (1U << i);
+            cdc_dev->data.tx_async.count = i + 1;
+        }
+    }
+    return ESP_OK;
+
+err:
+    cdc_acm_transfers_free(cdc_dev);
+    return ret;
+}
+
+/**
+ * @brief Check device configuration passed to cdc_acm_host_open() or cdc_acm_host_open_on_arrival()
+ *
+ * @param[in] dev_config Configuration structure of the device
+ * @return ESP_OK or ESP_ERR_INVALID_ARG
+ */
+static esp_err_t cdc_acm_check_device_config(const cdc_acm_host_device_config_t *dev_config)
+{
+    CDC_ACM_CHECK(dev_config, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(dev_config->in_xfer_count <= CDC_ACM_IN_XFERS_MAX, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(dev_config->rx_loan_count <= CDC_ACM_RX_LOANS_MAX, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(dev_config->tx_xfer_count <= CDC_ACM_TX_XFERS_MAX, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK((dev_config->tx_xfer_count == 0) || (dev_config->out_buffer_size > 0), ESP_ERR_INVALID_ARG);
+    // Received data goes to one of data_cb, the RX loans or the RX ring buffer
+    CDC_ACM_CHECK((!!dev_config->data_cb + !!dev_config->rx_loan_count + !!dev_config->rx_buffer_size) <= 1, ESP_ERR_INVALID_ARG);
+    return ESP_OK;
+}
+
+/**
+ * @brief Open CDC interface on top of a USB device
+ *
+ * Parses the interface, allocates its transfers, claims its interfaces and starts the device.
+ *
+ * @note Must be called with open_close_mutex taken. On error, cdc_dev is removed.
+ * @param[in] cdc_dev       CDC device with opened USB device, from cdc_acm_find_and_open_usb_device() or a new device event
+ * @param[in] interface_idx Index of device's interface used for CDC-ACM communication
+ * @param[in] dev_config    Configuration structure of the device, checked by cdc_acm_check_device_config()
+ * @return esp_err_t
+ */
+static esp_err_t cdc_acm_device_open(cdc_dev_t *cdc_dev, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config)
+{
+    esp_err_t ret;
+
+    // Get Device and Configuration descriptors
+    const usb_config_desc_t *config_desc;
+    const usb_device_desc_t *device_desc;
+    ESP_ERROR_CHECK(usb_host_get_device_descriptor(cdc_dev->dev_hdl, &device_desc));
+    ESP_ERROR_CHECK(usb_host_get_active_config_descriptor(cdc_dev->dev_hdl, &config_desc));
+
+    // Parse the required interface descriptor
+    cdc_parsed_info_t cdc_info;
+    if (p_cdc_acm_obj->cache_descriptors) {
+        ret = cdc_parse_interface_descriptor_cached(p_cdc_acm_obj->desc_cache, CDC_ACM_DESC_CACHE_SIZE,
+                                                    device_desc, config_desc, interface_idx, &cdc_info, NULL);
+    } else {
+        ret = cdc_parse_interface_descriptor(device_desc, config_desc, interface_idx, &cdc_info);
+    }
+    ESP_GOTO_ON_ERROR(ret, err, TAG, "Could not open required interface as CDC");
+
+    // Save all members of cdc_dev
+    cdc_dev->data.intf_desc = cdc_info.data_intf;
+    cdc_dev->data_protocol = (cdc_data_protocol_t)cdc_dev->data.intf_desc->bInterfaceProtocol;
+    cdc_dev->notif.intf_desc = cdc_info.notif_intf;
+    if (cdc_info.notif_intf) {
+        cdc_dev->comm_protocol = (cdc_comm_protocol_t)cdc_dev->notif.intf_desc->bInterfaceProtocol;
+    }
+    cdc_dev->cdc_func_desc = cdc_info.func;
+    cdc_dev->cdc_func_desc_cnt = cdc_info.func_cnt;
+
+    // For CDC compliant devices, this driver provides default implementation of CDC-ACM specific functions.
+    if (cdc_dev->cdc_func_desc_cnt > 1) {
+        cdc_dev->intf_func.line_coding_get = acm_compliant_line_coding_get;
+        cdc_dev->intf_func.line_coding_set = acm_compliant_line_coding_set;
+        cdc_dev->intf_func.set_control_line_state = acm_compliant_set_control_line_state;
+        cdc_dev->intf_func.send_break = acm_compliant_send_break;
+    }
+
+    // The following line is here for backward compatibility with v1.0.*
+    // where fixed size of IN buffer (equal to IN Maximum Packet Size) was used
+    const bool rx_enabled = (dev_config->data_cb != NULL) || (dev_config->rx_loan_count > 0) || (dev_config->rx_buffer_size > 0);
+    const size_t in_buf_size = (rx_enabled && (dev_config->in_buffer_size == 0)) ? USB_EP_DESC_GET_MPS(cdc_info.in_ep) : dev_config->in_buffer_size;
+    const uint8_t in_xfer_count = (dev_config->in_xfer_count == 0) ? 1 : dev_config->in_xfer_count;
+
+    // Allocate USB transfers, claim CDC interfaces and return CDC-ACM handle
+    ESP_GOTO_ON_ERROR(
+        cdc_acm_transfers_allocate(cdc_dev, cdc_info.notif_ep, cdc_info.in_ep, in_buf_size, in_xfer_count, dev_config->rx_loan_count, dev_config->rx_buffer_size, cdc_info.out_ep, dev_config->out_buffer_size, dev_config->tx_xfer_count),
+        err, TAG,);
+    ESP_GOTO_ON_ERROR(cdc_acm_start(cdc_dev, dev_config->event_cb, dev_config->data_cb, dev_config->user_arg), err, TAG,);
+    return ESP_OK;
+
+err:
+    cdc_acm_device_remove(cdc_dev);
+    return ret;
+}
+
+esp_err_t cdc_acm_host_open(uint16_t vid, uint16_t pid, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config, cdc_acm_dev_hdl_t *cdc_hdl_ret)
+{
+    esp_err_t ret;
+    CDC_ACM_CHECK(p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+    CDC_ACM_CHECK(cdc_hdl_ret, ESP_ERR_INVALID_ARG);
+    ret = cdc_acm_check_device_config(dev_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+    // Find underlying USB device
+    cdc_dev_t *cdc_dev;
+    ret =  cdc_acm_find_and_open_usb_device(vid, pid, dev_config->connection_timeout_ms, &cdc_dev);
+    if (ESP_OK == ret) {
+        ret = cdc_acm_device_open(cdc_dev, interface_idx, dev_config);
+    }
+    xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+    *cdc_hdl_ret = (ESP_OK == ret) ? (cdc_acm_dev_hdl_t)cdc_dev : NULL;
+    return ret;
+}
+
+esp_err_t cdc_acm_host_open_by_address(uint8_t dev_addr, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config, cdc_acm_dev_hdl_t *cdc_hdl_ret)
+{
+    esp_err_t ret;
+    CDC_ACM_CHECK(p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+    CDC_ACM_CHECK(cdc_hdl_ret, ESP_ERR_INVALID_ARG);
+    *cdc_hdl_ret = NULL;
+    ret = cdc_acm_check_device_config(dev_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    cdc_dev_t *cdc_dev = calloc(1, sizeof(cdc_dev_t));
+    if (cdc_dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+    // Another interface of the device may be open already: share its USB device handle, like cdc_acm_host_open()
+    cdc_dev_t *open_dev;
+    SLIST_FOREACH(open_dev, &p_cdc_acm_obj->cdc_devices_list, list_entry) {
+        usb_device_info_t dev_info;
+        if (usb_host_device_info(open_dev->dev_hdl, &dev_info) == ESP_OK && dev_info.dev_addr == dev_addr) {
+            cdc_dev->dev_hdl = open_dev->dev_hdl;
+            break;
+        }
+    }
+    ret = ESP_OK;
+    if (cdc_dev->dev_hdl == NULL) {
+        usb_device_handle_t dev_hdl;
+        if (usb_host_device_open(p_cdc_acm_obj->cdc_acm_client_hdl, dev_addr, &dev_hdl) == ESP_OK) {
+            assert(dev_hdl);
+            const usb_device_desc_t *device_desc;
+            ESP_ERROR_CHECK(usb_host_get_device_descriptor(dev_hdl, &device_desc));
+            if (device_desc->bDeviceClass != USB_CLASS_HUB) {
+                cdc_dev->dev_hdl = dev_hdl;
+            } else {
+                usb_host_device_close(p_cdc_acm_obj->cdc_acm_client_hdl, dev_hdl);
+            }
+        }
+        if (cdc_dev->dev_hdl == NULL) {
+            free(cdc_dev);
+            cdc_dev = NULL;
+            ret = ESP_ERR_NOT_FOUND;
+        }
+    }
+    if (ESP_OK == ret) {
+        ret = cdc_acm_device_open(cdc_dev, interface_idx, dev_config);
+    }
+    xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+    *cdc_hdl_ret = (ESP_OK == ret) ? (cdc_acm_dev_hdl_t)cdc_dev : NULL;
+    return ret;
+}
+
+esp_err_t cdc_acm_host_open_on_arrival(uint16_t vid, uint16_t pid, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config,
+                                       cdc_acm_arrival_callback_t arrival_cb, void *arrival_arg)
+{
+    esp_err_t ret;
+    CDC_ACM_CHECK(p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+    CDC_ACM_CHECK(arrival_cb, ESP_ERR_INVALID_ARG);
+    ret = cdc_acm_check_device_config(dev_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+    int free_slot = -1;
+    ret = ESP_ERR_NO_MEM;
+    for (int i = 0; i < CDC_ACM_ARRIVALS_MAX; i++) {
+        if (!p_cdc_acm_obj->arrivals[i].used) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+        } else if (p_cdc_acm_obj->arrivals[i].vid == vid && p_cdc_acm_obj->arrivals[i].pid == pid &&
+                   p_cdc_acm_obj->arrivals[i].interface_idx == interface_idx) {
+            ret = ESP_ERR_INVALID_STATE; // Already registered
+            free_slot = -1;
+            break;
+        }
+    }
+    if (free_slot >= 0) {
+        p_cdc_acm_obj->arrivals[free_slot].vid = vid;
+        p_cdc_acm_obj->arrivals[free_slot].pid = pid;
+        p_cdc_acm_obj->arrivals[free_slot].interface_idx = interface_idx;
+        p_cdc_acm_obj->arrivals[free_slot].dev_config = *dev_config;
+        p_cdc_acm_obj->arrivals[free_slot].arrival_cb = arrival_cb;
+        p_cdc_acm_obj->arrivals[free_slot].arrival_arg = arrival_arg;
+        CDC_ACM_ENTER_CRITICAL();
+        p_cdc_acm_obj->arrivals[free_slot].used = true;
+        p_cdc_acm_obj->arrivals_used++;
+        CDC_ACM_EXIT_CRITICAL();
+        ret = ESP_OK;
+    }
+    xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+    return ret;
+}
+
+esp_err_t cdc_acm_host_open_on_arrival_cancel(uint16_t vid, uint16_t pid, uint8_t interface_idx)
+{
+    CDC_ACM_CHECK(p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+    for (int i = 0; i < CDC_ACM_ARRIVALS_MAX; i++) {
+        if (p_cdc_acm_obj->arrivals[i].used && p_cdc_acm_obj->arrivals[i].vid == vid &&
+                p_cdc_acm_obj->arrivals[i].pid == pid && p_cdc_acm_obj->arrivals[i].interface_idx == interface_idx) {
+            CDC_ACM_ENTER_CRITICAL();
+            p_cdc_acm_obj->arrivals[i].used = false;
+            p_cdc_acm_obj->arrivals_used--;
+            CDC_ACM_EXIT_CRITICAL();
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+    return ret;
+}
+
+esp_err_t cdc_acm_host_close(cdc_acm_dev_hdl_t cdc_hdl)
+{
+    CDC_ACM_CHECK(p_cdc_acm_obj, ESP_ERR_INVALID_STATE);
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+
+    // Make sure that the device is in the devices list (that it is not already closed)
+    cdc_dev_t *cdc_dev;
+    bool device_found = false;
+    CDC_ACM_ENTER_CRITICAL();
+    SLIST_FOREACH(cdc_dev, &p_cdc_acm_obj->cdc_devices_list, list_entry) {
+        if (cdc_dev == (cdc_dev_t *)cdc_hdl) {
+            device_found = true;
+            break;
+        }
+    }
+
+    // Device was not found in the cdc_devices_list; it was already closed, return OK
+    if (!device_found) {
+        CDC_ACM_EXIT_CRITICAL();
+        xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+        return ESP_OK;
+    }
+
+    // No user callbacks from this point
+    cdc_dev->notif.cb = NULL;
+    cdc_dev->data.in_cb = NULL;
+    cdc_dev->data.in_stopped = true; // Nor IN transfer resubmission, which buffers released by the user could otherwise trigger
+    cdc_dev->data.tx_async.stopped = true;
+    const bool tx_async_in_flight = cdc_dev->data.tx_async.free != (uint8_t)((1U << cdc_dev->data.tx_async.count) - 1);
+    CDC_ACM_EXIT_CRITICAL();
+
+    // Cancel asynchronous sending, so that no transfer uses the user's buffer after close
+    if (tx_async_in_flight) {
+        ESP_ERROR_CHECK(cdc_acm_reset_transfer_endpoint(cdc_dev->dev_hdl, cdc_dev->data.tx_async.xfers[0]));
+    }
+
+    // Cancel polling of BULK IN and INTERRUPT IN. Flushing the endpoint cancels all of its IN transfers
+    if (cdc_dev->data.in_xfer_count > 0) {
+        // With RX loans, a slot may be empty: any transfer of the pool carries the endpoint address
+        usb_transfer_t *in_xfer = (cdc_dev->data.rx_loan.count > 0) ? cdc_dev->data.rx_loan.xfers[0] : cdc_dev->data.in_xfers[0];
+        ESP_ERROR_CHECK(cdc_acm_reset_transfer_endpoint(cdc_dev->dev_hdl, in_xfer));
+    }
+    if (cdc_dev->notif.xfer != NULL) {
+        ESP_ERROR_CHECK(cdc_acm_reset_transfer_endpoint(cdc_dev->dev_hdl, cdc_dev->notif.xfer));
+    }
+
+    // Release all interfaces
+    ESP_ERROR_CHECK(usb_host_interface_release(p_cdc_acm_obj->cdc_acm_client_hdl, cdc_dev->dev_hdl, cdc_dev->data.intf_desc->bInterfaceNumber));
+    if ((cdc_dev->notif.intf_desc != NULL) && (cdc_dev->notif.intf_desc != cdc_dev->data.intf_desc)) {
+        ESP_ERROR_CHECK(usb_host_interface_release(p_cdc_acm_obj->cdc_acm_client_hdl, cdc_dev->dev_hdl, cdc_dev->notif.intf_desc->bInterfaceNumber));
+    }
+
+    CDC_ACM_ENTER_CRITICAL();
+    SLIST_REMOVE(&p_cdc_acm_obj->cdc_devices_list, cdc_dev, cdc_dev_s, list_entry);
+    CDC_ACM_EXIT_CRITICAL();
+
+    cdc_acm_device_remove(cdc_dev);
+    xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+    return ESP_OK;
+}
+
+void cdc_acm_host_desc_print(cdc_acm_dev_hdl_t cdc_hdl)
+{
+    assert(cdc_hdl);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+
+    const usb_device_desc_t *device_desc;
+    const usb_config_desc_t *config_desc;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(usb_host_get_device_descriptor(cdc_dev->dev_hdl, &device_desc));
+    ESP_ERROR_CHECK_WITHOUT_ABORT(usb_host_get_active_config_descriptor(cdc_dev->dev_hdl, &config_desc));
+    usb_print_device_descriptor(device_desc);
+    usb_print_config_descriptor(config_desc, cdc_print_desc);
+}
+
+/**
+ * @brief Check finished transfer status
+ *
+ * Return to on transfer completed OK.
+ * Cancel the transfer and issue user's callback in case of an error.
+ *
+ * @param[in] transfer Transfer to be checked
+ * @return true Transfer completed
+ * @return false Transfer NOT completed
+ */
+static bool cdc_acm_is_transfer_completed(usb_transfer_t *transfer)
+{
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)transfer->context;
+    bool completed = false;
+
+    if (transfer->status != USB_TRANSFER_STATUS_COMPLETED && transfer->status < CDC_ACM_STATS_STATUS_MAX) {
+        CDC_ACM_ENTER_CRITICAL();
+        cdc_dev->stats.errors[transfer->status]++;
+        CDC_ACM_EXIT_CRITICAL();
+    }
+
+    switch (transfer->status) {
+    case USB_TRANSFER_STATUS_COMPLETED:
+        completed = true;
+        break;
+    case USB_TRANSFER_STATUS_NO_DEVICE: // User is notified about device disconnection from usb_event_cb
+    case USB_TRANSFER_STATUS_CANCELED:
+        break;
+    case USB_TRANSFER_STATUS_ERROR:
+    case USB_TRANSFER_STATUS_TIMED_OUT:
+    case USB_TRANSFER_STATUS_STALL:
+    case USB_TRANSFER_STATUS_OVERFLOW:
+    case USB_TRANSFER_STATUS_SKIPPED:
+    default:
+        // Transfer was not completed or cancelled by user. Inform user about this
+        if (cdc_dev->notif.cb) {
+            const cdc_acm_host_dev_event_data_t error_event = {
+                .type = CDC_ACM_HOST_ERROR,
+                .data.error = (int) transfer->status
+            };
+            cdc_dev->notif.cb(&error_event, cdc_dev->cb_arg);
+        }
+    }
+    return completed;
+}
+
+/**
+ * @brief Find a transfer in the RX loan pool
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ * @param[in] data    Data buffer of the transfer
+ * @return Index of the transfer in the pool, -1 if it is not there
+ */
+static int cdc_acm_rx_loan_find(const cdc_dev_t *cdc_dev, const uint8_t *data)
+{
+    for (int i = 0; i < cdc_dev->data.rx_loan.count; i++) {
+        if (cdc_dev->data.rx_loan.xfers[i]->data_buffer == data) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Submit free pool transfers into IN transfer slots waiting for one
+ *
+ * Called both from the driver task, after a slot's transfer is queued for the user, and from the user's task,
+ * after a buffer is released. Slots are refilled strictly in slot order so that data is still delivered in the
+ * order it was received, and only one task at a time submits: the other just leaves its free transfer behind.
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ */
+static void cdc_acm_rx_loan_refill(cdc_dev_t *cdc_dev)
+{
+    CDC_ACM_ENTER_CRITICAL();
+    if (cdc_dev->data.rx_loan.refilling) {
+        CDC_ACM_EXIT_CRITICAL();
+        return;
+    }
+    cdc_dev->data.rx_loan.refilling = true;
+    while (!cdc_dev->data.in_stopped &&
+            (cdc_dev->data.rx_loan.pending & (1U << cdc_dev->data.rx_loan.refill_next)) &&
+            (cdc_dev->data.rx_loan.free != 0)) {
+        const int slot = cdc_dev->data.rx_loan.refill_next;
+        const int i = __builtin_ctz(cdc_dev->data.rx_loan.free);
+        usb_transfer_t *transfer = cdc_dev->data.rx_loan.xfers[i];
+        cdc_dev->data.rx_loan.free &= ~(1U << i);
+        cdc_dev->data.rx_loan.pending &= ~(1U << slot);
+        cdc_dev->data.rx_loan.refill_next = (slot + 1) % cdc_dev->data.in_xfer_count;
+        cdc_dev->data.in_xfers[slot] = transfer;
+        cdc_dev->data.in_data_buffer_base[slot] = transfer->data_buffer;
+        CDC_ACM_EXIT_CRITICAL();
+
+        cdc_acm_reset_in_transfer(cdc_dev, slot);
+        cdc_acm_stats_in_resubmit(cdc_dev, slot);
+        ESP_LOGD(TAG, "Submitting poll for BULK IN transfer %d", slot);
+        usb_host_transfer_submit(transfer);
+        CDC_ACM_ENTER_CRITICAL();
+    }
+    cdc_dev->data.rx_loan.refilling = false;
+    CDC_ACM_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Queue one completed IN transfer for cdc_acm_host_rx_acquire() and refill its slot from the pool
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ * @param[in] idx     Index of the IN transfer
+ */
+static void cdc_acm_rx_loan_deliver(cdc_dev_t *cdc_dev, int idx)
+{
+    usb_transfer_t *transfer = cdc_dev->data.in_xfers[idx];
+    const int i = cdc_acm_rx_loan_find(cdc_dev, transfer->data_buffer);
+    assert(i >= 0);
+
+    CDC_ACM_ENTER_CRITICAL();
+    cdc_dev->data.in_xfers[idx] = NULL;
+    cdc_dev->data.rx_loan.pending |= (1U << idx);
+    if (transfer->actual_num_bytes == 0) {
+        cdc_dev->data.rx_loan.free |= (1U << i); // Nothing to lend, the transfer can be submitted again
+    }
+    CDC_ACM_EXIT_CRITICAL();
+
+    if (transfer->actual_num_bytes > 0) {
+        // The queue can hold the whole pool, so this never fails
+        xQueueSend(cdc_dev->data.rx_loan.filled, &transfer, 0);
+    }
+    cdc_acm_rx_loan_refill(cdc_dev);
+}
+
+/**
+ * @brief Copy received data into the RX ring buffer
+ *
+ * Data that does not fit is dropped and reported as overrun, like data lost in a full UART FIFO.
+ * Every push that adds data is signalled with a CDC_ACM_HOST_RX_DATA event, so a reader can sleep in between.
+ *
+ * @param[in] cdc_dev  Pointer to CDC device
+ * @param[in] transfer Completed IN transfer
+ */
+static void cdc_acm_rx_buffer_push(cdc_dev_t *cdc_dev, const usb_transfer_t *transfer)
+{
+    const size_t len = transfer->actual_num_bytes;
+    const size_t written = xStreamBufferSend(cdc_dev->data.rx_buf.stream, transfer->data_buffer, len, 0);
+    const size_t used = xStreamBufferBytesAvailable(cdc_dev->data.rx_buf.stream);
+    if (used > cdc_dev->data.rx_buf.high_water) {
+        cdc_dev->data.rx_buf.high_water = used;
+    }
+
+    // Signal every push, not only the first into an empty ring buffer: a reader that is still draining may have
+    // already passed the point where it would see this data, and would otherwise sleep with it in the ring buffer
+    if ((written > 0) && cdc_dev->notif.cb) {
+        const cdc_acm_host_dev_event_data_t rx_data_event = {
+            .type = CDC_ACM_HOST_RX_DATA,
+            .data.cdc_hdl = (cdc_acm_dev_hdl_t) cdc_dev,
+        };
+        cdc_dev->notif.cb(&rx_data_event, cdc_dev->cb_arg);
+    }
+    if (written < len) {
+        ESP_LOGW(TAG, "RX ring buffer overflow, %zu bytes dropped", len - written);
+        cdc_dev->data.rx_buf.overflows++;
+        cdc_dev->data.rx_buf.dropped_bytes += len - written;
+        CDC_ACM_ENTER_CRITICAL();
+        cdc_dev->stats.in.overflows++;
+        CDC_ACM_EXIT_CRITICAL();
+        cdc_dev->serial_state.bOverRun = true;
+        if (cdc_dev->notif.cb) {
+            const cdc_acm_host_dev_event_data_t serial_state_event = {
+                .type = CDC_ACM_HOST_SERIAL_STATE,
+                .data.serial_state = cdc_dev->serial_state
+            };
+            cdc_dev->notif.cb(&serial_state_event, cdc_dev->cb_arg);
+        }
+        cdc_dev->serial_state.bOverRun = false;
+    }
+}
+
+/**
+ * @brief Deliver one completed IN transfer to the user and resubmit it
+ *
+ * @param[in] cdc_dev Pointer to CDC device
+ * @param[in] idx     Index of the IN transfer
+ */
+static void cdc_acm_in_xfer_deliver(cdc_dev_t *cdc_dev, int idx)
+{
+    if (cdc_dev->data.rx_loan.count > 0) {
+        cdc_acm_rx_loan_deliver(cdc_dev, idx);
+        return;
+    }
+
+    usb_transfer_t *transfer = cdc_dev->data.in_xfers[idx];
+
+    if (cdc_dev->data.rx_buf.stream) {
+        // Only copy here: the user reads the ring buffer from its own task
+        cdc_acm_rx_buffer_push(cdc_dev, transfer);
+        cdc_acm_reset_in_transfer(cdc_dev, idx);
+    } else if (cdc_dev->data.in_cb) {
+        const int64_t cb_start_us = esp_timer_get_time();
+        const bool data_processed = cdc_dev->data.in_cb(transfer->data_buffer, transfer->actual_num_bytes, cdc_dev->cb_arg);
+        cdc_acm_stats_data_cb_time(cdc_dev, (uint32_t)(esp_timer_get_time() - cb_start_us));
+
+        // Information for developers:
+        // In order to save RAM and CPU time, the application can indicate that the received data was not processed and that the application expects more data.
+        // In this case, the next received data must be appended to the existing buffer.
+        // Since the data_buffer in usb_transfer_t is a constant pointer, we must cast away to const qualifier.
+        if (!data_processed && cdc_dev->data.in_xfer_count > 1) {
+            // The next RX data is already being received into another transfer, so it cannot be appended here
+            ESP_LOGW(TAG, "RX buffer append is not supported with more than one IN transfer");
+            cdc_acm_reset_in_transfer(cdc_dev, idx);
+        } else if (!data_processed) {
+#if !SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+            // In case the received data was not processed, the next RX data must be appended to current buffer
+            uint8_t **ptr = (uint8_t **)(&(transfer->data_buffer));
+            *ptr += transfer->actual_num_bytes;
+
+            // Calculate remaining space in the buffer. Attention: pointer arithmetic!
+            size_t space_left = transfer->data_buffer_size - (transfer->data_buffer - cdc_dev->data.in_data_buffer_base[idx]);
+            uint16_t mps = cdc_dev->data.in_mps;
+            transfer->num_bytes = (space_left / mps) * mps; // Round down to MPS for next transfer
+
+            if (transfer->num_bytes == 0) {
+                // The IN buffer cannot accept more data, inform the user and reset the buffer
+                ESP_LOGW(TAG, "IN buffer overflow");
+                CDC_ACM_ENTER_CRITICAL();
+                cdc_dev->stats.in.overflows++;
+                CDC_ACM_EXIT_CRITICAL();
+                cdc_dev->serial_state.bOverRun = true;
+                if (cdc_dev->notif.cb) {
+                    const cdc_acm_host_dev_event_data_t serial_state_event = {
+                        .type = CDC_ACM_HOST_SERIAL_STATE,
+                        .data.serial_state = cdc_dev->serial_state
+                    };
+                    cdc_dev->notif.cb(&serial_state_event, cdc_dev->cb_arg);
+                }
+
+                cdc_acm_reset_in_transfer(cdc_dev, idx);
+                cdc_dev->serial_state.bOverRun = false;
+            }
+#else
+            // For targets that must sync internal memory through L1CACHE, we cannot change the data_buffer
+            // because it would lead to unaligned cache sync, which is not allowed
+            ESP_LOGW(TAG, "RX buffer append is not yet supported on ESP32-P4!");
+#endif
+        } else {
+            cdc_acm_reset_in_transfer(cdc_dev, idx);
+        }
+    }
+
+    cdc_acm_stats_in_resubmit(cdc_dev, idx);
+    ESP_LOGD(TAG, "Submitting poll for BULK IN transfer %d", idx);
+    usb_host_transfer_submit(transfer);
+}
+
+static void in_xfer_cb(usb_transfer_t *transfer)
+{
+    ESP_LOGD(TAG, "in xfer cb");
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)transfer->context;
+
+    if (!cdc_acm_is_transfer_completed(transfer)) {
+        // As with a single transfer, the IN endpoint is not polled again until the device is resumed or reopened
+        cdc_dev->data.in_stopped = true;
+        return;
+    }
+    if (cdc_dev->data.in_stopped) {
+        return;
+    }
+
+    int idx = 0;
+    while (cdc_dev->data.in_xfers[idx] != transfer) {
+        idx++;
+        assert(idx < cdc_dev->data.in_xfer_count);
+    }
+    const int64_t done_us = esp_timer_get_time();
+    CDC_ACM_ENTER_CRITICAL();
+    cdc_dev->in_done_us[idx] = done_us;
+    cdc_dev->in_done_timed |= (1U << idx);
+    cdc_dev->stats.in.transfers++;
+    cdc_dev->stats.in.bytes += transfer->actual_num_bytes;
+    CDC_ACM_EXIT_CRITICAL();
+
+    // Transfers of one endpoint complete in the order they were submitted, so this is normally the next one.
+    // Should one ever overtake another, it is held back until those before it are delivered
+    cdc_dev->data.in_done |= (1U << idx);
+    while (cdc_dev->data.in_done & (1U << cdc_dev->data.in_next)) {
+        const int next = cdc_dev->data.in_next;
+        cdc_dev->data.in_done &= ~(1U << next);
+        cdc_dev->data.in_next = (next + 1) % cdc_dev->data.in_xfer_count;
+        cdc_acm_in_xfer_deliver(cdc_dev, next);
+    }
+}
+
+static void notif_xfer_cb(usb_transfer_t *transfer)
+{
+    ESP_LOGD(TAG, "notif xfer cb");
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)transfer->context;
+
+    if (cdc_acm_is_transfer_completed(transfer)) {
+        cdc_notification_t *notif = (cdc_notification_t *)transfer->data_buffer;
+        switch (notif->bNotificationCode) {
+        case USB_CDC_NOTIF_NETWORK_CONNECTION: {
+            if (cdc_dev->notif.cb) {
+                const cdc_acm_host_dev_event_data_t net_conn_event = {
+                    .type = CDC_ACM_HOST_NETWORK_CONNECTION,
+                    .data.network_connected = (bool) notif->wValue
+                };
+                cdc_dev->notif.cb(&net_conn_event, cdc_dev->cb_arg);
+            }
+            break;
+        }
+        case USB_CDC_NOTIF_SERIAL_STATE: {
+            cdc_dev->serial_state.val = *((uint16_t *)notif->Data);
+            if (cdc_dev->serial_state.bOverRun) {
+                CDC_ACM_ENTER_CRITICAL();
+                cdc_dev->stats.in.serial_overruns++;
+                CDC_ACM_EXIT_CRITICAL();
+            }
+            if (cdc_dev->notif.cb) {
+                const cdc_acm_host_dev_event_data_t serial_state_event = {
+                    .type = CDC_ACM_HOST_SERIAL_STATE,
+                    .data.serial_state = cdc_dev->serial_state
+                };
+                cdc_dev->notif.cb(&serial_state_event, cdc_dev->cb_arg);
+            }
+            break;
+        }
+        case USB_CDC_NOTIF_RESPONSE_AVAILABLE: // Encapsulated commands not implemented - fallthrough
+        default:
+            ESP_LOGW(TAG, "Unsupported notification type 0x%02X", notif->bNotificationCode);
+            ESP_LOG_BUFFER_HEX(TAG, transfer->data_buffer, transfer->actual_num_bytes);
+            break;
+        }
+
+        // Start polling for new data again
+        ESP_LOGD(TAG, "Submitting poll for INTR IN transfer");
+        usb_host_transfer_submit(cdc_dev->notif.xfer);
+    }
+}
+
+static void out_xfer_cb(usb_transfer_t *transfer)
+{
+    ESP_LOGD(TAG, "out/ctrl xfer cb");
+    assert(transfer->context);
+    xSemaphoreGive((SemaphoreHandle_t)transfer->context);
+}
+
+static void tx_async_xfer_cb(usb_transfer_t *transfer)
+{
+    ESP_LOGD(TAG, "async out xfer cb");
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)transfer->context;
+    const bool sent = cdc_acm_is_transfer_completed(transfer) && (transfer->actual_num_bytes == transfer->num_bytes);
+    if (sent) {
+        CDC_ACM_ENTER_CRITICAL();
+        cdc_dev->stats.out.transfers++;
+        cdc_dev->stats.out.bytes += transfer->actual_num_bytes;
+        CDC_ACM_EXIT_CRITICAL();
+    }
+
+    int idx = 0;
+    while (cdc_dev->data.tx_async.xfers[idx] != transfer) {
+        idx++;
+    }
+
+    // Restore the transfer's own buffer after zero-copy sending and return it to the free ones,
+    // so the callback can already submit the next data
+    CDC_ACM_ENTER_CRITICAL();
+    const cdc_acm_tx_callback_t tx_cb = cdc_dev->data.tx_async.stopped ? NULL : cdc_dev->data.tx_async.done[idx].cb;
+    void *const tx_arg = cdc_dev->data.tx_async.done[idx].arg;
+    const uint8_t *const data = cdc_dev->data.tx_async.done[idx].data;
+    const size_t data_len = transfer->num_bytes;
+    uint8_t **ptr = (uint8_t **)(&(transfer->data_buffer));
+    *ptr = cdc_dev->data.tx_async.data_buffer_base[idx];
+    cdc_dev->data.tx_async.free |= (1U << idx);
+    CDC_ACM_EXIT_CRITICAL();
+
+    if (tx_cb) {
+        tx_cb(data, data_len, sent ? ESP_OK : ESP_ERR_INVALID_RESPONSE, tx_arg);
+    }
+}
+
+/**
+ * @brief Resume CDC device
+ *
+ * Submit poll for BULK IN and INTR IN transfers
+ *
+ * @param cdc_dev
+ * @return esp_err_t
+ */
+#ifdef CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+static void cdc_acm_resume(cdc_dev_t *cdc_dev)
+{
+    assert(cdc_dev);
+
+    // All IN transfers were cancelled by the suspend: start over from the first one
+    cdc_dev->data.in_next = 0;
+    cdc_dev->data.in_done = 0;
+    cdc_dev->in_done_timed = 0;
+    if (cdc_dev->data.rx_loan.count > 0) {
+        // Return the cancelled transfers to the pool and refill every slot from it, in order
+        CDC_ACM_ENTER_CRITICAL();
+        for (int slot = 0; slot < cdc_dev->data.in_xfer_count; slot++) {
+            if (cdc_dev->data.in_xfers[slot] != NULL) {
+                cdc_dev->data.rx_loan.free |= (1U << cdc_acm_rx_loan_find(cdc_dev, cdc_dev->data.in_xfers[slot]->data_buffer));
+                cdc_dev->data.in_xfers[slot] = NULL;
+            }
+        }
+        cdc_dev->data.rx_loan.pending = (1U << cdc_dev->data.in_xfer_count) - 1;
+        cdc_dev->data.rx_loan.refill_next = 0;
+        cdc_dev->data.in_stopped = false;
+        CDC_ACM_EXIT_CRITICAL();
+        cdc_acm_rx_loan_refill(cdc_dev);
+    } else {
+        cdc_dev->data.in_stopped = false;
+        for (int i = 0; i < cdc_dev->data.in_xfer_count; i++) {
+            cdc_acm_reset_in_transfer(cdc_dev, i);
+            ESP_LOGD(TAG, "Submitting poll for BULK IN transfer %d", i);
+            ESP_ERROR_CHECK(usb_host_transfer_submit(cdc_dev->data.in_xfers[i]));
+        }
+    }
+
+    if (cdc_dev->notif.xfer) {
+        ESP_LOGD(TAG, "Submitting poll for INTR IN transfer");
+        ESP_ERROR_CHECK(usb_host_transfer_submit(cdc_dev->notif.xfer));
+    }
+}
+#endif // CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+
+/**
+ * @brief Open a new USB device for the first matching open on arrival registration
+ *
+ * Runs in the driver task. The arrival callback is called after open_close_mutex is given, so it can close the device.
+ * Without registrations it returns before taking open_close_mutex, which another task may hold.
+ *
+ * @param[in] dev_addr Address of the new USB device
+ */
+static void cdc_acm_open_on_arrival(uint8_t dev_addr)
+{
+    cdc_acm_arrival_callback_t arrival_cb = NULL;
+    void *arrival_arg = NULL;
+    cdc_dev_t *cdc_dev = NULL;
+
+    CDC_ACM_ENTER_CRITICAL();
+    const bool registered = p_cdc_acm_obj->arrivals_used > 0;
+    CDC_ACM_EXIT_CRITICAL();
+    if (!registered) {
+        return;
+    }
+
+    xSemaphoreTake(p_cdc_acm_obj->open_close_mutex, portMAX_DELAY);
+    usb_device_handle_t dev_hdl;
+    if (usb_host_device_open(p_cdc_acm_obj->cdc_acm_client_hdl, dev_addr, &dev_hdl) == ESP_OK) {
+        assert(dev_hdl);
+        const usb_device_desc_t *device_desc;
+        ESP_ERROR_CHECK(usb_host_get_device_descriptor(dev_hdl, &device_desc));
+        bool dev_hdl_taken = false;
+        for (int i = 0; i < CDC_ACM_ARRIVALS_MAX && device_desc->bDeviceClass != USB_CLASS_HUB; i++) {
+            const cdc_acm_arrival_t *arrival = &p_cdc_acm_obj->arrivals[i];
+            if (!arrival->used ||
+                    !(arrival->vid == device_desc->idVendor || arrival->vid == CDC_HOST_ANY_VID) ||
+                    !(arrival->pid == device_desc->idProduct || arrival->pid == CDC_HOST_ANY_PID)) {
+                continue;
+            }
+            cdc_dev = calloc(1, sizeof(cdc_dev_t));
+            if (cdc_dev) {
+                cdc_dev->dev_hdl = dev_hdl;
+                dev_hdl_taken = true; // Closed by cdc_acm_device_open() on error
+                if (cdc_acm_device_open(cdc_dev, arrival->interface_idx, &arrival->dev_config) == ESP_OK) {
+                    arrival_cb = arrival->arrival_cb;
+                    arrival_arg = arrival->arrival_arg;
+                } else {
+                    ESP_LOGW(TAG, "Could not open arrived device VID=0x%04X PID=0x%04X", device_desc->idVendor, device_desc->idProduct);
+                    cdc_dev = NULL;
+                }
+            }
+            break; // First matching registration only
+        }
+        if (!dev_hdl_taken) {
+            usb_host_device_close(p_cdc_acm_obj->cdc_acm_client_hdl, dev_hdl);
+        }
+    }
+    xSemaphoreGive(p_cdc_acm_obj->open_close_mutex);
+
+    if (arrival_cb) {
+        arrival_cb((cdc_acm_dev_hdl_t)cdc_dev, arrival_arg);
+    }
+}
+
+static void usb_event_cb(const usb_host_client_event_msg_t *event_msg, void *arg)
+{
+    switch (event_msg->event) {
+    case USB_HOST_CLIENT_EVENT_NEW_DEV: {
+        // Wake cdc_acm_host_open() calls waiting for their device
+        xEventGroupSetBits(p_cdc_acm_obj->event_group, CDC_ACM_NEW_DEV);
+
+        // Guard p_cdc_acm_obj->new_dev_cb from concurrent access
+        ESP_LOGD(TAG, "New device connected");
+        CDC_ACM_ENTER_CRITICAL();
+        cdc_acm_new_dev_callback_t _new_dev_cb = p_cdc_acm_obj->new_dev_cb;
+        CDC_ACM_EXIT_CRITICAL();
+
+        if (_new_dev_cb) {
+            usb_device_handle_t new_dev;
+            if (usb_host_device_open(p_cdc_acm_obj->cdc_acm_client_hdl, event_msg->new_dev.address, &new_dev) != ESP_OK) {
+                break;
+            }
+            assert(new_dev);
+            _new_dev_cb(new_dev);
+            usb_host_device_close(p_cdc_acm_obj->cdc_acm_client_hdl, new_dev);
+        }
+        cdc_acm_open_on_arrival(event_msg->new_dev.address);
+        break;
+    }
+    case USB_HOST_CLIENT_EVENT_DEV_GONE: {
+        ESP_LOGD(TAG, "Device suddenly disconnected");
+        // Find CDC pseudo-devices associated with this USB device and close them
+        cdc_dev_t *cdc_dev;
+        cdc_dev_t *tcdc_dev;
+        // We are using 'SAFE' version of 'SLIST_FOREACH' which enables user to close the disconnected device in the callback
+        SLIST_FOREACH_SAFE(cdc_dev, &p_cdc_acm_obj->cdc_devices_list, list_entry, tcdc_dev) {
+            if (cdc_dev->dev_hdl == event_msg->dev_gone.dev_hdl && cdc_dev->notif.cb) {
+                // The suddenly disconnected device was opened by this driver: inform user about this
+                const cdc_acm_host_dev_event_data_t disconn_event = {
+                    .type = CDC_ACM_HOST_DEVICE_DISCONNECTED,
+                    .data.cdc_hdl = (cdc_acm_dev_hdl_t) cdc_dev,
+                };
+                cdc_dev->notif.cb(&disconn_event, cdc_dev->cb_arg);
+            }
+        }
+        break;
+    }
+#ifdef CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+    case USB_HOST_CLIENT_EVENT_DEV_SUSPENDED: {
+        ESP_LOGD(TAG, "Device suspended");
+        // Find CDC pseudo-devices associated with this USB device and deliver suspend event to the user
+        cdc_dev_t *cdc_dev;
+        cdc_dev_t *tcdc_dev;
+        SLIST_FOREACH_SAFE(cdc_dev, &p_cdc_acm_obj->cdc_devices_list, list_entry, tcdc_dev) {
+            if (cdc_dev->dev_hdl == event_msg->dev_suspend_resume.dev_hdl && cdc_dev->notif.cb) {
+
+                // The driver does not have to do anything to suspend the device,
+                // the usb host lib already halted and flushed all EPs
+
+                // The suspended device was opened by this driver: inform user about this
+                const cdc_acm_host_dev_event_data_t suspend_event = {
+                    .type = CDC_ACM_HOST_DEVICE_SUSPENDED,
+                    .data.cdc_hdl = (cdc_acm_dev_hdl_t) cdc_dev,
+                };
+                cdc_dev->notif.cb(&suspend_event, cdc_dev->cb_arg);
+            }
+        }
+        break;
+    }
+    case USB_HOST_CLIENT_EVENT_DEV_RESUMED: {
+        ESP_LOGD(TAG, "Device resumed");
+        // Find CDC pseudo-devices associated with this USB device and deliver resume event to the user
+        cdc_dev_t *cdc_dev;
+        cdc_dev_t *tcdc_dev;
+        SLIST_FOREACH_SAFE(cdc_dev, &p_cdc_acm_obj->cdc_devices_list, list_entry, tcdc_dev) {
+            if (cdc_dev->dev_hdl == event_msg->dev_suspend_resume.dev_hdl) {
+
+                // Resume the pseudo-device
+                cdc_acm_resume(cdc_dev);
+
+                if (cdc_dev->notif.cb != NULL) {
+                    // The resumed device was opened by this driver: inform user about this
+                    const cdc_acm_host_dev_event_data_t resume_event = {
+                        .type = CDC_ACM_HOST_DEVICE_RESUMED,
+                        .data.cdc_hdl = (cdc_acm_dev_hdl_t) cdc_dev,
+                    };
+                    cdc_dev->notif.cb(&resume_event, cdc_dev->cb_arg);
+                }
+            }
+        }
+        break;
+    }
+#endif // CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+    default:
+        ESP_LOGE(TAG, "Unrecognized USB Host client event");
+        assert(false);
+        break;
+    }
+}
+
+esp_err_t cdc_acm_host_data_tx_blocking(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data, size_t data_len, uint32_t timeout_ms)
+{
+    esp_err_t ret = ESP_OK;
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    CDC_ACM_CHECK(data && (data_len > 0), ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(cdc_dev->data.out_xfer, ESP_ERR_NOT_SUPPORTED); // Device was opened as read-only.
+
+    const size_t buffer_size = cdc_dev->data.out_xfer->data_buffer_size;
+    const uint8_t *data_ptr = data;
+    size_t remaining = data_len;
+
+    // Record start time for timeout tracking
+    TickType_t start_ticks = xTaskGetTickCount();
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    TickType_t elapsed_ticks = 0;
+    int remaining_timeout_ticks = timeout_ticks;
+
+    // Take OUT mutex for the entire transfer operation
+    BaseType_t taken = xSemaphoreTake(cdc_dev->data.out_mux, remaining_timeout_ticks);
+    if (taken != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    SemaphoreHandle_t transfer_finished_semaphore = (SemaphoreHandle_t)cdc_dev->data.out_xfer->context;
+
+    // Process data in chunks if it's larger than the buffer size
+    while (remaining > 0) {
+        size_t chunk_size = (remaining > buffer_size) ? buffer_size : remaining;
+
+        ESP_LOGV(TAG, "Submitting BULK OUT transfer chunk: %zu bytes (remaining: %zu)", chunk_size, remaining);
+        xSemaphoreTake(transfer_finished_semaphore, 0); // Make sure the semaphore is taken before we submit new transfer
+
+        memcpy(cdc_dev->data.out_xfer->data_buffer, data_ptr, chunk_size);
+        cdc_dev->data.out_xfer->num_bytes = chunk_size;
+        // Use remaining timeout for this chunk's transfer timeout
+        cdc_dev->data.out_xfer->timeout_ms = pdTICKS_TO_MS(remaining_timeout_ticks);
+        ESP_GOTO_ON_ERROR(usb_host_transfer_submit(cdc_dev->data.out_xfer), unblock, TAG,);
+
+        // Wait for OUT transfer completion with remaining timeout
+        taken = xSemaphoreTake(transfer_finished_semaphore, remaining_timeout_ticks);
+        elapsed_ticks = xTaskGetTickCount() - start_ticks;
+        remaining_timeout_ticks = timeout_ticks - elapsed_ticks;
+        if (!taken || remaining_timeout_ticks < 0) {
+            cdc_acm_reset_transfer_endpoint(cdc_dev->dev_hdl, cdc_dev->data.out_xfer); // Resetting the endpoint will cause all in-progress transfers to complete
+            ESP_LOGW(TAG, "TX transfer timeout");
+            ret = ESP_ERR_TIMEOUT;
+            goto unblock;
+        }
+
+        const usb_transfer_status_t status = cdc_dev->data.out_xfer->status;
+        CDC_ACM_ENTER_CRITICAL();
+        if (status == USB_TRANSFER_STATUS_COMPLETED) {
+            cdc_dev->stats.out.transfers++;
+            cdc_dev->stats.out.bytes += cdc_dev->data.out_xfer->actual_num_bytes;
+        } else if (status < CDC_ACM_STATS_STATUS_MAX) {
+            cdc_dev->stats.errors[status]++;
+        }
+        CDC_ACM_EXIT_CRITICAL();
+        ESP_GOTO_ON_FALSE(status == USB_TRANSFER_STATUS_COMPLETED, ESP_ERR_INVALID_RESPONSE, unblock, TAG, "Bulk OUT transfer error");
+        ESP_GOTO_ON_FALSE(cdc_dev->data.out_xfer->actual_num_bytes == chunk_size, ESP_ERR_INVALID_RESPONSE, unblock, TAG, "Incorrect number of bytes transferred");
+
+        remaining -= chunk_size;
+        data_ptr += chunk_size;
+    }
+
+    ret = ESP_OK;
+
+unblock:
+    xSemaphoreGive(cdc_dev->data.out_mux);
+    return ret;
+}
+
+/**
+ * @brief Submit data on a free asynchronous OUT transfer
+ *
+ * @param[in] cdc_dev   Pointer to CDC device
+ * @param[in] data      Data to be sent
+ * @param[in] data_len  Data length
+ * @param[in] zero_copy Send from the user's buffer instead of a copy
+ * @param[in] tx_cb     Completion callback
+ * @param[in] tx_arg    Argument of the completion callback
+ * @return See cdc_acm_host_data_tx_async()
+ */
+static esp_err_t cdc_acm_tx_async_submit(cdc_dev_t *cdc_dev, const uint8_t *data, size_t data_len, bool zero_copy, cdc_acm_tx_callback_t tx_cb, void *tx_arg)
+{
+    CDC_ACM_CHECK(data && (data_len > 0), ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(cdc_dev->data.tx_async.count > 0, ESP_ERR_NOT_SUPPORTED);
+    CDC_ACM_CHECK(data_len <= cdc_dev->data.out_buf_len, ESP_ERR_INVALID_SIZE);
+#if !CONFIG_IDF_TARGET_LINUX
+    // The USB DMA would read garbage from PSRAM or flash; host builds have no such memory
+    CDC_ACM_CHECK(!zero_copy || esp_ptr_dma_capable(data), ESP_ERR_INVALID_ARG);
+#endif
+
+    // Take the lowest free transfer
+    CDC_ACM_ENTER_CRITICAL();
+    const uint8_t free = cdc_dev->data.tx_async.free;
+    CDC_ACM_CHECK_FROM_CRIT(free != 0, ESP_ERR_NO_MEM);
+    const int idx = __builtin_ctz(free);
+    cdc_dev->data.tx_async.free &= ~(1U << idx);
+    CDC_ACM_EXIT_CRITICAL();
+
+    // The transfer is ours until it is submitted
+    usb_transfer_t *transfer = cdc_dev->data.tx_async.xfers[idx];
+    cdc_dev->data.tx_async.done[idx].cb = tx_cb;
+    cdc_dev->data.tx_async.done[idx].arg = tx_arg;
+    cdc_dev->data.tx_async.done[idx].data = data;
+    if (zero_copy) {
+        uint8_t **ptr = (uint8_t **)(&(transfer->data_buffer));
+        *ptr = (uint8_t *)data;
+    } else {
+        memcpy(transfer->data_buffer, data, data_len);
+    }
+    transfer->num_bytes = data_len;
+
+    ESP_LOGV(TAG, "Submitting asynchronous BULK OUT transfer %d: %zu bytes", idx, data_len);
+    const esp_err_t ret = usb_host_transfer_submit(transfer);
+    if (ret != ESP_OK) {
+        uint8_t **ptr = (uint8_t **)(&(transfer->data_buffer));
+        *ptr = cdc_dev->data.tx_async.data_buffer_base[idx];
+        CDC_ACM_ENTER_CRITICAL();
+        cdc_dev->data.tx_async.free |= (1U << idx);
+        CDC_ACM_EXIT_CRITICAL();
+    }
+    return ret;
+}
+
+esp_err_t cdc_acm_host_data_tx_async(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data, size_t data_len, cdc_acm_tx_callback_t tx_cb, void *tx_arg)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    return cdc_acm_tx_async_submit((cdc_dev_t *)cdc_hdl, data, data_len, false, tx_cb, tx_arg);
+}
+
+esp_err_t cdc_acm_host_data_tx_async_zero_copy(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data, size_t data_len, cdc_acm_tx_callback_t tx_cb, void *tx_arg)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    return cdc_acm_tx_async_submit((cdc_dev_t *)cdc_hdl, data, data_len, true, tx_cb, tx_arg);
+}
+
+esp_err_t cdc_acm_host_rx_acquire(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t **data, size_t *data_len, uint32_t timeout_ms)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    CDC_ACM_CHECK(data && data_len, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(cdc_dev->data.rx_loan.count > 0, ESP_ERR_NOT_SUPPORTED); // Device was opened with data_cb
+
+    usb_transfer_t *transfer;
+    if (xQueueReceive(cdc_dev->data.rx_loan.filled, &transfer, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    const int i = cdc_acm_rx_loan_find(cdc_dev, transfer->data_buffer);
+    assert(i >= 0);
+    CDC_ACM_ENTER_CRITICAL();
+    cdc_dev->data.rx_loan.lent |= (1U << i);
+    CDC_ACM_EXIT_CRITICAL();
+
+    *data = transfer->data_buffer;
+    *data_len = transfer->actual_num_bytes;
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_rx_release(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    CDC_ACM_CHECK(cdc_dev->data.rx_loan.count > 0, ESP_ERR_NOT_SUPPORTED); // Device was opened with data_cb
+
+    const int i = cdc_acm_rx_loan_find(cdc_dev, data);
+    CDC_ACM_CHECK(i >= 0, ESP_ERR_INVALID_ARG);
+    CDC_ACM_ENTER_CRITICAL();
+    CDC_ACM_CHECK_FROM_CRIT(cdc_dev->data.rx_loan.lent & (1U << i), ESP_ERR_INVALID_ARG); // Not lent, or already released
+    cdc_dev->data.rx_loan.lent &= ~(1U << i);
+    cdc_dev->data.rx_loan.free |= (1U << i);
+    CDC_ACM_EXIT_CRITICAL();
+
+    // A slot may have been waiting for this buffer
+    cdc_acm_rx_loan_refill(cdc_dev);
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_data_rx_blocking(cdc_acm_dev_hdl_t cdc_hdl, uint8_t *data, size_t data_len, size_t *rx_len, uint32_t timeout_ms)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    CDC_ACM_CHECK(data && (data_len > 0) && rx_len, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(cdc_dev->data.rx_buf.stream, ESP_ERR_NOT_SUPPORTED); // Device was opened without RX ring buffer
+
+    *rx_len = xStreamBufferReceive(cdc_dev->data.rx_buf.stream, data, data_len, pdMS_TO_TICKS(timeout_ms));
+    return (*rx_len > 0) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t cdc_acm_host_rx_buffer_stats_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_acm_host_rx_buffer_stats_t *stats)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    CDC_ACM_CHECK(stats, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(cdc_dev->data.rx_buf.stream, ESP_ERR_NOT_SUPPORTED); // Device was opened without RX ring buffer
+
+    // Counters are written by the driver task only; a snapshot that is slightly out of date is fine
+    stats->size = cdc_dev->data.rx_buf.size;
+    stats->high_water = cdc_dev->data.rx_buf.high_water;
+    stats->overflows = cdc_dev->data.rx_buf.overflows;
+    stats->dropped_bytes = cdc_dev->data.rx_buf.dropped_bytes;
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_get_stats(cdc_acm_dev_hdl_t cdc_hdl, cdc_acm_host_stats_t *stats)
+{
+    CDC_ACM_CHECK(cdc_hdl && stats, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+
+    CDC_ACM_ENTER_CRITICAL();
+    *stats = cdc_dev->stats;
+    CDC_ACM_EXIT_CRITICAL();
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_send_custom_request(cdc_acm_dev_hdl_t cdc_hdl, uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, uint16_t wLength, uint8_t *data)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    if (wLength > 0) {
+        CDC_ACM_CHECK(data, ESP_ERR_INVALID_ARG);
+    }
+    CDC_ACM_CHECK(cdc_dev->ctrl_transfer->data_buffer_size >= wLength, ESP_ERR_INVALID_SIZE);
+
+    esp_err_t ret;
+
+    // Take Mutex and fill the CTRL request
+    BaseType_t taken = xSemaphoreTake(cdc_dev->ctrl_mux, pdMS_TO_TICKS(CDC_ACM_CTRL_TIMEOUT_MS));
+    if (!taken) {
+        return ESP_ERR_TIMEOUT;
+    }
+    usb_setup_packet_t *req = (usb_setup_packet_t *)(cdc_dev->ctrl_transfer->data_buffer);
+    uint8_t *start_of_data = (uint8_t *)req + sizeof(usb_setup_packet_t);
+    req->bmRequestType = bmRequestType;
+    req->bRequest = bRequest;
+    req->wValue = wValue;
+    req->wIndex = wIndex;
+    req->wLength = wLength;
+
+    // For IN transfers we must transfer data ownership to CDC driver
+    const bool in_transfer = bmRequestType & USB_BM_REQUEST_TYPE_DIR_IN;
+    if (!in_transfer) {
+        memcpy(start_of_data, data, wLength);
+    }
+
+    cdc_dev->ctrl_transfer->num_bytes = wLength + sizeof(usb_setup_packet_t);
+    ESP_GOTO_ON_ERROR(
+        usb_host_transfer_submit_control(p_cdc_acm_obj->cdc_acm_client_hdl, cdc_dev->ctrl_transfer),
+        unblock, TAG, "CTRL transfer failed");
+
+    taken = xSemaphoreTake((SemaphoreHandle_t)cdc_dev->ctrl_transfer->context, pdMS_TO_TICKS(CDC_ACM_CTRL_TIMEOUT_MS));
+    if (!taken) {
+        // Transfer was not finished, error in USB LIB. Reset the endpoint
+        cdc_acm_reset_transfer_endpoint(cdc_dev->dev_hdl, cdc_dev->ctrl_transfer);
+        ret = ESP_ERR_TIMEOUT;
+        goto unblock;
+    }
+
+    ESP_GOTO_ON_FALSE(cdc_dev->ctrl_transfer->status == USB_TRANSFER_STATUS_COMPLETED, ESP_ERR_INVALID_RESPONSE, unblock, TAG, "Control transfer error");
+    ESP_GOTO_ON_FALSE(cdc_dev->ctrl_transfer->actual_num_bytes == cdc_dev->ctrl_transfer->num_bytes, ESP_ERR_INVALID_RESPONSE, unblock, TAG, "Incorrect number of bytes transferred");
+
+    // For OUT transfers, we must transfer data ownership to user
+    if (in_transfer) {
+        memcpy(data, start_of_data, wLength);
+    }
+    ret = ESP_OK;
+
+unblock:
+    xSemaphoreGive(cdc_dev->ctrl_mux);
+    return ret;
+}
+
+esp_err_t cdc_acm_host_protocols_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_comm_protocol_t *comm, cdc_data_protocol_t *data)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+
+    if (comm != NULL) {
+        *comm = cdc_dev->comm_protocol;
+    }
+    if (data != NULL) {
+        *data = cdc_dev->data_protocol;
+    }
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_cdc_desc_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_desc_subtype_t desc_type, const usb_standard_desc_t **desc_out)
+{
+    CDC_ACM_CHECK(cdc_hdl, ESP_ERR_INVALID_ARG);
+    CDC_ACM_CHECK(desc_type < USB_CDC_DESC_SUBTYPE_MAX, ESP_ERR_INVALID_ARG);
+    cdc_dev_t *cdc_dev = (cdc_dev_t *)cdc_hdl;
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    *desc_out = NULL;
+
+    for (int i = 0; i < cdc_dev->cdc_func_desc_cnt; i++) {
+        const cdc_header_desc_t *_desc = (const cdc_header_desc_t *)((*(cdc_dev->cdc_func_desc))[i]);
+        if (_desc->bDescriptorSubtype == desc_type) {
+            ret = ESP_OK;
+            *desc_out = (const usb_standard_desc_t *)_desc;
+            break;
+        }
+    }
+    return ret;
+}
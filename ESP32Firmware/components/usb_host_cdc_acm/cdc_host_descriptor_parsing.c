@@ -5,6 +5,7 @@
  */
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include "esp_check.h"
 #include "esp_log.h"
@@ -177,6 +178,209 @@ esp_err_t cdc_parse_interface_descriptor(const usb_device_desc_t *device_desc, c
     return (info_ret->in_ep && info_ret->out_ep) ? ESP_OK : ESP_ERR_NOT_FOUND;
 }
 
+static uint16_t cdc_parse_cache_offset(const usb_config_desc_t *config_desc, const void *desc)
+{
+    return desc ? (uint16_t)((const uint8_t *)desc - (const uint8_t *)config_desc) : 0;
+}
+
+/**
+ * @brief Get descriptor at a cached offset, checking that it is still in place
+ *
+ * @param[in]  config_desc Pointer do Configuration descriptor
+ * @param[in]  offset      Cached offset, 0 for 'not present'
+ * @param[in]  type        Expected bDescriptorType
+ * @param[out] desc        Descriptor at the offset, NULL for offset 0
+ * @return true  Offset is 0 or a descriptor of the expected type fits there
+ * @return false Cached offset does not match the Configuration descriptor
+ */
+static bool cdc_parse_cache_desc(const usb_config_desc_t *config_desc, uint16_t offset, uint8_t type, const usb_standard_desc_t **desc)
+{
+    *desc = NULL;
+    if (offset == 0) {
+        return true;
+    }
+    if (offset + sizeof(usb_standard_desc_t) > config_desc->wTotalLength) {
+        return false;
+    }
+    const usb_standard_desc_t *this_desc = (const usb_standard_desc_t *)((const uint8_t *)config_desc + offset);
+    if (this_desc->bLength < sizeof(usb_standard_desc_t) ||
+            offset + this_desc->bLength > config_desc->wTotalLength ||
+            this_desc->bDescriptorType != type) {
+        return false;
+    }
+    *desc = this_desc;
+    return true;
+}
+
+/**
+ * @brief Check that a cached endpoint has the transfer type and direction it was cached with
+ *
+ * @param[in] ep_desc   Endpoint descriptor from cdc_parse_cache_desc(), NULL for 'not present'
+ * @param[in] xfer_type Expected transfer type
+ * @param[in] dir_in    Expected direction: true for IN
+ * @param[in] check_dir Check the direction too; the notification endpoint is found by transfer type only
+ * @return true if the endpoint is not present or matches
+ */
+static bool cdc_parse_cache_ep_matches(const usb_standard_desc_t *ep_desc, uint8_t xfer_type, bool dir_in, bool check_dir)
+{
+    if (!ep_desc) {
+        return true;
+    }
+    if (ep_desc->bLength < sizeof(usb_ep_desc_t)) {
+        return false;
+    }
+    const usb_ep_desc_t *ep = (const usb_ep_desc_t *)ep_desc;
+    if (USB_EP_DESC_GET_XFERTYPE(ep) != xfer_type) {
+        return false;
+    }
+    return !check_dir || (USB_EP_DESC_GET_EP_DIR(ep) != 0) == dir_in;
+}
+
+/**
+ * @brief Check that a cached interface has one of the expected interface numbers
+ *
+ * @return true if the interface is not present or matches
+ */
+static bool cdc_parse_cache_intf_matches(const usb_standard_desc_t *intf_desc, uint8_t first_num, uint8_t last_num)
+{
+    if (!intf_desc) {
+        return true;
+    }
+    if (intf_desc->bLength < sizeof(usb_intf_desc_t)) {
+        return false;
+    }
+    const uint8_t num = ((const usb_intf_desc_t *)intf_desc)->bInterfaceNumber;
+    return num >= first_num && num <= last_num;
+}
+
+/**
+ * @brief Rebuild parsed information from a cache entry
+ *
+ * @attention The driver must take care of memory freeing
+ * @return ESP_OK if the entry matches the Configuration descriptor, ESP_ERR_INVALID_STATE if not, ESP_ERR_NO_MEM
+ */
+static esp_err_t cdc_parse_cache_load(const cdc_parse_cache_entry_t *entry, const usb_config_desc_t *config_desc, cdc_parsed_info_t *info_ret)
+{
+    const uint8_t func_type = (USB_CLASS_COMM << 4) | USB_B_DESCRIPTOR_TYPE_INTERFACE;
+    const usb_standard_desc_t *notif_ep, *in_ep, *out_ep, *notif_intf, *data_intf;
+
+    memset(info_ret, 0, sizeof(cdc_parsed_info_t));
+    if (!cdc_parse_cache_desc(config_desc, entry->notif_ep, USB_B_DESCRIPTOR_TYPE_ENDPOINT, &notif_ep) ||
+            !cdc_parse_cache_desc(config_desc, entry->in_ep, USB_B_DESCRIPTOR_TYPE_ENDPOINT, &in_ep) ||
+            !cdc_parse_cache_desc(config_desc, entry->out_ep, USB_B_DESCRIPTOR_TYPE_ENDPOINT, &out_ep) ||
+            !cdc_parse_cache_desc(config_desc, entry->notif_intf, USB_B_DESCRIPTOR_TYPE_INTERFACE, &notif_intf) ||
+            !cdc_parse_cache_desc(config_desc, entry->data_intf, USB_B_DESCRIPTOR_TYPE_INTERFACE, &data_intf) ||
+            !in_ep || !out_ep) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // The key does not cover the descriptor contents, so check what the driver relies on
+    if (!cdc_parse_cache_ep_matches(notif_ep, USB_TRANSFER_TYPE_INTR, false, false) ||
+            !cdc_parse_cache_ep_matches(in_ep, USB_TRANSFER_TYPE_BULK, true, true) ||
+            !cdc_parse_cache_ep_matches(out_ep, USB_TRANSFER_TYPE_BULK, false, true) ||
+            !cdc_parse_cache_intf_matches(notif_intf, entry->intf_idx, entry->intf_idx) ||
+            !cdc_parse_cache_intf_matches(data_intf, entry->intf_idx, entry->intf_idx + 1)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int i = 0; i < entry->func_cnt; i++) {
+        const usb_standard_desc_t *func_desc;
+        if (!cdc_parse_cache_desc(config_desc, entry->func[i], func_type, &func_desc) || !func_desc) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    if (entry->func_cnt > 0) {
+        info_ret->func = malloc(entry->func_cnt * (sizeof(usb_standard_desc_t *)));
+        if (!info_ret->func) {
+            ESP_LOGD(TAG, "Out of mem for functional descriptors");
+            return ESP_ERR_NO_MEM;
+        }
+        for (int i = 0; i < entry->func_cnt; i++) {
+            (*info_ret->func)[i] = (const usb_standard_desc_t *)((const uint8_t *)config_desc + entry->func[i]);
+        }
+        info_ret->func_cnt = entry->func_cnt;
+    }
+    info_ret->notif_ep = (const usb_ep_desc_t *)notif_ep;
+    info_ret->in_ep = (const usb_ep_desc_t *)in_ep;
+    info_ret->out_ep = (const usb_ep_desc_t *)out_ep;
+    info_ret->notif_intf = (const usb_intf_desc_t *)notif_intf;
+    info_ret->data_intf = (const usb_intf_desc_t *)data_intf;
+    return ESP_OK;
+}
+
+esp_err_t cdc_parse_interface_descriptor_cached(cdc_parse_cache_entry_t *cache, size_t cache_len,
+                                                const usb_device_desc_t *device_desc, const usb_config_desc_t *config_desc,
+                                                uint8_t intf_idx, cdc_parsed_info_t *info_ret, bool *cache_hit)
+{
+    uint32_t last_use = 0;
+    cdc_parse_cache_entry_t *victim = NULL;
+
+    if (cache_hit) {
+        *cache_hit = false;
+    }
+    for (size_t i = 0; i < cache_len; i++) {
+        cdc_parse_cache_entry_t *entry = &cache[i];
+        if (entry->valid && entry->last_use > last_use) {
+            last_use = entry->last_use;
+        }
+    }
+    for (size_t i = 0; i < cache_len; i++) {
+        cdc_parse_cache_entry_t *entry = &cache[i];
+        if (!entry->valid) {
+            if (!victim || victim->valid) {
+                victim = entry;
+            }
+            continue;
+        }
+        if (entry->vid == device_desc->idVendor && entry->pid == device_desc->idProduct &&
+                entry->bcd_device == device_desc->bcdDevice && entry->intf_idx == intf_idx &&
+                entry->total_len == config_desc->wTotalLength) {
+            const esp_err_t ret = cdc_parse_cache_load(entry, config_desc, info_ret);
+            if (ret == ESP_OK) {
+                entry->last_use = last_use + 1;
+                if (cache_hit) {
+                    *cache_hit = true;
+                }
+                return ESP_OK;
+            }
+            if (ret == ESP_ERR_NO_MEM) {
+                return ret;
+            }
+            ESP_LOGW(TAG, "Cached descriptor layout does not match, parsing again");
+            entry->valid = false;
+            victim = entry;
+            continue;
+        }
+        if (!victim || (victim->valid && entry->last_use < victim->last_use)) {
+            victim = entry;
+        }
+    }
+
+    const esp_err_t ret = cdc_parse_interface_descriptor(device_desc, config_desc, intf_idx, info_ret);
+    if (ret != ESP_OK || !victim || info_ret->func_cnt > CDC_PARSE_CACHE_FUNC_MAX) {
+        return ret;
+    }
+
+    // Save the layout of this parse
+    memset(victim, 0, sizeof(cdc_parse_cache_entry_t));
+    victim->vid = device_desc->idVendor;
+    victim->pid = device_desc->idProduct;
+    victim->bcd_device = device_desc->bcdDevice;
+    victim->intf_idx = intf_idx;
+    victim->total_len = config_desc->wTotalLength;
+    victim->notif_ep = cdc_parse_cache_offset(config_desc, info_ret->notif_ep);
+    victim->in_ep = cdc_parse_cache_offset(config_desc, info_ret->in_ep);
+    victim->out_ep = cdc_parse_cache_offset(config_desc, info_ret->out_ep);
+    victim->notif_intf = cdc_parse_cache_offset(config_desc, info_ret->notif_intf);
+    victim->data_intf = cdc_parse_cache_offset(config_desc, info_ret->data_intf);
+    victim->func_cnt = info_ret->func_cnt;
+    for (int i = 0; i < info_ret->func_cnt; i++) {
+        victim->func[i] = cdc_parse_cache_offset(config_desc, (*info_ret->func)[i]);
+    }
+    victim->last_use = last_use + 1;
+    victim->valid = true;
+    return ESP_OK;
+}
+
 void cdc_print_desc(const usb_standard_desc_t *_desc)
 {
     if (_desc->bDescriptorType != ((USB_CLASS_COMM << 4) | USB_B_DESCRIPTOR_TYPE_INTERFACE )) {
@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <catch2/reporters/catch_reporter_event_listener.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+
+/**
+ * @brief Machine-readable summary of the benchmarks of a test run
+ *
+ * Include this header in exactly one source file of the test application: it registers a Catch2 event listener.
+ * After the run, every benchmark is printed as one CSV line between the CDC_BENCH_SUMMARY_BEGIN and
+ * CDC_BENCH_SUMMARY_END markers, so that results of two component versions can be compared by a script:
+ *
+ *     name,mean_ns,std_dev_ns,bytes,mb_per_s
+ *
+ * bytes and mb_per_s are 0 unless the benchmark registered the bytes it processes per run with benchmark_bytes().
+ */
+
+/**
+ * @brief Bytes processed per run of a benchmark, by benchmark name
+ */
+inline std::map<std::string, size_t> &benchmark_bytes()
+{
+    static std::map<std::string, size_t> bytes;
+    return bytes;
+}
+
+class BenchmarkSummaryListener : public Catch::EventListenerBase {
+public:
+    using Catch::EventListenerBase::EventListenerBase;
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const &stats) override
+    {
+        results.push_back({stats.info.name, stats.mean.point.count(), stats.standardDeviation.point.count()});
+    }
+
+    void testRunEnded(Catch::TestRunStats const &) override
+    {
+        if (results.empty()) {
+            return;
+        }
+        printf("\nCDC_BENCH_SUMMARY_BEGIN\n");
+        printf("name,mean_ns,std_dev_ns,bytes,mb_per_s\n");
+        for (const auto &result : results) {
+            const auto found = benchmark_bytes().find(result.name);
+            const size_t bytes = (found != benchmark_bytes().end()) ? found->second : 0;
+            const double mb_per_s = (result.mean_ns > 0) ? bytes * 1e3 / result.mean_ns : 0; // B/ns is GB/s
+            printf("\"%s\",%.1f,%.1f,%zu,%.2f\n", result.name.c_str(), result.mean_ns, result.std_dev_ns, bytes, mb_per_s);
+        }
+        printf("CDC_BENCH_SUMMARY_END\n");
+        fflush(stdout);
+    }
+
+private:
+    struct result_t {
+        std::string name;
+        double mean_ns;
+        double std_dev_ns;
+    };
+    std::vector<result_t> results;
+};
+
+CATCH_REGISTER_LISTENER(BenchmarkSummaryListener)
@@ -9,6 +9,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include "usb/cdc_acm_host.h"
 #include "mock_add_usb_device.h"
+#include "descriptors/cdc_descriptors.hpp"
 #include "common_test_fixtures.hpp"
 #include "cdc_host_descriptor_parsing.h"
 
@@ -25,11 +26,17 @@ extern "C" {
  * Then, during the device opening we expect usb_host_transfer_alloc() exactly 3 times (CTRL, IN, OUT)
  * Also, during the device closing we expect usb_host_transfer_free() exactly 3 times (CTRL, IN, OUT)
  * Different device could have CTRL, IN, OUT and NOTIF, thus we must expect those mocked functions exactly 4 times
+ * IN is allocated, submitted and freed once per in-flight IN transfer (in_xfer_count)
+ * RX loan buffers (rx_loan_count) are extra IN transfers: allocated and freed, but not submitted on open
+ * Asynchronous OUT transfers (tx_xfer_count) are extra OUT transfers: allocated and freed, but not submitted on open
  */
 typedef struct {
     struct {
         usb_transfer_t *out_xfer;
         usb_transfer_t *in_xfer;
+        int in_xfer_count;
+        int rx_loan_count;
+        int tx_xfer_count;
         uint8_t in_bEndpointAddress;
         uint8_t out_bEndpointAddress;
     } data;
@@ -89,15 +96,21 @@ static esp_err_t _test_create_cmock_expectations(uint8_t dev_address, uint8_t in
     // Check, if IN data transfer is allocated
     if (dev_config->in_buffer_size) {
         cdc_dev_expects->data.in_xfer = reinterpret_cast<usb_transfer_t *>(&data_in_xfer);
+        cdc_dev_expects->data.in_xfer_count = (dev_config->in_xfer_count == 0) ? 1 : dev_config->in_xfer_count;
+        cdc_dev_expects->data.rx_loan_count = dev_config->rx_loan_count;
     } else {
         cdc_dev_expects->data.in_xfer = nullptr;
+        cdc_dev_expects->data.in_xfer_count = 0;
+        cdc_dev_expects->data.rx_loan_count = 0;
     }
 
     // Check if OUT data transfer is allocated
     if (dev_config->out_buffer_size) {
         cdc_dev_expects->data.out_xfer = reinterpret_cast<usb_transfer_t *>(&data_out_xfer);
+        cdc_dev_expects->data.tx_xfer_count = dev_config->tx_xfer_count;
     } else {
         cdc_dev_expects->data.out_xfer = nullptr;
+        cdc_dev_expects->data.tx_xfer_count = 0;
     }
 
     p_cdc_dev_expects = cdc_dev_expects;
@@ -178,14 +191,16 @@ esp_err_t test_cdc_acm_host_open(uint8_t dev_address, uint16_t vid, uint16_t pid
         usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
     }
 
-    //  Setup IN data transfer
-    if (dev_config->in_buffer_size) {
+    //  Setup IN data transfers
+    for (int i = 0; i < p_cdc_dev_expects->data.in_xfer_count + p_cdc_dev_expects->data.rx_loan_count; i++) {
         usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
     }
 
-    // Setup OUT bulk transfer
+    // Setup OUT bulk transfers
     if (dev_config->out_buffer_size) {
-        usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+        for (int i = 0; i < 1 + p_cdc_dev_expects->data.tx_xfer_count; i++) {
+            usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+        }
     }
 
     // Register callback
@@ -197,6 +212,11 @@ esp_err_t test_cdc_acm_host_open(uint8_t dev_address, uint16_t vid, uint16_t pid
     // Make sure that the interface_index has been claimed
     test_usb_host_interface_claim(interface_index);
 
+    // Remaining IN transfers are submitted right after the first one
+    for (int i = 1; i < p_cdc_dev_expects->data.in_xfer_count; i++) {
+        usb_host_transfer_submit_ExpectAnyArgsAndReturn(ESP_OK);
+    }
+
     // Claim 2nd interface (if supported)
     if (p_cdc_dev_expects->notif.has_separate_interface) {
         test_usb_host_interface_claim(interface_index + 1);
@@ -238,15 +258,19 @@ esp_err_t test_cdc_acm_host_close(cdc_acm_dev_hdl_t *cdc_hdl, uint8_t interface_
         p_cdc_dev_expects->notif.xfer = nullptr;
     }
 
-    // Free in transfer
+    // Free in transfers
     if (p_cdc_dev_expects->data.in_xfer) {
-        usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+        for (int i = 0; i < p_cdc_dev_expects->data.in_xfer_count + p_cdc_dev_expects->data.rx_loan_count; i++) {
+            usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+        }
         p_cdc_dev_expects->data.in_xfer = nullptr;
     }
 
-    // Free out transfer
+    // Free out transfers
     if (p_cdc_dev_expects->data.out_xfer) {
-        usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+        for (int i = 0; i < 1 + p_cdc_dev_expects->data.tx_xfer_count; i++) {
+            usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+        }
         p_cdc_dev_expects->data.out_xfer = nullptr;
     }
 
@@ -316,3 +340,84 @@ esp_err_t test_usb_host_interface_claim(uint8_t interface_index)
 
     return ESP_OK;
 }
+
+std::vector<usb_transfer_t *> test_cp210x_submitted;
+std::vector<usb_transfer_t *> test_cp210x_submitted_out;
+esp_err_t test_cp210x_submit_ret;
+bool test_cp210x_out_done_at_once;
+
+static esp_err_t usb_host_transfer_submit_record_callback(usb_transfer_t *transfer, int call_count)
+{
+    if (test_cp210x_submit_ret != ESP_OK) {
+        return test_cp210x_submit_ret;
+    }
+    if (transfer->bEndpointAddress == test_cp210x_out_ep && test_cp210x_out_done_at_once) {
+        test_cp210x_complete_out(transfer);
+    } else if (transfer->bEndpointAddress == test_cp210x_out_ep) {
+        test_cp210x_submitted_out.push_back(transfer);
+    } else {
+        test_cp210x_submitted.push_back(transfer);
+    }
+    return ESP_OK;
+}
+
+void test_cp210x_open(const cdc_acm_host_device_config_t *dev_config, cdc_acm_dev_hdl_t *dev)
+{
+    usb_host_mock_dev_list_init();
+    REQUIRE(ESP_OK == usb_host_mock_add_device(4, (const usb_device_desc_t *)cp210x_device_desc,
+                                               (const usb_config_desc_t *)cp210x_config_desc, USB_SPEED_FULL));
+
+    usb_host_device_open_Stub(usb_host_device_open_mock_callback);
+    usb_host_get_device_descriptor_Stub(usb_host_get_device_descriptor_mock_callback);
+    usb_host_device_close_Stub(usb_host_device_close_mock_callback);
+    usb_host_get_active_config_descriptor_Stub(usb_host_get_active_config_descriptor_mock_callback);
+    usb_host_device_addr_list_fill_Stub(usb_host_device_addr_list_fill_mock_callback);
+    usb_host_transfer_alloc_Stub(usb_host_transfer_alloc_mock_callback);
+    usb_host_transfer_submit_Stub(usb_host_transfer_submit_record_callback);
+    usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+
+    test_cp210x_submitted.clear();
+    test_cp210x_submitted_out.clear();
+    test_cp210x_submit_ret = ESP_OK;
+    test_cp210x_out_done_at_once = false;
+    REQUIRE(ESP_OK == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, dev_config, dev));
+    REQUIRE(nullptr != *dev);
+}
+
+void test_cp210x_close(cdc_acm_dev_hdl_t dev, bool tx_in_flight)
+{
+    if (tx_in_flight) {
+        test_cdc_acm_reset_transfer_endpoint(test_cp210x_out_ep);
+    }
+    test_cdc_acm_reset_transfer_endpoint(test_cp210x_in_ep);
+    usb_host_interface_release_ExpectAndReturn(nullptr, nullptr, test_cp210x_interface_index, ESP_OK);
+    usb_host_interface_release_IgnoreArg_client_hdl();
+    usb_host_interface_release_IgnoreArg_dev_hdl();
+    usb_host_transfer_free_Stub(usb_host_transfer_free_mock_callback);
+    REQUIRE(ESP_OK == cdc_acm_host_close(dev));
+
+    usb_host_device_open_Stub(nullptr);
+    usb_host_get_device_descriptor_Stub(nullptr);
+    usb_host_device_close_Stub(nullptr);
+    usb_host_get_active_config_descriptor_Stub(nullptr);
+    usb_host_device_addr_list_fill_Stub(nullptr);
+    usb_host_transfer_alloc_Stub(nullptr);
+    usb_host_transfer_submit_Stub(nullptr);
+    usb_host_transfer_free_Stub(nullptr);
+}
+
+void test_cp210x_complete(usb_transfer_t *transfer, const char *data, usb_transfer_status_t status)
+{
+    const size_t len = strlen(data);
+    memcpy(transfer->data_buffer, data, len);
+    transfer->actual_num_bytes = len;
+    transfer->status = status;
+    transfer->callback(transfer);
+}
+
+void test_cp210x_complete_out(usb_transfer_t *transfer, usb_transfer_status_t status)
+{
+    transfer->actual_num_bytes = (status == USB_TRANSFER_STATUS_COMPLETED) ? transfer->num_bytes : 0;
+    transfer->status = status;
+    transfer->callback(transfer);
+}
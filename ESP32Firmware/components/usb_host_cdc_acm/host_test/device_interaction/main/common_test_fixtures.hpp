@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <vector>
 #include "esp_err.h"
+#include "usb/usb_host.h"
 
 #pragma once
 
@@ -134,3 +136,81 @@ esp_err_t test_cdc_acm_reset_transfer_endpoint(uint8_t ep_address);
  *   - ESP_OK: Interface claim successful
  */
 esp_err_t test_usb_host_interface_claim(uint8_t interface_index);
+
+/**
+ * @brief CP210x opened by test_cp210x_open(): no notification endpoint, one bulk IN and one bulk OUT endpoint
+ */
+constexpr uint16_t test_cp210x_vid = 0x10C4;
+constexpr uint16_t test_cp210x_pid = 0xEA60;
+constexpr uint8_t test_cp210x_interface_index = 0;
+constexpr uint8_t test_cp210x_in_ep = 0x82;
+constexpr uint8_t test_cp210x_out_ep = 0x02;
+
+/**
+ * @brief Submitted IN transfers of the device opened by test_cp210x_open(), in submission order
+ *
+ * The mocked usb_host_transfer_submit() only records the transfer, the test completes it with test_cp210x_complete()
+ */
+extern std::vector<usb_transfer_t *> test_cp210x_submitted;
+
+/**
+ * @brief Submitted OUT transfers of the device opened by test_cp210x_open(), in submission order
+ *
+ * Recorded like test_cp210x_submitted, the test completes them with test_cp210x_complete_out()
+ */
+extern std::vector<usb_transfer_t *> test_cp210x_submitted_out;
+
+/**
+ * @brief Returned by the mocked usb_host_transfer_submit(), ESP_OK after test_cp210x_open()
+ *
+ * Transfers whose submission fails are not recorded
+ */
+extern esp_err_t test_cp210x_submit_ret;
+
+/**
+ * @brief OUT transfers are completed as soon as they are submitted instead of being recorded, false after test_cp210x_open()
+ *
+ * For tests that send with cdc_acm_host_data_tx_blocking(), which waits for the completion
+ */
+extern bool test_cp210x_out_done_at_once;
+
+/**
+ * @brief Host test fixture function, open the CP210x for data path tests
+ *
+ * - Adds the CP210x to the mocked device list and stubs the mocked USB Host stack, so transfers are allocated for real
+ *   and submitted transfers are recorded in test_cp210x_submitted
+ * - Calls the real cdc_acm_host_open(), which must succeed
+ *
+ * @param[in] dev_config Configuration structure of the device
+ * @param[out] dev       CDC device handle
+ */
+void test_cp210x_open(const cdc_acm_host_device_config_t *dev_config, cdc_acm_dev_hdl_t *dev);
+
+/**
+ * @brief Host test fixture function, close the device opened by test_cp210x_open()
+ *
+ * - Calls the real cdc_acm_host_close(), which must succeed, and returns the mocked USB Host stack to expectations
+ *
+ * @param[in] dev          CDC device handle
+ * @param[in] tx_in_flight Asynchronous OUT transfers are in flight, so the OUT endpoint is reset too
+ */
+void test_cp210x_close(cdc_acm_dev_hdl_t dev, bool tx_in_flight = false);
+
+/**
+ * @brief Host test fixture function, complete a submitted IN transfer as the USB Host stack would
+ *
+ * Fills the transfer with data and calls its callback
+ *
+ * @param[in] transfer Transfer from test_cp210x_submitted
+ * @param[in] data     Received data, a string
+ * @param[in] status   Transfer status
+ */
+void test_cp210x_complete(usb_transfer_t *transfer, const char *data, usb_transfer_status_t status = USB_TRANSFER_STATUS_COMPLETED);
+
+/**
+ * @brief Host test fixture function, complete a submitted OUT transfer as the USB Host stack would
+ *
+ * @param[in] transfer Transfer from test_cp210x_submitted_out
+ * @param[in] status   Transfer status; a completed transfer sent all its bytes, others none
+ */
+void test_cp210x_complete_out(usb_transfer_t *transfer, usb_transfer_status_t status = USB_TRANSFER_STATUS_COMPLETED);
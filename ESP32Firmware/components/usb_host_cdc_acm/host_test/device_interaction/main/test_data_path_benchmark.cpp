@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "benchmark/benchmark_summary.hpp"
+#include "usb/cdc_acm_host.h"
+#include "common_test_fixtures.hpp"
+
+/**
+ * @brief Complete the last submitted IN transfer with len bytes, as the USB Host stack would
+ *
+ * The data itself is left as it is in the transfer buffer. The driver resubmits the transfer from the callback,
+ * so a single transfer is completed over and over; the record is cleared first to keep it from growing.
+ */
+static void _complete(size_t len)
+{
+    usb_transfer_t *transfer = test_cp210x_submitted.back();
+    test_cp210x_submitted.clear();
+    transfer->actual_num_bytes = len;
+    transfer->status = USB_TRANSFER_STATUS_COMPLETED;
+    transfer->callback(transfer);
+}
+
+static size_t received_bytes;
+
+static bool handle_rx(const uint8_t *data, size_t data_len, void *user_arg)
+{
+    received_bytes += data_len;
+    return true;
+}
+
+// Received data sizes, one benchmark each: a short line, a full-speed packet, and full IN transfers
+static const size_t xfer_sizes[] = {16, 64, 512, 2048};
+
+SCENARIO("Data path benchmark", "[benchmark]")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+    cdc_acm_dev_hdl_t dev = nullptr;
+
+    GIVEN("Device delivering to data_cb") {
+        for (size_t size : xfer_sizes) {
+            const cdc_acm_host_device_config_t dev_config = {
+                .connection_timeout_ms = 1000,
+                .out_buffer_size = 64,
+                .in_buffer_size = size < 64 ? 64 : size,
+                .event_cb = nullptr,
+                .data_cb = handle_rx,
+                .user_arg = nullptr,
+            };
+            test_cp210x_open(&dev_config, &dev);
+            REQUIRE_FALSE(test_cp210x_submitted.empty());
+            received_bytes = 0;
+
+            const std::string name = "in_xfer_cb to data_cb: " + std::to_string(size) + " B";
+            benchmark_bytes()[name] = size;
+            BENCHMARK(name.c_str()) {
+                _complete(size);
+            };
+            CHECK(received_bytes > 0);
+            CHECK(received_bytes % size == 0);
+            test_cp210x_close(dev);
+        }
+    }
+
+    GIVEN("Device delivering to the RX ring buffer, read by the application") {
+        for (size_t size : xfer_sizes) {
+            const cdc_acm_host_device_config_t dev_config = {
+                .connection_timeout_ms = 1000,
+                .out_buffer_size = 64,
+                .in_buffer_size = size < 64 ? 64 : size,
+                .event_cb = nullptr,
+                .data_cb = nullptr,
+                .user_arg = nullptr,
+                .in_xfer_count = 0,
+                .rx_loan_count = 0,
+                .rx_buffer_size = 2 * size,
+            };
+            test_cp210x_open(&dev_config, &dev);
+            REQUIRE_FALSE(test_cp210x_submitted.empty());
+            uint8_t data[2048];
+
+            const std::string name = "in_xfer_cb to RX ring buffer and read: " + std::to_string(size) + " B";
+            benchmark_bytes()[name] = size;
+            BENCHMARK(name.c_str()) {
+                size_t rx_len = 0;
+                _complete(size);
+                cdc_acm_host_data_rx_blocking(dev, data, sizeof(data), &rx_len, 0);
+                return rx_len;
+            };
+
+            cdc_acm_host_rx_buffer_stats_t stats;
+            REQUIRE(ESP_OK == cdc_acm_host_rx_buffer_stats_get(dev, &stats));
+            CHECK(stats.overflows == 0);
+            test_cp210x_close(dev);
+        }
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
@@ -0,0 +1,314 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "usb/cdc_acm_host.h"
+#include "common_test_fixtures.hpp"
+
+extern "C" {
+#include "Mockusb_host.h"
+}
+
+static std::vector<std::string> received;
+static int errors;
+
+static bool record_rx(const uint8_t *data, size_t data_len, void *user_arg)
+{
+    received.push_back(std::string((const char *)data, data_len));
+    return true;
+}
+
+static void record_event(const cdc_acm_host_dev_event_data_t *event, void *user_ctx)
+{
+    if (event->type == CDC_ACM_HOST_ERROR) {
+        errors++;
+    }
+}
+
+SCENARIO("Several IN transfers in flight")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+
+    cdc_acm_dev_hdl_t dev = nullptr;
+    cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 0,
+        .in_buffer_size = 64,
+        .event_cb = record_event,
+        .data_cb = record_rx,
+        .user_arg = nullptr,
+        .in_xfer_count = 3,
+    };
+    received.clear();
+    errors = 0;
+
+    SECTION("Fail to open CDC-ACM Device: too many IN transfers") {
+        dev_config.in_xfer_count = CDC_ACM_IN_XFERS_MAX + 1;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+    }
+
+    SECTION("All IN transfers are test_cp210x_submitted on open") {
+        test_cp210x_open(&dev_config, &dev);
+        REQUIRE(test_cp210x_submitted.size() == 3);
+        CHECK(test_cp210x_submitted[0] != test_cp210x_submitted[1]);
+        CHECK(test_cp210x_submitted[1] != test_cp210x_submitted[2]);
+        CHECK(test_cp210x_submitted[0]->bEndpointAddress == test_cp210x_in_ep);
+        CHECK(test_cp210x_submitted[2]->bEndpointAddress == test_cp210x_in_ep);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Data is delivered in submission order and each transfer is resubmitted after its delivery") {
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+        test_cp210x_submitted.clear();
+
+        // In order: delivered and resubmitted one by one
+        test_cp210x_complete(xfers[0], "A");
+        test_cp210x_complete(xfers[1], "B");
+        REQUIRE(received == std::vector<std::string> {"A", "B"});
+        REQUIRE(test_cp210x_submitted == std::vector<usb_transfer_t *> {xfers[0], xfers[1]});
+
+        // A transfer that overtakes the one before it is held back until that one is delivered
+        test_cp210x_complete(xfers[0], "D");
+        CHECK(received.size() == 2);
+        CHECK(test_cp210x_submitted.size() == 2);
+        test_cp210x_complete(xfers[2], "C");
+        REQUIRE(received == std::vector<std::string> {"A", "B", "C", "D"});
+        REQUIRE(test_cp210x_submitted == std::vector<usb_transfer_t *> {xfers[0], xfers[1], xfers[2], xfers[0]});
+        test_cp210x_close(dev);
+    }
+
+    SECTION("A failed IN transfer stops the IN pipe like with a single transfer") {
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+        test_cp210x_submitted.clear();
+
+        test_cp210x_complete(xfers[0], "A", USB_TRANSFER_STATUS_STALL);
+        CHECK(errors == 1);
+        test_cp210x_complete(xfers[1], "B");
+        CHECK(received.empty());
+        CHECK(test_cp210x_submitted.empty());
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Data that was not processed is not appended with several IN transfers") {
+        dev_config.data_cb = [](const uint8_t *data, size_t data_len, void *user_arg) {
+            received.push_back(std::string((const char *)data, data_len));
+            return false;
+        };
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+
+        test_cp210x_complete(xfers[0], "A");
+        test_cp210x_complete(xfers[1], "B");
+        test_cp210x_complete(xfers[2], "C");
+        test_cp210x_complete(xfers[0], "D");
+        REQUIRE(received == std::vector<std::string> {"A", "B", "C", "D"});
+        CHECK(xfers[0]->num_bytes == 64);
+        test_cp210x_close(dev);
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
+
+/**
+ * @brief Simulated analyzer streaming into the driver, in simulated time
+ *
+ * The device UART receives at a fixed baud rate into a small FIFO. While an IN transfer is in flight, the device
+ * moves its FIFO to the host in full packets, so during continuous streaming a transfer completes when its buffer is full.
+ * When no transfer is in flight, the FIFO fills up and further bytes are lost (UART overrun).
+ * The host runs one data_cb at a time, each takes the callback latency; a transfer is resubmitted when its data_cb returns.
+ */
+typedef struct {
+    uint32_t baud_bytes_per_s;  // UART payload rate
+    size_t fifo_size;           // Device's FIFO towards USB
+    size_t mps;                 // IN endpoint Maximum Packet Size
+    uint32_t callback_us;       // Time spent in data_cb
+    uint32_t duration_us;       // Simulated streaming time
+} rx_sim_config_t;
+
+typedef struct {
+    uint64_t produced;          // Bytes received by the device UART
+    uint64_t delivered;         // Bytes passed to data_cb
+    uint64_t lost;              // Bytes dropped by the device, no IN transfer in flight
+    bool in_order;              // Every delivered byte came after the one before it
+} rx_sim_result_t;
+
+static struct {
+    uint64_t now_us;
+    uint64_t busy_until_us;     // Host is in data_cb until this time
+    uint32_t callback_us;
+    uint64_t next_expected;     // Sequence number of the next byte data_cb should see
+    uint64_t delivered;
+    bool in_order;
+    std::deque<std::pair<uint64_t, usb_transfer_t *>> resubmits; // (time, transfer) once data_cb returned
+} sim;
+
+static esp_err_t usb_host_transfer_submit_sim_callback(usb_transfer_t *transfer, int call_count)
+{
+    sim.resubmits.push_back({sim.busy_until_us, transfer});
+    return ESP_OK;
+}
+
+// Bytes carry the low bits of their sequence number, every delivered byte is checked against the stream
+static bool sim_rx(const uint8_t *data, size_t data_len, void *user_arg)
+{
+    sim.busy_until_us = ((sim.busy_until_us > sim.now_us) ? sim.busy_until_us : sim.now_us) + sim.callback_us;
+    for (size_t i = 0; i < data_len; i++) {
+        if (data[i] != (uint8_t)sim.next_expected) {
+            sim.in_order = false;
+        }
+        sim.next_expected++;
+    }
+    sim.delivered += data_len;
+    return true;
+}
+
+static rx_sim_result_t _simulate_rx(const rx_sim_config_t *config, uint8_t in_xfer_count, size_t in_buffer_size)
+{
+    cdc_acm_dev_hdl_t dev = nullptr;
+    const cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 0,
+        .in_buffer_size = in_buffer_size,
+        .event_cb = nullptr,
+        .data_cb = sim_rx,
+        .user_arg = nullptr,
+        .in_xfer_count = in_xfer_count,
+    };
+    test_cp210x_open(&dev_config, &dev);
+
+    sim.now_us = 0;
+    sim.busy_until_us = 0;
+    sim.callback_us = config->callback_us;
+    sim.next_expected = 0;
+    sim.delivered = 0;
+    sim.in_order = true;
+    sim.resubmits.clear();
+    usb_host_transfer_submit_Stub(usb_host_transfer_submit_sim_callback);
+
+    std::deque<usb_transfer_t *> in_flight(test_cp210x_submitted.begin(), test_cp210x_submitted.end());
+    std::deque<usb_transfer_t *> completed;
+    for (usb_transfer_t *transfer : in_flight) {
+        transfer->actual_num_bytes = 0;
+    }
+
+    // Bytes lost on overrun never get a sequence number, so the delivered stream must be contiguous
+    std::deque<uint8_t> fifo;
+    rx_sim_result_t result = {};
+    uint8_t sequence = 0;
+    const uint32_t step_us = 10;
+
+    for (uint64_t t = 0; t < config->duration_us; t += step_us) {
+        sim.now_us = t;
+
+        // UART -> device FIFO
+        const uint64_t produced = (uint64_t)config->baud_bytes_per_s * (t + step_us) / 1000000;
+        for (; result.produced < produced; result.produced++) {
+            if (fifo.size() < config->fifo_size) {
+                fifo.push_back(sequence++);
+            } else {
+                result.lost++;
+            }
+        }
+
+        // Device FIFO -> in-flight IN transfers, full packets only
+        while (!in_flight.empty() && fifo.size() >= config->mps) {
+            usb_transfer_t *transfer = in_flight.front();
+            for (size_t i = 0; i < config->mps; i++) {
+                transfer->data_buffer[transfer->actual_num_bytes++] = fifo.front();
+                fifo.pop_front();
+            }
+            if ((size_t)transfer->actual_num_bytes + config->mps > (size_t)transfer->num_bytes) {
+                transfer->status = USB_TRANSFER_STATUS_COMPLETED;
+                completed.push_back(transfer);
+                in_flight.pop_front();
+            }
+        }
+
+        // Host: one callback at a time
+        if (t >= sim.busy_until_us && !completed.empty()) {
+            usb_transfer_t *transfer = completed.front();
+            completed.pop_front();
+            transfer->callback(transfer);
+        }
+
+        // Transfers come back in flight when their data_cb returned
+        while (!sim.resubmits.empty() && sim.resubmits.front().first <= t) {
+            usb_transfer_t *transfer = sim.resubmits.front().second;
+            sim.resubmits.pop_front();
+            transfer->actual_num_bytes = 0;
+            in_flight.push_back(transfer);
+        }
+    }
+
+    result.delivered = sim.delivered;
+    result.in_order = sim.in_order;
+    test_cp210x_close(dev);
+    return result;
+}
+
+SCENARIO("Sustained RX throughput versus callback latency")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+
+    // 921600 baud 8N1 analyzer behind an FTDI-like bridge with a 256 byte FIFO
+    rx_sim_config_t config = {
+        .baud_bytes_per_s = 92160,
+        .fifo_size = 256,
+        .mps = 64,
+        .callback_us = 0,
+        .duration_us = 2000000,
+    };
+    const size_t in_buffer_size = 512;
+    const uint32_t latencies_us[] = {0, 1000, 2000, 3000, 5000, 8000};
+    const uint8_t counts[] = {1, 2, 4};
+
+    printf("\nRX throughput at %" PRIu32 " B/s, %zu B device FIFO, %zu B IN transfers\n",
+           config.baud_bytes_per_s, config.fifo_size, in_buffer_size);
+    printf("%12s %10s %12s %10s\n", "data_cb [us]", "IN xfers", "kB/s", "lost [%]");
+
+    for (uint32_t latency_us : latencies_us) {
+        config.callback_us = latency_us;
+        double throughput[sizeof(counts)];
+        uint64_t lost[sizeof(counts)];
+        for (size_t i = 0; i < sizeof(counts); i++) {
+            const rx_sim_result_t result = _simulate_rx(&config, counts[i], in_buffer_size);
+            throughput[i] = result.delivered * 1000.0 / config.duration_us;
+            lost[i] = result.lost;
+            printf("%12" PRIu32 " %10u %12.1f %10.1f\n", latency_us, (unsigned)counts[i], throughput[i],
+                   100.0 * result.lost / result.produced);
+            CHECK(result.in_order);
+        }
+
+        // More transfers in flight never lose more
+        CHECK(lost[1] <= lost[0]);
+        CHECK(lost[2] <= lost[1]);
+        if (latency_us * config.baud_bytes_per_s / 1000000 < config.fifo_size) {
+            // The device FIFO covers the callback on its own
+            CHECK(lost[0] == 0);
+        }
+        if (latency_us == 5000) {
+            // Longer than the device FIFO lasts, but a second transfer keeps polling meanwhile
+            CHECK(lost[0] > 0);
+            CHECK(lost[1] == 0);
+        }
+        if (latency_us == 8000) {
+            // data_cb takes longer than the line needs to fill a transfer: no number of transfers helps
+            CHECK(lost[2] > 0);
+            CHECK(throughput[2] < config.baud_bytes_per_s / 1000.0);
+        }
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
@@ -0,0 +1,363 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "descriptors/cdc_descriptors.hpp"
+#include "usb/cdc_acm_host.h"
+#include "mock_add_usb_device.h"
+#include "common_test_fixtures.hpp"
+
+extern "C" {
+#include "Mockusb_host.h"
+}
+
+// CP210x: no notification endpoint, one bulk IN and one bulk OUT endpoint
+static const uint16_t vid = 0x10C4, pid = 0xEA60;
+static const uint8_t interface_index = 0;
+static const uint8_t in_ep = 0x82;
+static const uint8_t cp210x_address = 4;
+static const uint8_t ch340_address = 5;
+static const uint8_t cp210x_2_address = 6;  // A second CP210x, same VID and PID
+
+/**
+ * @brief Client event callback of the driver, captured on install
+ *
+ * The test calls it to deliver USB Host client events, as the USB Host library would in the driver task.
+ */
+static usb_host_client_event_cb_t client_event_cb;
+static void *client_event_arg;
+
+static esp_err_t usb_host_client_register_capture_callback(const usb_host_client_config_t *client_config, usb_host_client_handle_t *client_hdl_ret, int call_count)
+{
+    client_event_cb = client_config->async.client_event_callback;
+    client_event_arg = client_config->async.callback_arg;
+    return usb_host_client_register_mock_callback(client_config, client_hdl_ret, call_count);
+}
+
+static void _new_device_event(uint8_t address)
+{
+    usb_host_client_event_msg_t event_msg = {};
+    event_msg.event = USB_HOST_CLIENT_EVENT_NEW_DEV;
+    event_msg.new_dev.address = address;
+    client_event_cb(&event_msg, client_event_arg);
+}
+
+static void _install(void)
+{
+    usb_host_client_register_Stub(usb_host_client_register_capture_callback);
+    usb_host_client_handle_events_ExpectAnyArgsAndReturn(ESP_OK);
+    usb_host_client_handle_events_AddCallback(usb_host_client_handle_events_mock_callback);
+    REQUIRE(ESP_OK == cdc_acm_host_install(nullptr));
+    usb_host_client_register_Stub(nullptr);
+    REQUIRE(client_event_cb != nullptr);
+}
+
+/**
+ * @brief USB devices opened and closed through the mocked USB Host stack, to check that no handle is leaked
+ */
+static int usb_devices_open;
+static int addr_list_fills;
+
+static esp_err_t usb_host_device_open_count_callback(usb_host_client_handle_t client_hdl, uint8_t dev_addr, usb_device_handle_t *dev_hdl_ret, int call_count)
+{
+    const esp_err_t ret = usb_host_device_open_mock_callback(client_hdl, dev_addr, dev_hdl_ret, call_count);
+    if (ret == ESP_OK) {
+        usb_devices_open++;
+    }
+    return ret;
+}
+
+static esp_err_t usb_host_device_close_count_callback(usb_host_client_handle_t client_hdl, usb_device_handle_t dev_hdl, int call_count)
+{
+    usb_devices_open--;
+    return usb_host_device_close_mock_callback(client_hdl, dev_hdl, call_count);
+}
+
+static esp_err_t usb_host_device_addr_list_fill_count_callback(int list_len, uint8_t *dev_addr_list, int *num_dev_ret, int call_count)
+{
+    addr_list_fills++;
+    return usb_host_device_addr_list_fill_mock_callback(list_len, dev_addr_list, num_dev_ret, call_count);
+}
+
+static esp_err_t usb_host_transfer_submit_ok_callback(usb_transfer_t *transfer, int call_count)
+{
+    return ESP_OK;
+}
+
+/**
+ * @brief Stub the mocked USB Host stack for opening devices from the mocked device list
+ */
+static void _stub_usb_host(void)
+{
+    usb_devices_open = 0;
+    addr_list_fills = 0;
+    usb_host_device_open_Stub(usb_host_device_open_count_callback);
+    usb_host_device_close_Stub(usb_host_device_close_count_callback);
+    usb_host_get_device_descriptor_Stub(usb_host_get_device_descriptor_mock_callback);
+    usb_host_device_info_Stub(usb_host_device_info_mock_callback);
+    usb_host_get_active_config_descriptor_Stub(usb_host_get_active_config_descriptor_mock_callback);
+    usb_host_device_addr_list_fill_Stub(usb_host_device_addr_list_fill_count_callback);
+    usb_host_transfer_alloc_Stub(usb_host_transfer_alloc_mock_callback);
+    usb_host_transfer_submit_Stub(usb_host_transfer_submit_ok_callback);
+    usb_host_transfer_free_Stub(usb_host_transfer_free_mock_callback);
+}
+
+static void _unstub_usb_host(void)
+{
+    usb_host_device_open_Stub(nullptr);
+    usb_host_device_close_Stub(nullptr);
+    usb_host_get_device_descriptor_Stub(nullptr);
+    usb_host_device_info_Stub(nullptr);
+    usb_host_get_active_config_descriptor_Stub(nullptr);
+    usb_host_device_addr_list_fill_Stub(nullptr);
+    usb_host_transfer_alloc_Stub(nullptr);
+    usb_host_transfer_submit_Stub(nullptr);
+    usb_host_transfer_free_Stub(nullptr);
+}
+
+static void _close_device(cdc_acm_dev_hdl_t dev)
+{
+    test_cdc_acm_reset_transfer_endpoint(in_ep);
+    usb_host_interface_release_ExpectAndReturn(nullptr, nullptr, interface_index, ESP_OK);
+    usb_host_interface_release_IgnoreArg_client_hdl();
+    usb_host_interface_release_IgnoreArg_dev_hdl();
+    REQUIRE(ESP_OK == cdc_acm_host_close(dev));
+}
+
+static std::vector<cdc_acm_dev_hdl_t> arrived;
+
+static void handle_arrival(cdc_acm_dev_hdl_t cdc_hdl, void *arrival_arg)
+{
+    arrived.push_back(cdc_hdl);
+    (*(int *)arrival_arg)++;
+}
+
+SCENARIO("Open on arrival")
+{
+    _install();
+    _stub_usb_host();
+    usb_host_mock_dev_list_init();
+    arrived.clear();
+
+    int arrival_calls = 0;
+    const cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 0,
+        .out_buffer_size = 64,
+        .in_buffer_size = 64,
+        .event_cb = nullptr,
+        .data_cb = nullptr,
+        .user_arg = nullptr,
+    };
+
+    SECTION("Registrations are checked") {
+        cdc_acm_host_device_config_t bad_config = dev_config;
+        bad_config.rx_buffer_size = 256;
+        bad_config.rx_loan_count = 1;
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_open_on_arrival(vid, pid, interface_index, nullptr, handle_arrival, &arrival_calls));
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_open_on_arrival(vid, pid, interface_index, &dev_config, nullptr, nullptr));
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_open_on_arrival(vid, pid, interface_index, &bad_config, handle_arrival, &arrival_calls));
+
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival(vid, pid, interface_index, &dev_config, handle_arrival, &arrival_calls));
+        CHECK(ESP_ERR_INVALID_STATE == cdc_acm_host_open_on_arrival(vid, pid, interface_index, &dev_config, handle_arrival, &arrival_calls));
+        for (int i = 1; i < CDC_ACM_ARRIVALS_MAX; i++) {
+            REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival(vid, pid, interface_index + i, &dev_config, handle_arrival, &arrival_calls));
+        }
+        CHECK(ESP_ERR_NO_MEM == cdc_acm_host_open_on_arrival(CDC_HOST_ANY_VID, CDC_HOST_ANY_PID, interface_index, &dev_config, handle_arrival, &arrival_calls));
+
+        for (int i = 0; i < CDC_ACM_ARRIVALS_MAX; i++) {
+            REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival_cancel(vid, pid, interface_index + i));
+        }
+        CHECK(ESP_ERR_NOT_FOUND == cdc_acm_host_open_on_arrival_cancel(vid, pid, interface_index));
+    }
+
+    SECTION("Matching device is opened as it arrives") {
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival(vid, pid, interface_index, &dev_config, handle_arrival, &arrival_calls));
+
+        // Another device arrives first: it is not opened
+        REQUIRE(ESP_OK == usb_host_mock_add_device(ch340_address, (const usb_device_desc_t *)ch340_device_desc,
+                                                   (const usb_config_desc_t *)ch340_config_desc, USB_SPEED_FULL));
+        _new_device_event(ch340_address);
+        CHECK(arrival_calls == 0);
+        CHECK(usb_devices_open == 0);
+
+        REQUIRE(ESP_OK == usb_host_mock_add_device(cp210x_address, (const usb_device_desc_t *)cp210x_device_desc,
+                                                   (const usb_config_desc_t *)cp210x_config_desc, USB_SPEED_FULL));
+        usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+        _new_device_event(cp210x_address);
+        REQUIRE(arrival_calls == 1);
+        REQUIRE(arrived.size() == 1);
+        REQUIRE(arrived[0] != nullptr);
+        CHECK(usb_devices_open == 1);
+        CHECK(addr_list_fills == 0); // No bus scan
+
+        cdc_acm_host_stats_t stats;
+        CHECK(ESP_OK == cdc_acm_host_get_stats(arrived[0], &stats));
+        _close_device(arrived[0]);
+        CHECK(usb_devices_open == 0);
+
+        // The registration stays: the device is opened again when it is replugged
+        usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+        _new_device_event(cp210x_address);
+        REQUIRE(arrival_calls == 2);
+        _close_device(arrived[1]);
+
+        // Not after the registration is cancelled
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival_cancel(vid, pid, interface_index));
+        _new_device_event(cp210x_address);
+        CHECK(arrival_calls == 2);
+        CHECK(usb_devices_open == 0);
+    }
+
+    SECTION("Device without the CDC interface is closed again") {
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival(CDC_HOST_ANY_VID, CDC_HOST_ANY_PID, 3, &dev_config, handle_arrival, &arrival_calls));
+        REQUIRE(ESP_OK == usb_host_mock_add_device(cp210x_address, (const usb_device_desc_t *)cp210x_device_desc,
+                                                   (const usb_config_desc_t *)cp210x_config_desc, USB_SPEED_FULL));
+        _new_device_event(cp210x_address);
+        CHECK(arrival_calls == 0);
+        CHECK(usb_devices_open == 0);
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival_cancel(CDC_HOST_ANY_VID, CDC_HOST_ANY_PID, 3));
+    }
+
+    _unstub_usb_host();
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
+
+static SemaphoreHandle_t plug_done;
+
+// Connects the CP210x after a while, from another task; the CH340 before it if arg is not NULL
+static void plug_task(void *arg)
+{
+    vTaskDelay(pdMS_TO_TICKS(200));
+    if (arg != nullptr) {
+        usb_host_mock_add_device(ch340_address, (const usb_device_desc_t *)ch340_device_desc,
+                                 (const usb_config_desc_t *)ch340_config_desc, USB_SPEED_FULL);
+        _new_device_event(ch340_address);
+    }
+    usb_host_mock_add_device(cp210x_address, (const usb_device_desc_t *)cp210x_device_desc,
+                             (const usb_config_desc_t *)cp210x_config_desc, USB_SPEED_FULL);
+    _new_device_event(cp210x_address);
+    xSemaphoreGive(plug_done);
+    vTaskDelete(NULL);
+}
+
+SCENARIO("Blocking open waits for the new device event")
+{
+    _install();
+    _stub_usb_host();
+    usb_host_mock_dev_list_init();
+
+    const cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 64,
+        .in_buffer_size = 64,
+        .event_cb = nullptr,
+        .data_cb = nullptr,
+        .user_arg = nullptr,
+    };
+    cdc_acm_dev_hdl_t dev = nullptr;
+
+    SECTION("Device that is not connected times out") {
+        const TickType_t start = xTaskGetTickCount();
+        CHECK(ESP_ERR_NOT_FOUND == cdc_acm_host_open(vid, pid, interface_index, &dev_config, &dev));
+        CHECK(dev == nullptr);
+        CHECK(xTaskGetTickCount() - start >= pdMS_TO_TICKS(1000));
+        CHECK(addr_list_fills == 1); // Nothing was enumerated meanwhile
+    }
+
+    SECTION("Device connected during the open is opened without polling the bus") {
+        plug_done = xSemaphoreCreateBinary();
+        REQUIRE(plug_done != nullptr);
+        REQUIRE(pdPASS == xTaskCreate(plug_task, "plug", 4096, nullptr, 5, nullptr));
+
+        usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+        REQUIRE(ESP_OK == cdc_acm_host_open(vid, pid, interface_index, &dev_config, &dev));
+        REQUIRE(dev != nullptr);
+        REQUIRE(pdTRUE == xSemaphoreTake(plug_done, pdMS_TO_TICKS(1000)));
+        vSemaphoreDelete(plug_done);
+        CHECK(addr_list_fills == 2); // Once before the device was connected, once after its event
+        _close_device(dev);
+        CHECK(usb_devices_open == 0);
+    }
+
+    SECTION("Events of other devices are delivered while the open waits") {
+        // A registration makes the driver task take open_close_mutex for each new device: the waiting open must not hold it
+        int arrival_calls = 0;
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival(0x1234, 0x5678, interface_index, &dev_config, handle_arrival, &arrival_calls));
+        plug_done = xSemaphoreCreateBinary();
+        REQUIRE(plug_done != nullptr);
+        REQUIRE(pdPASS == xTaskCreate(plug_task, "plug", 4096, (void *)&arrival_calls, 5, nullptr));
+
+        usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+        REQUIRE(ESP_OK == cdc_acm_host_open(vid, pid, interface_index, &dev_config, &dev));
+        REQUIRE(dev != nullptr);
+        REQUIRE(pdTRUE == xSemaphoreTake(plug_done, pdMS_TO_TICKS(1000)));
+        vSemaphoreDelete(plug_done);
+        CHECK(arrival_calls == 0);
+        _close_device(dev);
+        CHECK(usb_devices_open == 0);
+        REQUIRE(ESP_OK == cdc_acm_host_open_on_arrival_cancel(0x1234, 0x5678, interface_index));
+    }
+
+    _unstub_usb_host();
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
+
+SCENARIO("Open by address")
+{
+    _install();
+    _stub_usb_host();
+    usb_host_mock_dev_list_init();
+
+    const cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 0,
+        .out_buffer_size = 64,
+        .in_buffer_size = 64,
+        .event_cb = nullptr,
+        .data_cb = nullptr,
+        .user_arg = nullptr,
+    };
+    REQUIRE(ESP_OK == usb_host_mock_add_device(cp210x_address, (const usb_device_desc_t *)cp210x_device_desc,
+                                               (const usb_config_desc_t *)cp210x_config_desc, USB_SPEED_FULL));
+    REQUIRE(ESP_OK == usb_host_mock_add_device(cp210x_2_address, (const usb_device_desc_t *)cp210x_device_desc,
+                                               (const usb_config_desc_t *)cp210x_config_desc, USB_SPEED_FULL));
+    cdc_acm_dev_hdl_t first = nullptr;
+    cdc_acm_dev_hdl_t second = nullptr;
+
+    SECTION("Devices with the same VID and PID are opened separately") {
+        usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+        REQUIRE(ESP_OK == cdc_acm_host_open_by_address(cp210x_2_address, interface_index, &dev_config, &second));
+        usb_host_interface_claim_ExpectAnyArgsAndReturn(ESP_OK);
+        REQUIRE(ESP_OK == cdc_acm_host_open_by_address(cp210x_address, interface_index, &dev_config, &first));
+        REQUIRE(first != nullptr);
+        REQUIRE(second != nullptr);
+        CHECK(first != second);
+        CHECK(usb_devices_open == 2);
+        CHECK(addr_list_fills == 0); // No bus scan
+
+        _close_device(first);
+        _close_device(second);
+        CHECK(usb_devices_open == 0);
+    }
+
+    SECTION("Missing device or interface is not found") {
+        CHECK(ESP_ERR_NOT_FOUND == cdc_acm_host_open_by_address(ch340_address, interface_index, &dev_config, &first));
+        CHECK(first == nullptr);
+        CHECK(ESP_ERR_NOT_FOUND == cdc_acm_host_open_by_address(cp210x_address, 3, &dev_config, &first));
+        CHECK(first == nullptr);
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_open_by_address(cp210x_address, interface_index, nullptr, &first));
+        CHECK(usb_devices_open == 0);
+    }
+
+    _unstub_usb_host();
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
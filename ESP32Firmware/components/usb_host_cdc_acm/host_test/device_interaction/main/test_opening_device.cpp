@@ -193,3 +193,147 @@ SCENARIO("Test mocked device opening and closing")
         REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
     }
 }
+
+SCENARIO("Test reopening a device with kept transfers")
+{
+    _add_mocked_devices();
+
+    GIVEN("CDC-ACM driver installed with keep_transfers") {
+        const cdc_acm_host_driver_config_t driver_config = {
+            .driver_task_stack_size = 4096,
+            .driver_task_priority = 10,
+            .xCoreID = 0,
+            .new_dev_cb = nullptr,
+            .keep_transfers = true,
+        };
+        REQUIRE(ESP_OK == test_cdc_acm_host_install(&driver_config));
+
+        cdc_acm_dev_hdl_t dev = nullptr;
+        const cdc_acm_host_device_config_t dev_config = {
+            .connection_timeout_ms = 1000,
+            .out_buffer_size = 100,
+            .in_buffer_size = 100,
+            .event_cb = nullptr,
+            .data_cb = nullptr,
+            .user_arg = nullptr,
+        };
+        const uint16_t vid = 0x10C4, pid = 0xEA60;
+        const uint8_t interface_index = 0;
+        const uint8_t in_ep = 0x82;
+
+        SECTION("Second open reuses the transfers of the first") {
+            for (int round = 0; round < 2; round++) {
+                usb_host_device_addr_list_fill_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_device_addr_list_fill_AddCallback(usb_host_device_addr_list_fill_mock_callback);
+                usb_host_device_open_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_device_open_AddCallback(usb_host_device_open_mock_callback);
+                usb_host_get_device_descriptor_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_get_device_descriptor_AddCallback(usb_host_get_device_descriptor_mock_callback);
+                usb_host_device_close_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_device_close_AddCallback(usb_host_device_close_mock_callback);
+
+                usb_host_get_device_descriptor_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_get_active_config_descriptor_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_get_active_config_descriptor_AddCallback(usb_host_get_active_config_descriptor_mock_callback);
+
+                if (round == 0) {
+                    // CTRL, IN and OUT transfers are allocated once; the second open takes them from the spares
+                    usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+                    usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+                    usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+                    usb_host_transfer_alloc_AddCallback(usb_host_transfer_alloc_mock_callback);
+                }
+                test_usb_host_interface_claim(interface_index);
+
+                REQUIRE(ESP_OK == cdc_acm_host_open(vid, pid, interface_index, &dev_config, &dev));
+                REQUIRE(nullptr != dev);
+
+                // Closing keeps the transfers: no usb_host_transfer_free() expected
+                test_cdc_acm_reset_transfer_endpoint(in_ep);
+                usb_host_interface_release_ExpectAndReturn(nullptr, nullptr, interface_index, ESP_OK);
+                usb_host_interface_release_IgnoreArg_client_hdl();
+                usb_host_interface_release_IgnoreArg_dev_hdl();
+                usb_host_device_close_ExpectAnyArgsAndReturn(ESP_OK);
+                REQUIRE(ESP_OK == cdc_acm_host_close(dev));
+            }
+
+            // Uninstall frees the kept CTRL, IN and OUT transfers
+            usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+            usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+            usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+            usb_host_transfer_free_AddCallback(usb_host_transfer_free_mock_callback);
+        }
+
+        REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+    }
+}
+
+SCENARIO("Test reopening a device with cached descriptors")
+{
+    _add_mocked_devices();
+
+    GIVEN("CDC-ACM driver installed with cache_descriptors") {
+        const cdc_acm_host_driver_config_t driver_config = {
+            .driver_task_stack_size = 4096,
+            .driver_task_priority = 10,
+            .xCoreID = 0,
+            .new_dev_cb = nullptr,
+            .keep_transfers = false,
+            .cache_descriptors = true,
+        };
+        REQUIRE(ESP_OK == test_cdc_acm_host_install(&driver_config));
+
+        cdc_acm_dev_hdl_t dev = nullptr;
+        const cdc_acm_host_device_config_t dev_config = {
+            .connection_timeout_ms = 1000,
+            .out_buffer_size = 100,
+            .in_buffer_size = 100,
+            .event_cb = nullptr,
+            .data_cb = nullptr,
+            .user_arg = nullptr,
+        };
+        const uint16_t vid = 0x10C4, pid = 0xEA60;
+        const uint8_t interface_index = 0;
+        const uint8_t in_ep = 0x82;
+
+        SECTION("Second open uses the cached layout of the first") {
+            for (int round = 0; round < 2; round++) {
+                usb_host_device_addr_list_fill_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_device_addr_list_fill_AddCallback(usb_host_device_addr_list_fill_mock_callback);
+                usb_host_device_open_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_device_open_AddCallback(usb_host_device_open_mock_callback);
+                usb_host_get_device_descriptor_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_get_device_descriptor_AddCallback(usb_host_get_device_descriptor_mock_callback);
+                usb_host_device_close_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_device_close_AddCallback(usb_host_device_close_mock_callback);
+
+                usb_host_get_device_descriptor_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_get_active_config_descriptor_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_get_active_config_descriptor_AddCallback(usb_host_get_active_config_descriptor_mock_callback);
+
+                // CTRL, IN and OUT transfers
+                usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_transfer_alloc_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_transfer_alloc_AddCallback(usb_host_transfer_alloc_mock_callback);
+                test_usb_host_interface_claim(interface_index);
+
+                REQUIRE(ESP_OK == cdc_acm_host_open(vid, pid, interface_index, &dev_config, &dev));
+                REQUIRE(nullptr != dev);
+
+                test_cdc_acm_reset_transfer_endpoint(in_ep);
+                usb_host_interface_release_ExpectAndReturn(nullptr, nullptr, interface_index, ESP_OK);
+                usb_host_interface_release_IgnoreArg_client_hdl();
+                usb_host_interface_release_IgnoreArg_dev_hdl();
+                usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_transfer_free_ExpectAnyArgsAndReturn(ESP_OK);
+                usb_host_transfer_free_AddCallback(usb_host_transfer_free_mock_callback);
+                usb_host_device_close_ExpectAnyArgsAndReturn(ESP_OK);
+                REQUIRE(ESP_OK == cdc_acm_host_close(dev));
+            }
+        }
+
+        REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "usb/cdc_acm_host.h"
+#include "common_test_fixtures.hpp"
+
+static std::string _read(cdc_acm_dev_hdl_t dev, size_t len)
+{
+    uint8_t buf[64];
+    size_t rx_len = 0;
+    REQUIRE(len <= sizeof(buf));
+    REQUIRE(ESP_OK == cdc_acm_host_data_rx_blocking(dev, buf, len, &rx_len, 0));
+    return std::string((const char *)buf, rx_len);
+}
+
+static int overruns;
+static int rx_data_events;
+
+static void record_event(const cdc_acm_host_dev_event_data_t *event, void *user_ctx)
+{
+    if (event->type == CDC_ACM_HOST_SERIAL_STATE && event->data.serial_state.bOverRun) {
+        overruns++;
+    }
+    if (event->type == CDC_ACM_HOST_RX_DATA) {
+        rx_data_events++;
+    }
+}
+
+static bool unexpected_rx(const uint8_t *data, size_t data_len, void *user_arg)
+{
+    FAIL("data_cb must not be called");
+    return true;
+}
+
+SCENARIO("RX ring buffer")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+
+    cdc_acm_dev_hdl_t dev = nullptr;
+    cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 0,
+        .in_buffer_size = 64,
+        .event_cb = record_event,
+        .data_cb = nullptr,
+        .user_arg = nullptr,
+        .in_xfer_count = 2,
+        .rx_loan_count = 0,
+        .rx_buffer_size = 8,
+    };
+    overruns = 0;
+    rx_data_events = 0;
+
+    SECTION("Fail to open CDC-ACM Device: the ring buffer is combined with another way of receiving data") {
+        dev_config.data_cb = unexpected_rx;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+        dev_config.data_cb = nullptr;
+        dev_config.rx_loan_count = 1;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+    }
+
+    SECTION("The ring buffer is not available on a device opened with data_cb") {
+        dev_config.rx_buffer_size = 0;
+        dev_config.data_cb = unexpected_rx;
+        test_cp210x_open(&dev_config, &dev);
+        uint8_t buf[4];
+        size_t rx_len;
+        cdc_acm_host_rx_buffer_stats_t stats;
+        CHECK(ESP_ERR_NOT_SUPPORTED == cdc_acm_host_data_rx_blocking(dev, buf, sizeof(buf), &rx_len, 0));
+        CHECK(ESP_ERR_NOT_SUPPORTED == cdc_acm_host_rx_buffer_stats_get(dev, &stats));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Received data is read as a stream, IN transfers are resubmitted without waiting for the reader") {
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+        test_cp210x_submitted.clear();
+
+        uint8_t buf[4];
+        size_t rx_len = 1;
+        CHECK(ESP_ERR_TIMEOUT == cdc_acm_host_data_rx_blocking(dev, buf, sizeof(buf), &rx_len, 10));
+        CHECK(rx_len == 0);
+
+        test_cp210x_complete(xfers[0], "abc");
+        test_cp210x_complete(xfers[1], "de");
+        REQUIRE(test_cp210x_submitted == std::vector<usb_transfer_t *> {xfers[0], xfers[1]});
+        CHECK(xfers[0]->num_bytes == 64);
+        CHECK(rx_data_events == 2);  // Also for "de", pushed while "abc" was still unread
+
+        // Reads return what is there, up to the buffer size, across transfer boundaries
+        CHECK(_read(dev, 2) == "ab");
+        CHECK(_read(dev, 64) == "cde");
+        CHECK(ESP_ERR_TIMEOUT == cdc_acm_host_data_rx_blocking(dev, buf, sizeof(buf), &rx_len, 0));
+        test_cp210x_complete(xfers[0], "f");
+        CHECK(rx_data_events == 3);
+        CHECK(_read(dev, 64) == "f");
+
+        cdc_acm_host_rx_buffer_stats_t stats;
+        REQUIRE(ESP_OK == cdc_acm_host_rx_buffer_stats_get(dev, &stats));
+        CHECK(stats.size == 8);
+        CHECK(stats.high_water == 5);
+        CHECK(stats.overflows == 0);
+        CHECK(stats.dropped_bytes == 0);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Data that does not fit is dropped, counted and reported as overrun") {
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+
+        test_cp210x_complete(xfers[0], "ABCDEF");
+        test_cp210x_complete(xfers[1], "GHIJ");
+        test_cp210x_complete(xfers[0], "KL");
+        CHECK(overruns == 2);
+
+        cdc_acm_host_rx_buffer_stats_t stats;
+        REQUIRE(ESP_OK == cdc_acm_host_rx_buffer_stats_get(dev, &stats));
+        CHECK(stats.high_water == 8);
+        CHECK(stats.overflows == 2);
+        CHECK(stats.dropped_bytes == 4);
+
+        // The oldest data is kept, and the stream goes on once there is room again
+        CHECK(_read(dev, 64) == "ABCDEFGH");
+        test_cp210x_complete(xfers[1], "MN");
+        CHECK(_read(dev, 64) == "MN");
+        test_cp210x_close(dev);
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "usb/cdc_acm_host.h"
+#include "common_test_fixtures.hpp"
+
+/**
+ * @brief Take the next lent buffer, which must be available at once
+ */
+static std::string _acquire(cdc_acm_dev_hdl_t dev, const uint8_t **data)
+{
+    size_t data_len = 0;
+    REQUIRE(ESP_OK == cdc_acm_host_rx_acquire(dev, data, &data_len, 0));
+    return std::string((const char *)*data, data_len);
+}
+
+static bool unexpected_rx(const uint8_t *data, size_t data_len, void *user_arg)
+{
+    FAIL("data_cb must not be called");
+    return true;
+}
+
+SCENARIO("RX buffer loans")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+
+    cdc_acm_dev_hdl_t dev = nullptr;
+    cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 0,
+        .in_buffer_size = 64,
+        .event_cb = nullptr,
+        .data_cb = nullptr,
+        .user_arg = nullptr,
+        .in_xfer_count = 2,
+        .rx_loan_count = 2,
+    };
+
+    SECTION("Fail to open CDC-ACM Device: invalid RX loan configuration") {
+        dev_config.rx_loan_count = CDC_ACM_RX_LOANS_MAX + 1;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+
+        // Received data goes either to data_cb or to the loans, never both
+        dev_config.rx_loan_count = 1;
+        dev_config.data_cb = unexpected_rx;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+    }
+
+    SECTION("Loans are not available on a device opened with data_cb") {
+        dev_config.rx_loan_count = 0;
+        dev_config.data_cb = unexpected_rx;
+        test_cp210x_open(&dev_config, &dev);
+        const uint8_t *data;
+        size_t data_len;
+        CHECK(ESP_ERR_NOT_SUPPORTED == cdc_acm_host_rx_acquire(dev, &data, &data_len, 0));
+        CHECK(ESP_ERR_NOT_SUPPORTED == cdc_acm_host_rx_release(dev, test_cp210x_submitted[0]->data_buffer));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Only the IN transfer slots are test_cp210x_submitted on open, the rest of the pool waits") {
+        test_cp210x_open(&dev_config, &dev);
+        REQUIRE(test_cp210x_submitted.size() == 2);
+        CHECK(test_cp210x_submitted[0] != test_cp210x_submitted[1]);
+
+        const uint8_t *data;
+        size_t data_len;
+        CHECK(ESP_ERR_TIMEOUT == cdc_acm_host_rx_acquire(dev, &data, &data_len, 10));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Received data is lent in place and in order, slots are refilled from the pool") {
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+        test_cp210x_submitted.clear();
+
+        test_cp210x_complete(xfers[0], "A");
+        test_cp210x_complete(xfers[1], "B");
+        REQUIRE(test_cp210x_submitted.size() == 2);  // Both slots got a spare transfer from the pool
+        CHECK(test_cp210x_submitted[0] != xfers[0]);
+        CHECK(test_cp210x_submitted[0] != xfers[1]);
+        CHECK(test_cp210x_submitted[1] != test_cp210x_submitted[0]);
+
+        const uint8_t *a, *b;
+        CHECK(_acquire(dev, &a) == "A");
+        CHECK(_acquire(dev, &b) == "B");
+        CHECK(a == xfers[0]->data_buffer);  // No copy: the buffer the data was received into
+        CHECK(b == xfers[1]->data_buffer);
+
+        // Released buffers are reused for the next poll
+        const std::vector<usb_transfer_t *> spares = test_cp210x_submitted;
+        test_cp210x_submitted.clear();
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, a));
+        CHECK(test_cp210x_submitted.empty());  // No slot is waiting
+        test_cp210x_complete(spares[0], "C");
+        REQUIRE(test_cp210x_submitted == std::vector<usb_transfer_t *> {xfers[0]});
+        CHECK(_acquire(dev, &a) == "C");
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, a));
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, b));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Slots wait for released buffers when the application holds them all, and keep their order") {
+        test_cp210x_open(&dev_config, &dev);
+        std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+
+        // Four buffers fill up: slots 0 and 1 are refilled once, then wait
+        test_cp210x_complete(xfers[0], "A");
+        test_cp210x_complete(xfers[1], "B");
+        xfers = std::vector<usb_transfer_t *>(test_cp210x_submitted.end() - 2, test_cp210x_submitted.end());
+        test_cp210x_submitted.clear();
+        test_cp210x_complete(xfers[0], "C");
+        test_cp210x_complete(xfers[1], "D");
+        CHECK(test_cp210x_submitted.empty());
+
+        const uint8_t *held[4];
+        CHECK(_acquire(dev, &held[0]) == "A");
+        CHECK(_acquire(dev, &held[1]) == "B");
+        CHECK(_acquire(dev, &held[2]) == "C");
+        CHECK(_acquire(dev, &held[3]) == "D");
+
+        // Released out of order: slot 0 is refilled first, then slot 1
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, held[2]));
+        REQUIRE(test_cp210x_submitted.size() == 1);
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, held[0]));
+        REQUIRE(test_cp210x_submitted.size() == 2);
+        CHECK(test_cp210x_submitted[0]->data_buffer == held[2]);
+        CHECK(test_cp210x_submitted[1]->data_buffer == held[0]);
+        test_cp210x_complete(test_cp210x_submitted[0], "E");
+        test_cp210x_complete(test_cp210x_submitted[1], "F");
+
+        const uint8_t *data;
+        CHECK(_acquire(dev, &data) == "E");
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, data));
+        CHECK(_acquire(dev, &data) == "F");
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, data));
+
+        // A buffer still lent on close is freed with the rest of the pool
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, held[1]));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Only lent buffers can be released, once") {
+        test_cp210x_open(&dev_config, &dev);
+        test_cp210x_complete(test_cp210x_submitted[0], "A");
+
+        const uint8_t *data;
+        CHECK(_acquire(dev, &data) == "A");
+        const uint8_t other[4] = {0};
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_rx_release(dev, other));
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_rx_release(dev, test_cp210x_submitted[1]->data_buffer));  // In flight
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, data));
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_rx_release(dev, data));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Empty transfers are polled again without being lent") {
+        test_cp210x_open(&dev_config, &dev);
+        usb_transfer_t *first = test_cp210x_submitted[0];
+        test_cp210x_submitted.clear();
+
+        test_cp210x_complete(first, "");
+        REQUIRE(test_cp210x_submitted.size() == 1);
+        const uint8_t *data;
+        size_t data_len;
+        CHECK(ESP_ERR_TIMEOUT == cdc_acm_host_rx_acquire(dev, &data, &data_len, 0));
+        test_cp210x_close(dev);
+    }
+
+    SECTION("A failed IN transfer stops the IN pipe, released buffers do not restart it") {
+        test_cp210x_open(&dev_config, &dev);
+        const std::vector<usb_transfer_t *> xfers = test_cp210x_submitted;
+        test_cp210x_submitted.clear();
+
+        test_cp210x_complete(xfers[0], "A");
+        const uint8_t *data;
+        CHECK(_acquire(dev, &data) == "A");
+        test_cp210x_complete(xfers[1], "B", USB_TRANSFER_STATUS_STALL);
+        test_cp210x_complete(test_cp210x_submitted[0], "C", USB_TRANSFER_STATUS_CANCELED);
+        test_cp210x_submitted.clear();
+        REQUIRE(ESP_OK == cdc_acm_host_rx_release(dev, data));
+        CHECK(test_cp210x_submitted.empty());
+        test_cp210x_close(dev);
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
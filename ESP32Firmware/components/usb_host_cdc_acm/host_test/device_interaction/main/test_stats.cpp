@@ -0,0 +1,128 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <catch2/catch_test_macros.hpp>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "usb/cdc_acm_host.h"
+#include "common_test_fixtures.hpp"
+
+static int data_cb_calls;
+static TickType_t data_cb_delay;
+
+static bool handle_rx(const uint8_t *data, size_t data_len, void *user_arg)
+{
+    data_cb_calls++;
+    if (data_cb_delay > 0) {
+        vTaskDelay(data_cb_delay);
+    }
+    return true;
+}
+
+static uint32_t _hist_sum(const cdc_acm_host_stats_t &stats, int from_bin = 0)
+{
+    uint32_t sum = 0;
+    for (int i = from_bin; i < CDC_ACM_STATS_HIST_BINS; i++) {
+        sum += stats.in.data_cb_hist[i];
+    }
+    return sum;
+}
+
+SCENARIO("Device statistics")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+
+    cdc_acm_dev_hdl_t dev = nullptr;
+    cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 2,
+        .in_buffer_size = 64,
+        .event_cb = nullptr,
+        .data_cb = handle_rx,
+        .user_arg = nullptr,
+    };
+    cdc_acm_host_stats_t stats;
+    data_cb_calls = 0;
+    data_cb_delay = 0;
+
+    SECTION("Statistics start at zero") {
+        test_cp210x_open(&dev_config, &dev);
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_get_stats(dev, nullptr));
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_get_stats(nullptr, &stats));
+
+        memset(&stats, 0xFF, sizeof(stats));
+        REQUIRE(ESP_OK == cdc_acm_host_get_stats(dev, &stats));
+        static const cdc_acm_host_stats_t zero = {};
+        CHECK(memcmp(&stats, &zero, sizeof(stats)) == 0);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Received data, resubmit gaps and data_cb run times are counted") {
+        test_cp210x_open(&dev_config, &dev);
+        test_cp210x_complete(test_cp210x_submitted.back(), "abc");
+        test_cp210x_complete(test_cp210x_submitted.back(), "");
+        data_cb_delay = pdMS_TO_TICKS(2);  // A slow data_cb keeps the IN endpoint from being polled
+        test_cp210x_complete(test_cp210x_submitted.back(), "de");
+
+        REQUIRE(ESP_OK == cdc_acm_host_get_stats(dev, &stats));
+        CHECK(stats.in.transfers == 3);
+        CHECK(stats.in.bytes == 5);
+        CHECK(stats.in.resubmits == 3);
+        CHECK(stats.in.resubmit_gap_max_us >= 1000);
+        CHECK(stats.in.resubmit_gap_total_us >= stats.in.resubmit_gap_max_us);
+        CHECK(stats.in.data_cb_max_us >= 1000);
+        CHECK(_hist_sum(stats) == (uint32_t)data_cb_calls);
+        CHECK(_hist_sum(stats, 9) >= 1);  // The slow call is at least 512 us
+        CHECK(stats.in.overflows == 0);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Failed transfers are counted by status") {
+        test_cp210x_open(&dev_config, &dev);
+        test_cp210x_complete(test_cp210x_submitted.back(), "", USB_TRANSFER_STATUS_STALL);
+
+        REQUIRE(ESP_OK == cdc_acm_host_get_stats(dev, &stats));
+        CHECK(stats.errors[USB_TRANSFER_STATUS_STALL] == 1);
+        CHECK(stats.errors[USB_TRANSFER_STATUS_COMPLETED] == 0);
+        CHECK(stats.in.transfers == 0);
+        CHECK(stats.in.resubmits == 0);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("RX ring buffer overflows are counted") {
+        dev_config.data_cb = nullptr;
+        dev_config.rx_buffer_size = 4;
+        test_cp210x_open(&dev_config, &dev);
+        test_cp210x_complete(test_cp210x_submitted.back(), "abc");
+        test_cp210x_complete(test_cp210x_submitted.back(), "def");
+
+        REQUIRE(ESP_OK == cdc_acm_host_get_stats(dev, &stats));
+        CHECK(stats.in.transfers == 2);
+        CHECK(stats.in.bytes == 6);
+        CHECK(stats.in.overflows == 1);
+        CHECK(_hist_sum(stats) == 0);  // No data_cb
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Sent data is counted") {
+        dev_config.tx_xfer_count = 1;
+        test_cp210x_open(&dev_config, &dev);
+        test_cp210x_out_done_at_once = true;
+        const uint8_t data[] = "abcde";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_blocking(dev, data, 5, 100));  // Three chunks
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, data, 2, nullptr, nullptr));
+
+        REQUIRE(ESP_OK == cdc_acm_host_get_stats(dev, &stats));
+        CHECK(stats.out.transfers == 4);
+        CHECK(stats.out.bytes == 7);
+        test_cp210x_close(dev);
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "usb/cdc_acm_host.h"
+#include "common_test_fixtures.hpp"
+
+/**
+ * @brief Completions reported to tx_done()
+ */
+struct tx_done_t {
+    const uint8_t *data;
+    size_t data_len;
+    esp_err_t status;
+    void *tx_arg;
+};
+static std::vector<tx_done_t> done;
+
+static void tx_done(const uint8_t *data, size_t data_len, esp_err_t status, void *tx_arg)
+{
+    done.push_back({data, data_len, status, tx_arg});
+}
+
+static std::string _payload(const usb_transfer_t *transfer)
+{
+    return std::string((const char *)transfer->data_buffer, transfer->num_bytes);
+}
+
+SCENARIO("Asynchronous data sending")
+{
+    REQUIRE(ESP_OK == test_cdc_acm_host_install(nullptr));
+
+    cdc_acm_dev_hdl_t dev = nullptr;
+    cdc_acm_host_device_config_t dev_config = {
+        .connection_timeout_ms = 1000,
+        .out_buffer_size = 16,
+        .in_buffer_size = 64,
+        .event_cb = nullptr,
+        .data_cb = nullptr,
+        .user_arg = nullptr,
+        .tx_xfer_count = 2,
+    };
+    int arg;
+    done.clear();
+
+    SECTION("Fail to open CDC-ACM Device: invalid asynchronous transfer configuration") {
+        dev_config.tx_xfer_count = CDC_ACM_TX_XFERS_MAX + 1;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+
+        // Asynchronous transfers are OUT transfers: the device must not be read-only
+        dev_config.tx_xfer_count = 1;
+        dev_config.out_buffer_size = 0;
+        REQUIRE(ESP_ERR_INVALID_ARG == cdc_acm_host_open(test_cp210x_vid, test_cp210x_pid, test_cp210x_interface_index, &dev_config, &dev));
+    }
+
+    SECTION("Asynchronous sending is not available on a device opened without it") {
+        dev_config.tx_xfer_count = 0;
+        test_cp210x_open(&dev_config, &dev);
+        const uint8_t data[] = "abc";
+        CHECK(ESP_ERR_NOT_SUPPORTED == cdc_acm_host_data_tx_async(dev, data, 3, tx_done, nullptr));
+        CHECK(ESP_ERR_NOT_SUPPORTED == cdc_acm_host_data_tx_async_zero_copy(dev, data, 3, tx_done, nullptr));
+        CHECK(test_cp210x_submitted_out.empty());
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Invalid data is rejected") {
+        test_cp210x_open(&dev_config, &dev);
+        uint8_t data[17] = {0};
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_data_tx_async(dev, nullptr, 3, tx_done, nullptr));
+        CHECK(ESP_ERR_INVALID_ARG == cdc_acm_host_data_tx_async(dev, data, 0, tx_done, nullptr));
+        CHECK(ESP_ERR_INVALID_SIZE == cdc_acm_host_data_tx_async(dev, data, sizeof(data), tx_done, nullptr));
+        CHECK(ESP_ERR_INVALID_SIZE == cdc_acm_host_data_tx_async_zero_copy(dev, data, sizeof(data), tx_done, nullptr));
+        CHECK(test_cp210x_submitted_out.empty());
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Data is copied, test_cp210x_submitted_out at once and completed through the callback") {
+        test_cp210x_open(&dev_config, &dev);
+        uint8_t data[] = "abc";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, data, 3, tx_done, &arg));
+        REQUIRE(test_cp210x_submitted_out.size() == 1);
+        CHECK(test_cp210x_submitted_out[0]->data_buffer != data);
+        data[0] = 'x';  // The caller's buffer is free as soon as the function returns
+        CHECK(_payload(test_cp210x_submitted_out[0]) == "abc");
+        CHECK(done.empty());
+
+        test_cp210x_complete_out(test_cp210x_submitted_out[0]);
+        REQUIRE(done.size() == 1);
+        CHECK(done[0].data == data);
+        CHECK(done[0].data_len == 3);
+        CHECK(done[0].status == ESP_OK);
+        CHECK(done[0].tx_arg == &arg);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Several transfers are in flight in submission order, until none is free") {
+        test_cp210x_open(&dev_config, &dev);
+        const uint8_t a[] = "a", b[] = "b", c[] = "c";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, a, 1, tx_done, nullptr));
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, b, 1, nullptr, nullptr));
+        CHECK(ESP_ERR_NO_MEM == cdc_acm_host_data_tx_async(dev, c, 1, tx_done, nullptr));
+        REQUIRE(test_cp210x_submitted_out.size() == 2);
+        CHECK(test_cp210x_submitted_out[0] != test_cp210x_submitted_out[1]);
+        CHECK(_payload(test_cp210x_submitted_out[0]) == "a");
+        CHECK(_payload(test_cp210x_submitted_out[1]) == "b");
+
+        // A completed transfer is reused
+        test_cp210x_complete_out(test_cp210x_submitted_out[0]);
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, c, 1, tx_done, nullptr));
+        REQUIRE(test_cp210x_submitted_out.size() == 3);
+        CHECK(test_cp210x_submitted_out[2] == test_cp210x_submitted_out[0]);
+        CHECK(_payload(test_cp210x_submitted_out[2]) == "c");
+
+        // Completions without a callback are fine
+        test_cp210x_complete_out(test_cp210x_submitted_out[1]);
+        test_cp210x_complete_out(test_cp210x_submitted_out[2]);
+        REQUIRE(done.size() == 2);
+        CHECK(done[0].data == a);
+        CHECK(done[1].data == c);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Zero-copy transfers are sent from the caller's buffer") {
+        test_cp210x_open(&dev_config, &dev);
+        const uint8_t data[] = "zero";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async_zero_copy(dev, data, 4, tx_done, &arg));
+        REQUIRE(test_cp210x_submitted_out.size() == 1);
+        CHECK(test_cp210x_submitted_out[0]->data_buffer == data);
+        CHECK(test_cp210x_submitted_out[0]->num_bytes == 4);
+
+        test_cp210x_complete_out(test_cp210x_submitted_out[0]);
+        REQUIRE(done.size() == 1);
+        CHECK(done[0].data == data);
+        CHECK(done[0].status == ESP_OK);
+        CHECK(test_cp210x_submitted_out[0]->data_buffer != data);  // The transfer got its own buffer back
+
+        // The next copy goes into the transfer's own buffer
+        const uint8_t copy[] = "copy";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, copy, 4, tx_done, nullptr));
+        REQUIRE(test_cp210x_submitted_out.size() == 2);
+        CHECK(test_cp210x_submitted_out[1]->data_buffer != data);
+        CHECK(_payload(test_cp210x_submitted_out[1]) == "copy");
+        test_cp210x_complete_out(test_cp210x_submitted_out[1]);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Failed transfers are reported") {
+        test_cp210x_open(&dev_config, &dev);
+        const uint8_t data[] = "abc";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, data, 3, tx_done, nullptr));
+        test_cp210x_complete_out(test_cp210x_submitted_out[0], USB_TRANSFER_STATUS_STALL);
+        REQUIRE(done.size() == 1);
+        CHECK(done[0].status == ESP_ERR_INVALID_RESPONSE);
+
+        // A transfer that could not be test_cp210x_submitted_out is free again
+        test_cp210x_submit_ret = ESP_ERR_INVALID_STATE;
+        CHECK(ESP_ERR_INVALID_STATE == cdc_acm_host_data_tx_async_zero_copy(dev, data, 3, tx_done, nullptr));
+        CHECK(ESP_ERR_INVALID_STATE == cdc_acm_host_data_tx_async_zero_copy(dev, data, 3, tx_done, nullptr));
+        CHECK(ESP_ERR_INVALID_STATE == cdc_acm_host_data_tx_async_zero_copy(dev, data, 3, tx_done, nullptr));
+        test_cp210x_submit_ret = ESP_OK;
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, data, 3, tx_done, nullptr));
+        REQUIRE(test_cp210x_submitted_out.size() == 2);
+        CHECK(test_cp210x_submitted_out[1]->data_buffer != data);
+        test_cp210x_complete_out(test_cp210x_submitted_out[1]);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("The completion callback can submit the next data") {
+        test_cp210x_open(&dev_config, &dev);
+        static cdc_acm_dev_hdl_t chained_dev;
+        static const uint8_t next[] = "next";
+        chained_dev = dev;
+        const cdc_acm_tx_callback_t chain = [](const uint8_t *data, size_t data_len, esp_err_t status, void *tx_arg) {
+            tx_done(data, data_len, status, tx_arg);
+            REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(chained_dev, next, 4, tx_done, nullptr));
+        };
+
+        // With both transfers in flight, the completing one is already free in its callback
+        const uint8_t a[] = "a", b[] = "b";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, a, 1, chain, nullptr));
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async(dev, b, 1, tx_done, nullptr));
+        test_cp210x_complete_out(test_cp210x_submitted_out[0]);
+        REQUIRE(test_cp210x_submitted_out.size() == 3);
+        CHECK(test_cp210x_submitted_out[2] == test_cp210x_submitted_out[0]);
+        CHECK(_payload(test_cp210x_submitted_out[2]) == "next");
+        test_cp210x_complete_out(test_cp210x_submitted_out[1]);
+        test_cp210x_complete_out(test_cp210x_submitted_out[2]);
+        CHECK(done.size() == 3);
+        test_cp210x_close(dev);
+    }
+
+    SECTION("Close cancels transfers in flight without calling back") {
+        test_cp210x_open(&dev_config, &dev);
+        const uint8_t data[] = "abc";
+        REQUIRE(ESP_OK == cdc_acm_host_data_tx_async_zero_copy(dev, data, 3, tx_done, nullptr));
+        test_cp210x_close(dev, true);
+        CHECK(done.empty());
+    }
+
+    REQUIRE(ESP_OK == test_cdc_acm_host_uninstall());
+}
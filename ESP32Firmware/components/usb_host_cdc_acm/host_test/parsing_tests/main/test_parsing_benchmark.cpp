@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "usb/usb_helpers.h"
+
+#include "descriptors/cdc_descriptors.hpp"
+#include "descriptors/cypress_rfa.hpp"
+#include "descriptors/stm32_device.hpp"
+#include "benchmark/benchmark_summary.hpp"
+#include "cdc_host_descriptor_parsing.h"
+#include "usb/cdc_acm_host.h"
+
+/**
+ * @brief All bundled descriptors
+ */
+static const struct {
+    const char *name;
+    const uint8_t *dev_desc;
+    const uint8_t *cfg_desc;
+} devices[] = {
+    {"FTDI FS", ftdi_device_desc_fs_hs, ftdi_config_desc_fs},
+    {"FTDI HS", ftdi_device_desc_fs_hs, ftdi_config_desc_hs},
+    {"TTL232", ttl232_device_desc, ttl232_config_desc},
+    {"CP210x", cp210x_device_desc, cp210x_config_desc},
+    {"CH340", ch340_device_desc, ch340_config_desc},
+    {"PremiumCord FS", premium_cord_device_desc_fs, premium_cord_config_desc_fs},
+    {"PremiumCord HS", premium_cord_device_desc_hs, premium_cord_config_desc_hs},
+    {"i-tec FS", i_tec_device_desc_fs, i_tec_config_desc_fs},
+    {"i-tec HS", i_tec_device_desc_hs, i_tec_config_desc_hs},
+    {"AXAGON FS config 1", axagon_device_desc_fs_hs, axagon_config_desc_fs_1},
+    {"AXAGON FS config 2", axagon_device_desc_fs_hs, axagon_config_desc_fs_2},
+    {"AXAGON HS config 1", axagon_device_desc_fs_hs, axagon_config_desc_hs_1},
+    {"AXAGON HS config 2", axagon_device_desc_fs_hs, axagon_config_desc_hs_2},
+    {"SIM7070G FS", sim7070G_device_desc_fs_hs, sim7070G_config_desc_fs},
+    {"SIM7070G HS", sim7070G_device_desc_fs_hs, sim7070G_config_desc_hs},
+    {"BG96 FS", bg96_device_desc_fs_hs, bg96_config_desc_fs},
+    {"BG96 HS", bg96_device_desc_fs_hs, bg96_config_desc_hs},
+    {"SIM7000E FS", sim7000e_device_desc_fs_hs, sim7000e_config_desc_fs},
+    {"SIM7000E HS", sim7000e_device_desc_fs_hs, sim7000e_config_desc_hs},
+    {"SIM7600E FS", sim7600e_device_desc_fs_hs, sim7600e_config_desc_fs},
+    {"SIM7600E HS", sim7600e_device_desc_fs_hs, sim7600e_config_desc_hs},
+    {"SIM7080G FS", sim7080g_device_desc_fs_hs, sim7080g_config_desc_fs},
+    {"SIM7080G HS", sim7080g_device_desc_fs_hs, sim7080g_config_desc_hs},
+    {"SIMA7672E FS", sima7672e_device_desc_fs_hs, sima7672e_config_desc_fs},
+    {"SIMA7672E HS", sima7672e_device_desc_fs_hs, sima7672e_config_desc_hs},
+    {"Rapoo dongle", rapoo_device_desc, rapoo_config_desc},
+    {"CSR dongle FS", csr_device_desc_fs_hs, csr_config_desc_fs},
+    {"CSR dongle HS", csr_device_desc_fs_hs, csr_config_desc_hs},
+    {"TinyUSB composite", tusb_composite_device_desc, tusb_composite_config_desc},
+    {"TinyUSB console", tusb_console_device_desc, tusb_console_config_desc},
+    {"TinyUSB HID", tusb_hid_device_desc, tusb_hid_config_desc},
+    {"TinyUSB MIDI", tusb_midi_device_desc, tusb_midi_config_desc},
+    {"TinyUSB MSC", tusb_msc_device_desc, tusb_msc_config_desc},
+    {"TinyUSB NCM", tusb_ncm_device_desc, tusb_ncm_config_desc},
+    {"TinyUSB serial FS", tusb_serial_device_device_desc_fs_hs, tusb_serial_device_config_desc_fs},
+    {"TinyUSB serial HS", tusb_serial_device_device_desc_fs_hs, tusb_serial_device_config_desc_hs},
+    {"TinyUSB dual serial FS", tusb_serial_device_dual_device_desc_fs_hs, tusb_serial_device_dual_config_desc_fs},
+    {"TinyUSB dual serial HS", tusb_serial_device_dual_device_desc_fs_hs, tusb_serial_device_dual_config_desc_hs},
+    {"Cypress RFA", cypress_rfa::dev_desc, cypress_rfa::cfg_desc},
+    {"STM32 device", stm32_device::dev_desc, stm32_device::cfg_desc},
+};
+
+/**
+ * @brief Parse every interface of the Configuration descriptor, as opening each one would
+ *
+ * @return Number of interfaces that can be opened as CDC
+ */
+static int _parse_all_interfaces(const usb_device_desc_t *dev_desc, const usb_config_desc_t *cfg_desc)
+{
+    int parsed = 0;
+    for (int intf = 0; intf < cfg_desc->bNumInterfaces; intf++) {
+        cdc_parsed_info_t parsed_result;
+        if (cdc_parse_interface_descriptor(dev_desc, cfg_desc, intf, &parsed_result) == ESP_OK) {
+            parsed++;
+        }
+        free(parsed_result.func);
+    }
+    return parsed;
+}
+
+SCENARIO("Descriptor parsing benchmark", "[!benchmark]")
+{
+    for (const auto &device : devices) {
+        const usb_device_desc_t *dev_desc = (const usb_device_desc_t *)device.dev_desc;
+        const usb_config_desc_t *cfg_desc = (const usb_config_desc_t *)device.cfg_desc;
+        const std::string name = std::string("parse: ") + device.name;
+        benchmark_bytes()[name] = cfg_desc->wTotalLength;
+
+        BENCHMARK(name.c_str()) {
+            return _parse_all_interfaces(dev_desc, cfg_desc);
+        };
+    }
+}
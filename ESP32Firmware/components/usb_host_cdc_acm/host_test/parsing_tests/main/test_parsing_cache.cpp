@@ -0,0 +1,186 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "usb/usb_helpers.h"
+
+#include "descriptors/cdc_descriptors.hpp"
+#include "test_parsing_checker.hpp"
+#include "cdc_host_descriptor_parsing.h"
+#include "usb/cdc_acm_host.h"
+
+/**
+ * @brief Parse with the cache and check that the result is the same as uncached parsing
+ */
+static bool _parse_cached_and_compare(cdc_parse_cache_entry_t *cache, size_t cache_len,
+                                      const usb_device_desc_t *dev_desc, const usb_config_desc_t *cfg_desc, uint8_t intf_idx)
+{
+    cdc_parsed_info_t expected = {};
+    cdc_parsed_info_t parsed_result = {};
+    bool hit = false;
+    REQUIRE(ESP_OK == cdc_parse_interface_descriptor(dev_desc, cfg_desc, intf_idx, &expected));
+    REQUIRE(ESP_OK == cdc_parse_interface_descriptor_cached(cache, cache_len, dev_desc, cfg_desc, intf_idx, &parsed_result, &hit));
+
+    CHECK(parsed_result.notif_ep == expected.notif_ep);
+    CHECK(parsed_result.in_ep == expected.in_ep);
+    CHECK(parsed_result.out_ep == expected.out_ep);
+    CHECK(parsed_result.notif_intf == expected.notif_intf);
+    CHECK(parsed_result.data_intf == expected.data_intf);
+    REQUIRE(parsed_result.func_cnt == expected.func_cnt);
+    for (int i = 0; i < expected.func_cnt; i++) {
+        CHECK((*parsed_result.func)[i] == (*expected.func)[i]);
+    }
+    free(expected.func);
+    free(parsed_result.func);
+    return hit;
+}
+
+SCENARIO("Descriptor parsing cache", "[cache]")
+{
+    cdc_parse_cache_entry_t cache[2] = {};
+    const usb_device_desc_t *dev_desc = (const usb_device_desc_t *)tusb_serial_device_dual_device_desc_fs_hs;
+    const usb_config_desc_t *cfg_desc = (const usb_config_desc_t *)tusb_serial_device_dual_config_desc_fs;
+
+    GIVEN("Empty cache") {
+        SECTION("First parse misses, second one hits with the same result") {
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 2));
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 2));
+        }
+
+        SECTION("CDC non-compliant device hits too") {
+            const usb_device_desc_t *cp210x_dev = (const usb_device_desc_t *)cp210x_device_desc;
+            const usb_config_desc_t *cp210x_cfg = (const usb_config_desc_t *)cp210x_config_desc;
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, cp210x_dev, cp210x_cfg, 0));
+            CHECK(_parse_cached_and_compare(cache, 2, cp210x_dev, cp210x_cfg, 0));
+        }
+
+        SECTION("Failed parse is not cached") {
+            cdc_parsed_info_t parsed_result = {};
+            bool hit = true;
+            REQUIRE(ESP_ERR_NOT_FOUND == cdc_parse_interface_descriptor_cached(cache, 2, dev_desc, cfg_desc, 7, &parsed_result, &hit));
+            CHECK_FALSE(hit);
+            CHECK_FALSE(cache[0].valid);
+            CHECK_FALSE(cache[1].valid);
+        }
+
+        SECTION("Least recently used entry is replaced") {
+            const usb_device_desc_t *cp210x_dev = (const usb_device_desc_t *)cp210x_device_desc;
+            const usb_config_desc_t *cp210x_cfg = (const usb_config_desc_t *)cp210x_config_desc;
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 2));
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, cp210x_dev, cp210x_cfg, 0)); // Replaces interface 2
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+            CHECK(_parse_cached_and_compare(cache, 2, cp210x_dev, cp210x_cfg, 0));
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 2));
+        }
+    }
+
+    GIVEN("Cached interface of a device") {
+        CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+
+        SECTION("Another copy of the same descriptors hits") {
+            std::vector<uint8_t> cfg_copy(cfg_desc->wTotalLength);
+            memcpy(cfg_copy.data(), cfg_desc, cfg_copy.size());
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, (const usb_config_desc_t *)cfg_copy.data(), 0));
+        }
+
+        SECTION("Changed wTotalLength misses") {
+            std::vector<uint8_t> cfg_copy(cfg_desc->wTotalLength);
+            memcpy(cfg_copy.data(), cfg_desc, cfg_copy.size());
+            ((usb_config_desc_t *)cfg_copy.data())->wTotalLength -= 1; // Last descriptor of interface 2 is cut off, interface 0 is still complete
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, (const usb_config_desc_t *)cfg_copy.data(), 0));
+        }
+
+        SECTION("Changed descriptor that keeps the layout still hits") {
+            std::vector<uint8_t> cfg_copy(cfg_desc->wTotalLength);
+            memcpy(cfg_copy.data(), cfg_desc, cfg_copy.size());
+            cfg_copy[7] ^= 0x20; // bmAttributes: remote wakeup
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, (const usb_config_desc_t *)cfg_copy.data(), 0));
+        }
+
+        SECTION("Changed endpoint at a cached offset misses") {
+            cdc_parse_cache_entry_t *entry = cache[0].valid ? &cache[0] : &cache[1];
+            std::vector<uint8_t> cfg_copy(cfg_desc->wTotalLength);
+            memcpy(cfg_copy.data(), cfg_desc, cfg_copy.size());
+            usb_ep_desc_t *in_ep = (usb_ep_desc_t *)(cfg_copy.data() + entry->in_ep);
+            REQUIRE(USB_EP_DESC_GET_EP_DIR(in_ep));
+            in_ep->bEndpointAddress &= 0x7F; // IN becomes OUT, so the parse fails too
+            cdc_parsed_info_t parsed_result = {};
+            bool hit = true;
+            CHECK(ESP_ERR_NOT_FOUND == cdc_parse_interface_descriptor_cached(cache, 2, dev_desc, (const usb_config_desc_t *)cfg_copy.data(), 0, &parsed_result, &hit));
+            CHECK_FALSE(hit);
+            CHECK_FALSE(entry->valid);
+        }
+
+        SECTION("Different bcdDevice misses") {
+            usb_device_desc_t dev_copy;
+            memcpy(&dev_copy, dev_desc, sizeof(dev_copy));
+            dev_copy.bcdDevice++;
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, &dev_copy, cfg_desc, 0));
+        }
+
+        SECTION("Entry that does not match the descriptors is dropped") {
+            // Same key, but the layout points to another descriptor, as for a device that changed its descriptors
+            cdc_parse_cache_entry_t *entry = cache[0].valid ? &cache[0] : &cache[1];
+            entry->in_ep = entry->data_intf;
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+            CHECK(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+
+            entry = cache[0].valid ? &cache[0] : &cache[1];
+            entry->out_ep = cfg_desc->wTotalLength; // Out of the descriptor
+            CHECK_FALSE(_parse_cached_and_compare(cache, 2, dev_desc, cfg_desc, 0));
+        }
+    }
+}
+
+/**
+ * @brief Descriptors used for the parsing benchmark: CDC non-compliant, CDC compliant and a modem with many interfaces
+ */
+static const struct {
+    const char *name;
+    const uint8_t *dev_desc;
+    const uint8_t *cfg_desc;
+    uint8_t intf_idx;
+} bench_devices[] = {
+    {"CP210x", cp210x_device_desc, cp210x_config_desc, 0},
+    {"TinyUSB dual CDC", tusb_serial_device_dual_device_desc_fs_hs, tusb_serial_device_dual_config_desc_fs, 2},
+    {"SIM7600E", sim7600e_device_desc_fs_hs, sim7600e_config_desc_hs, 4},
+};
+
+SCENARIO("Descriptor parsing cache benchmark", "[cache][!benchmark]")
+{
+    for (const auto &device : bench_devices) {
+        const usb_device_desc_t *dev_desc = (const usb_device_desc_t *)device.dev_desc;
+        const usb_config_desc_t *cfg_desc = (const usb_config_desc_t *)device.cfg_desc;
+        cdc_parse_cache_entry_t cache[4] = {};
+        cdc_parsed_info_t parsed_result = {};
+        REQUIRE(ESP_OK == cdc_parse_interface_descriptor_cached(cache, 4, dev_desc, cfg_desc, device.intf_idx, &parsed_result, nullptr));
+        free(parsed_result.func);
+
+        BENCHMARK(std::string(device.name) + ": parse") {
+            cdc_parsed_info_t info;
+            esp_err_t ret = cdc_parse_interface_descriptor(dev_desc, cfg_desc, device.intf_idx, &info);
+            free(info.func);
+            return ret;
+        };
+
+        BENCHMARK(std::string(device.name) + ": cache hit") {
+            cdc_parsed_info_t info;
+            esp_err_t ret = cdc_parse_interface_descriptor_cached(cache, 4, dev_desc, cfg_desc, device.intf_idx, &info, nullptr);
+            free(info.func);
+            return ret;
+        };
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/queue.h>                  // For singly linked list
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"            // For mutexes and semaphores
+#include "freertos/queue.h"             // For queue of received transfers
+#include "freertos/stream_buffer.h"     // For RX ring buffer
+
+#include "usb/usb_host.h"               // For USB device handle and transfers
+#include "usb/cdc_acm_host_interface.h" // For CDC interface function table
+#include "usb/usb_types_cdc.h"          // For protocol and serial state
+
+// CDC-ACM check macros
+#define CDC_ACM_CHECK(cond, ret_val) ({                             \
+    if (!(cond)) {                                                  \
+        return (ret_val);                                           \
+    }                                                               \
+})
+
+#define CDC_ACM_CHECK_FROM_CRIT(cond, ret_val) ({                   \
+    if (!(cond)) {                                                  \
+        CDC_ACM_EXIT_CRITICAL();                                    \
+        return ret_val;                                             \
+    }                                                               \
+})
+
+typedef struct cdc_dev_s cdc_dev_t;
+struct cdc_dev_s {
+    cdc_acm_intf_t intf_func;             // CDC interface function table
+    usb_device_handle_t dev_hdl;          // USB device handle
+    void *cb_arg;                         // Common argument for user's callbacks (data IN and Notification)
+    struct {
+        usb_transfer_t *out_xfer;         // OUT data transfer
+        usb_transfer_t *in_xfers[CDC_ACM_IN_XFERS_MAX]; // IN data transfers, in submission order
+        uint8_t in_xfer_count;            // Number of IN data transfers, 0 for write-only devices
+        uint8_t in_next;                  // Index of the IN transfer to be delivered next
+        uint8_t in_done;                  // Bit mask of IN transfers completed but not yet delivered
+        bool in_stopped;                  // An IN transfer failed or was cancelled: stop delivering and resubmitting
+        cdc_acm_data_callback_t in_cb;    // User's callback for async (non-blocking) data IN
+        uint16_t in_mps;                  // IN endpoint Maximum Packet Size
+        size_t in_buf_len;                // Requested IN buffer size
+        size_t out_buf_len;               // Requested OUT buffer size
+        uint8_t *in_data_buffer_base[CDC_ACM_IN_XFERS_MAX]; // Pointers to IN data buffers in usb_transfer_t
+        const usb_intf_desc_t *intf_desc; // Pointer to data interface descriptor
+        SemaphoreHandle_t out_mux;        // OUT mutex
+        struct {
+            usb_transfer_t *xfers[CDC_ACM_IN_XFERS_MAX + CDC_ACM_RX_LOANS_MAX]; // All IN transfers of the device, owned here
+            uint8_t count;                // Number of transfers in the pool, 0 if received data goes to in_cb
+            uint16_t free;                // Bit mask of pool transfers ready to be submitted
+            uint16_t lent;                // Bit mask of pool transfers held by the application
+            uint8_t pending;              // Bit mask of IN transfer slots waiting for a free pool transfer
+            uint8_t refill_next;          // Slot to be refilled next, so that transfers are submitted in slot order
+            bool refilling;               // A task is submitting pool transfers to pending slots
+            QueueHandle_t filled;         // Received transfers in order, waiting for cdc_acm_host_rx_acquire()
+        } rx_loan;                        // RX buffer loans, used instead of in_cb if rx_loan_count > 0
+        struct {
+            StreamBufferHandle_t stream;  // Received bytes waiting for cdc_acm_host_data_rx_blocking()
+            size_t size;                  // Requested ring buffer size
+            size_t high_water;            // Most bytes ever waiting in the ring buffer
+            uint32_t overflows;           // Received transfers that did not fit completely
+            uint32_t dropped_bytes;       // Received bytes lost to overflows
+        } rx_buf;                         // RX ring buffer, used instead of in_cb if rx_buffer_size > 0. Written by the driver task only
+        struct {
+            usb_transfer_t *xfers[CDC_ACM_TX_XFERS_MAX]; // OUT transfers for asynchronous sending
+            uint8_t *data_buffer_base[CDC_ACM_TX_XFERS_MAX]; // Own data buffers of the transfers, replaced by the user's during zero-copy sending
+            struct {
+                cdc_acm_tx_callback_t cb;     // User's completion callback
+                void *arg;                    // Argument of the completion callback
+                const uint8_t *data;          // Data pointer passed by the user
+            } done[CDC_ACM_TX_XFERS_MAX];     // Completion of the transfer in flight
+            uint8_t count;                    // Number of asynchronous OUT transfers, 0 if not enabled
+            uint8_t free;                     // Bit mask of transfers not in flight
+            bool stopped;                     // Device is being closed: no completion callbacks
+        } tx_async;                           // Asynchronous OUT transfers, protected by the CDC-ACM spinlock
+    } data;
+
+    struct {
+        usb_transfer_t *xfer;             // IN notification transfer
+        size_t buf_len;                   // Requested notification buffer size
+        const usb_intf_desc_t *intf_desc; // Pointer to notification interface descriptor, can be NULL if there is no notification channel in the device
+        cdc_acm_host_dev_callback_t cb;   // User's callback for device events
+    } notif;                              // Structure with Notif pipe data
+
+    cdc_acm_host_stats_t stats;           // Statistics. This and the following are protected by the CDC-ACM spinlock
+    int64_t in_done_us[CDC_ACM_IN_XFERS_MAX]; // Completion time of each IN transfer slot
+    uint8_t in_done_timed;                // Bit mask of IN transfer slots completed, but not yet resubmitted
+
+    usb_transfer_t *ctrl_transfer;        // CTRL (endpoint 0) transfer
+    SemaphoreHandle_t ctrl_mux;           // CTRL mutex
+    cdc_acm_uart_state_t serial_state;    // Serial State
+    cdc_comm_protocol_t comm_protocol;
+    cdc_data_protocol_t data_protocol;
+    int cdc_func_desc_cnt;                // Number of CDC Functional descriptors in following array
+    const usb_standard_desc_t *(*cdc_func_desc)[]; // Pointer to array of pointers to const usb_standard_desc_t
+    SLIST_ENTRY(cdc_dev_s) list_entry;
+};
@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "usb/usb_types_cdc.h"
+#include "usb/usb_host.h"               // For USB Host suspend/resume API
+
+// For backward compatibility with IDF versions which do not have suspend/resume api
+#ifdef USB_HOST_LIB_EVENT_FLAGS_AUTO_SUSPEND
+#define CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+#endif
+
+typedef struct cdc_dev_s *cdc_acm_dev_hdl_t;
+
+#define CDC_ACM_IN_XFERS_MAX (4) // Maximum number of bulk IN transfers kept in flight per device
+#define CDC_ACM_RX_LOANS_MAX (8) // Maximum number of RX buffers a device can have besides those in flight
+#define CDC_ACM_TX_XFERS_MAX (4) // Maximum number of bulk OUT transfers for asynchronous sending per device
+#define CDC_ACM_STATS_HIST_BINS   (16) // Bins of the data_cb run time histogram: bin 0 is below 2 us, bin i from 2^i us, the last one open ended
+#define CDC_ACM_STATS_STATUS_MAX  (USB_TRANSFER_STATUS_SKIPPED + 1) // Number of usb_transfer_status_t values
+
+/**
+ * @brief CDC-ACM Device Event types to upper layer
+ */
+typedef enum {
+    CDC_ACM_HOST_ERROR,                             /**< An error occurred on the CDC-ACM device */
+    CDC_ACM_HOST_SERIAL_STATE,                      /**< Serial state of the CDC-ACM device has changed */
+    CDC_ACM_HOST_NETWORK_CONNECTION,                /**< CDC-ACM device network connection state has changed */
+    CDC_ACM_HOST_DEVICE_DISCONNECTED,               /**< CDC-ACM device has been disconnected */
+#ifdef CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+    CDC_ACM_HOST_DEVICE_SUSPENDED,                  /**< CDC-ACM device has been suspended */
+    CDC_ACM_HOST_DEVICE_RESUMED,                    /**< CDC-ACM device has been resumed */
+#endif // CDC_HOST_SUSPEND_RESUME_API_SUPPORTED
+    CDC_ACM_HOST_RX_DATA,                           /**< Data was added to the RX ring buffer (devices opened with rx_buffer_size only) */
+} cdc_acm_host_dev_event_t;
+
+/**
+ * @brief CDC-ACM Device Event data structure
+ */
+typedef struct {
+    cdc_acm_host_dev_event_t type;
+    union {
+        int error;                         //!< Error code from USB Host
+        cdc_acm_uart_state_t serial_state; //!< Serial (UART) state
+        bool network_connected;            //!< Network connection event
+        cdc_acm_dev_hdl_t cdc_hdl;         //!< Disconnection, suspend, resume and RX data events
+    } data;
+} cdc_acm_host_dev_event_data_t;
+
+/**
+ * @brief Data receive callback type
+ *
+ * @param[in] data     Pointer to received data
+ * @param[in] data_len Length of received data in bytes
+ * @param[in] user_arg User's argument passed to open function
+ * @return true        Received data was processed     -> Flush RX buffer
+ * @return false       Received data was NOT processed -> Append new data to the buffer
+ */
+typedef bool (*cdc_acm_data_callback_t)(const uint8_t *data, size_t data_len, void *user_arg);
+
+/**
+ * @brief Asynchronous send completion callback type
+ *
+ * Called from the CDC-ACM driver task, so it must not block. It can submit the next data.
+ *
+ * @param[in] data     Data pointer passed to cdc_acm_host_data_tx_async() or cdc_acm_host_data_tx_async_zero_copy()
+ * @param[in] data_len Length of the data in bytes
+ * @param[in] status   ESP_OK if all data was sent, ESP_ERR_INVALID_RESPONSE if the transfer failed or was cancelled
+ * @param[in] tx_arg   Argument passed with the data
+ */
+typedef void (*cdc_acm_tx_callback_t)(const uint8_t *data, size_t data_len, esp_err_t status, void *tx_arg);
+
+/**
+ * @brief Device event callback type
+ *
+ * @param[in] event    Event structure
+ * @param[in] user_ctx User's context passed to open function
+ */
+typedef void (*cdc_acm_host_dev_callback_t)(const cdc_acm_host_dev_event_data_t *event, void *user_ctx);
+
+/**
+ * @brief Configuration structure of CDC-ACM device
+ */
+typedef struct {
+    uint32_t connection_timeout_ms;       /**< Timeout for USB device connection in [ms] */
+    size_t out_buffer_size;               /**< Maximum size of USB bulk out transfer, set to 0 for read-only devices. Larger transfers will be split into multiple transfers */
+    size_t in_buffer_size;                /**< Maximum size of USB bulk in transfer. If set to 0, the MPS of the IN endpoint will be used */
+    cdc_acm_host_dev_callback_t event_cb; /**< Device's event callback function. Can be NULL */
+    cdc_acm_data_callback_t data_cb;      /**< Device's data RX callback function. Can be NULL for write-only devices */
+    void *user_arg;                       /**< User's argument that will be passed to the callbacks */
+    uint8_t in_xfer_count;                /**< Number of bulk IN transfers kept in flight, up to CDC_ACM_IN_XFERS_MAX. 0 is the same as 1.
+                                               With more than one, the endpoint is still polled while data_cb runs; data is delivered in order,
+                                               but data_cb must return true (appending to the RX buffer needs a single transfer) */
+    uint8_t rx_loan_count;                /**< Number of RX buffers, up to CDC_ACM_RX_LOANS_MAX, in addition to the in_xfer_count buffers in flight.
+                                               0 delivers received data to data_cb. Otherwise data_cb must be NULL: filled buffers are queued in order and
+                                               lent to the application with cdc_acm_host_rx_acquire() until it calls cdc_acm_host_rx_release() */
+    size_t rx_buffer_size;                /**< Size of the RX ring buffer in bytes. 0 delivers received data to data_cb. Otherwise data_cb must be NULL
+                                               and rx_loan_count 0: received data is only copied into the ring buffer in the driver task and read
+                                               with cdc_acm_host_data_rx_blocking(). event_cb gets CDC_ACM_HOST_RX_DATA whenever data is added to the ring buffer */
+    uint8_t tx_xfer_count;                /**< Number of bulk OUT transfers, up to CDC_ACM_TX_XFERS_MAX, for cdc_acm_host_data_tx_async().
+                                               0 disables asynchronous sending. Each transfer has its own out_buffer_size buffer */
+} cdc_acm_host_device_config_t;
+
+/**
+ * @brief RX ring buffer statistics
+ */
+typedef struct {
+    size_t size;                          /**< Size of the ring buffer in bytes */
+    size_t high_water;                    /**< Most bytes ever waiting in the ring buffer */
+    uint32_t overflows;                   /**< Received transfers that did not fit in the ring buffer completely */
+    uint32_t dropped_bytes;               /**< Received bytes lost to overflows */
+} cdc_acm_host_rx_buffer_stats_t;
+
+/**
+ * @brief Device statistics
+ *
+ * Counted since the device was opened
+ */
+typedef struct {
+    struct {
+        uint64_t bytes;                   /**< Received data bytes */
+        uint32_t transfers;               /**< Completed bulk IN transfers, empty ones included */
+        uint32_t overflows;               /**< Received data dropped by the driver: full IN buffer or RX ring buffer */
+        uint32_t serial_overruns;         /**< SERIAL_STATE notifications from the device with bOverRun set */
+        uint32_t resubmits;               /**< Bulk IN transfers submitted again after completion */
+        uint32_t resubmit_gap_max_us;     /**< Longest time from completion to resubmission of a bulk IN transfer, in [us] */
+        uint64_t resubmit_gap_total_us;   /**< Sum of those times, divide by resubmits for the average */
+        uint32_t data_cb_max_us;          /**< Longest data_cb run time in [us] */
+        uint32_t data_cb_hist[CDC_ACM_STATS_HIST_BINS]; /**< data_cb calls by run time, see CDC_ACM_STATS_HIST_BINS */
+    } in;
+    struct {
+        uint64_t bytes;                   /**< Sent data bytes */
+        uint32_t transfers;               /**< Completed bulk OUT transfers */
+    } out;
+    uint32_t errors[CDC_ACM_STATS_STATUS_MAX]; /**< Failed bulk and notification transfers by usb_transfer_status_t. Cancelled ones included */
+} cdc_acm_host_stats_t;
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "usb/usb_types_ch9.h"
+
+typedef const usb_standard_desc_t *cdc_func_array_t[]; // Array of pointers to const usb_standard_desc_t
+
+typedef struct {
+    const usb_ep_desc_t *notif_ep;
+    const usb_ep_desc_t *in_ep;
+    const usb_ep_desc_t *out_ep;
+    const usb_intf_desc_t *notif_intf;
+    const usb_intf_desc_t *data_intf;
+    cdc_func_array_t *func;
+    int func_cnt;
+} cdc_parsed_info_t;
+
+#define CDC_PARSE_CACHE_FUNC_MAX (8) // Functional descriptors a cache entry can hold, interfaces with more are not cached
+
+/**
+ * @brief Cached layout of one parsed interface
+ *
+ * Descriptors are stored as offsets into the Configuration descriptor, so the layout stays valid for another copy
+ * of the same descriptor, e.g. after the device is plugged in again. Offset 0 means 'not present'.
+ */
+typedef struct {
+    bool valid;
+    uint32_t last_use;                    // Age for replacement, larger is more recent
+    uint16_t vid;                         // Key: idVendor, idProduct, bcdDevice, interface index
+    uint16_t pid;
+    uint16_t bcd_device;
+    uint8_t intf_idx;
+    uint16_t total_len;                   // Key: wTotalLength
+    uint16_t notif_ep;
+    uint16_t in_ep;
+    uint16_t out_ep;
+    uint16_t notif_intf;
+    uint16_t data_intf;
+    uint8_t func_cnt;
+    uint16_t func[CDC_PARSE_CACHE_FUNC_MAX];
+} cdc_parse_cache_entry_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Parse CDC interface descriptor
+ *
+ * #. Check if the required interface exists
+ * #. Parse the interface descriptor
+ * #. Check if the device is CDC compliant
+ * #. For CDC compliant devices also parse second interface descriptor and functional descriptors
+ *
+ * @param[in] device_desc Pointer to Device descriptor
+ * @param[in] config_desc Pointer do Configuration descriptor
+ * @param[in] intf_idx    Index of the required interface
+ * @param[out] info_ret   Array of parsed information, see cdc_parsed_info_t
+ * @return
+ *     - ESP_OK:            Success
+ *     - ESP_ERR_NOT_FOUND: Interfaces and endpoints NOT found
+ */
+esp_err_t cdc_parse_interface_descriptor(const usb_device_desc_t *device_desc, const usb_config_desc_t *config_desc, uint8_t intf_idx, cdc_parsed_info_t *info_ret);
+
+/**
+ * @brief Parse CDC interface descriptor, reusing the layout of a previous parse of the same descriptors
+ *
+ * Same as cdc_parse_interface_descriptor(), but an entry of the cache that matches the device's VID, PID, bcdDevice,
+ * the interface index and wTotalLength is used instead of walking the descriptors again.
+ * The cached descriptors are checked in place before use (descriptor type, endpoint transfer type and direction,
+ * interface number); if they do not match, the entry is dropped and the interface is parsed. Successful parses
+ * are added to the cache, replacing the least recently used entry.
+ *
+ * @note The cache is not protected: the caller must serialize the calls that share it
+ * @param[inout] cache     Cache entries, zero-initialized before first use
+ * @param[in]    cache_len Number of cache entries
+ * @param[in]  device_desc Pointer to Device descriptor
+ * @param[in]  config_desc Pointer do Configuration descriptor
+ * @param[in]  intf_idx    Index of the required interface
+ * @param[out] info_ret    Array of parsed information, see cdc_parsed_info_t
+ * @param[out] cache_hit   Optional, set to true if the cache was used
+ * @return Same as cdc_parse_interface_descriptor()
+ */
+esp_err_t cdc_parse_interface_descriptor_cached(cdc_parse_cache_entry_t *cache, size_t cache_len,
+                                                const usb_device_desc_t *device_desc, const usb_config_desc_t *config_desc,
+                                                uint8_t intf_idx, cdc_parsed_info_t *info_ret, bool *cache_hit);
+
+/**
+ * @brief Print CDC specific descriptor in human readable form
+ *
+ * This is a callback function that is called from USB Host library,
+ * when it wants to print full configuration descriptor to stdout.
+ *
+ * @param[in] _desc CDC specific descriptor
+ */
+void cdc_print_desc(const usb_standard_desc_t *_desc);
+
+#ifdef __cplusplus
+}
+#endif
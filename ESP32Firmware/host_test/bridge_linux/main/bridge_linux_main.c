@@ -0,0 +1,412 @@
+/*
+ * GasTag Bridge on the Linux Target
+ *
+ * Runs the bridge's USB side natively, with no hardware: the CDC-ACM API
+ * comes from the socket backend (host_test/components/cdc_acm_host_linux),
+ * devices are opened and closed by the bridge state machine, and their
+ * bytes take the firmware's own USB RX path (src/usb_rx.c: handle_rx,
+ * line framing, the line ring). A forwarding task stands in for the BLE
+ * notify task: it takes each line as the bridge does
+ * (analyzer_channel_take) and encodes the readings it would send, with
+ * no BLE stack behind it.
+ *
+ * When a device goes away, one BRIDGE_CHANNEL_REPORT line gives what its
+ * session went through, for soak tests and throughput runs:
+ *
+ *   BRIDGE_CHANNEL_REPORT channel=0 bytes=... lines=... readings=...
+ *       parse_failures=... line_overflows=... first_line_ms=...
+ *       duration_ms=... kB_per_s=...
+ *
+ * With GASTAG_REPLAY set, no devices are taken: the trace file (rx_trace.h,
+ * captured on a bridge) is fed chunk by chunk through the same RX path
+ * with usb_rx_replay(), then one BRIDGE_REPLAY_REPORT line sums it up and
+ * the app exits. Each chunk waits for the forwarding task to take its
+ * lines, so a replay never drops lines and its output only depends on
+ * the trace.
+ *
+ * Environment:
+ *   GASTAG_CDC_SOCKET       Socket devices connect to (tools/cdc_feed.py)
+ *   GASTAG_EXIT_AFTER       Exit after this many device sessions; 0 runs forever
+ *   GASTAG_REPLAY           Trace file to replay instead of taking devices
+ *   GASTAG_REPLAY_REALTIME  1 keeps the trace's timing; otherwise as fast as possible
+ *   GASTAG_LINE_ECHO        1 prints every forwarded line as "LINE <channel> <text>"
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "usb/cdc_acm_host.h"
+#include "usb/cdc_acm_host_linux.h"
+#include "analyzer_channel.h"
+#include "bridge_state.h"
+#include "line_ring.h"
+#include "reading_filter.h"
+#include "reading_format.h"
+#include "rx_trace.h"
+#include "usb_rx.h"
+
+static const char *TAG = "bridge_linux";
+
+#define BRIDGE_EVENT_QUEUE_DEPTH  16
+#define BRIDGE_TASK_STACK         8192
+#define BRIDGE_TASK_PRIORITY      3
+#define FORWARD_TASK_STACK        8192
+#define FORWARD_TASK_PRIORITY     4     // Where the BLE notify task runs
+#define USB_INTERFACE_INDEX       0
+#define DRAIN_TIMEOUT_MS          1000  // Wait for queued lines before reporting a closed device
+#define REPLAY_TASK_STACK         8192
+#define REPLAY_TASK_PRIORITY      3     // Below the forwarding task, like the bridge task
+
+_Static_assert(BRIDGE_DEVICE_MAX == USB_RX_DEVICE_MAX, "Every device slot needs a channel");
+
+static QueueHandle_t bridge_queue = NULL;
+static TaskHandle_t forward_task_handle = NULL;
+static line_ring_t line_ring;
+static bool line_echo = false;
+static const char *replay_path = NULL;
+
+// Written by the forwarding task, read by the bridge task for the reports
+static analyzer_channel_latest_t channel_latest[ANALYZER_CHANNEL_MAX];
+static volatile uint32_t readings_sent[ANALYZER_CHANNEL_MAX];
+
+// Per device session, owned by the bridge task
+typedef struct {
+    cdc_acm_dev_hdl_t dev;
+    int64_t attach_us;
+    int64_t first_line_us;
+    analyzer_stream_stats_t stream_start;
+    uint32_t lines_start;
+    uint32_t parse_failures_start;
+    uint32_t readings_start;
+    uint32_t overflows_start;
+} session_t;
+
+static session_t sessions[BRIDGE_DEVICE_MAX];
+
+static void post_event(const bridge_event_t *event) {
+    if (bridge_queue == NULL || xQueueSend(bridge_queue, event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Bridge event %d dropped", event->type);
+    }
+}
+
+static void post_device_event(bridge_event_type_t type, uint8_t device, uint32_t arg) {
+    bridge_event_t event = { .type = type, .device = device, .time_us = esp_timer_get_time(), .arg = arg };
+    post_event(&event);
+}
+
+// ============== USB RX HOOKS ==============
+static void usb_rx_lines(uint8_t id, size_t lines, bool first, void *ctx) {
+    if (first && replay_path == NULL) {
+        post_device_event(BRIDGE_EV_FIRST_LINE, id, 0);
+    }
+    xTaskNotifyGive(forward_task_handle);
+}
+
+// ============== CDC CALLBACKS ==============
+// Runs in the backend's driver task, like the USB driver task on the bridge
+static void handle_event(const cdc_acm_host_dev_event_data_t *event, void *user_ctx) {
+    const analyzer_channel_t *channel = (const analyzer_channel_t *)user_ctx;
+
+    switch (event->type) {
+        case CDC_ACM_HOST_RX_DATA:
+            usb_rx_notify();
+            break;
+        case CDC_ACM_HOST_DEVICE_DISCONNECTED:
+            post_device_event(BRIDGE_EV_USB_DETACHED, channel->id, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+static void new_device_cb(usb_device_handle_t usb_dev) {
+    const usb_device_desc_t *desc;
+    usb_device_info_t info;
+    usb_host_get_device_descriptor(usb_dev, &desc);
+    usb_host_device_info(usb_dev, &info);
+    bridge_event_t event = {
+        .type = BRIDGE_EV_USB_ATTACHED,
+        .time_us = esp_timer_get_time(),
+        .arg = ((uint32_t)desc->idVendor << 16) | desc->idProduct,
+        .address = info.dev_addr,
+    };
+    post_event(&event);
+}
+
+// ============== FORWARDING TASK ==============
+// Encoded as the bridge would send it; nothing is sent
+static void forward_reading(uint8_t id, uint32_t seq, const gas_reading_t *reading, void *ctx) {
+    uint8_t packet[READING_FORMAT_SIZE];
+    reading_format_encode(reading, packet);
+    readings_sent[id]++;
+}
+
+// The BLE notify task's line handling, minus the BLE stack
+static void forward_task(void *arg) {
+    reading_filter_config_t filter_config;
+    reading_filter_default_config(&filter_config);
+    for (int id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+        analyzer_channel_latest_init(&channel_latest[id], &filter_config);
+    }
+    const analyzer_channel_hooks_t hooks = {
+        .send_reading = forward_reading,
+    };
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        const line_ring_slot_t *slot;
+        while ((slot = line_ring_peek(&line_ring)) != NULL) {
+            uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            analyzer_channel_take(channel_latest, slot, now_ms, &hooks);
+            if (line_echo) {
+                printf("LINE %d %s\n", slot->channel, slot->text);
+            }
+            line_ring_pop(&line_ring);
+        }
+    }
+}
+
+// Let the forwarding task take what is still queued
+static void drain_lines(void) {
+    for (int waited = 0; line_ring_peek(&line_ring) != NULL && waited < DRAIN_TIMEOUT_MS; waited++) {
+        xTaskNotifyGive(forward_task_handle);
+        vTaskDelay(pdMS_TO_TICKS(1) > 0 ? pdMS_TO_TICKS(1) : 1);
+    }
+}
+
+// ============== BRIDGE TASK ==============
+static bool open_device(uint8_t id, const bridge_device_t *dev) {
+    session_t *session = &sessions[id];
+    usb_rx_arm(id);
+
+    cdc_acm_host_device_config_t dev_config = {
+        .event_cb = handle_event,
+    };
+    usb_rx_device_config(id, &dev_config);
+    esp_err_t err = cdc_acm_host_open_by_address(dev->address, USB_INTERFACE_INDEX, &dev_config, &session->dev);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open VID=0x%04X PID=0x%04X: %s", dev->vid, dev->pid, esp_err_to_name(err));
+        usb_rx_disarm(id);
+        return false;
+    }
+
+    line_ring_stats_t ring;
+    line_ring_get_stats(&line_ring, &ring);
+    session->attach_us = esp_timer_get_time();
+    session->first_line_us = 0;
+    session->stream_start = usb_rx_channel(id)->stream.stats;
+    session->lines_start = channel_latest[id].lines;
+    session->parse_failures_start = channel_latest[id].parse_failures;
+    session->readings_start = readings_sent[id];
+    session->overflows_start = ring.overflows;
+    usb_rx_attach(id, session->dev);
+
+    // Same setup as the bridge: 115200 8N1 and DTR
+    cdc_acm_line_coding_t line_coding = {
+        .dwDTERate = 115200,
+        .bCharFormat = 0,
+        .bParityType = 0,
+        .bDataBits = 8,
+    };
+    cdc_acm_host_line_coding_set(session->dev, &line_coding);
+    cdc_acm_host_set_control_line_state(session->dev, true, false);
+    ESP_LOGI(TAG, "Channel %d: VID=0x%04X PID=0x%04X open", id, dev->vid, dev->pid);
+    return true;
+}
+
+static bool close_device(uint8_t id) {
+    session_t *session = &sessions[id];
+    if (session->dev == NULL) {
+        return false;
+    }
+    cdc_acm_host_stats_t usb;
+    cdc_acm_host_get_stats(session->dev, &usb);
+    usb_rx_close(id);
+    session->dev = NULL;
+
+    drain_lines();
+
+    line_ring_stats_t ring;
+    line_ring_get_stats(&line_ring, &ring);
+    int64_t first_rx_us = usb_rx_first_rx_time_us(id);
+    int64_t start_us = (session->first_line_us != 0) ? first_rx_us : session->attach_us;
+    uint64_t duration_us = (uint64_t)(esp_timer_get_time() - start_us);
+    uint64_t kb_per_s_x10 = duration_us > 0 ? usb.in.bytes * 10000 / duration_us : 0;
+    printf("BRIDGE_CHANNEL_REPORT channel=%d bytes=%" PRIu64 " lines=%" PRIu32 " readings=%" PRIu32
+           " parse_failures=%" PRIu32 " line_overflows=%" PRIu32 " framing_errors=%" PRIu32
+           " first_line_ms=%" PRId64 " duration_ms=%" PRIu64 " kB_per_s=%" PRIu64 ".%" PRIu64 "\n",
+           id, usb.in.bytes,
+           channel_latest[id].lines - session->lines_start,
+           readings_sent[id] - session->readings_start,
+           channel_latest[id].parse_failures - session->parse_failures_start,
+           ring.overflows - session->overflows_start,
+           usb_rx_channel(id)->stream.stats.framing_errors - session->stream_start.framing_errors,
+           session->first_line_us != 0 ? (session->first_line_us - session->attach_us) / 1000 : -1,
+           duration_us / 1000, kb_per_s_x10 / 10, kb_per_s_x10 % 10);
+    fflush(stdout);
+    return true;
+}
+
+static void bridge_task(void *arg) {
+    const char *exit_after_env = getenv("GASTAG_EXIT_AFTER");
+    uint32_t exit_after = exit_after_env != NULL ? (uint32_t)strtoul(exit_after_env, NULL, 0) : 0;
+    uint32_t closed = 0;
+    bridge_state_t state;
+    bridge_state_init(&state);
+
+    while (true) {
+        bridge_event_t event;
+        xQueueReceive(bridge_queue, &event, portMAX_DELAY);
+
+        uint32_t actions = bridge_state_handle(&state, &event);
+        uint8_t id = state.current;
+        if (event.type == BRIDGE_EV_USB_ATTACHED && actions == 0) {
+            ESP_LOGW(TAG, "USB device VID=0x%04X PID=0x%04X ignored: no free channel or already open",
+                     (uint16_t)(event.arg >> 16), (uint16_t)event.arg);
+        }
+        if ((actions & BRIDGE_ACTION_CLOSE_DEVICE) && close_device(id)) {
+            closed++;
+        }
+        if (actions & BRIDGE_ACTION_OPEN_DEVICE) {
+            bool opened = open_device(id, &state.devices[id]);
+            bridge_event_t result = {
+                .type = opened ? BRIDGE_EV_USB_OPENED : BRIDGE_EV_USB_OPEN_FAILED,
+                .device = id,
+                .time_us = esp_timer_get_time(),
+            };
+            bridge_state_handle(&state, &result);
+        }
+        if (event.type == BRIDGE_EV_FIRST_LINE && event.device < BRIDGE_DEVICE_MAX) {
+            sessions[event.device].first_line_us = event.time_us;
+        }
+        if (exit_after > 0 && closed >= exit_after) {
+            ESP_LOGI(TAG, "%" PRIu32 " device sessions done", closed);
+            fflush(stdout);
+            exit(0);
+        }
+    }
+}
+
+// ============== REPLAY TASK ==============
+static uint8_t *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    uint8_t *buf = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long size = ftell(f);
+        buf = size >= 0 ? malloc(size > 0 ? (size_t)size : 1) : NULL;
+        rewind(f);
+        if (buf != NULL && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+            free(buf);
+            buf = NULL;
+        }
+        *len = (size_t)size;
+    }
+    fclose(f);
+    return buf;
+}
+
+static void replay_task(void *arg) {
+    const char *realtime_env = getenv("GASTAG_REPLAY_REALTIME");
+    bool realtime = realtime_env != NULL && strcmp(realtime_env, "1") == 0;
+    size_t len = 0;
+    uint8_t *trace = read_file(replay_path, &len);
+    rx_trace_reader_t reader;
+    if (trace == NULL || !rx_trace_reader_init(&reader, trace, len)) {
+        ESP_LOGE(TAG, "%s is not a readable RX trace", replay_path);
+        exit(1);
+    }
+
+    uint32_t records = 0;
+    uint32_t skipped = 0;
+    uint64_t bytes = 0;
+    uint64_t trace_us = 0;
+    int64_t start_us = esp_timer_get_time();
+    rx_trace_record_t record;
+    while (rx_trace_next(&reader, &record)) {
+        trace_us += record.delta_us;
+        if (realtime) {
+            int64_t ahead_us = start_us + (int64_t)trace_us - esp_timer_get_time();
+            if (ahead_us >= 1000) {
+                vTaskDelay(pdMS_TO_TICKS(ahead_us / 1000));
+            }
+        }
+        if (!usb_rx_replay(&record)) {
+            skipped++;
+            continue;
+        }
+        records++;
+        bytes += record.len;
+        drain_lines();
+    }
+    drain_lines();
+    int64_t duration_us = esp_timer_get_time() - start_us;
+    if (reader.truncated) {
+        ESP_LOGW(TAG, "Trace ends inside a record");
+    }
+
+    uint32_t lines = 0, readings = 0, parse_failures = 0, framing_errors = 0;
+    for (int id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+        lines += channel_latest[id].lines;
+        readings += readings_sent[id];
+        parse_failures += channel_latest[id].parse_failures;
+        framing_errors += usb_rx_channel(id)->stream.stats.framing_errors;
+    }
+    line_ring_stats_t ring;
+    line_ring_get_stats(&line_ring, &ring);
+    uint64_t kb_per_s_x10 = duration_us > 0 ? bytes * 10000 / (uint64_t)duration_us : 0;
+    printf("BRIDGE_REPLAY_REPORT records=%" PRIu32 " skipped=%" PRIu32 " bytes=%" PRIu64 " lines=%" PRIu32
+           " readings=%" PRIu32 " parse_failures=%" PRIu32 " line_overflows=%" PRIu32 " framing_errors=%" PRIu32
+           " trace_ms=%" PRIu64 " duration_ms=%" PRId64 " kB_per_s=%" PRIu64 ".%" PRIu64 "\n",
+           records, skipped, bytes, lines, readings, parse_failures, ring.overflows, framing_errors,
+           trace_us / 1000, duration_us / 1000, kb_per_s_x10 / 10, kb_per_s_x10 % 10);
+    fflush(stdout);
+    free(trace);
+    exit(reader.truncated ? 1 : 0);
+}
+
+// ============== MAIN ==============
+void app_main(void) {
+    const char *line_echo_env = getenv("GASTAG_LINE_ECHO");
+    line_echo = line_echo_env != NULL && strcmp(line_echo_env, "1") == 0;
+    replay_path = getenv("GASTAG_REPLAY");
+
+    bridge_queue = xQueueCreate(BRIDGE_EVENT_QUEUE_DEPTH, sizeof(bridge_event_t));
+    line_ring_init(&line_ring);
+    xTaskCreate(forward_task, "forward", FORWARD_TASK_STACK, NULL, FORWARD_TASK_PRIORITY, &forward_task_handle);
+
+    const usb_rx_hooks_t usb_rx_hooks = {
+        .lines = usb_rx_lines,
+    };
+    ESP_ERROR_CHECK(usb_rx_start(&line_ring, &usb_rx_hooks));
+
+    if (replay_path != NULL) {
+        xTaskCreate(replay_task, "replay", REPLAY_TASK_STACK, NULL, REPLAY_TASK_PRIORITY, NULL);
+        ESP_LOGI(TAG, "=== GasTag Bridge (linux) replaying %s ===", replay_path);
+        return;
+    }
+
+    const cdc_acm_host_linux_config_t linux_config = {
+        .socket_path = getenv("GASTAG_CDC_SOCKET"),
+    };
+    ESP_ERROR_CHECK(cdc_acm_host_linux_configure(&linux_config));
+    const cdc_acm_host_driver_config_t driver_config = {
+        .driver_task_stack_size = 8192,
+        .driver_task_priority = 10,
+        .xCoreID = 0,
+        .new_dev_cb = new_device_cb,
+    };
+    ESP_ERROR_CHECK(cdc_acm_host_install(&driver_config));
+    xTaskCreate(bridge_task, "bridge", BRIDGE_TASK_STACK, NULL, BRIDGE_TASK_PRIORITY, NULL);
+
+    ESP_LOGI(TAG, "=== GasTag Bridge (linux) ready ===");
+}
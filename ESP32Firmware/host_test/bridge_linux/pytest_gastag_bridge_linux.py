@@ -0,0 +1,27 @@
+import os
+import subprocess
+import sys
+
+import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
+
+FEEDER = os.path.join(os.path.dirname(__file__), '..', '..', 'tools', 'cdc_feed.py')
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_gastag_bridge_linux(dut: Dut) -> None:
+    dut.expect_exact('GasTag Bridge (linux) ready', timeout=10)
+
+    # 5 warm-up lines + 600 readings at the analyzer's line rate: every line
+    # must come through the USB RX path, none dropped
+    feed = [sys.executable, FEEDER, '--readings', '600', '--baud', '115200']
+    report = r'BRIDGE_CHANNEL_REPORT channel=\d bytes=44170 lines=605 readings=\d+ parse_failures=0 line_overflows=0 '
+    subprocess.run(feed, check=True, timeout=30)
+    dut.expect(report, timeout=10)
+
+    # Two analyzers at once, on separate channels
+    subprocess.run(feed + ['--devices', '2'], check=True, timeout=30)
+    dut.expect(report, timeout=10)
+    dut.expect(report, timeout=10)
@@ -0,0 +1,683 @@
+/*
+ * Linux CDC-ACM Backend Implementation
+ *
+ * The driver task owns the listening socket and the device table. It
+ * accepts new connections, reads every open device and notices hang-ups
+ * once per CDC_ACM_HOST_LINUX_POLL_MS, with driver_mutex held. That mutex
+ * is recursive so callbacks, which run inside the pass, can still call the
+ * API. The RX ring is a stream buffer with the driver task as its only
+ * writer, so cdc_acm_host_data_rx_blocking() reads it without the mutex.
+ */
+
+#include "usb/cdc_acm_host.h"
+#include "usb/cdc_acm_host_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/stream_buffer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "cdc_acm_linux";
+
+#define CDC_ACM_LINUX_NEW_DEV    BIT0  // A device connected
+#define CDC_ACM_LINUX_TEARDOWN   BIT1  // The driver task has stopped
+#define CDC_ACM_LINUX_READS_MAX  16    // Reads per device and pass, for devices without an RX ring
+#define CDC_ACM_LINUX_IN_MPS     64    // IN buffer size when the configuration asks for the MPS
+
+// ============== TYPES ==============
+typedef struct {
+    int fd;                                 // Connected socket, -1 once the peer hung up
+    bool hung_up;                           // Peer hung up, reported once the RX ring is drained
+    uint8_t slot;                           // Index in the device table
+    bool open;                              // Opened with cdc_acm_host_open()
+    usb_device_desc_t desc;                 // What new_dev_cb and the open see
+    cdc_acm_host_device_config_t config;
+    uint8_t *in_buf;                        // Like the bulk IN transfer buffer
+    size_t in_len;                          // Bytes kept in in_buf after data_cb returned false
+    StreamBufferHandle_t rx_stream;         // RX ring, devices opened with rx_buffer_size only
+    cdc_acm_host_rx_buffer_stats_t rx_stats;
+    cdc_acm_host_stats_t stats;
+    cdc_acm_line_coding_t line_coding;
+    bool dtr;
+    bool rts;
+} linux_dev_t;
+
+// ============== STATE ==============
+static cdc_acm_host_linux_config_t linux_config = {
+    .vid = CDC_ACM_HOST_LINUX_VID_DEFAULT,
+    .pid = CDC_ACM_HOST_LINUX_PID_DEFAULT,
+};
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)] = CDC_ACM_HOST_LINUX_SOCKET_DEFAULT;
+
+static bool installed = false;
+static volatile bool stopping = false;
+static int listen_fd = -1;
+static SemaphoreHandle_t driver_mutex = NULL;      // Recursive; guards the device table
+static EventGroupHandle_t driver_events = NULL;
+static cdc_acm_new_dev_callback_t new_dev_cb = NULL;
+static linux_dev_t *devs[CDC_ACM_HOST_LINUX_DEV_MAX];
+
+#define LOCK()    xSemaphoreTakeRecursive(driver_mutex, portMAX_DELAY)
+#define UNLOCK()  xSemaphoreGiveRecursive(driver_mutex)
+
+// ============== DEVICE TABLE ==============
+static void free_dev(linux_dev_t *dev) {
+    devs[dev->slot] = NULL;
+    if (dev->fd >= 0) {
+        close(dev->fd);
+    }
+    free(dev);
+}
+
+static void release_buffers(linux_dev_t *dev) {
+    if (dev->rx_stream != NULL) {
+        vStreamBufferDelete(dev->rx_stream);
+        dev->rx_stream = NULL;
+    }
+    free(dev->in_buf);
+    dev->in_buf = NULL;
+    dev->in_len = 0;
+}
+
+static void emit_event(linux_dev_t *dev, cdc_acm_host_dev_event_t type) {
+    if (dev->config.event_cb == NULL) {
+        return;
+    }
+    cdc_acm_host_dev_event_data_t event = {
+        .type = type,
+        .data.cdc_hdl = (cdc_acm_dev_hdl_t)dev,
+    };
+    dev->config.event_cb(&event, dev->config.user_arg);
+}
+
+// Peer hung up: an open device stays in the table until it is closed
+static void disconnect(linux_dev_t *dev) {
+    ESP_LOGI(TAG, "Device in slot %d disconnected", dev->slot);
+    close(dev->fd);
+    dev->fd = -1;
+    if (dev->open) {
+        emit_event(dev, CDC_ACM_HOST_DEVICE_DISCONNECTED);
+    } else {
+        free_dev(dev);
+    }
+}
+
+static void accept_devices(void) {
+    int fd;
+    while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+        int slot = 0;
+        while (slot < CDC_ACM_HOST_LINUX_DEV_MAX && devs[slot] != NULL) {
+            slot++;
+        }
+        linux_dev_t *dev = (slot < CDC_ACM_HOST_LINUX_DEV_MAX) ? calloc(1, sizeof(linux_dev_t)) : NULL;
+        if (dev == NULL) {
+            ESP_LOGW(TAG, "Connection refused: no free device slot");
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        dev->fd = fd;
+        dev->slot = (uint8_t)slot;
+        dev->desc = (usb_device_desc_t) {
+            .bLength = sizeof(usb_device_desc_t),
+            .bDescriptorType = 0x01,
+            .bcdUSB = 0x0200,
+            .bDeviceClass = 0x02,  // CDC
+            .bMaxPacketSize0 = 64,
+            .idVendor = linux_config.vid,
+            .idProduct = (uint16_t)(linux_config.pid + slot),
+            .bNumConfigurations = 1,
+        };
+        devs[slot] = dev;
+        ESP_LOGI(TAG, "Device connected in slot %d: VID=0x%04X PID=0x%04X", slot,
+                 dev->desc.idVendor, dev->desc.idProduct);
+
+        if (new_dev_cb != NULL) {
+            new_dev_cb((usb_device_handle_t)dev);
+        }
+        xEventGroupSetBits(driver_events, CDC_ACM_LINUX_NEW_DEV);
+    }
+}
+
+// ============== RX ==============
+static void record_data_cb_time(linux_dev_t *dev, uint32_t time_us) {
+    // Same bins as the USB driver: 0-1 us in bin 0, 2-3 us in bin 1, 4-7 us in bin 2...
+    int bin = (time_us < 2) ? 0 : 31 - __builtin_clz(time_us);
+    if (bin >= CDC_ACM_STATS_HIST_BINS) {
+        bin = CDC_ACM_STATS_HIST_BINS - 1;
+    }
+    dev->stats.in.data_cb_hist[bin]++;
+    if (time_us > dev->stats.in.data_cb_max_us) {
+        dev->stats.in.data_cb_max_us = time_us;
+    }
+}
+
+// len new bytes were read into in_buf; hand them over as a completed IN transfer would
+static void deliver(linux_dev_t *dev, size_t len) {
+    dev->stats.in.bytes += len;
+    dev->stats.in.transfers++;
+
+    if (dev->rx_stream != NULL) {
+        xStreamBufferSend(dev->rx_stream, dev->in_buf, len, 0);  // Room was checked before reading
+        size_t queued = xStreamBufferBytesAvailable(dev->rx_stream);
+        if (queued > dev->rx_stats.high_water) {
+            dev->rx_stats.high_water = queued;
+        }
+        emit_event(dev, CDC_ACM_HOST_RX_DATA);  // On every delivery, as the USB driver does
+        return;
+    }
+
+    if (dev->config.data_cb == NULL) {
+        return;  // Write-only device
+    }
+    dev->in_len += len;
+    int64_t start = esp_timer_get_time();
+    bool processed = dev->config.data_cb(dev->in_buf, dev->in_len, dev->config.user_arg);
+    record_data_cb_time(dev, (uint32_t)(esp_timer_get_time() - start));
+    if (processed) {
+        dev->in_len = 0;
+    } else if (dev->in_len == dev->config.in_buffer_size) {
+        // Nothing left to append to, as the USB driver does
+        dev->stats.in.overflows++;
+        dev->in_len = 0;
+    }
+}
+
+static void service_device(linux_dev_t *dev) {
+    if (!dev->open) {
+        // Not polled while closed: only notice the hang-up, leave the data queued
+        uint8_t peek;
+        ssize_t n = recv(dev->fd, &peek, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            disconnect(dev);
+        }
+        return;
+    }
+
+    if (dev->hung_up) {
+        if (xStreamBufferIsEmpty(dev->rx_stream) == pdTRUE) {
+            disconnect(dev);
+        }
+        return;
+    }
+
+    for (int i = 0; i < CDC_ACM_LINUX_READS_MAX; i++) {
+        uint8_t *dst = dev->in_buf;
+        size_t room = dev->config.in_buffer_size;
+        if (dev->rx_stream != NULL) {
+            size_t space = xStreamBufferSpacesAvailable(dev->rx_stream);
+            room = (space < room) ? space : room;
+        } else if (dev->config.data_cb != NULL) {
+            dst += dev->in_len;
+            room -= dev->in_len;
+        }
+        if (room == 0) {
+            return;  // Back-pressure, like an IN transfer that is not resubmitted yet
+        }
+
+        ssize_t n = recv(dev->fd, dst, room, MSG_DONTWAIT);
+        if (n > 0) {
+            deliver(dev, (size_t)n);
+            if (!dev->open || dev->fd < 0) {
+                return;
+            }
+            continue;
+        }
+        if (n == 0 && dev->rx_stream != NULL && xStreamBufferIsEmpty(dev->rx_stream) != pdTRUE) {
+            dev->hung_up = true;  // Let the application read the tail first
+        } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            disconnect(dev);
+        }
+        return;
+    }
+}
+
+static void driver_task(void *arg) {
+    TickType_t period = pdMS_TO_TICKS(CDC_ACM_HOST_LINUX_POLL_MS);
+    while (!stopping) {
+        LOCK();
+        accept_devices();
+        for (int slot = 0; slot < CDC_ACM_HOST_LINUX_DEV_MAX; slot++) {
+            if (devs[slot] != NULL && devs[slot]->fd >= 0) {
+                service_device(devs[slot]);
+            }
+        }
+        UNLOCK();
+        vTaskDelay(period > 0 ? period : 1);
+    }
+    xEventGroupSetBits(driver_events, CDC_ACM_LINUX_TEARDOWN);
+    vTaskDelete(NULL);
+}
+
+// ============== DRIVER ==============
+esp_err_t cdc_acm_host_linux_configure(const cdc_acm_host_linux_config_t *config) {
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const char *path = (config->socket_path != NULL) ? config->socket_path : CDC_ACM_HOST_LINUX_SOCKET_DEFAULT;
+    if (strlen(path) >= sizeof(socket_path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    strcpy(socket_path, path);
+    linux_config.vid = (config->vid != 0) ? config->vid : CDC_ACM_HOST_LINUX_VID_DEFAULT;
+    linux_config.pid = (config->pid != 0) ? config->pid : CDC_ACM_HOST_LINUX_PID_DEFAULT;
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_install(const cdc_acm_host_driver_config_t *driver_config) {
+    if (installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strcpy(addr.sun_path, socket_path);
+    unlink(socket_path);  // Left over by a previous run
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, CDC_ACM_HOST_LINUX_DEV_MAX) != 0) {
+        ESP_LOGE(TAG, "Cannot listen on %s: %s", socket_path, strerror(errno));
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            listen_fd = -1;
+        }
+        return ESP_FAIL;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+
+    driver_mutex = xSemaphoreCreateRecursiveMutex();
+    driver_events = xEventGroupCreate();
+    size_t stack = (driver_config != NULL) ? driver_config->driver_task_stack_size : 4096;
+    UBaseType_t priority = (driver_config != NULL) ? driver_config->driver_task_priority : 10;
+    new_dev_cb = (driver_config != NULL) ? driver_config->new_dev_cb : NULL;
+    stopping = false;
+    // xCoreID is ignored: the linux target runs FreeRTOS on a single core
+    if (driver_mutex == NULL || driver_events == NULL ||
+        xTaskCreate(driver_task, "USB-CDC", stack, NULL, priority, NULL) != pdPASS) {
+        if (driver_mutex != NULL) {
+            vSemaphoreDelete(driver_mutex);
+            driver_mutex = NULL;
+        }
+        if (driver_events != NULL) {
+            vEventGroupDelete(driver_events);
+            driver_events = NULL;
+        }
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        return ESP_ERR_NO_MEM;
+    }
+
+    installed = true;
+    ESP_LOGI(TAG, "Devices connect to %s", socket_path);
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_uninstall(void) {
+    if (!installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    LOCK();
+    for (int slot = 0; slot < CDC_ACM_HOST_LINUX_DEV_MAX; slot++) {
+        if (devs[slot] != NULL && devs[slot]->open) {
+            UNLOCK();
+            return ESP_ERR_INVALID_STATE;  // Close all devices first, as with the USB driver
+        }
+    }
+    stopping = true;
+    UNLOCK();
+    xEventGroupWaitBits(driver_events, CDC_ACM_LINUX_TEARDOWN, pdFALSE, pdFALSE, portMAX_DELAY);
+
+    for (int slot = 0; slot < CDC_ACM_HOST_LINUX_DEV_MAX; slot++) {
+        if (devs[slot] != NULL) {
+            free_dev(devs[slot]);
+        }
+    }
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(socket_path);
+    vSemaphoreDelete(driver_mutex);
+    driver_mutex = NULL;
+    vEventGroupDelete(driver_events);
+    driver_events = NULL;
+    new_dev_cb = NULL;
+    installed = false;
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_register_new_dev_callback(cdc_acm_new_dev_callback_t cb) {
+    if (!installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    new_dev_cb = cb;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_get_device_descriptor(usb_device_handle_t dev_hdl, const usb_device_desc_t **device_desc) {
+    if (dev_hdl == NULL || device_desc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *device_desc = &((linux_dev_t *)dev_hdl)->desc;
+    return ESP_OK;
+}
+
+esp_err_t usb_host_device_info(usb_device_handle_t dev_hdl, usb_device_info_t *dev_info) {
+    if (dev_hdl == NULL || dev_info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *dev_info = (usb_device_info_t) {
+        .dev_addr = (uint8_t)(((linux_dev_t *)dev_hdl)->slot + 1),
+    };
+    return ESP_OK;
+}
+
+// ============== OPEN / CLOSE ==============
+static linux_dev_t *find_device(uint16_t vid, uint16_t pid) {
+    for (int slot = 0; slot < CDC_ACM_HOST_LINUX_DEV_MAX; slot++) {
+        linux_dev_t *dev = devs[slot];
+        if (dev != NULL && dev->fd >= 0 && !dev->open &&
+            (vid == dev->desc.idVendor || vid == CDC_HOST_ANY_VID) &&
+            (pid == dev->desc.idProduct || pid == CDC_HOST_ANY_PID)) {
+            return dev;
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t open_device(linux_dev_t *dev, const cdc_acm_host_device_config_t *dev_config) {
+    dev->config = *dev_config;
+    if (dev->config.in_buffer_size == 0) {
+        dev->config.in_buffer_size = CDC_ACM_LINUX_IN_MPS;
+    }
+    dev->in_buf = malloc(dev->config.in_buffer_size);
+    if (dev->in_buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (dev->config.rx_buffer_size > 0) {
+        dev->rx_stream = xStreamBufferCreate(dev->config.rx_buffer_size, 1);
+        if (dev->rx_stream == NULL) {
+            release_buffers(dev);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->rx_stats = (cdc_acm_host_rx_buffer_stats_t) {
+        .size = dev->config.rx_buffer_size,
+    };
+    dev->line_coding = (cdc_acm_line_coding_t) {
+        .dwDTERate = 9600,
+        .bDataBits = 8,
+    };
+    dev->dtr = false;
+    dev->rts = false;
+    dev->open = true;
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_open(uint16_t vid, uint16_t pid, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config, cdc_acm_dev_hdl_t *cdc_hdl_ret) {
+    if (dev_config == NULL || cdc_hdl_ret == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *cdc_hdl_ret = NULL;
+    if (!installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (dev_config->rx_buffer_size > 0 && dev_config->data_cb != NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dev_config->rx_loan_count > 0 || dev_config->tx_xfer_count > 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (interface_idx != 0) {
+        return ESP_ERR_NOT_FOUND;  // Socket devices have a single CDC function
+    }
+
+    TickType_t timeout_ticks = (dev_config->connection_timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(dev_config->connection_timeout_ms);
+    TimeOut_t connection_timeout;
+    vTaskSetTimeOutState(&connection_timeout);
+    do {
+        // Clear before the scan: a device connecting during the scan sets it again
+        xEventGroupClearBits(driver_events, CDC_ACM_LINUX_NEW_DEV);
+        LOCK();
+        linux_dev_t *dev = find_device(vid, pid);
+        esp_err_t ret = (dev != NULL) ? open_device(dev, dev_config) : ESP_ERR_NOT_FOUND;
+        UNLOCK();
+        if (dev != NULL) {
+            if (ret == ESP_OK) {
+                *cdc_hdl_ret = (cdc_acm_dev_hdl_t)dev;
+            }
+            return ret;
+        }
+        xEventGroupWaitBits(driver_events, CDC_ACM_LINUX_NEW_DEV, pdFALSE, pdFALSE, timeout_ticks);
+    } while (xTaskCheckForTimeOut(&connection_timeout, &timeout_ticks) == pdFALSE);
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t cdc_acm_host_open_by_address(uint8_t dev_addr, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config, cdc_acm_dev_hdl_t *cdc_hdl_ret) {
+    if (dev_config == NULL || cdc_hdl_ret == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *cdc_hdl_ret = NULL;
+    if (!installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (dev_config->rx_buffer_size > 0 && dev_config->data_cb != NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (dev_config->rx_loan_count > 0 || dev_config->tx_xfer_count > 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (interface_idx != 0 || dev_addr == 0 || dev_addr > CDC_ACM_HOST_LINUX_DEV_MAX) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    LOCK();
+    linux_dev_t *dev = devs[dev_addr - 1];
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    if (dev != NULL && dev->fd >= 0 && !dev->open) {
+        ret = open_device(dev, dev_config);
+    }
+    UNLOCK();
+    if (ret == ESP_OK) {
+        *cdc_hdl_ret = (cdc_acm_dev_hdl_t)dev;
+    }
+    return ret;
+}
+
+esp_err_t cdc_acm_host_open_on_arrival(uint16_t vid, uint16_t pid, uint8_t interface_idx, const cdc_acm_host_device_config_t *dev_config,
+                                       cdc_acm_arrival_callback_t arrival_cb, void *arrival_arg) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_open_on_arrival_cancel(uint16_t vid, uint16_t pid, uint8_t interface_idx) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_close(cdc_acm_dev_hdl_t cdc_hdl) {
+    if (cdc_hdl == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    linux_dev_t *dev = (linux_dev_t *)cdc_hdl;
+    LOCK();
+    if (!dev->open) {
+        UNLOCK();
+        return ESP_ERR_INVALID_STATE;
+    }
+    release_buffers(dev);
+    dev->open = false;
+    if (dev->hung_up) {
+        close(dev->fd);
+        dev->fd = -1;
+    }
+    memset(&dev->config, 0, sizeof(dev->config));
+    if (dev->fd < 0) {
+        free_dev(dev);  // Already unplugged
+    }
+    UNLOCK();
+    return ESP_OK;
+}
+
+// ============== DATA ==============
+esp_err_t cdc_acm_host_data_tx_blocking(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data, size_t data_len, uint32_t timeout_ms) {
+    if (cdc_hdl == NULL || data == NULL || data_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    linux_dev_t *dev = (linux_dev_t *)cdc_hdl;
+    if (dev->config.out_buffer_size == 0) {
+        return ESP_ERR_NOT_SUPPORTED;  // Read-only device
+    }
+
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    TimeOut_t tx_timeout;
+    vTaskSetTimeOutState(&tx_timeout);
+    size_t sent = 0;
+    while (true) {
+        LOCK();
+        ssize_t n = (dev->fd >= 0) ? send(dev->fd, data + sent, data_len - sent, MSG_DONTWAIT | MSG_NOSIGNAL) : -1;
+        int err = errno;
+        if (n > 0) {
+            dev->stats.out.bytes += (uint64_t)n;
+            dev->stats.out.transfers++;
+        }
+        UNLOCK();
+
+        if (n > 0) {
+            sent += (size_t)n;
+            if (sent == data_len) {
+                return ESP_OK;
+            }
+            continue;
+        }
+        if (dev->fd < 0 || (err != EAGAIN && err != EWOULDBLOCK && err != EINTR)) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (xTaskCheckForTimeOut(&tx_timeout, &timeout_ticks) == pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);  // Peer is not reading
+    }
+}
+
+esp_err_t cdc_acm_host_data_tx_async(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data, size_t data_len, cdc_acm_tx_callback_t tx_cb, void *tx_arg) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_data_tx_async_zero_copy(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data, size_t data_len, cdc_acm_tx_callback_t tx_cb, void *tx_arg) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_rx_acquire(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t **data, size_t *data_len, uint32_t timeout_ms) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_rx_release(cdc_acm_dev_hdl_t cdc_hdl, const uint8_t *data) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_data_rx_blocking(cdc_acm_dev_hdl_t cdc_hdl, uint8_t *data, size_t data_len, size_t *rx_len, uint32_t timeout_ms) {
+    if (cdc_hdl == NULL || data == NULL || data_len == 0 || rx_len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    linux_dev_t *dev = (linux_dev_t *)cdc_hdl;
+    if (dev->rx_stream == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;  // Device was opened without RX ring buffer
+    }
+    *rx_len = xStreamBufferReceive(dev->rx_stream, data, data_len, pdMS_TO_TICKS(timeout_ms));
+    return (*rx_len > 0) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t cdc_acm_host_rx_buffer_stats_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_acm_host_rx_buffer_stats_t *stats) {
+    if (cdc_hdl == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    linux_dev_t *dev = (linux_dev_t *)cdc_hdl;
+    if (dev->rx_stream == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    LOCK();
+    *stats = dev->rx_stats;
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_get_stats(cdc_acm_dev_hdl_t cdc_hdl, cdc_acm_host_stats_t *stats) {
+    if (cdc_hdl == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    *stats = ((linux_dev_t *)cdc_hdl)->stats;
+    UNLOCK();
+    return ESP_OK;
+}
+
+// ============== CONTROL ==============
+esp_err_t cdc_acm_host_line_coding_set(cdc_acm_dev_hdl_t cdc_hdl, const cdc_acm_line_coding_t *line_coding) {
+    if (cdc_hdl == NULL || line_coding == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    linux_dev_t *dev = (linux_dev_t *)cdc_hdl;
+    LOCK();
+    dev->line_coding = *line_coding;
+    UNLOCK();
+    ESP_LOGD(TAG, "Slot %d line coding: %lu %u%c%u", dev->slot, (unsigned long)line_coding->dwDTERate,
+             line_coding->bDataBits, "NOEMS"[line_coding->bParityType % 5], line_coding->bCharFormat == 0 ? 1 : 2);
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_line_coding_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_acm_line_coding_t *line_coding) {
+    if (cdc_hdl == NULL || line_coding == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    *line_coding = ((linux_dev_t *)cdc_hdl)->line_coding;
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_set_control_line_state(cdc_acm_dev_hdl_t cdc_hdl, bool dtr, bool rts) {
+    if (cdc_hdl == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    linux_dev_t *dev = (linux_dev_t *)cdc_hdl;
+    LOCK();
+    dev->dtr = dtr;
+    dev->rts = rts;
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t cdc_acm_host_send_break(cdc_acm_dev_hdl_t cdc_hdl, uint16_t duration_ms) {
+    return (cdc_hdl != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// ============== DESCRIPTORS ==============
+void cdc_acm_host_desc_print(cdc_acm_dev_hdl_t cdc_hdl) {
+    const linux_dev_t *dev = (const linux_dev_t *)cdc_hdl;
+    if (dev != NULL) {
+        printf("Socket device in slot %d: VID=0x%04X PID=0x%04X\n", dev->slot, dev->desc.idVendor, dev->desc.idProduct);
+    }
+}
+
+esp_err_t cdc_acm_host_protocols_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_comm_protocol_t *comm, cdc_data_protocol_t *data) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_cdc_desc_get(cdc_acm_dev_hdl_t cdc_hdl, cdc_desc_subtype_t desc_type, const usb_standard_desc_t **desc_out) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t cdc_acm_host_send_custom_request(cdc_acm_dev_hdl_t cdc_hdl, uint8_t bmRequestType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, uint16_t wLength, uint8_t *data) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
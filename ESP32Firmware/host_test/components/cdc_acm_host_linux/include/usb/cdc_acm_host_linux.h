@@ -0,0 +1,64 @@
+/*
+ * Linux CDC-ACM Backend for GasTag Bridge Host Builds
+ *
+ * Implements the cdc_acm_host.h API on the ESP-IDF linux target, with
+ * Unix socket connections standing in for USB devices:
+ *
+ *   connect     the device arrives; new_dev_cb runs and the device can be
+ *               opened by VID/PID, or by its address (device slot + 1)
+ *   peer data   bulk IN data, delivered to data_cb or the RX ring buffer
+ *               exactly as the USB driver does (same events, same stats)
+ *   tx          cdc_acm_host_data_tx_blocking() writes to the peer
+ *   hang-up     CDC_ACM_HOST_DEVICE_DISCONNECTED for an open device, once
+ *               its RX ring is drained so a replay's last bytes are read
+ *
+ * Each connection reports the configured VID and the configured PID plus
+ * its device slot, so several analyzers can be fed at once and told apart
+ * like different models behind a hub. Line coding and control line state
+ * are kept and can be read back, but do not reach the peer.
+ *
+ * An open device is only read while its RX ring (or IN buffer) has room,
+ * as a USB device is only polled while an IN transfer is submitted, so the
+ * socket applies back-pressure instead of dropping data: a peer writing as
+ * fast as it can measures the throughput of the host side. Real-time
+ * pacing is up to the peer (tools/cdc_feed.py).
+ *
+ * Asynchronous sending, RX buffer loans, open on arrival and descriptor
+ * access return ESP_ERR_NOT_SUPPORTED. Callbacks run in the driver task
+ * and must not close devices.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CDC_ACM_HOST_LINUX_SOCKET_DEFAULT  "/tmp/gastag_cdc.sock"
+#define CDC_ACM_HOST_LINUX_VID_DEFAULT     0x303A   // Espressif, TinyUSB CDC
+#define CDC_ACM_HOST_LINUX_PID_DEFAULT     0x4001
+#define CDC_ACM_HOST_LINUX_DEV_MAX         8        // Connected sockets, open or not
+#define CDC_ACM_HOST_LINUX_POLL_MS         1        // Driver task period
+
+typedef struct {
+    const char *socket_path;    // Unix socket devices connect to, NULL for the default
+    uint16_t vid;               // VID of every device, 0 for the default
+    uint16_t pid;               // PID of device slot 0; slot n reports pid + n. 0 for the default
+} cdc_acm_host_linux_config_t;
+
+/**
+ * Set where devices connect and how they identify. Call before
+ * cdc_acm_host_install(); without it the defaults are used.
+ *
+ * @param config Configuration, copied (the socket path too)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a path too long for a Unix socket,
+ *         or ESP_ERR_INVALID_STATE once the driver is installed
+ */
+esp_err_t cdc_acm_host_linux_configure(const cdc_acm_host_linux_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * USB Host Stand-in for the Linux CDC-ACM Backend
+ *
+ * The linux target has no USB Host Library. cdc_acm_host.h only needs a
+ * few of its types, and new_dev_cb receives a device whose descriptor and
+ * address are read with usb_host_get_device_descriptor() and
+ * usb_host_device_info(); these are provided here for
+ * the socket devices of cdc_acm_host_linux.c. Field names match the
+ * USB Host Library, so callbacks written for the bridge build unchanged.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct usb_device_handle_s *usb_device_handle_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+} usb_standard_desc_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t bDeviceClass;
+    uint8_t bDeviceSubClass;
+    uint8_t bDeviceProtocol;
+    uint8_t bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t iManufacturer;
+    uint8_t iProduct;
+    uint8_t iSerialNumber;
+    uint8_t bNumConfigurations;
+} usb_device_desc_t;
+
+// Same order as the USB Host Library; cdc_acm_host_stats_t counts errors by it
+typedef enum {
+    USB_TRANSFER_STATUS_COMPLETED,
+    USB_TRANSFER_STATUS_ERROR,
+    USB_TRANSFER_STATUS_TIMED_OUT,
+    USB_TRANSFER_STATUS_CANCELED,
+    USB_TRANSFER_STATUS_STALL,
+    USB_TRANSFER_STATUS_OVERFLOW,
+    USB_TRANSFER_STATUS_SKIPPED,
+    USB_TRANSFER_STATUS_NO_DEVICE,
+} usb_transfer_status_t;
+
+// Only the fields the socket devices have
+typedef struct {
+    uint8_t dev_addr;
+} usb_device_info_t;
+
+/**
+ * Device descriptor of a device passed to new_dev_cb.
+ *
+ * @param dev_hdl     Device
+ * @param device_desc Descriptor, valid while the device is connected
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG
+ */
+esp_err_t usb_host_get_device_descriptor(usb_device_handle_t dev_hdl, const usb_device_desc_t **device_desc);
+
+/**
+ * Information about a device passed to new_dev_cb. A socket device's
+ * address is its device slot plus one.
+ *
+ * @param dev_hdl  Device
+ * @param dev_info Information, filled in
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG
+ */
+esp_err_t usb_host_device_info(usb_device_handle_t dev_hdl, usb_device_info_t *dev_info);
+
+#ifdef __cplusplus
+}
+#endif
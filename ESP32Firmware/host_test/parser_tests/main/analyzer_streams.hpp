@@ -0,0 +1,58 @@
+/*
+ * Analyzer stream fixtures
+ *
+ * Byte streams shaped like a Divesoft analyzer session as the bridge sees it
+ * over USB: attach noise, a warm-up period where He/O2 read ***.*, then a
+ * steady run of readings once per second, all CRLF terminated.
+ *
+ * The session is generated deterministically rather than stored as a blob so
+ * its size can be scaled for benchmarks.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+
+namespace analyzer_streams {
+
+// One reading line exactly as the analyzer formats it (without line ending)
+inline std::string reading_line(const char *he, const char *o2, double temp_f, double inhg, int second)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "He %5s %%  O2 %5s %%  Ti %5.1f ~F    %5.2f inHg   2025/12/15 21:%02d:%02d",
+             he, o2, temp_f, inhg, (second / 60) % 60, second % 60);
+    return line;
+}
+
+// Number of reading lines in session()
+inline size_t session_line_count(size_t readings)
+{
+    return 5 + readings;
+}
+
+// Full session: noise, 5 warm-up lines, then `readings` live readings
+inline std::string session(size_t readings)
+{
+    std::string s;
+
+    // Bytes seen while the CDC interface comes up
+    s.append("\xff\xfe\x00\r\n", 5);
+
+    for (int i = 0; i < 5; i++) {
+        s += reading_line("***.*", "***.*", 78.5 + i * 0.1, 29.52, i);
+        s += "\r\n";
+    }
+
+    for (size_t i = 0; i < readings; i++) {
+        char he[8], o2[8];
+        // Trimix-like mix drifting slightly as the sensor settles
+        snprintf(he, sizeof(he), "%.1f", 35.0 + (double)(i % 7) * 0.1);
+        snprintf(o2, sizeof(o2), "%.1f", 21.0 - (double)(i % 5) * 0.1);
+        s += reading_line(he, o2, 79.0 + (double)(i % 3) * 0.1, 29.50, (int)(5 + i));
+        s += "\r\n";
+    }
+    return s;
+}
+
+} // namespace analyzer_streams
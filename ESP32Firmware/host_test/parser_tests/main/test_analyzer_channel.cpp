@@ -0,0 +1,351 @@
+/*
+ * analyzer_channel tests: several mocked analyzers behind a hub sharing one
+ * line ring and one BLE link
+ */
+
+#include <stdio.h>
+#include <stdatomic.h>  // Before extern "C": the ring's counters are C11 atomics
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "analyzer_channel.h"
+#include "reading_format.h"
+}
+#include "analyzer_streams.hpp"
+
+namespace {
+
+// A CDC device on the hub: its own byte stream, delivered in chunks of its
+// own size, the way its bulk IN transfers would complete
+struct mock_analyzer {
+    std::string bytes;
+    size_t chunk;
+    size_t pos = 0;
+
+    bool done() const { return pos >= bytes.size(); }
+
+    // Next USB chunk into the channel, as handle_rx does
+    size_t deliver(analyzer_channel_t *channel)
+    {
+        size_t n = bytes.size() - pos < chunk ? bytes.size() - pos : chunk;
+        size_t lines = analyzer_channel_feed(channel, reinterpret_cast<const uint8_t *>(bytes.data() + pos), n);
+        pos += n;
+        return lines;
+    }
+};
+
+struct taken_line {
+    uint8_t channel;
+    std::string text;       // As sent on the text characteristic
+    bool parsed;
+    bool send;
+    gas_reading_t reading;
+};
+
+// What the notify task does with the ring
+struct bridge_side {
+    line_ring_t ring;
+    analyzer_channel_t channels[ANALYZER_CHANNEL_MAX];
+    analyzer_channel_latest_t latest[ANALYZER_CHANNEL_MAX];
+    std::vector<taken_line> taken;
+
+    explicit bridge_side(uint8_t filter_mode = READING_FILTER_MODE_ALL)
+    {
+        reading_filter_config_t config;
+        reading_filter_default_config(&config);
+        config.mode = filter_mode;
+        line_ring_init(&ring);
+        for (uint8_t id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+            analyzer_channel_init(&channels[id], id, &ring);
+            analyzer_channel_latest_init(&latest[id], &config);
+        }
+    }
+
+    void drain(uint32_t now_ms = 0)
+    {
+        const line_ring_slot_t *slot;
+        while ((slot = line_ring_peek(&ring)) != nullptr) {
+            taken_line line = {};
+            line.channel = slot->channel;
+            line.send = analyzer_channel_accept(&latest[slot->channel], slot, now_ms, &line.reading, &line.parsed);
+            line.text = std::string(latest[slot->channel].text, latest[slot->channel].text_len);
+            taken.push_back(line);
+            line_ring_pop(&ring);
+        }
+    }
+
+    std::vector<taken_line> from(uint8_t channel) const
+    {
+        std::vector<taken_line> lines;
+        for (const taken_line &line : taken) {
+            if (line.channel == channel) {
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+};
+
+// A second analyzer type with the same line format but a different mix, so
+// lines that leak between channels would show up as wrong values
+std::string nitrox_session(size_t readings)
+{
+    std::string s;
+    for (size_t i = 0; i < readings; i++) {
+        s += analyzer_streams::reading_line("0.0", "32.0", 68.0, 30.01, (int)i) + "\r\n";
+    }
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("Interleaved chunks from several analyzers stay on their own channels")
+{
+    bridge_side bridge;
+    mock_analyzer analyzers[3] = {
+        { analyzer_streams::session(40), 7 },
+        { nitrox_session(30), 64 },
+        { analyzer_streams::session(20), 13 },
+    };
+
+    // Round-robin over the hub, one transfer each, draining as the notify task would
+    bool busy = true;
+    while (busy) {
+        busy = false;
+        for (uint8_t id = 0; id < 3; id++) {
+            if (!analyzers[id].done()) {
+                analyzers[id].deliver(&bridge.channels[id]);
+                busy = true;
+            }
+        }
+        bridge.drain();
+    }
+
+    line_ring_stats_t stats;
+    line_ring_get_stats(&bridge.ring, &stats);
+    CHECK(stats.overflows == 0);
+
+    std::vector<taken_line> he = bridge.from(0);
+    std::vector<taken_line> nitrox = bridge.from(1);
+    std::vector<taken_line> short_he = bridge.from(2);
+    REQUIRE(he.size() == analyzer_streams::session_line_count(40));
+    REQUIRE(nitrox.size() == 30);
+    REQUIRE(short_he.size() == analyzer_streams::session_line_count(20));
+    CHECK(bridge.from(3).empty());
+
+    for (const taken_line &line : nitrox) {
+        REQUIRE(line.parsed);
+        CHECK(line.reading.o2_x10 == 320);
+        CHECK(line.reading.he_x10 == 0);
+        CHECK(GAS_READING_CHANNEL(line.reading.flags) == 1);
+        CHECK(line.text.rfind("#1 He", 0) == 0);
+    }
+    for (size_t i = 0; i < he.size(); i++) {
+        REQUIRE(he[i].parsed);
+        CHECK(GAS_READING_CHANNEL(he[i].reading.flags) == 0);
+        CHECK(he[i].text.rfind("He", 0) == 0);  // Channel 0 is sent unchanged
+        CHECK((he[i].reading.timestamp & 0x3F) == i % 60);  // In order, none lost
+    }
+    for (const taken_line &line : short_he) {
+        CHECK(GAS_READING_CHANNEL(line.reading.flags) == 2);
+    }
+    // The warm-up lines keep their stale flags next to the channel bits
+    CHECK((he[0].reading.flags & GAS_READING_FLAG_HE_STALE) != 0);
+    CHECK((short_he[0].reading.flags & GAS_READING_FLAG_O2_STALE) != 0);
+
+    CHECK(bridge.latest[1].has_reading);
+    CHECK(bridge.latest[1].reading.o2_x10 == 320);
+    CHECK_FALSE(bridge.latest[3].has_reading);
+}
+
+TEST_CASE("Detaching one analyzer mid-line does not disturb the others")
+{
+    bridge_side bridge;
+    const std::string line0 = analyzer_streams::reading_line("35.0", "21.0", 79.0, 29.50, 1) + "\r\n";
+    const std::string line1 = analyzer_streams::reading_line("0.0", "32.0", 68.0, 30.01, 2) + "\r\n";
+
+    // Both analyzers are halfway through a line
+    mock_analyzer a = { line0 + line0, line0.size() + 10 };
+    mock_analyzer b = { line1 + line1, 20 };
+    a.deliver(&bridge.channels[0]);
+    b.deliver(&bridge.channels[1]);
+    bridge.drain();
+    REQUIRE(bridge.from(0).size() == 1);
+    REQUIRE(bridge.from(1).empty());
+
+    // Channel 1 is unplugged; its partial line goes, channel 0's stays
+    analyzer_channel_reset(&bridge.channels[1]);
+    CHECK(bridge.channels[1].stream.len == 0);
+    CHECK(bridge.channels[0].stream.len == 10);
+
+    // Another analyzer on channel 1 starts clean, channel 0 finishes its line
+    mock_analyzer c = { line1, 5 };
+    while (!c.done()) {
+        c.deliver(&bridge.channels[1]);
+    }
+    while (!a.done()) {
+        a.deliver(&bridge.channels[0]);
+    }
+    bridge.drain();
+
+    std::vector<taken_line> ch0 = bridge.from(0);
+    std::vector<taken_line> ch1 = bridge.from(1);
+    REQUIRE(ch0.size() == 2);
+    REQUIRE(ch1.size() == 1);
+    CHECK(ch0[1].parsed);
+    CHECK(ch0[1].reading.he_x10 == 350);
+    CHECK(ch1[0].parsed);
+    CHECK(ch1[0].reading.o2_x10 == 320);
+    CHECK(bridge.latest[0].lines == 2);
+    CHECK(bridge.latest[0].parse_failures == 0);
+    CHECK(bridge.latest[1].parse_failures == 0);
+}
+
+TEST_CASE("The channel ID travels in the binary record flags")
+{
+    bridge_side bridge;
+    const std::string stale = analyzer_streams::reading_line("***.*", "***.*", 79.0, 29.50, 3) + "\n";
+    mock_analyzer analyzer = { stale, stale.size() };
+    analyzer.deliver(&bridge.channels[ANALYZER_CHANNEL_MAX - 1]);
+    bridge.drain();
+    REQUIRE(bridge.taken.size() == 1);
+
+    uint8_t buf[READING_FORMAT_SIZE];
+    reading_format_encode(&bridge.taken[0].reading, buf);
+    CHECK(GAS_READING_CHANNEL(buf[1]) == ANALYZER_CHANNEL_MAX - 1);
+    CHECK((buf[1] & (GAS_READING_FLAG_HE_STALE | GAS_READING_FLAG_O2_STALE)) ==
+          (GAS_READING_FLAG_HE_STALE | GAS_READING_FLAG_O2_STALE));
+    CHECK(bridge.taken[0].text == "#3 " + stale.substr(0, stale.size() - 1));
+
+    // Lines that are not readings still reach text clients, with the prefix
+    mock_analyzer noise = { "Calibrating...\r\n", 16 };
+    noise.deliver(&bridge.channels[2]);
+    bridge.drain();
+    REQUIRE(bridge.taken.size() == 2);
+    CHECK_FALSE(bridge.taken[1].parsed);
+    CHECK(bridge.taken[1].send);
+    CHECK(bridge.taken[1].text == "#2 Calibrating...");
+    CHECK(bridge.latest[2].parse_failures == 1);
+}
+
+TEST_CASE("A truncated line reaches text clients but is not parsed")
+{
+    bridge_side bridge;
+    const std::string line = analyzer_streams::reading_line("35.0", "21.0", 79.0, 29.50, 4);
+    const std::string noise(ANALYZER_STREAM_LINE_MAX, ' ');
+
+    // The reading is complete within the kept part, the tail is lost
+    mock_analyzer analyzer = { line + noise + "\r\n" + line + "\r\n", 64 };
+    while (!analyzer.done()) {
+        analyzer.deliver(&bridge.channels[1]);
+    }
+    bridge.drain();
+    REQUIRE(bridge.taken.size() == 2);
+    CHECK_FALSE(bridge.taken[0].parsed);
+    CHECK(bridge.taken[0].send);
+    CHECK(bridge.taken[0].text.size() == ANALYZER_CHANNEL_PREFIX_MAX + ANALYZER_STREAM_LINE_MAX - 1);
+    CHECK(bridge.taken[1].parsed);
+    CHECK(bridge.latest[1].parse_failures == 1);
+    CHECK(bridge.channels[1].stream.stats.truncated_lines == 1);
+}
+
+TEST_CASE("Each analyzer has its own deadband filter")
+{
+    bridge_side bridge(READING_FILTER_MODE_DEADBAND);
+    const std::string line = analyzer_streams::reading_line("35.0", "21.0", 79.0, 29.50, 0) + "\r\n";
+
+    // The same values from two analyzers: neither suppresses the other
+    for (uint8_t id = 0; id < 2; id++) {
+        mock_analyzer analyzer = { line, line.size() };
+        analyzer.deliver(&bridge.channels[id]);
+    }
+    bridge.drain(100);
+    REQUIRE(bridge.taken.size() == 2);
+    CHECK(bridge.taken[0].send);
+    CHECK(bridge.taken[1].send);
+
+    // A repeat on channel 0 is held back, a first reading on channel 2 is not
+    mock_analyzer repeat = { line, line.size() };
+    repeat.deliver(&bridge.channels[0]);
+    mock_analyzer other = { line, line.size() };
+    other.deliver(&bridge.channels[2]);
+    bridge.drain(200);
+    REQUIRE(bridge.taken.size() == 4);
+    CHECK_FALSE(bridge.taken[2].send);
+    CHECK(bridge.taken[3].send);
+    CHECK(bridge.latest[0].filter.suppressed == 1);
+    CHECK(bridge.latest[1].filter.suppressed == 0);
+}
+
+namespace {
+
+// What the notify task's hooks were handed
+struct hook_log {
+    uint32_t next_seq = 1;
+    std::vector<uint32_t> parsed;           // Sequence numbers given out
+    std::vector<std::string> texts;
+    std::vector<uint32_t> readings;         // Sequence numbers sent
+    std::vector<uint8_t> reading_channels;
+};
+
+uint32_t log_parsed(uint8_t id, const gas_reading_t *reading, void *ctx)
+{
+    hook_log *log = static_cast<hook_log *>(ctx);
+    log->parsed.push_back(log->next_seq);
+    return log->next_seq++;
+}
+
+void log_text(uint8_t id, const char *text, size_t len, void *ctx)
+{
+    static_cast<hook_log *>(ctx)->texts.push_back(std::string(text, len));
+}
+
+void log_reading(uint8_t id, uint32_t seq, const gas_reading_t *reading, void *ctx)
+{
+    hook_log *log = static_cast<hook_log *>(ctx);
+    log->readings.push_back(seq);
+    log->reading_channels.push_back(GAS_READING_CHANNEL(reading->flags));
+}
+
+} // namespace
+
+TEST_CASE("Taking a line hands it to the notify hooks")
+{
+    bridge_side bridge(READING_FILTER_MODE_DEADBAND);
+    hook_log log;
+    const analyzer_channel_hooks_t hooks = { log_parsed, log_text, log_reading, &log };
+    const std::string line = analyzer_streams::reading_line("35.0", "21.0", 79.0, 29.50, 0) + "\r\n";
+
+    // A reading, its repeat held back by the deadband, and a line that is not a reading
+    mock_analyzer first = { line, line.size() };
+    first.deliver(&bridge.channels[1]);
+    mock_analyzer repeat = { line, line.size() };
+    repeat.deliver(&bridge.channels[1]);
+    mock_analyzer banner = { "Divesoft analyzer\r\n", 64 };
+    banner.deliver(&bridge.channels[1]);
+
+    const line_ring_slot_t *slot;
+    while ((slot = line_ring_peek(&bridge.ring)) != nullptr) {
+        CHECK(analyzer_channel_take(bridge.latest, slot, 100, &hooks) == 1);
+        line_ring_pop(&bridge.ring);
+    }
+
+    // Every reading is numbered, sent or not; only the first goes out
+    CHECK(log.parsed == std::vector<uint32_t> {1, 2});
+    CHECK(log.readings == std::vector<uint32_t> {1});
+    CHECK(log.reading_channels == std::vector<uint8_t> {1});
+    REQUIRE(log.texts.size() == 2);
+    CHECK(log.texts[0] == "#1 " + line.substr(0, line.size() - 2));
+    CHECK(log.texts[1] == "#1 Divesoft analyzer");
+
+    // Hooks are optional
+    const analyzer_channel_hooks_t none = {};
+    mock_analyzer again = { line, line.size() };
+    again.deliver(&bridge.channels[0]);
+    REQUIRE((slot = line_ring_peek(&bridge.ring)) != nullptr);
+    CHECK(analyzer_channel_take(bridge.latest, slot, 200, &none) == 0);
+    line_ring_pop(&bridge.ring);
+    CHECK(bridge.latest[0].has_reading);
+}
@@ -0,0 +1,149 @@
+/*
+ * analyzer_stream framer tests
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "analyzer_stream.h"
+}
+#include "analyzer_streams.hpp"
+
+namespace {
+
+struct captured_line {
+    std::string text;
+    uint8_t flags;
+};
+
+void capture(const char *line, size_t len, uint8_t flags, void *ctx)
+{
+    auto *lines = static_cast<std::vector<captured_line> *>(ctx);
+    REQUIRE(strlen(line) == len);
+    lines->push_back({std::string(line, len), flags});
+}
+
+size_t feed(analyzer_stream_t *stream, const std::string &bytes, std::vector<captured_line> &lines)
+{
+    return analyzer_stream_feed(stream, reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(),
+                                capture, &lines);
+}
+
+} // namespace
+
+TEST_CASE("Lines end at CR or LF and empty lines are skipped")
+{
+    analyzer_stream_t stream;
+    analyzer_stream_init(&stream);
+    std::vector<captured_line> lines;
+
+    REQUIRE(feed(&stream, "one\r\ntwo\n\rthree\r\r\n\nfour", lines) == 3);
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0].text == "one");
+    CHECK(lines[1].text == "two");
+    CHECK(lines[2].text == "three");
+    CHECK(lines[2].flags == 0);
+
+    // "four" is still pending until its terminator arrives
+    REQUIRE(feed(&stream, "\n", lines) == 1);
+    CHECK(lines[3].text == "four");
+    CHECK(stream.stats.lines == 4);
+    CHECK(stream.stats.framing_errors == 0);
+}
+
+TEST_CASE("Lines reassemble across arbitrary chunk boundaries")
+{
+    const std::string bytes = analyzer_streams::session(20);
+
+    analyzer_stream_t whole;
+    analyzer_stream_init(&whole);
+    std::vector<captured_line> expected;
+    feed(&whole, bytes, expected);
+
+    for (size_t chunk : {1u, 2u, 7u, 64u, 512u}) {
+        analyzer_stream_t stream;
+        analyzer_stream_init(&stream);
+        std::vector<captured_line> lines;
+
+        for (size_t off = 0; off < bytes.size(); off += chunk) {
+            feed(&stream, bytes.substr(off, chunk), lines);
+        }
+
+        INFO("chunk size " << chunk);
+        REQUIRE(lines.size() == expected.size());
+        for (size_t i = 0; i < lines.size(); i++) {
+            CHECK(lines[i].text == expected[i].text);
+            CHECK(lines[i].flags == expected[i].flags);
+        }
+        CHECK(stream.stats.bytes == bytes.size());
+    }
+}
+
+TEST_CASE("Over-long lines are truncated and reported")
+{
+    analyzer_stream_t stream;
+    analyzer_stream_init(&stream);
+    std::vector<captured_line> lines;
+
+    std::string longline(ANALYZER_STREAM_LINE_MAX + 100, 'x');
+    feed(&stream, longline.substr(0, 200), lines);
+    feed(&stream, longline.substr(200) + "\nok\n", lines);
+
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].text.size() == ANALYZER_STREAM_LINE_MAX - 1);
+    CHECK(lines[0].flags == ANALYZER_LINE_TRUNCATED);
+    CHECK(lines[1].text == "ok");
+    CHECK(lines[1].flags == 0);
+    CHECK(stream.stats.truncated_lines == 1);
+    CHECK(stream.stats.truncated_bytes == 101);
+}
+
+TEST_CASE("Control and non-ASCII bytes are removed and reported")
+{
+    analyzer_stream_t stream;
+    analyzer_stream_init(&stream);
+    std::vector<captured_line> lines;
+
+    feed(&stream, std::string("He\x00 0.4\x7f %\xc2\xb0\n", 13) + "clean\n", lines);
+
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].text == "He 0.4 %");
+    CHECK(lines[0].flags == ANALYZER_LINE_FRAMING_ERROR);
+    CHECK(lines[1].flags == 0);
+    CHECK(stream.stats.invalid_bytes == 4);
+    CHECK(stream.stats.framing_errors == 1);
+}
+
+TEST_CASE("A line made only of invalid bytes is counted but not delivered")
+{
+    analyzer_stream_t stream;
+    analyzer_stream_init(&stream);
+    std::vector<captured_line> lines;
+
+    feed(&stream, std::string("\xff\xfe\x00\r\n", 5), lines);
+
+    CHECK(lines.empty());
+    CHECK(stream.stats.lines == 0);
+    CHECK(stream.stats.framing_errors == 1);
+    CHECK(stream.stats.invalid_bytes == 3);
+}
+
+TEST_CASE("Resetting the line drops the partial line but keeps counters")
+{
+    analyzer_stream_t stream;
+    analyzer_stream_init(&stream);
+    std::vector<captured_line> lines;
+
+    feed(&stream, "done\nhalf a li\x01", lines);
+    analyzer_stream_reset_line(&stream);
+    feed(&stream, "fresh\n", lines);
+
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[1].text == "fresh");
+    CHECK(lines[1].flags == 0);
+    CHECK(stream.stats.lines == 2);
+    CHECK(stream.stats.invalid_bytes == 1);
+}
@@ -0,0 +1,90 @@
+/*
+ * attach_timing phase accounting tests
+ */
+
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "attach_timing.h"
+}
+
+TEST_CASE("Attach phases are timed from the previous phase reached")
+{
+    attach_timing_t timing;
+    attach_timing_init(&timing);
+
+    // Nothing is recorded before an attach starts
+    CHECK_FALSE(attach_timing_mark(&timing, ATTACH_PHASE_OPENED, 500));
+
+    attach_timing_start(&timing, 1000, false);
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_OPENED, 4000));
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_CONFIGURED, 6000));
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_FIRST_DATA, 206000));
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_FIRST_LINE, 207000));
+
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_OPENED) == 3000);
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_CONFIGURED) == 2000);
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_FIRST_DATA) == 200000);
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_FIRST_LINE) == 1000);
+    CHECK(attach_timing_total_us(&timing, ATTACH_PHASE_FIRST_LINE) == 206000);
+
+    // Not subscribed yet: no notification
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_NOTIFIED) == -1);
+    CHECK(attach_timing_total_us(&timing, ATTACH_PHASE_NOTIFIED) == -1);
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_DETECTED) == -1);
+    CHECK(attach_timing_total_us(&timing, ATTACH_PHASE_DETECTED) == 0);
+}
+
+TEST_CASE("Only the first mark of a phase counts and skipped phases fold forward")
+{
+    attach_timing_t timing;
+    attach_timing_init(&timing);
+    attach_timing_start(&timing, 1000, true);
+    CHECK(timing.reattach);
+
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_OPENED, 2000));
+    CHECK_FALSE(attach_timing_mark(&timing, ATTACH_PHASE_OPENED, 3000));
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_OPENED) == 1000);
+
+    // Data arrived before the DTR request returned
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_FIRST_DATA, 2500));
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_CONFIGURED, 2600));
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_FIRST_DATA) == 0);
+
+    // Line framed but configuration never marked on the next attach
+    attach_timing_start(&timing, 10000, false);
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_OPENED, 11000));
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_FIRST_LINE, 15000));
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_FIRST_LINE) == 4000);
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_CONFIGURED) == -1);
+
+    // Marks from before the detection are clamped to it
+    attach_timing_start(&timing, 20000, false);
+    CHECK(attach_timing_mark(&timing, ATTACH_PHASE_OPENED, 19000));
+    CHECK(attach_timing_phase_us(&timing, ATTACH_PHASE_OPENED) == 0);
+}
+
+TEST_CASE("Plug-in to first line is summarised across attaches")
+{
+    attach_timing_t timing;
+    attach_timing_init(&timing);
+
+    const int64_t first_line_us[] = { 250000, 90000, 400000 };
+    int64_t t = 1000000;
+    for (int64_t latency : first_line_us) {
+        attach_timing_start(&timing, t, timing.attaches > 0);
+        attach_timing_mark(&timing, ATTACH_PHASE_FIRST_LINE, t + latency);
+        attach_timing_mark(&timing, ATTACH_PHASE_FIRST_LINE, t + latency + 1000000);
+        t += 10000000;
+    }
+    // Attach that never produced a line is not counted
+    attach_timing_start(&timing, t, true);
+    attach_timing_mark(&timing, ATTACH_PHASE_OPENED, t + 1000);
+
+    CHECK(timing.attaches == 3);
+    CHECK(timing.first_line_best_us == 90000);
+    CHECK(timing.first_line_worst_us == 400000);
+    CHECK(timing.first_line_sum_us == 740000);
+    CHECK(std::string(attach_phase_name(ATTACH_PHASE_FIRST_LINE)) == "first line");
+}
@@ -0,0 +1,416 @@
+/*
+ * ble_conn connection table and fan-out tests
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+extern "C" {
+#include "ble_conn.h"
+#include "reading_format.h"
+}
+
+namespace {
+
+const uint8_t BDA[6] = { 1, 2, 3, 4, 5, 6 };
+const uint8_t BDA2[6] = { 6, 5, 4, 3, 2, 1 };
+
+uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+struct sent_log {
+    std::vector<uint16_t> conn_ids;
+    bool accept = true;
+};
+
+bool record_send(const ble_conn_t *conn, const uint8_t *data, size_t len, void *ctx)
+{
+    auto *log = static_cast<sent_log *>(ctx);
+    log->conn_ids.push_back(conn->conn_id);
+    return log->accept;
+}
+
+// Stands in for the stack: copies the payload into a per-connection buffer
+struct copy_sink {
+    uint8_t buf[BLE_CONN_MAX][READING_BATCH_MAX_SIZE];
+    uint32_t checksum = 0;
+};
+
+bool copy_send(const ble_conn_t *conn, const uint8_t *data, size_t len, void *ctx)
+{
+    auto *sink = static_cast<copy_sink *>(ctx);
+    uint8_t *dst = sink->buf[conn->conn_id % BLE_CONN_MAX];
+    memcpy(dst, data, len);
+    sink->checksum += dst[len - 1];
+    return true;
+}
+
+// Table lock that records how it is used
+struct lock_log {
+    bool held = false;
+    int takes = 0;
+    bool sent_locked = false;
+    ble_conn_table_t *table = nullptr;
+    uint16_t drop_conn_id = 0xFFFF;    // Replaced by conn 7 during the first send
+};
+
+void log_lock(void *ctx)
+{
+    auto *log = static_cast<lock_log *>(ctx);
+    REQUIRE(!log->held);
+    log->held = true;
+    log->takes++;
+}
+
+void log_unlock(void *ctx)
+{
+    auto *log = static_cast<lock_log *>(ctx);
+    REQUIRE(log->held);
+    log->held = false;
+}
+
+bool locked_send(const ble_conn_t *conn, const uint8_t *data, size_t len, void *ctx)
+{
+    auto *log = static_cast<lock_log *>(ctx);
+    log->sent_locked |= log->held;
+    if (log->drop_conn_id != 0xFFFF) {
+        ble_conn_table_lock(log->table);
+        ble_conn_remove(log->table, log->drop_conn_id);
+        ble_conn_add(log->table, 7, BDA2);
+        ble_conn_table_unlock(log->table);
+        log->drop_conn_id = 0xFFFF;
+    }
+    return true;
+}
+
+ble_conn_t *subscribed_conn(ble_conn_table_t *table, uint16_t conn_id, uint16_t mtu)
+{
+    ble_conn_t *conn = ble_conn_add(table, conn_id, BDA);
+    REQUIRE(conn != nullptr);
+    conn->mtu = mtu;
+    conn->cccd[BLE_CONN_CHAR_READING] = BLE_CONN_CCCD_NOTIFY;
+    return conn;
+}
+
+} // namespace
+
+TEST_CASE("Connections are added, found and removed independently")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    CHECK(ble_conn_count(&table) == 0);
+
+    ble_conn_t *a = ble_conn_add(&table, 0, BDA);
+    ble_conn_t *b = ble_conn_add(&table, 1, BDA);
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    CHECK(a->mtu == BLE_ATT_DEFAULT_MTU);
+    CHECK(ble_conn_count(&table) == 2);
+    CHECK(ble_conn_find(&table, 1) == b);
+
+    // Disconnecting one client leaves the other untouched
+    ble_conn_remove(&table, 0);
+    CHECK(ble_conn_find(&table, 0) == nullptr);
+    CHECK(ble_conn_find(&table, 1) == b);
+    CHECK(ble_conn_count(&table) == 1);
+
+    ble_conn_remove(&table, 7);  // Unknown id is ignored
+    CHECK(ble_conn_count(&table) == 1);
+}
+
+TEST_CASE("The table refuses connections beyond BLE_CONN_MAX")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    for (uint16_t id = 0; id < BLE_CONN_MAX; id++) {
+        REQUIRE(ble_conn_add(&table, id, BDA) != nullptr);
+    }
+    CHECK(ble_conn_add(&table, BLE_CONN_MAX, BDA) == nullptr);
+
+    // A repeated connect for a known id reuses its slot with fresh state
+    ble_conn_find(&table, 2)->cccd[BLE_CONN_CHAR_TEXT] = BLE_CONN_CCCD_NOTIFY;
+    ble_conn_t *again = ble_conn_add(&table, 2, BDA);
+    REQUIRE(again != nullptr);
+    CHECK(again->cccd[BLE_CONN_CHAR_TEXT] == 0);
+    CHECK(ble_conn_count(&table) == BLE_CONN_MAX);
+}
+
+TEST_CASE("Fan-out reaches only subscribed, uncongested connections")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    subscribed_conn(&table, 0, 185);
+    ble_conn_t *congested = subscribed_conn(&table, 1, 185);
+    ble_conn_add(&table, 2, BDA);  // Connected, never subscribed
+    ble_conn_t *text_only = ble_conn_add(&table, 3, BDA);
+    text_only->cccd[BLE_CONN_CHAR_TEXT] = BLE_CONN_CCCD_NOTIFY;
+    congested->congested = true;
+
+    CHECK(ble_conn_subscribers(&table, BLE_CONN_CHAR_READING) == 2);
+    CHECK(!ble_conn_all_congested(&table));
+
+    uint8_t payload[17] = {};
+    sent_log log;
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, sizeof(payload), record_send, &log) == 1);
+    CHECK(log.conn_ids == std::vector<uint16_t>{ 0 });
+    CHECK(ble_conn_find(&table, 0)->sent == 1);
+    CHECK(congested->dropped == 1);
+
+    // Unsubscribing stops delivery
+    ble_conn_find(&table, 0)->cccd[BLE_CONN_CHAR_READING] = 0;
+    log.conn_ids.clear();
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, sizeof(payload), record_send, &log) == 0);
+    CHECK(log.conn_ids.empty());
+}
+
+TEST_CASE("CCCD writes report when a subscription turns on")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_t *conn = ble_conn_add(&table, 0, BDA);
+
+    CHECK(ble_conn_set_cccd(conn, BLE_CONN_CHAR_TEXT, BLE_CONN_CCCD_NOTIFY));
+    CHECK(ble_conn_subscribed(conn, BLE_CONN_CHAR_TEXT));
+    CHECK(!ble_conn_subscribed(conn, BLE_CONN_CHAR_READING));
+
+    // Rewriting an enabled CCCD does not push the cached reading again
+    CHECK(!ble_conn_set_cccd(conn, BLE_CONN_CHAR_TEXT, BLE_CONN_CCCD_NOTIFY));
+    CHECK(!ble_conn_set_cccd(conn, BLE_CONN_CHAR_TEXT, BLE_CONN_CCCD_NOTIFY | BLE_CONN_CCCD_INDICATE));
+
+    // Disabling and enabling again does
+    CHECK(!ble_conn_set_cccd(conn, BLE_CONN_CHAR_TEXT, 0));
+    CHECK(!ble_conn_subscribed(conn, BLE_CONN_CHAR_TEXT));
+    CHECK(ble_conn_set_cccd(conn, BLE_CONN_CHAR_TEXT, BLE_CONN_CCCD_NOTIFY));
+
+    // Unknown bits alone do not subscribe
+    CHECK(!ble_conn_set_cccd(conn, BLE_CONN_CHAR_READING, 0x0004));
+    CHECK(!ble_conn_subscribed(conn, BLE_CONN_CHAR_READING));
+}
+
+TEST_CASE("Indications are used only when notifications are off")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_t *conn = ble_conn_add(&table, 0, BDA);
+
+    CHECK(!ble_conn_wants_indication(conn, BLE_CONN_CHAR_READING));
+    ble_conn_set_cccd(conn, BLE_CONN_CHAR_READING, BLE_CONN_CCCD_INDICATE);
+    CHECK(ble_conn_subscribed(conn, BLE_CONN_CHAR_READING));
+    CHECK(ble_conn_wants_indication(conn, BLE_CONN_CHAR_READING));
+    ble_conn_set_cccd(conn, BLE_CONN_CHAR_READING, BLE_CONN_CCCD_NOTIFY | BLE_CONN_CCCD_INDICATE);
+    CHECK(!ble_conn_wants_indication(conn, BLE_CONN_CHAR_READING));
+}
+
+TEST_CASE("Payloads are sized for the smallest subscriber MTU")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    CHECK(ble_conn_min_mtu(&table, BLE_CONN_CHAR_READING) == BLE_ATT_DEFAULT_MTU);
+
+    subscribed_conn(&table, 0, 185);
+    ble_conn_t *small = subscribed_conn(&table, 1, 23);
+    ble_conn_t *big_unsubscribed = ble_conn_add(&table, 2, BDA);
+    big_unsubscribed->mtu = 517;
+    CHECK(ble_conn_min_mtu(&table, BLE_CONN_CHAR_READING) == 23);
+
+    // A payload built before the small client subscribed is skipped for it only
+    uint8_t payload[READING_BATCH_MAX_SIZE] = {};
+    sent_log log;
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, 182, record_send, &log) == 1);
+    CHECK(small->dropped == 1);
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, 20, record_send, &log) == 2);
+}
+
+TEST_CASE("Data is held back only when every connection is congested")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    CHECK(!ble_conn_all_congested(&table));  // Nobody connected: nothing to wait for
+
+    ble_conn_t *a = subscribed_conn(&table, 0, 185);
+    ble_conn_t *b = subscribed_conn(&table, 1, 185);
+    a->congested = true;
+    CHECK(!ble_conn_all_congested(&table));
+    b->congested = true;
+    CHECK(ble_conn_all_congested(&table));
+
+    ble_conn_remove(&table, 1);
+    CHECK(ble_conn_all_congested(&table));
+    a->congested = false;
+    CHECK(!ble_conn_all_congested(&table));
+}
+
+TEST_CASE("A rejected send counts as dropped")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_t *conn = subscribed_conn(&table, 0, 185);
+
+    uint8_t payload[4] = {};
+    sent_log log;
+    log.accept = false;
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, sizeof(payload), record_send, &log) == 0);
+    CHECK(conn->sent == 0);
+    CHECK(conn->dropped == 1);
+}
+
+TEST_CASE("Fan-out sends with the table lock released")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_t *a = subscribed_conn(&table, 0, 185);
+    ble_conn_t *b = subscribed_conn(&table, 1, 185);
+    lock_log log;
+    log.table = &table;
+    ble_conn_table_set_lock(&table, log_lock, log_unlock, &log);
+
+    uint8_t payload[4] = {};
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, sizeof(payload), locked_send, &log) == 2);
+    CHECK(!log.sent_locked);
+    CHECK(!log.held);
+    CHECK(log.takes == 2);  // Once to pick the receivers, once to count
+    CHECK(a->sent == 1);
+    CHECK(b->sent == 1);
+
+    // A client that disconnects while the sends run is not counted, even
+    // when a new connection has taken its slot
+    log.drop_conn_id = 1;
+    CHECK(ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, sizeof(payload), locked_send, &log) == 2);
+    CHECK(a->sent == 2);
+    ble_conn_t *c = ble_conn_find(&table, 7);
+    REQUIRE(c == b);
+    CHECK(c->sent == 0);
+    CHECK(c->dropped == 0);
+}
+
+TEST_CASE("GAP events find their connection by peer address")
+{
+    const uint8_t other[6] = { 9, 9, 9, 9, 9, 9 };
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_t *a = ble_conn_add(&table, 0, BDA);
+    ble_conn_t *b = ble_conn_add(&table, 1, other);
+
+    CHECK(ble_conn_find_bda(&table, BDA) == a);
+    CHECK(ble_conn_find_bda(&table, other) == b);
+    ble_conn_remove(&table, 1);
+    CHECK(ble_conn_find_bda(&table, other) == nullptr);
+}
+
+TEST_CASE("Throughput is measured over one-second windows")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_t *conn = subscribed_conn(&table, 0, 185);
+
+    ble_conn_update_rate(conn, 10000);  // Opens the first window
+    uint8_t payload[100] = {};
+    sent_log log;
+    for (int i = 0; i < 30; i++) {
+        ble_conn_fanout(&table, BLE_CONN_CHAR_READING, payload, sizeof(payload), record_send, &log);
+    }
+    ble_conn_account(conn, 500, true);  // A direct send, e.g. history
+    ble_conn_account(conn, 500, false);
+
+    ble_conn_update_rate(conn, 10500);  // Window still open
+    CHECK(conn->tx_rate == 0);
+    ble_conn_update_rate(conn, 12000);
+    CHECK(conn->tx_rate == 1750);       // 3500 bytes over 2 s
+    CHECK(conn->tx_bytes == 3500);
+    CHECK(conn->sent == 31);
+    CHECK(conn->dropped == 1);
+
+    ble_conn_update_rate(conn, 13000);  // Nothing sent in the next window
+    CHECK(conn->tx_rate == 0);
+}
+
+TEST_CASE("Diagnostics packet layout")
+{
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    ble_conn_add(&table, 0, BDA);
+    ble_conn_t *conn = ble_conn_add(&table, 1, BDA2);
+    CHECK(conn->tx_phy == BLE_CONN_PHY_1M);
+    CHECK(conn->tx_data_len == BLE_LL_DEFAULT_DATA_LEN);
+
+    conn->tx_phy = BLE_CONN_PHY_2M;
+    conn->rx_phy = BLE_CONN_PHY_2M;
+    conn->mtu = 185;
+    conn->tx_data_len = 251;
+    conn->rx_data_len = 251;
+    conn->interval = 24;
+    conn->latency = 4;
+    conn->timeout = 400;
+    conn->tx_rate = 0x12345;
+    conn->sent = 70000;
+    conn->dropped = 3;
+
+    uint8_t buf[BLE_CONN_DIAG_SIZE];
+    REQUIRE(ble_conn_encode_diagnostics(&table, conn, buf) == BLE_CONN_DIAG_SIZE);
+    CHECK(buf[0] == BLE_CONN_DIAG_VERSION);
+    CHECK(buf[1] == BLE_CONN_PHY_2M);
+    CHECK(buf[2] == BLE_CONN_PHY_2M);
+    CHECK(buf[3] == 2);
+    CHECK(get_u16(&buf[4]) == 185);
+    CHECK(get_u16(&buf[6]) == 251);
+    CHECK(get_u16(&buf[8]) == 251);
+    CHECK(get_u16(&buf[10]) == 24);
+    CHECK(get_u16(&buf[12]) == 4);
+    CHECK(get_u16(&buf[14]) == 400);
+    CHECK(get_u32(&buf[16]) == 0x12345);
+    CHECK(get_u32(&buf[20]) == 70000);
+    CHECK(get_u32(&buf[24]) == 3);
+}
+
+TEST_CASE("Fan-out cost by client count", "[benchmark]")
+{
+    constexpr int ITERATIONS = 200000;
+
+    // One single-reading v2 batch, as sent at one reading per second
+    gas_reading_t reading = {};
+    reading.o2_x10 = 209;
+    reading_batch_t batch;
+    reading_batch_init(&batch, 182);
+    reading_batch_add(&batch, 1, &reading);
+
+    copy_sink sink;
+    for (uint16_t clients = 1; clients <= BLE_CONN_MAX; clients++) {
+        ble_conn_table_t table;
+        ble_conn_table_init(&table);
+        for (uint16_t id = 0; id < clients; id++) {
+            subscribed_conn(&table, id, 185);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            ble_conn_fanout(&table, BLE_CONN_CHAR_READING, batch.buf, batch.len, copy_send, &sink);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+        printf("Fan-out: %u client(s), %.1f ns per reading, %.1f ns per client\n",
+               clients, ns / ITERATIONS, ns / ITERATIONS / clients);
+        CHECK(table.conns[clients - 1].sent == (uint32_t)ITERATIONS);
+    }
+
+    ble_conn_table_t table;
+    ble_conn_table_init(&table);
+    for (uint16_t id = 0; id < BLE_CONN_MAX; id++) {
+        subscribed_conn(&table, id, 185);
+    }
+    BENCHMARK("ble_conn_fanout, BLE_CONN_MAX clients") {
+        return ble_conn_fanout(&table, BLE_CONN_CHAR_READING, batch.buf, batch.len, copy_send, &sink);
+    };
+    CHECK(sink.checksum != 0xFFFFFFFFu);
+}
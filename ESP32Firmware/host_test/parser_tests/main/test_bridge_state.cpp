@@ -0,0 +1,328 @@
+/*
+ * bridge_state event handling and attach-to-first-notification latency tests
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "analyzer_stream.h"
+#include "ble_conn.h"
+#include "bridge_state.h"
+#include "divesoft_parser.h"
+#include "reading_format.h"
+}
+#include "analyzer_streams.hpp"
+
+namespace {
+
+const uint32_t ANALYZER = (0xA600u << 16) | 0xE212u;
+
+uint32_t post(bridge_state_t *state, bridge_event_type_t type, int64_t time_us, uint32_t arg = 0,
+              uint8_t device = 0)
+{
+    bridge_event_t event = { type, device, time_us, arg };
+    return bridge_state_handle(state, &event);
+}
+
+// Attach of the device at a USB address; post() attaches at address 0
+uint32_t post_attach(bridge_state_t *state, int64_t time_us, uint32_t arg, uint8_t address)
+{
+    bridge_event_t event = { BRIDGE_EV_USB_ATTACHED, 0, time_us, arg, address };
+    return bridge_state_handle(state, &event);
+}
+
+// Per-device event for a slot other than the first
+uint32_t post_to(bridge_state_t *state, uint8_t device, bridge_event_type_t type, int64_t time_us)
+{
+    return post(state, type, time_us, 0, device);
+}
+
+int64_t now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// What the CDC driver task and the notify task do with the first line
+struct first_line_path {
+    ble_conn_table_t table;
+    bool armed = false;
+    int64_t notified_us = 0;
+};
+
+bool accept_send(const ble_conn_t *conn, const uint8_t *data, size_t len, void *ctx)
+{
+    return true;
+}
+
+void notify_line(const char *line, size_t len, uint8_t flags, void *ctx)
+{
+    auto *path = static_cast<first_line_path *>(ctx);
+    gas_reading_t reading;
+    if (!divesoft_parse_line(line, len, &reading)) {
+        return;
+    }
+    uint8_t buf[READING_FORMAT_SIZE];
+    size_t n = reading_format_encode(&reading, buf);
+    size_t sent = ble_conn_fanout(&path->table, BLE_CONN_CHAR_READING, buf, n, accept_send, nullptr);
+    if (sent > 0 && path->armed) {
+        path->armed = false;
+        path->notified_us = now_us();
+    }
+}
+
+} // namespace
+
+TEST_CASE("Attach opens the device at once and detach closes it")
+{
+    bridge_state_t state;
+    bridge_state_init(&state);
+    const bridge_device_t &dev = state.devices[0];
+    CHECK(dev.usb == BRIDGE_USB_IDLE);
+
+    CHECK(post(&state, BRIDGE_EV_USB_ATTACHED, 1000, ANALYZER) == BRIDGE_ACTION_OPEN_DEVICE);
+    CHECK(state.current == 0);
+    CHECK(dev.usb == BRIDGE_USB_OPENING);
+    CHECK(dev.vid == 0xA600);
+    CHECK(dev.pid == 0xE212);
+
+    // The same device again while it is in use is ignored
+    CHECK(post(&state, BRIDGE_EV_USB_ATTACHED, 1500, ANALYZER) == 0);
+    CHECK(state.rejected == 1);
+    CHECK(bridge_state_active_devices(&state) == 1);
+
+    CHECK(post(&state, BRIDGE_EV_USB_OPENED, 2000) == BRIDGE_ACTION_ARM_NOTIFY);
+    CHECK(dev.usb == BRIDGE_USB_STREAMING);
+    CHECK(state.attaches == 1);
+
+    CHECK(post(&state, BRIDGE_EV_USB_DETACHED, 3000) == BRIDGE_ACTION_CLOSE_DEVICE);
+    CHECK(dev.usb == BRIDGE_USB_IDLE);
+    CHECK(post(&state, BRIDGE_EV_USB_DETACHED, 3100) == 0);
+    CHECK(bridge_state_active_devices(&state) == 0);
+}
+
+TEST_CASE("Failed opens return to idle and data timeouts reopen the device")
+{
+    bridge_state_t state;
+    bridge_state_init(&state);
+    const bridge_device_t &dev = state.devices[0];
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 1000, ANALYZER);
+    CHECK(post(&state, BRIDGE_EV_USB_OPEN_FAILED, 1100) == 0);
+    CHECK(dev.usb == BRIDGE_USB_IDLE);
+    CHECK(state.open_failures == 1);
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 2000, ANALYZER);
+    CHECK(state.current == 0);
+    CHECK_FALSE(dev.reattach);  // Never opened before
+    post(&state, BRIDGE_EV_USB_OPENED, 2100);
+    CHECK(post(&state, BRIDGE_EV_DATA_TIMEOUT, 8000) ==
+          (BRIDGE_ACTION_CLOSE_DEVICE | BRIDGE_ACTION_OPEN_DEVICE));
+    CHECK(dev.usb == BRIDGE_USB_OPENING);
+    CHECK(dev.reattach);
+    CHECK(dev.vid == 0xA600);
+    CHECK(state.data_timeouts == 1);
+
+    // A late notification from the closed device is not measured
+    CHECK(post(&state, BRIDGE_EV_NOTIFIED, 8100) == 0);
+    CHECK(dev.attach_latency_us == -1);
+
+    // The device went away after all
+    CHECK(post(&state, BRIDGE_EV_USB_OPEN_FAILED, 8200) == 0);
+    CHECK(dev.usb == BRIDGE_USB_IDLE);
+    CHECK(post(&state, BRIDGE_EV_DATA_TIMEOUT, 14000) == 0);
+}
+
+TEST_CASE("A replug of the last analyzer is a reattach")
+{
+    bridge_state_t state;
+    bridge_state_init(&state);
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 1000, ANALYZER);
+    post(&state, BRIDGE_EV_USB_OPENED, 1100);
+    CHECK(post(&state, BRIDGE_EV_FIRST_LINE, 1200) == 0);  // Timing only
+    CHECK(state.devices[0].usb == BRIDGE_USB_STREAMING);
+    post(&state, BRIDGE_EV_USB_DETACHED, 2000);
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 3000, ANALYZER);
+    CHECK(state.current == 0);
+    CHECK(state.devices[0].reattach);
+    post(&state, BRIDGE_EV_USB_OPENED, 3100);
+    post(&state, BRIDGE_EV_USB_DETACHED, 4000);
+
+    // A different analyzer takes a fresh slot, keeping the first one's
+    // channel free for when it comes back
+    post(&state, BRIDGE_EV_USB_ATTACHED, 5000, 0x10C4EA60u);
+    CHECK(state.current == 1);
+    CHECK_FALSE(state.devices[1].reattach);
+    post_to(&state, 1, BRIDGE_EV_USB_OPENED, 5100);
+    CHECK(state.devices[1].vid == 0x10C4);
+    CHECK(state.devices[1].pid == 0xEA60);
+    CHECK(state.devices[0].vid == 0xA600);
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 6000, ANALYZER);
+    CHECK(state.current == 0);
+    CHECK(state.devices[0].reattach);
+}
+
+TEST_CASE("Analyzers behind a hub get their own slots and do not disturb each other")
+{
+    const uint32_t analyzers[BRIDGE_DEVICE_MAX] = { ANALYZER, 0x10C4EA60u, 0x04036001u, 0x1A867523u };
+    bridge_state_t state;
+    bridge_state_init(&state);
+
+    for (uint8_t i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+        CHECK(post_attach(&state, 1000 + i, analyzers[i], i + 1) == BRIDGE_ACTION_OPEN_DEVICE);
+        CHECK(state.current == i);
+        CHECK(post_to(&state, i, BRIDGE_EV_USB_OPENED, 2000 + i) == BRIDGE_ACTION_ARM_NOTIFY);
+    }
+    CHECK(bridge_state_active_devices(&state) == BRIDGE_DEVICE_MAX);
+
+    // No slot left for a fifth
+    CHECK(post_attach(&state, 3000, 0x067B2303u, BRIDGE_DEVICE_MAX + 1) == 0);
+    CHECK(state.rejected == 1);
+
+    // Unplugging one closes only that one
+    CHECK(post_to(&state, 2, BRIDGE_EV_USB_DETACHED, 4000) == BRIDGE_ACTION_CLOSE_DEVICE);
+    CHECK(state.current == 2);
+    for (uint8_t i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+        CHECK(state.devices[i].usb == (i == 2 ? BRIDGE_USB_IDLE : BRIDGE_USB_STREAMING));
+    }
+
+    // A timeout on another reopens only that one
+    CHECK(post_to(&state, 1, BRIDGE_EV_DATA_TIMEOUT, 9000) ==
+          (BRIDGE_ACTION_CLOSE_DEVICE | BRIDGE_ACTION_OPEN_DEVICE));
+    CHECK(state.current == 1);
+    CHECK(state.devices[0].usb == BRIDGE_USB_STREAMING);
+    CHECK(state.devices[1].usb == BRIDGE_USB_OPENING);
+    CHECK(state.devices[3].usb == BRIDGE_USB_STREAMING);
+
+    // The fifth device now fits in the freed slot
+    CHECK(post_attach(&state, 9500, 0x067B2303u, BRIDGE_DEVICE_MAX + 1) == BRIDGE_ACTION_OPEN_DEVICE);
+    CHECK(state.current == 2);
+    CHECK_FALSE(state.devices[2].reattach);
+
+    // Latency is measured per device
+    CHECK(post_to(&state, 3, BRIDGE_EV_NOTIFIED, 10003) == BRIDGE_ACTION_REPORT_LATENCY);
+    CHECK(state.devices[3].attach_latency_us == 9000);
+    CHECK(state.devices[0].attach_latency_us == -1);
+    CHECK(post_to(&state, 0, BRIDGE_EV_NOTIFIED, 11000) == BRIDGE_ACTION_REPORT_LATENCY);
+    CHECK(state.devices[0].attach_latency_us == 10000);
+
+    // Events naming a slot that does not exist are ignored
+    CHECK(post_to(&state, BRIDGE_DEVICE_MAX, BRIDGE_EV_USB_DETACHED, 12000) == 0);
+}
+
+TEST_CASE("Analyzers of the same model are told apart by address")
+{
+    bridge_state_t state;
+    bridge_state_init(&state);
+
+    CHECK(post_attach(&state, 1000, ANALYZER, 3) == BRIDGE_ACTION_OPEN_DEVICE);
+    CHECK(state.current == 0);
+    post_to(&state, 0, BRIDGE_EV_USB_OPENED, 1100);
+    CHECK(post_attach(&state, 1200, ANALYZER, 4) == BRIDGE_ACTION_OPEN_DEVICE);
+    CHECK(state.current == 1);
+    CHECK(state.devices[1].address == 4);
+    post_to(&state, 1, BRIDGE_EV_USB_OPENED, 1300);
+    CHECK(bridge_state_active_devices(&state) == 2);
+
+    // A repeated attach of an open device is still ignored
+    CHECK(post_attach(&state, 1400, ANALYZER, 4) == 0);
+    CHECK(state.rejected == 1);
+
+    // The second one is replugged at a new address and gets a slot its model had
+    post_to(&state, 1, BRIDGE_EV_USB_DETACHED, 2000);
+    CHECK(post_attach(&state, 3000, ANALYZER, 5) == BRIDGE_ACTION_OPEN_DEVICE);
+    CHECK(state.current == 1);
+    CHECK(state.devices[1].reattach);
+    CHECK(state.devices[1].address == 5);
+    CHECK(state.devices[0].address == 3);
+}
+
+TEST_CASE("BLE clients are counted and OTA stops everything")
+{
+    bridge_state_t state;
+    bridge_state_init(&state);
+
+    post(&state, BRIDGE_EV_BLE_CONNECTED, 100, 0);
+    post(&state, BRIDGE_EV_BLE_CONNECTED, 200, 1);
+    post(&state, BRIDGE_EV_BLE_DISCONNECTED, 300, 0);
+    CHECK(state.ble_clients == 1);
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 1000, ANALYZER);
+    post(&state, BRIDGE_EV_USB_OPENED, 1100);
+    post_attach(&state, 1200, 0x10C4EA60u, 1);
+    CHECK(post(&state, BRIDGE_EV_OTA_REQUESTED, 2000) == BRIDGE_ACTION_START_OTA);
+    CHECK(state.ota);
+    CHECK(bridge_state_active_devices(&state) == 0);
+
+    CHECK(post(&state, BRIDGE_EV_USB_ATTACHED, 3000, ANALYZER) == 0);
+    CHECK(post(&state, BRIDGE_EV_OTA_REQUESTED, 3000) == 0);
+}
+
+TEST_CASE("Attach latency runs to the first notification, or from a later subscription")
+{
+    bridge_state_t state;
+    bridge_state_init(&state);
+
+    post(&state, BRIDGE_EV_USB_ATTACHED, 10000, ANALYZER);
+    post(&state, BRIDGE_EV_USB_OPENED, 60000);
+    CHECK(post(&state, BRIDGE_EV_NOTIFIED, 1010000) == BRIDGE_ACTION_REPORT_LATENCY);
+    CHECK(state.devices[0].attach_latency_us == 1000000);
+    CHECK(post(&state, BRIDGE_EV_NOTIFIED, 2010000) == 0);  // Measured once per attach
+
+    // Nobody subscribed until 5 s after the analyzer came up
+    post(&state, BRIDGE_EV_USB_DETACHED, 3000000);
+    post(&state, BRIDGE_EV_USB_ATTACHED, 4000000, ANALYZER);
+    post(&state, BRIDGE_EV_USB_OPENED, 4050000);
+    post(&state, BRIDGE_EV_BLE_SUBSCRIBED, 9000000, 0);
+    CHECK(post(&state, BRIDGE_EV_NOTIFIED, 9300000) == BRIDGE_ACTION_REPORT_LATENCY);
+    CHECK(state.devices[0].attach_latency_us == 300000);
+}
+
+TEST_CASE("Attach to first notification latency", "[benchmark]")
+{
+    constexpr int ATTACHES = 10000;
+    const std::string first_line = analyzer_streams::reading_line("35.0", "21.0", 72.5, 29.92, 0) + "\r\n";
+
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+    for (int i = 0; i < ATTACHES; i++) {
+        bridge_state_t state;
+        bridge_state_init(&state);
+        first_line_path path;
+        ble_conn_table_init(&path.table);
+        ble_conn_t *conn = ble_conn_add(&path.table, 0, (const uint8_t *)"\x01\x02\x03\x04\x05\x06");
+        conn->cccd[BLE_CONN_CHAR_READING] = BLE_CONN_CCCD_NOTIFY;
+        analyzer_stream_t stream;
+        analyzer_stream_init(&stream);
+
+        // Device appears; the open itself is the USB stack's time, not ours
+        uint32_t actions = post(&state, BRIDGE_EV_USB_ATTACHED, now_us(), ANALYZER);
+        REQUIRE(actions == BRIDGE_ACTION_OPEN_DEVICE);
+        actions = post(&state, BRIDGE_EV_USB_OPENED, now_us());
+        path.armed = (actions & BRIDGE_ACTION_ARM_NOTIFY) != 0;
+
+        // First USB packet carries a whole line
+        analyzer_stream_feed(&stream, (const uint8_t *)first_line.data(), first_line.size(),
+                             notify_line, &path);
+        REQUIRE(path.notified_us != 0);
+        REQUIRE(post(&state, BRIDGE_EV_NOTIFIED, path.notified_us) == BRIDGE_ACTION_REPORT_LATENCY);
+
+        int64_t latency_us = state.devices[0].attach_latency_us;
+        total_us += latency_us;
+        if (latency_us > max_us) {
+            max_us = latency_us;
+        }
+    }
+
+    // The firmware adds only the USB open and the analyzer's own output
+    // interval; no polling period is left in the path
+    printf("Attach to first notification (excluding USB open): %.2f us mean, %lld us max\n",
+           (double)total_us / ATTACHES, (long long)max_us);
+    CHECK(max_us < 100000);
+}
@@ -0,0 +1,129 @@
+/*
+ * conn_policy connection parameter controller tests
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "conn_policy.h"
+}
+
+namespace {
+
+conn_params_t profile(conn_profile_t p)
+{
+    conn_params_t params;
+    conn_policy_profile_params(p, &params);
+    return params;
+}
+
+// Connection whose initial active-profile request the central granted
+conn_policy_t settled_active(uint32_t now_ms)
+{
+    conn_policy_t policy;
+    conn_policy_init(&policy, now_ms);
+    conn_policy_result(&policy, now_ms, true, profile(CONN_PROFILE_ACTIVE).max_int);
+    REQUIRE(policy.settled);
+    return policy;
+}
+
+} // namespace
+
+TEST_CASE("Both profiles satisfy Apple's connection parameter rules")
+{
+    conn_params_t active = profile(CONN_PROFILE_ACTIVE);
+    conn_params_t idle = profile(CONN_PROFILE_IDLE);
+    CHECK(conn_policy_params_valid(&active));
+    CHECK(conn_policy_params_valid(&idle));
+    CHECK(active.latency == 0);
+    CHECK(idle.max_int * (idle.latency + 1) > active.max_int * 4);
+
+    conn_params_t too_fast = { 6, 12, 0, 400 };          // 7.5 ms minimum
+    conn_params_t narrow = { 24, 28, 0, 400 };           // max < min + 15 ms
+    conn_params_t short_timeout = { 12, 24, 0, 100 };    // 1 s supervision timeout
+    conn_params_t slow_effective = { 72, 96, 20, 600 };  // 2.5 s between events
+    CHECK_FALSE(conn_policy_params_valid(&too_fast));
+    CHECK_FALSE(conn_policy_params_valid(&narrow));
+    CHECK_FALSE(conn_policy_params_valid(&short_timeout));
+    CHECK_FALSE(conn_policy_params_valid(&slow_effective));
+}
+
+TEST_CASE("Policy steps to the idle profile when readings stop and back on activity")
+{
+    conn_policy_t policy = settled_active(0);
+    conn_params_t params;
+
+    CHECK_FALSE(conn_policy_poll(&policy, 5000, 5000, &params));
+    CHECK_FALSE(conn_policy_poll(&policy, 9999, CONN_POLICY_IDLE_MS - 1, &params));
+
+    REQUIRE(conn_policy_poll(&policy, 10000, CONN_POLICY_IDLE_MS, &params));
+    CHECK(params.min_int == profile(CONN_PROFILE_IDLE).min_int);
+    CHECK(params.latency == profile(CONN_PROFILE_IDLE).latency);
+    CHECK(policy.pending);
+
+    // Nothing more while the request is outstanding
+    CHECK_FALSE(conn_policy_poll(&policy, 11000, 11000, &params));
+    conn_policy_result(&policy, 11000, true, profile(CONN_PROFILE_IDLE).min_int);
+    CHECK(policy.settled);
+    CHECK_FALSE(conn_policy_poll(&policy, 20000, 20000, &params));
+
+    // A reading (or a backfill, reported as idle 0) brings back the active profile
+    REQUIRE(conn_policy_poll(&policy, 21000, 0, &params));
+    CHECK(params.max_int == profile(CONN_PROFILE_ACTIVE).max_int);
+    CHECK(params.latency == 0);
+}
+
+TEST_CASE("Rejected requests are retried with a doubling back-off, then given up")
+{
+    conn_policy_t policy = settled_active(0);
+    conn_params_t params;
+
+    REQUIRE(conn_policy_poll(&policy, 10000, 10000, &params));
+    conn_policy_result(&policy, 10000, false, 0);
+    CHECK(policy.retries == 1);
+    CHECK_FALSE(conn_policy_poll(&policy, 10000 + CONN_POLICY_RETRY_MS - 1, 20000, &params));
+    REQUIRE(conn_policy_poll(&policy, 10000 + CONN_POLICY_RETRY_MS, 20000, &params));
+
+    uint32_t now = 10000 + CONN_POLICY_RETRY_MS;
+    conn_policy_result(&policy, now, false, 0);
+    CHECK(policy.retries == 2);
+    CHECK_FALSE(conn_policy_poll(&policy, now + 2 * CONN_POLICY_RETRY_MS - 1, 30000, &params));
+    REQUIRE(conn_policy_poll(&policy, now + 2 * CONN_POLICY_RETRY_MS, 30000, &params));
+
+    now += 2 * CONN_POLICY_RETRY_MS;
+    conn_policy_result(&policy, now, false, 0);
+    CHECK(policy.retries == CONN_POLICY_MAX_RETRIES);
+    CHECK(policy.settled);
+    CHECK_FALSE(conn_policy_poll(&policy, now + 600000, 600000, &params));
+
+    // A profile change starts over
+    REQUIRE(conn_policy_poll(&policy, now + 600001, 0, &params));
+    CHECK(policy.retries == 0);
+}
+
+TEST_CASE("An interval granted outside the requested range is retried")
+{
+    conn_policy_t policy;
+    conn_params_t params;
+    conn_policy_init(&policy, 0);
+
+    // Central kept its own 45 ms interval
+    conn_policy_result(&policy, 100, true, 36);
+    CHECK_FALSE(policy.settled);
+    CHECK(policy.retries == 1);
+    REQUIRE(conn_policy_poll(&policy, 100 + CONN_POLICY_RETRY_MS, 0, &params));
+    CHECK(params.min_int == profile(CONN_PROFILE_ACTIVE).min_int);
+}
+
+TEST_CASE("An unanswered request counts as failed after the pending timeout")
+{
+    conn_policy_t policy;
+    conn_params_t params;
+    conn_policy_init(&policy, 0);
+
+    CHECK_FALSE(conn_policy_poll(&policy, CONN_POLICY_PENDING_MS - 1, 0, &params));
+    CHECK_FALSE(conn_policy_poll(&policy, CONN_POLICY_PENDING_MS, 0, &params));
+    CHECK(policy.retries == 1);
+    CHECK_FALSE(policy.pending);
+    CHECK(conn_policy_poll(&policy, CONN_POLICY_PENDING_MS + CONN_POLICY_RETRY_MS, 0, &params));
+}
@@ -0,0 +1,142 @@
+/*
+ * divesoft_parser and reading_format tests
+ */
+
+#include <string.h>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "divesoft_parser.h"
+#include "reading_format.h"
+}
+
+namespace {
+
+bool parse(const char *line, gas_reading_t *out)
+{
+    return divesoft_parse_line(line, strlen(line), out);
+}
+
+} // namespace
+
+TEST_CASE("Parses a live reading")
+{
+    gas_reading_t r;
+    REQUIRE(parse("He   0.4 %  O2  20.2 %  Ti  79.0 ~F    29.5 inHg   2025/12/15 21:36:26", &r));
+    CHECK(r.he_x10 == 4);
+    CHECK(r.o2_x10 == 202);
+    CHECK(r.temp_x10 == 790);
+    CHECK(r.pressure_x100 == 2950);
+    CHECK(r.timestamp == GAS_TIMESTAMP_PACK(2025, 12, 15, 21, 36, 26));
+    CHECK(r.flags == 0);
+}
+
+TEST_CASE("Tolerates single spaces and units attached to values")
+{
+    gas_reading_t r;
+    REQUIRE(parse("He 45.0% O2 21.3% Ti -3.5 ~F 29.92 inHg 2025/01/02 03:04:05", &r));
+    CHECK(r.he_x10 == 450);
+    CHECK(r.o2_x10 == 213);
+    CHECK(r.temp_x10 == -35);
+    CHECK(r.pressure_x100 == 2992);
+}
+
+TEST_CASE("Stale gas fields are flagged and zeroed")
+{
+    gas_reading_t r;
+    REQUIRE(parse("He  ***.* %  O2  ***.* %  Ti  79.0 ~F    29.52 inHg   2025/12/15 21:36:26", &r));
+    CHECK(r.he_x10 == 0);
+    CHECK(r.o2_x10 == 0);
+    CHECK(r.flags == (GAS_READING_FLAG_HE_STALE | GAS_READING_FLAG_O2_STALE));
+}
+
+TEST_CASE("Rejects incomplete or malformed lines")
+{
+    gas_reading_t r = {};
+    r.he_x10 = 1234;
+
+    CHECK_FALSE(parse("", &r));
+    CHECK_FALSE(parse("garbage", &r));
+    CHECK_FALSE(parse("He 0.4 % O2 20.2 % Ti 79.0 ~F 29.5 inHg", &r));
+    CHECK_FALSE(parse("He 0.4 % O2 20.2 % Ti 79.0 ~F 29.5 inHg 2025/12/15", &r));
+    CHECK_FALSE(parse("He 0.4 % O2 20.2 % Ti 79.0 ~F 29.5 inHg 2025/13/15 21:36:26", &r));
+    CHECK_FALSE(parse("He 100.1 % O2 20.2 % Ti 79.0 ~F 29.5 inHg 2025/12/15 21:36:26", &r));
+    CHECK_FALSE(parse("O2 20.2 % He 0.4 % Ti 79.0 ~F 29.5 inHg 2025/12/15 21:36:26", &r));
+
+    // Output is untouched on failure
+    CHECK(r.he_x10 == 1234);
+}
+
+TEST_CASE("Does not read past len")
+{
+    const char *line = "He 0.4 % O2 20.2 % Ti 79.0 ~F 29.5 inHg 2025/12/15 21:36:26";
+    gas_reading_t r;
+    CHECK_FALSE(divesoft_parse_line(line, strlen(line) - 1, &r));
+}
+
+TEST_CASE("Encodes the binary reading little-endian")
+{
+    gas_reading_t r = {};
+    r.he_x10 = 0x0102;
+    r.o2_x10 = 0x0304;
+    r.temp_x10 = -2;
+    r.pressure_x100 = 0x0506;
+    r.timestamp = 0x0708090A;
+    r.flags = GAS_READING_FLAG_O2_STALE;
+
+    uint8_t buf[READING_FORMAT_SIZE];
+    REQUIRE(reading_format_encode(&r, buf) == READING_FORMAT_SIZE);
+
+    const uint8_t expected[READING_FORMAT_SIZE] = {
+        READING_FORMAT_VERSION, GAS_READING_FLAG_O2_STALE,
+        0x02, 0x01, 0x04, 0x03, 0xFE, 0xFF, 0x06, 0x05,
+        0x0A, 0x09, 0x08, 0x07,
+    };
+    CHECK(memcmp(buf, expected, sizeof(expected)) == 0);
+}
+
+TEST_CASE("Batches fill up to the link limit")
+{
+    gas_reading_t r = {};
+    r.o2_x10 = 210;
+
+    reading_batch_t batch;
+    reading_batch_init(&batch, 23 - 3);  // Default ATT MTU
+    CHECK(reading_batch_count(&batch) == 0);
+    CHECK(reading_batch_add(&batch, 0xFFFF, &r));
+    CHECK_FALSE(reading_batch_add(&batch, 0x0000, &r));
+    CHECK(batch.len == READING_BATCH_HEADER_SIZE + READING_BATCH_RECORD_SIZE);
+
+    reading_batch_init(&batch, 256 - 3);
+    int added = 0;
+    while (reading_batch_add(&batch, (uint16_t)added, &r)) {
+        added++;
+    }
+    CHECK(added == READING_BATCH_MAX_RECORDS);
+    CHECK(reading_batch_count(&batch) == READING_BATCH_MAX_RECORDS);
+    CHECK(batch.len <= 256 - 3);
+}
+
+TEST_CASE("Batch records carry the sequence number and reading body")
+{
+    gas_reading_t r = {};
+    r.he_x10 = 0x0102;
+    r.o2_x10 = 0x0304;
+    r.timestamp = 0x0708090A;
+    r.flags = GAS_READING_FLAG_HE_STALE;
+
+    uint8_t single[READING_FORMAT_SIZE];
+    reading_format_encode(&r, single);
+
+    reading_batch_t batch;
+    reading_batch_init(&batch, READING_BATCH_MAX_SIZE);
+    REQUIRE(reading_batch_add(&batch, 0x1234, &r));
+    REQUIRE(reading_batch_add(&batch, 0x1235, &r));
+
+    CHECK(batch.buf[0] == READING_BATCH_VERSION);
+    CHECK(batch.buf[1] == 2);
+    const uint8_t *second = &batch.buf[READING_BATCH_HEADER_SIZE + READING_BATCH_RECORD_SIZE];
+    CHECK(second[0] == 0x35);
+    CHECK(second[1] == 0x12);
+    CHECK(memcmp(&second[2], &single[1], READING_FORMAT_SIZE - 1) == 0);
+}
@@ -0,0 +1,28 @@
+/*
+ * GasTag parser host tests
+ *
+ * Runs the Catch2 session from app_main, as the linux target provides
+ * main() through its FreeRTOS port.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <catch2/catch_session.hpp>
+
+extern "C" void app_main(void)
+{
+    int argc = 1;
+    const char *argv[2] = {
+        "host_test_gastag_parser",
+        NULL
+    };
+
+    auto result = Catch::Session().run(argc, argv);
+    if (result != 0) {
+        printf("Test failed with result %d\n", result);
+    } else {
+        printf("Test passed.\n");
+    }
+    fflush(stdout);
+    exit(result);
+}
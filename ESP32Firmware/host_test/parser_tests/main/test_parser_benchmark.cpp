@@ -0,0 +1,134 @@
+/*
+ * Parser throughput benchmarks
+ *
+ * Measures the framer and the field parser over a generated analyzer
+ * session. The Catch2 BENCHMARKs give per-stage statistics; the
+ * "per-byte cost" case prints a single ns/byte figure for the whole
+ * USB-chunk-to-parsed-reading path so runs can be compared over time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+extern "C" {
+#include "analyzer_stream.h"
+#include "divesoft_parser.h"
+#include "reading_format.h"
+}
+#include "analyzer_streams.hpp"
+
+namespace {
+
+constexpr size_t BENCH_READINGS = 1000;
+constexpr size_t USB_CHUNK = 64;  // Full-speed bulk IN packet size
+
+struct pipeline_counts {
+    size_t parsed;
+    size_t failed;
+    uint32_t checksum;  // Keeps the optimizer from discarding the work
+};
+
+void parse_and_encode(const char *line, size_t len, uint8_t flags, void *ctx)
+{
+    auto *counts = static_cast<pipeline_counts *>(ctx);
+    gas_reading_t reading;
+    if (divesoft_parse_line(line, len, &reading)) {
+        uint8_t buf[READING_FORMAT_SIZE];
+        reading_format_encode(&reading, buf);
+        counts->parsed++;
+        counts->checksum += buf[2] + buf[4] + buf[10];
+    } else {
+        counts->failed++;
+    }
+}
+
+void count_only(const char *line, size_t len, uint8_t flags, void *ctx)
+{
+    *static_cast<size_t *>(ctx) += len;
+}
+
+// Feed the stream the way the CDC driver delivers it: in bulk-packet chunks
+template <typename Cb, typename Ctx>
+void feed_chunks(analyzer_stream_t *stream, const std::string &bytes, Cb cb, Ctx *ctx)
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(bytes.data());
+    for (size_t off = 0; off < bytes.size(); off += USB_CHUNK) {
+        size_t n = bytes.size() - off < USB_CHUNK ? bytes.size() - off : USB_CHUNK;
+        analyzer_stream_feed(stream, data + off, n, cb, ctx);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Parser benchmarks", "[benchmark]")
+{
+    const std::string bytes = analyzer_streams::session(BENCH_READINGS);
+
+    std::vector<std::string> lines;
+    {
+        analyzer_stream_t stream;
+        analyzer_stream_init(&stream);
+        analyzer_stream_feed(&stream, reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(),
+                             [](const char *line, size_t len, uint8_t, void *ctx) {
+                                 static_cast<std::vector<std::string> *>(ctx)->emplace_back(line, len);
+                             }, &lines);
+    }
+    REQUIRE(lines.size() == analyzer_streams::session_line_count(BENCH_READINGS));
+
+    BENCHMARK("framer, 64-byte chunks") {
+        analyzer_stream_t stream;
+        analyzer_stream_init(&stream);
+        size_t total = 0;
+        feed_chunks(&stream, bytes, count_only, &total);
+        return total;
+    };
+
+    BENCHMARK("divesoft_parse_line, all lines") {
+        uint32_t sum = 0;
+        for (const auto &line : lines) {
+            gas_reading_t reading;
+            if (divesoft_parse_line(line.data(), line.size(), &reading)) {
+                sum += reading.o2_x10;
+            }
+        }
+        return sum;
+    };
+
+    BENCHMARK("framer + parse + encode") {
+        analyzer_stream_t stream;
+        analyzer_stream_init(&stream);
+        pipeline_counts counts = {};
+        feed_chunks(&stream, bytes, parse_and_encode, &counts);
+        return counts.checksum;
+    };
+}
+
+TEST_CASE("Per-byte cost of the full parse path", "[benchmark]")
+{
+    constexpr int ITERATIONS = 200;
+    const std::string bytes = analyzer_streams::session(BENCH_READINGS);
+
+    pipeline_counts counts = {};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        analyzer_stream_t stream;
+        analyzer_stream_init(&stream);
+        feed_chunks(&stream, bytes, parse_and_encode, &counts);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    double total_bytes = (double)bytes.size() * ITERATIONS;
+    printf("Parser cost: %.2f ns/byte, %.0f ns/line (%zu bytes x %d, checksum %u)\n",
+           ns / total_bytes, ns / (double)(counts.parsed + counts.failed),
+           bytes.size(), ITERATIONS, counts.checksum);
+
+    // Every warm-up and live line parses; only the attach noise is dropped
+    CHECK(counts.failed == 0);
+    CHECK(counts.parsed == analyzer_streams::session_line_count(BENCH_READINGS) * ITERATIONS);
+}
@@ -0,0 +1,55 @@
+/*
+ * power_stats time split and current estimate tests
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "power_stats.h"
+}
+
+TEST_CASE("Power report splits an interval between sleep, min clock and full clock")
+{
+    power_stats_t start = { 1000000, 500000, 10 };
+    power_stats_t end = { 1000000 + 6000000, 500000 + 1000000, 10 + 300 };
+    power_report_t report;
+
+    power_stats_report(&end, &start, 10000000, &report);
+    CHECK(report.elapsed_ms == 10000);
+    CHECK(report.sleep_permille == 600);
+    CHECK(report.boost_permille == 100);
+    CHECK(report.awake_permille == 300);
+    CHECK(report.sleeps == 300);
+    CHECK(report.avg_current_ua == (6 * POWER_CURRENT_SLEEP_UA + 3 * POWER_CURRENT_AWAKE_UA +
+                                    1 * POWER_CURRENT_BOOST_UA) / 10);
+}
+
+TEST_CASE("Power report bounds counters that overshoot the wall clock")
+{
+    power_stats_t zero = {};
+    power_stats_t all_sleep = { 1200000, 0, 3 };
+    power_stats_t all_boost = { 0, 1500000, 0 };
+    power_report_t report;
+
+    power_stats_report(&all_sleep, &zero, 1000000, &report);
+    CHECK(report.sleep_permille == 1000);
+    CHECK(report.awake_permille == 0);
+    CHECK(report.avg_current_ua == POWER_CURRENT_SLEEP_UA);
+
+    power_stats_report(&all_boost, &zero, 1000000, &report);
+    CHECK(report.boost_permille == 1000);
+    CHECK(report.avg_current_ua == POWER_CURRENT_BOOST_UA);
+
+    power_stats_report(&all_boost, &zero, 0, &report);
+    CHECK(report.avg_current_ua == 0);
+}
+
+TEST_CASE("An always-awake bridge reports the minimum clock current")
+{
+    power_stats_t zero = {};
+    power_report_t report;
+
+    power_stats_report(&zero, &zero, 60000000, &report);
+    CHECK(report.awake_permille == 1000);
+    CHECK(report.avg_current_ua == POWER_CURRENT_AWAKE_UA);
+}
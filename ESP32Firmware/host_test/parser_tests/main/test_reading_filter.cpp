@@ -0,0 +1,134 @@
+/*
+ * reading_filter deadband tests
+ */
+
+#include <string.h>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "reading_filter.h"
+}
+
+namespace {
+
+gas_reading_t make_reading(uint16_t he, uint16_t o2, int16_t temp, uint16_t pressure)
+{
+    gas_reading_t r = {};
+    r.he_x10 = he;
+    r.o2_x10 = o2;
+    r.temp_x10 = temp;
+    r.pressure_x100 = pressure;
+    return r;
+}
+
+reading_filter_t deadband_filter()
+{
+    reading_filter_config_t config;
+    reading_filter_default_config(&config);
+    config.mode = READING_FILTER_MODE_DEADBAND;
+
+    reading_filter_t filter;
+    reading_filter_init(&filter, &config);
+    return filter;
+}
+
+} // namespace
+
+TEST_CASE("Default mode sends every reading")
+{
+    reading_filter_config_t config;
+    reading_filter_default_config(&config);
+    reading_filter_t filter;
+    reading_filter_init(&filter, &config);
+
+    gas_reading_t r = make_reading(350, 210, 790, 2950);
+    for (uint32_t t = 0; t < 10; t++) {
+        CHECK(reading_filter_accept(&filter, &r, t * 100));
+    }
+    CHECK(filter.suppressed == 0);
+}
+
+TEST_CASE("Deadband mode suppresses repeats until the heartbeat")
+{
+    reading_filter_t filter = deadband_filter();
+    gas_reading_t r = make_reading(350, 210, 790, 2950);
+
+    CHECK(reading_filter_accept(&filter, &r, 0));
+    CHECK_FALSE(reading_filter_accept(&filter, &r, 1000));
+    CHECK_FALSE(reading_filter_accept(&filter, &r, 1999));
+    CHECK(reading_filter_accept(&filter, &r, 2000));
+    CHECK(filter.suppressed == 2);
+}
+
+TEST_CASE("Changes within the deadband are held, beyond it are sent")
+{
+    reading_filter_t filter = deadband_filter();
+    gas_reading_t r = make_reading(350, 210, 790, 2950);
+    REQUIRE(reading_filter_accept(&filter, &r, 0));
+
+    gas_reading_t small = make_reading(351, 209, 794, 2954);
+    CHECK_FALSE(reading_filter_accept(&filter, &small, 100));
+
+    gas_reading_t he = make_reading(352, 210, 790, 2950);
+    CHECK(reading_filter_accept(&filter, &he, 200));
+
+    // Compared against the last sent reading, not the last seen one
+    gas_reading_t temp = make_reading(352, 210, 784, 2950);
+    CHECK(reading_filter_accept(&filter, &temp, 300));
+}
+
+TEST_CASE("Stale flag changes are always sent")
+{
+    reading_filter_t filter = deadband_filter();
+    gas_reading_t r = make_reading(0, 0, 790, 2950);
+    r.flags = GAS_READING_FLAG_HE_STALE | GAS_READING_FLAG_O2_STALE;
+    REQUIRE(reading_filter_accept(&filter, &r, 0));
+
+    r.flags = 0;
+    CHECK(reading_filter_accept(&filter, &r, 100));
+}
+
+TEST_CASE("Heartbeat survives millisecond counter wrap")
+{
+    reading_filter_t filter = deadband_filter();
+    gas_reading_t r = make_reading(350, 210, 790, 2950);
+
+    REQUIRE(reading_filter_accept(&filter, &r, 0xFFFFFF00u));
+    CHECK_FALSE(reading_filter_accept(&filter, &r, 0x00000100u));
+    CHECK(reading_filter_accept(&filter, &r, 0x00000800u));
+}
+
+TEST_CASE("Config round-trips and bad configs are rejected")
+{
+    reading_filter_config_t config;
+    reading_filter_default_config(&config);
+    config.mode = READING_FILTER_MODE_DEADBAND;
+    config.pressure_x100 = 300;
+    config.heartbeat_ms = 4500;
+
+    uint8_t buf[READING_FILTER_CONFIG_SIZE];
+    REQUIRE(reading_filter_config_encode(&config, buf) == READING_FILTER_CONFIG_SIZE);
+
+    reading_filter_config_t decoded = {};
+    REQUIRE(reading_filter_config_decode(buf, sizeof(buf), &decoded));
+    CHECK(decoded.mode == READING_FILTER_MODE_DEADBAND);
+    CHECK(decoded.he_x10 == config.he_x10);
+    CHECK(decoded.pressure_x100 == 300);
+    CHECK(decoded.heartbeat_ms == 4500);
+
+    CHECK_FALSE(reading_filter_config_decode(buf, sizeof(buf) - 1, &decoded));
+
+    uint8_t bad[READING_FILTER_CONFIG_SIZE];
+    memcpy(bad, buf, sizeof(bad));
+    bad[0] = 9;
+    CHECK_FALSE(reading_filter_config_decode(bad, sizeof(bad), &decoded));
+
+    memcpy(bad, buf, sizeof(bad));
+    bad[1] = 7;
+    CHECK_FALSE(reading_filter_config_decode(bad, sizeof(bad), &decoded));
+
+    memcpy(bad, buf, sizeof(bad));
+    bad[10] = 10;
+    bad[11] = 0;
+    CHECK_FALSE(reading_filter_config_decode(bad, sizeof(bad), &decoded));
+}
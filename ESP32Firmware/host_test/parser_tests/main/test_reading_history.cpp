@@ -0,0 +1,111 @@
+/*
+ * reading_history ring and backfill packet tests
+ */
+
+#include <string.h>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "reading_history.h"
+#include "reading_format.h"
+}
+
+namespace {
+
+gas_reading_t reading_with_o2(uint16_t o2)
+{
+    gas_reading_t r = {};
+    r.o2_x10 = o2;
+    return r;
+}
+
+uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+} // namespace
+
+TEST_CASE("Sequence numbers start at 1 and readings can be looked up")
+{
+    std::vector<gas_reading_t> storage(8);
+    reading_history_t history;
+    reading_history_init(&history, storage.data(), storage.size());
+
+    CHECK(reading_history_oldest_seq(&history) == 1);
+    CHECK(reading_history_append(&history, &storage[0]) == 1);
+
+    gas_reading_t r = reading_with_o2(210);
+    CHECK(reading_history_append(&history, &r) == 2);
+
+    gas_reading_t out;
+    REQUIRE(reading_history_get(&history, 2, &out));
+    CHECK(out.o2_x10 == 210);
+    CHECK_FALSE(reading_history_get(&history, 0, &out));
+    CHECK_FALSE(reading_history_get(&history, 3, &out));
+}
+
+TEST_CASE("A full history overwrites the oldest readings")
+{
+    std::vector<gas_reading_t> storage(4);
+    reading_history_t history;
+    reading_history_init(&history, storage.data(), storage.size());
+
+    for (uint16_t i = 1; i <= 10; i++) {
+        gas_reading_t r = reading_with_o2(i);
+        reading_history_append(&history, &r);
+    }
+
+    CHECK(history.count == 4);
+    CHECK(reading_history_oldest_seq(&history) == 7);
+
+    gas_reading_t out;
+    CHECK_FALSE(reading_history_get(&history, 6, &out));
+    for (uint32_t seq = 7; seq <= 10; seq++) {
+        REQUIRE(reading_history_get(&history, seq, &out));
+        CHECK(out.o2_x10 == seq);
+    }
+}
+
+TEST_CASE("Without storage, readings are still numbered")
+{
+    reading_history_t history;
+    reading_history_init(&history, NULL, 100);
+
+    gas_reading_t r = reading_with_o2(1);
+    CHECK(reading_history_append(&history, &r) == 1);
+    CHECK(reading_history_append(&history, &r) == 2);
+
+    gas_reading_t out;
+    CHECK_FALSE(reading_history_get(&history, 2, &out));
+    CHECK(reading_history_oldest_seq(&history) == 3);
+}
+
+TEST_CASE("History packets carry 32-bit sequence numbers")
+{
+    gas_reading_t r = reading_with_o2(0x0304);
+
+    reading_batch_t packet;
+    reading_history_batch_init(&packet, 256 - 3);
+    int added = 0;
+    while (reading_batch_add(&packet, 0x10000u + (uint32_t)added, &r)) {
+        added++;
+    }
+    CHECK(added == (256 - 3 - READING_BATCH_HEADER_SIZE) / READING_HISTORY_RECORD_SIZE);
+    CHECK(packet.buf[0] == READING_HISTORY_VERSION);
+    CHECK(packet.buf[1] == added);
+
+    const uint8_t *second = &packet.buf[READING_BATCH_HEADER_SIZE + READING_HISTORY_RECORD_SIZE];
+    CHECK(get_u32(second) == 0x10001u);
+    CHECK(second[4 + 3] == 0x04);  // O2 low byte, after flags and He
+}
+
+TEST_CASE("The end marker reports the next live sequence number")
+{
+    uint8_t buf[READING_HISTORY_END_SIZE];
+    REQUIRE(reading_history_encode_end(0x01020304, buf) == READING_HISTORY_END_SIZE);
+    CHECK(buf[0] == READING_HISTORY_VERSION);
+    CHECK(buf[1] == 0);
+    CHECK(get_u32(&buf[2]) == 0x01020304u);
+}
@@ -0,0 +1,388 @@
+/*
+ * reading_log flash log tests
+ *
+ * The log runs on a RAM image that behaves like NOR flash: erase sets a
+ * block to 0xFF, writes can only clear bits. Any write that would need to
+ * set a bit is counted so the tests can check the log never relies on it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+extern "C" {
+#include "reading_log.h"
+}
+
+namespace {
+
+struct nor_flash {
+    std::vector<uint8_t> image;
+    std::vector<uint32_t> erase_counts;
+    uint32_t bit_set_violations = 0;
+    uint32_t writes = 0;
+
+    explicit nor_flash(size_t blocks)
+        : image(blocks * READING_LOG_BLOCK_SIZE, 0xFF), erase_counts(blocks, 0) {}
+
+    static esp_err_t read(void *ctx, size_t offset, void *dst, size_t len)
+    {
+        auto *f = static_cast<nor_flash *>(ctx);
+        if (offset + len > f->image.size()) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(dst, &f->image[offset], len);
+        return ESP_OK;
+    }
+
+    static esp_err_t write(void *ctx, size_t offset, const void *src, size_t len)
+    {
+        auto *f = static_cast<nor_flash *>(ctx);
+        if (offset + len > f->image.size()) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        const uint8_t *bytes = static_cast<const uint8_t *>(src);
+        for (size_t i = 0; i < len; i++) {
+            if (bytes[i] & ~f->image[offset + i]) {
+                f->bit_set_violations++;
+            }
+            f->image[offset + i] &= bytes[i];
+        }
+        f->writes++;
+        return ESP_OK;
+    }
+
+    static esp_err_t erase_block(void *ctx, size_t offset)
+    {
+        auto *f = static_cast<nor_flash *>(ctx);
+        if (offset % READING_LOG_BLOCK_SIZE != 0 || offset >= f->image.size()) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        memset(&f->image[offset], 0xFF, READING_LOG_BLOCK_SIZE);
+        f->erase_counts[offset / READING_LOG_BLOCK_SIZE]++;
+        return ESP_OK;
+    }
+
+    reading_log_flash_t ops()
+    {
+        return { read, write, erase_block, image.size(), this };
+    }
+};
+
+gas_reading_t reading_at(uint32_t n)
+{
+    gas_reading_t r = {};
+    r.he_x10 = (uint16_t)(n % 1000);
+    r.o2_x10 = 209;
+    r.temp_x10 = (int16_t)(n % 200) - 100;
+    r.pressure_x100 = 2950;
+    r.timestamp = GAS_TIMESTAMP_PACK(2025, 12, 15, 0, 0, 0) + n * 2;  // Even seconds
+    return r;
+}
+
+void append_n(reading_log_t *log, uint32_t first, uint32_t count)
+{
+    std::vector<gas_reading_t> readings;
+    for (uint32_t i = 0; i < count; i++) {
+        readings.push_back(reading_at(first + i));
+    }
+    REQUIRE(reading_log_append(log, readings.data(), readings.size()) == ESP_OK);
+}
+
+void check_reading(reading_log_t *log, uint32_t seq, uint32_t n)
+{
+    gas_reading_t r;
+    REQUIRE(reading_log_read(log, seq, &r) == ESP_OK);
+    gas_reading_t expected = reading_at(n);
+    CHECK(r.he_x10 == expected.he_x10);
+    CHECK(r.temp_x10 == expected.temp_x10);
+    CHECK(r.timestamp == expected.timestamp);
+}
+
+} // namespace
+
+TEST_CASE("An erased partition mounts as an empty log")
+{
+    nor_flash flash(8);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    CHECK(log.block_count == 8);
+    CHECK(log.next_seq == 1);
+    CHECK(reading_log_oldest_seq(&log) == 1);
+
+    gas_reading_t r;
+    uint32_t seq;
+    CHECK(reading_log_read(&log, 1, &r) == ESP_ERR_NOT_FOUND);
+    CHECK(reading_log_find_time(&log, 0, &seq) == ESP_ERR_NOT_FOUND);
+    reading_log_unmount(&log);
+}
+
+TEST_CASE("A partition smaller than the minimum is rejected")
+{
+    nor_flash flash(READING_LOG_MIN_BLOCKS - 1);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    CHECK(reading_log_mount(&log, &ops) == ESP_ERR_INVALID_SIZE);
+}
+
+TEST_CASE("Appended readings read back by sequence number and survive a remount")
+{
+    nor_flash flash(8);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    // Spans three blocks, in uneven batches
+    const uint32_t total = READING_LOG_RECORDS_PER_BLOCK * 2 + 40;
+    uint32_t n = 0;
+    while (n < total) {
+        uint32_t count = (n % 7) + 1;
+        if (n + count > total) {
+            count = total - n;
+        }
+        append_n(&log, n, count);
+        n += count;
+    }
+    CHECK(log.next_seq == total + 1);
+    CHECK(log.used_blocks == 3);
+    for (uint32_t seq = 1; seq <= total; seq++) {
+        check_reading(&log, seq, seq - 1);
+    }
+    gas_reading_t r;
+    CHECK(reading_log_read(&log, total + 1, &r) == ESP_ERR_NOT_FOUND);
+    reading_log_unmount(&log);
+
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+    CHECK(log.next_seq == total + 1);
+    CHECK(log.used_blocks == 3);
+    CHECK(reading_log_oldest_seq(&log) == 1);
+    check_reading(&log, 1, 0);
+    check_reading(&log, total, total - 1);
+
+    // Appending continues where the previous mount stopped
+    append_n(&log, total, 5);
+    check_reading(&log, total + 5, total + 4);
+    reading_log_unmount(&log);
+
+    CHECK(flash.bit_set_violations == 0);
+}
+
+TEST_CASE("A batch within one block is written with one flash write")
+{
+    nor_flash flash(4);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    append_n(&log, 0, 1);  // Opens the block: header + record
+    uint32_t writes = flash.writes;
+    append_n(&log, 1, 16);
+    CHECK(flash.writes == writes + 1);
+    CHECK(log.stats.write_calls == 2);
+    reading_log_unmount(&log);
+}
+
+TEST_CASE("The log wraps around the partition and wears blocks evenly")
+{
+    const uint32_t blocks = 5;
+    nor_flash flash(blocks);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    const uint32_t total = READING_LOG_RECORDS_PER_BLOCK * blocks * 4 + 17;
+    for (uint32_t n = 0; n < total; n += 16) {
+        append_n(&log, n, total - n < 16 ? total - n : 16);
+        REQUIRE(reading_log_prepare(&log) == ESP_OK);
+    }
+    CHECK(log.next_seq == total + 1);
+
+    // Only the erased-ahead block is missing from the ring
+    CHECK(log.used_blocks == blocks - 1);
+    uint32_t oldest = reading_log_oldest_seq(&log);
+    CHECK(oldest == total + 1 - (READING_LOG_RECORDS_PER_BLOCK * (blocks - 2) + 17));
+
+    gas_reading_t r;
+    CHECK(reading_log_read(&log, oldest - 1, &r) == ESP_ERR_NOT_FOUND);
+    check_reading(&log, oldest, oldest - 1);
+    check_reading(&log, total, total - 1);
+
+    uint32_t min_erases = flash.erase_counts[0];
+    uint32_t max_erases = flash.erase_counts[0];
+    for (uint32_t count : flash.erase_counts) {
+        min_erases = count < min_erases ? count : min_erases;
+        max_erases = count > max_erases ? count : max_erases;
+    }
+    CHECK(max_erases - min_erases <= 1);
+    CHECK(flash.bit_set_violations == 0);
+    reading_log_unmount(&log);
+
+    // Remount finds the same range after wrapping
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+    CHECK(reading_log_oldest_seq(&log) == oldest);
+    CHECK(log.next_seq == total + 1);
+    check_reading(&log, oldest, oldest - 1);
+    append_n(&log, total, READING_LOG_RECORDS_PER_BLOCK);
+    check_reading(&log, total + READING_LOG_RECORDS_PER_BLOCK, total + READING_LOG_RECORDS_PER_BLOCK - 1);
+    CHECK(flash.bit_set_violations == 0);
+    reading_log_unmount(&log);
+}
+
+TEST_CASE("Erasing ahead keeps erases out of the append path")
+{
+    nor_flash flash(4);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    // The first block of a fresh mount is erased inline unless prepared
+    REQUIRE(reading_log_prepare(&log) == ESP_OK);
+    REQUIRE(reading_log_prepare(&log) == ESP_OK);  // Already erased: no-op
+    CHECK(log.stats.erases == 1);
+
+    for (uint32_t n = 0; n < READING_LOG_RECORDS_PER_BLOCK * 10; n += 8) {
+        append_n(&log, n, 8);
+        REQUIRE(reading_log_prepare(&log) == ESP_OK);
+    }
+    CHECK(log.stats.inline_erases == 0);
+    CHECK(log.stats.erases > 0);
+
+    // Without preparing, the second block switch erases inline
+    append_n(&log, 0, READING_LOG_RECORDS_PER_BLOCK * 2);
+    CHECK(log.stats.inline_erases == 1);
+    reading_log_unmount(&log);
+}
+
+TEST_CASE("Time lookups go to the first record at or after the timestamp")
+{
+    nor_flash flash(8);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    const uint32_t total = READING_LOG_RECORDS_PER_BLOCK * 3 + 10;
+    append_n(&log, 0, total);
+
+    uint32_t seq = 0;
+    // Exact match, including the first record of a block
+    REQUIRE(reading_log_find_time(&log, reading_at(100).timestamp, &seq) == ESP_OK);
+    CHECK(seq == 101);
+    REQUIRE(reading_log_find_time(&log, reading_at(READING_LOG_RECORDS_PER_BLOCK).timestamp, &seq) == ESP_OK);
+    CHECK(seq == READING_LOG_RECORDS_PER_BLOCK + 1);
+
+    // Between two readings (odd second): the later one
+    REQUIRE(reading_log_find_time(&log, reading_at(100).timestamp + 1, &seq) == ESP_OK);
+    CHECK(seq == 102);
+
+    // Just after the last record of a block: the first record of the next block
+    REQUIRE(reading_log_find_time(&log, reading_at(READING_LOG_RECORDS_PER_BLOCK - 1).timestamp + 1,
+                                  &seq) == ESP_OK);
+    CHECK(seq == READING_LOG_RECORDS_PER_BLOCK + 1);
+
+    // Before the log: the oldest record; after the newest: nothing
+    REQUIRE(reading_log_find_time(&log, 0, &seq) == ESP_OK);
+    CHECK(seq == 1);
+    CHECK(reading_log_find_time(&log, reading_at(total - 1).timestamp + 1, &seq) == ESP_ERR_NOT_FOUND);
+    reading_log_unmount(&log);
+}
+
+TEST_CASE("Torn and corrupted records are detected and never overwritten")
+{
+    nor_flash flash(4);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+    append_n(&log, 0, 10);
+    reading_log_unmount(&log);
+
+    // Power lost while writing record 11: only part of it reached flash
+    size_t torn = READING_LOG_HEADER_SIZE + 10 * READING_LOG_RECORD_SIZE;
+    flash.image[torn + 3] = 0x00;
+
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+    CHECK(log.next_seq == 12);  // The torn slot is skipped, not reused
+    gas_reading_t r;
+    CHECK(reading_log_read(&log, 11, &r) == ESP_ERR_INVALID_CRC);
+    CHECK(log.stats.corrupt_records == 1);
+
+    append_n(&log, 11, 2);
+    check_reading(&log, 12, 11);
+    check_reading(&log, 13, 12);
+    CHECK(flash.bit_set_violations == 0);
+
+    // A flipped bit in a stored record
+    flash.image[READING_LOG_HEADER_SIZE + 4 * READING_LOG_RECORD_SIZE + 5] ^= 0x10;
+    CHECK(reading_log_read(&log, 5, &r) == ESP_ERR_INVALID_CRC);
+    check_reading(&log, 6, 5);
+    reading_log_unmount(&log);
+}
+
+TEST_CASE("Reading log append and query cost", "[benchmark]")
+{
+    // 1 MB partition, filled several times over
+    const uint32_t blocks = 256;
+    const uint32_t batch = 16;
+    const uint32_t total = READING_LOG_RECORDS_PER_BLOCK * blocks * 3;
+    nor_flash flash(blocks);
+    reading_log_flash_t ops = flash.ops();
+    reading_log_t log;
+    REQUIRE(reading_log_mount(&log, &ops) == ESP_OK);
+
+    std::vector<gas_reading_t> readings(total);
+    for (uint32_t i = 0; i < total; i++) {
+        readings[i] = reading_at(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < total; n += batch) {
+        reading_log_append(&log, &readings[n], batch);
+        if ((n / batch) % 8 == 0) {
+            reading_log_prepare(&log);
+        }
+    }
+    auto append_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    REQUIRE(log.next_seq == total + 1);
+
+    const uint32_t oldest = reading_log_oldest_seq(&log);
+    const uint32_t queries = 20000;
+    uint32_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < queries; i++) {
+        uint32_t seq;
+        uint32_t n = oldest - 1 + (i * 7919u) % (total - oldest + 1);
+        if (reading_log_find_time(&log, readings[n].timestamp, &seq) == ESP_OK && seq == n + 1) {
+            found++;
+        }
+    }
+    auto query_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // RAM-backed flash: this is the log's CPU cost, not SPI flash timing
+    printf("Reading log: %.0f appends/s (%.1f ns/record, batches of %u), "
+           "time query %.0f ns (%u blocks indexed)\n",
+           total * 1e9 / (double)append_ns, (double)append_ns / total, batch,
+           (double)query_ns / queries, blocks);
+    CHECK(found == queries);
+
+    BENCHMARK("reading_log_append, 16 records") {
+        return reading_log_append(&log, &readings[0], batch);
+    };
+
+    BENCHMARK("reading_log_find_time") {
+        uint32_t seq = 0;
+        reading_log_find_time(&log, readings[total - 1000].timestamp, &seq);
+        return seq;
+    };
+
+    BENCHMARK("reading_log_read") {
+        gas_reading_t r;
+        return reading_log_read(&log, log.next_seq - 500, &r);
+    };
+    reading_log_unmount(&log);
+}
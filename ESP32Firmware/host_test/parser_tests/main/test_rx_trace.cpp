@@ -0,0 +1,269 @@
+/*
+ * rx_trace tests: recording the USB RX chunks, reading them back, and a
+ * replay reproducing exactly what the framers and the parser saw
+ */
+
+#include <stdatomic.h>  // Before extern "C": the ring's counters are C11 atomics
+#include <string.h>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+#include "rx_trace.h"
+#include "analyzer_channel.h"
+}
+#include "analyzer_streams.hpp"
+
+namespace {
+
+std::vector<rx_trace_record_t> read_all(const uint8_t *buf, size_t len, bool *truncated = nullptr)
+{
+    rx_trace_reader_t reader;
+    std::vector<rx_trace_record_t> records;
+    if (rx_trace_reader_init(&reader, buf, len)) {
+        rx_trace_record_t record;
+        while (rx_trace_next(&reader, &record)) {
+            records.push_back(record);
+        }
+    }
+    if (truncated != nullptr) {
+        *truncated = reader.truncated;
+    }
+    return records;
+}
+
+const uint8_t *bytes(const std::string &s)
+{
+    return reinterpret_cast<const uint8_t *>(s.data());
+}
+
+// The USB RX path of the bridge, without FreeRTOS: every chunk goes to
+// the framers the way handle_rx() does, and into the trace while recording
+struct rx_side {
+    line_ring_t ring;
+    analyzer_channel_t channels[ANALYZER_CHANNEL_MAX];
+    analyzer_channel_latest_t latest[ANALYZER_CHANNEL_MAX];
+    rx_trace_t *trace = nullptr;
+    std::vector<std::pair<uint8_t, std::string>> lines;
+
+    rx_side()
+    {
+        reading_filter_config_t config;
+        reading_filter_default_config(&config);
+        line_ring_init(&ring);
+        for (uint8_t id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+            analyzer_channel_init(&channels[id], id, &ring);
+            analyzer_channel_latest_init(&latest[id], &config);
+        }
+    }
+
+    void chunk(uint8_t id, int64_t time_us, const uint8_t *data, size_t len)
+    {
+        if (trace != nullptr) {
+            rx_trace_record(trace, RX_TRACE_REC_DATA, id, time_us, data, len);
+        }
+        analyzer_channel_feed(&channels[id], data, len);
+        drain();
+    }
+
+    void close(uint8_t id, int64_t time_us)
+    {
+        if (trace != nullptr) {
+            rx_trace_record(trace, RX_TRACE_REC_CLOSE, id, time_us, nullptr, 0);
+        }
+        analyzer_channel_reset(&channels[id]);
+    }
+
+    // What usb_rx_replay() does with a record
+    void replay(const rx_trace_record_t &record)
+    {
+        if (record.type == RX_TRACE_REC_DATA) {
+            analyzer_channel_feed(&channels[record.channel], record.data, record.len);
+            drain();
+        } else if (record.type == RX_TRACE_REC_CLOSE) {
+            analyzer_channel_reset(&channels[record.channel]);
+        }
+    }
+
+    void drain()
+    {
+        const line_ring_slot_t *slot;
+        while ((slot = line_ring_peek(&ring)) != nullptr) {
+            gas_reading_t reading;
+            bool parsed;
+            analyzer_channel_accept(&latest[slot->channel], slot, 0, &reading, &parsed);
+            lines.emplace_back(slot->channel, std::string(slot->text, slot->len));
+            line_ring_pop(&ring);
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("Trace records read back with their channel, time and chunk")
+{
+    uint8_t storage[256];
+    rx_trace_t trace;
+    rx_trace_init(&trace, storage, sizeof(storage));
+    rx_trace_start(&trace, 1000);
+
+    const std::string a = "He 35.0 %\r";
+    const std::string b = "\n";
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_OPEN, 2, 1500, nullptr, 0));
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_DATA, 2, 1750, bytes(a), a.size()));
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_DATA, 2, 1750, bytes(b), b.size()));
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_CLOSE, 2, 9000, nullptr, 0));
+    CHECK(trace.records == 4);
+    CHECK(trace.used == RX_TRACE_HEADER_SIZE + 4 * RX_TRACE_RECORD_HEADER_SIZE + a.size() + b.size());
+    CHECK(memcmp(storage, "GTRX\x01\0\0\0", RX_TRACE_HEADER_SIZE) == 0);
+
+    std::vector<rx_trace_record_t> records = read_all(storage, trace.used);
+    REQUIRE(records.size() == 4);
+    CHECK(records[0].type == RX_TRACE_REC_OPEN);
+    CHECK(records[0].channel == 2);
+    CHECK(records[0].delta_us == 500);
+    CHECK(records[0].data == nullptr);
+    CHECK(records[1].type == RX_TRACE_REC_DATA);
+    CHECK(records[1].delta_us == 250);
+    CHECK(std::string(reinterpret_cast<const char *>(records[1].data), records[1].len) == a);
+    CHECK(records[2].delta_us == 0);  // Same drain pass, boundary kept
+    CHECK(records[2].len == 1);
+    CHECK(records[3].type == RX_TRACE_REC_CLOSE);
+    CHECK(records[3].delta_us == 7250);
+}
+
+TEST_CASE("A full trace keeps a complete prefix and counts the rest as dropped")
+{
+    uint8_t storage[RX_TRACE_HEADER_SIZE + 3 * (RX_TRACE_RECORD_HEADER_SIZE + 10)];
+    rx_trace_t trace;
+    rx_trace_init(&trace, storage, sizeof(storage));
+    const uint8_t chunk[12] = {0};
+
+    // Not recording yet: nothing written, nothing dropped
+    CHECK_FALSE(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 0, chunk, 10));
+    CHECK(trace.dropped == 0);
+
+    rx_trace_start(&trace, 0);
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 10, chunk, 10));
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 20, chunk, 10));
+    CHECK_FALSE(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 30, chunk, 12));
+    // Would fit, but after a dropped record it would leave a hole
+    CHECK_FALSE(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 40, chunk, 4));
+    CHECK(trace.full);
+    CHECK(trace.records == 2);
+    CHECK(trace.dropped == 2);
+    CHECK(read_all(storage, trace.used).size() == 2);
+
+    // Stopped, the trace stays as it was
+    rx_trace_stop(&trace);
+    CHECK_FALSE(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 50, chunk, 1));
+    CHECK(trace.dropped == 2);
+
+    // A new capture starts empty
+    rx_trace_start(&trace, 100);
+    CHECK_FALSE(trace.full);
+    CHECK(trace.dropped == 0);
+    CHECK(rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 110, chunk, 12));
+    CHECK(read_all(storage, trace.used).size() == 1);
+
+    // No storage: records are only counted
+    rx_trace_t empty;
+    rx_trace_init(&empty, nullptr, 0);
+    rx_trace_start(&empty, 0);
+    CHECK_FALSE(rx_trace_record(&empty, RX_TRACE_REC_OPEN, 0, 0, nullptr, 0));
+    CHECK(empty.dropped == 1);
+}
+
+TEST_CASE("Trace times saturate and never run backwards")
+{
+    uint8_t storage[64];
+    rx_trace_t trace;
+    rx_trace_init(&trace, storage, sizeof(storage));
+    rx_trace_start(&trace, 0);
+    rx_trace_record(&trace, RX_TRACE_REC_OPEN, 0, 5000000000LL, nullptr, 0);  // Idle for over an hour
+    rx_trace_record(&trace, RX_TRACE_REC_CLOSE, 0, 4999999000LL, nullptr, 0);
+
+    std::vector<rx_trace_record_t> records = read_all(storage, trace.used);
+    REQUIRE(records.size() == 2);
+    CHECK(records[0].delta_us == UINT32_MAX);
+    CHECK(records[1].delta_us == 0);
+}
+
+TEST_CASE("Malformed traces are rejected or stop at the last whole record")
+{
+    uint8_t storage[64];
+    rx_trace_t trace;
+    rx_trace_init(&trace, storage, sizeof(storage));
+    rx_trace_start(&trace, 0);
+    const std::string data = "O2 21.0";
+    rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 1, bytes(data), data.size());
+    rx_trace_record(&trace, RX_TRACE_REC_DATA, 0, 2, bytes(data), data.size());
+
+    bool truncated = false;
+    CHECK(read_all(storage, trace.used - 3, &truncated).size() == 1);
+    CHECK(truncated);
+    CHECK(read_all(storage, trace.used, &truncated).size() == 2);
+    CHECK_FALSE(truncated);
+
+    rx_trace_reader_t reader;
+    rx_trace_record_t record;
+    CHECK_FALSE(rx_trace_reader_init(&reader, storage, RX_TRACE_HEADER_SIZE - 1));
+    CHECK_FALSE(rx_trace_next(&reader, &record));
+    storage[4] = RX_TRACE_VERSION + 1;
+    CHECK_FALSE(rx_trace_reader_init(&reader, storage, trace.used));
+    CHECK_FALSE(rx_trace_next(&reader, &record));
+}
+
+TEST_CASE("Replaying a trace gives the same lines as the capture")
+{
+    std::vector<uint8_t> storage(64 * 1024);
+    rx_trace_t trace;
+    rx_trace_init(&trace, storage.data(), storage.size());
+
+    // Two analyzers with odd chunk sizes, one unplugged mid-line and plugged
+    // back: boundaries and the dropped partial line must replay exactly
+    rx_side live;
+    live.trace = &trace;
+    rx_trace_start(&trace, 0);
+    const std::string s0 = analyzer_streams::session(50);
+    const std::string s1 = analyzer_streams::session(30);
+    int64_t now = 0;
+    size_t p0 = 0;
+    size_t p1 = 0;
+    bool replugged = false;
+    while (p0 < s0.size() || p1 < s1.size()) {
+        now += 3000;
+        if (p0 < s0.size()) {
+            size_t n = std::min<size_t>(s0.size() - p0, 37);
+            live.chunk(0, now, bytes(s0) + p0, n);
+            p0 += n;
+        }
+        if (p1 < s1.size()) {
+            size_t n = std::min<size_t>(s1.size() - p1, 61);
+            live.chunk(1, now, bytes(s1) + p1, n);
+            p1 += n;
+            if (!replugged && p1 > s1.size() / 2) {
+                live.close(1, now);
+                replugged = true;
+            }
+        }
+    }
+    rx_trace_stop(&trace);
+    CHECK(trace.dropped == 0);
+    REQUIRE(live.lines.size() > analyzer_streams::session_line_count(50));
+
+    rx_side replayed;
+    uint64_t total_us = 0;
+    for (const rx_trace_record_t &record : read_all(storage.data(), trace.used)) {
+        total_us += record.delta_us;
+        replayed.replay(record);
+    }
+    CHECK(total_us == (uint64_t)now);
+    CHECK(replayed.lines == live.lines);
+    for (uint8_t id = 0; id < 2; id++) {
+        CHECK(replayed.channels[id].stream.stats.framing_errors == live.channels[id].stream.stats.framing_errors);
+        CHECK(replayed.latest[id].parse_failures == live.latest[id].parse_failures);
+        CHECK(replayed.latest[id].lines == live.latest[id].lines);
+    }
+}
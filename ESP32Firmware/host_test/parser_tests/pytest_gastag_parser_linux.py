@@ -0,0 +1,10 @@
+import pytest
+from pytest_embedded import Dut
+from pytest_embedded_idf.utils import idf_parametrize
+
+
+@pytest.mark.host_test
+@idf_parametrize('target', ['linux'], indirect=['target'])
+def test_gastag_parser_linux(dut: Dut) -> None:
+    # Benchmarks run as part of the session, so allow more than the usual 5s
+    dut.expect_exact('All tests passed', timeout=120)
@@ -0,0 +1,88 @@
+/*
+ * Analyzer Channels Implementation
+ */
+
+#include "analyzer_channel.h"
+
+#include <string.h>
+
+_Static_assert(((ANALYZER_CHANNEL_MAX - 1) << GAS_READING_CHANNEL_SHIFT) <= GAS_READING_CHANNEL_MASK,
+               "ANALYZER_CHANNEL_MAX does not fit the reading flags");
+_Static_assert(ANALYZER_CHANNEL_MAX <= 10, "Text prefix holds a single digit");
+
+// ============== DEVICE SIDE ==============
+static void queue_line(const char *line, size_t len, uint8_t flags, void *ctx) {
+    analyzer_channel_t *channel = (analyzer_channel_t *)ctx;
+    line_ring_push(channel->ring, channel->id, flags, line, len);
+}
+
+void analyzer_channel_init(analyzer_channel_t *channel, uint8_t id, line_ring_t *ring) {
+    channel->id = id;
+    channel->ring = ring;
+    analyzer_stream_init(&channel->stream);
+}
+
+void analyzer_channel_reset(analyzer_channel_t *channel) {
+    analyzer_stream_reset_line(&channel->stream);
+}
+
+size_t analyzer_channel_feed(analyzer_channel_t *channel, const uint8_t *data, size_t len) {
+    return analyzer_stream_feed(&channel->stream, data, len, queue_line, channel);
+}
+
+// ============== NOTIFY SIDE ==============
+void analyzer_channel_latest_init(analyzer_channel_latest_t *latest, const reading_filter_config_t *config) {
+    memset(latest, 0, sizeof(*latest));
+    reading_filter_init(&latest->filter, config);
+}
+
+bool analyzer_channel_accept(analyzer_channel_latest_t *latest, const line_ring_slot_t *slot,
+                             uint32_t now_ms, gas_reading_t *reading, bool *parsed) {
+    size_t n = 0;
+    if (slot->channel != 0) {
+        latest->text[n++] = '#';
+        latest->text[n++] = (char)('0' + slot->channel);
+        latest->text[n++] = ' ';
+    }
+    memcpy(latest->text + n, slot->text, slot->len);
+    n += slot->len;
+    latest->text[n] = '\0';
+    latest->text_len = (uint16_t)n;
+    latest->lines++;
+
+    // A truncated line lost its tail; whatever parses from the rest may be cut mid-field
+    *parsed = !(slot->flags & ANALYZER_LINE_TRUNCATED) && divesoft_parse_line(slot->text, slot->len, reading);
+    if (!*parsed) {
+        latest->parse_failures++;
+        return true;  // Text clients still see the line
+    }
+    reading->flags = (uint8_t)((reading->flags & ~GAS_READING_CHANNEL_MASK) |
+                               ((slot->channel << GAS_READING_CHANNEL_SHIFT) & GAS_READING_CHANNEL_MASK));
+    latest->reading = *reading;
+    latest->has_reading = true;
+
+    // In deadband mode, repeats of the last sent reading stay off the air
+    return reading_filter_accept(&latest->filter, reading, now_ms);
+}
+
+uint8_t analyzer_channel_take(analyzer_channel_latest_t *latest, const line_ring_slot_t *slot,
+                              uint32_t now_ms, const analyzer_channel_hooks_t *hooks) {
+    uint8_t id = slot->channel < ANALYZER_CHANNEL_MAX ? slot->channel : 0;
+    analyzer_channel_latest_t *channel = &latest[id];
+    gas_reading_t reading;
+    bool parsed;
+    bool send = analyzer_channel_accept(channel, slot, now_ms, &reading, &parsed);
+
+    // History and logging keep every reading, the deadband only thins the air
+    uint32_t seq = 0;
+    if (parsed && hooks->parsed != NULL) {
+        seq = hooks->parsed(id, &reading, hooks->ctx);
+    }
+    if (send && hooks->send_text != NULL) {
+        hooks->send_text(id, channel->text, channel->text_len, hooks->ctx);
+    }
+    if (send && parsed && hooks->send_reading != NULL) {
+        hooks->send_reading(id, seq, &reading, hooks->ctx);
+    }
+    return id;
+}
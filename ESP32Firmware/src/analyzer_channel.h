@@ -0,0 +1,140 @@
+/*
+ * Analyzer Channels for GasTag Bridge
+ *
+ * Several analyzers behind a USB hub share one BLE link. Each open device
+ * is a channel with its own line assembler, parser state, deadband filter
+ * and latest reading, so interleaved USB chunks from different analyzers
+ * never mix and attaching or detaching one leaves the others untouched.
+ *
+ * The two halves run in different tasks:
+ *
+ *   analyzer_channel_t         USB RX task: frames the device's bytes
+ *                              into lines and queues them on the shared
+ *                              line ring, tagged with the channel ID
+ *   analyzer_channel_latest_t  BLE notify task: parses each line, tags the
+ *                              reading with the channel and decides whether
+ *                              it is sent
+ *
+ * On BLE the channel ID travels in bits 4-5 of the reading flags
+ * (GAS_READING_CHANNEL). Text lines from channel 0 are sent unchanged so a
+ * single analyzer looks exactly as before; lines from other channels are
+ * prefixed "#<id> ".
+ */
+
+#ifndef ANALYZER_CHANNEL_H
+#define ANALYZER_CHANNEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "analyzer_stream.h"
+#include "divesoft_parser.h"
+#include "line_ring.h"
+#include "reading_filter.h"
+
+// ============== CHANNEL CONFIGURATION ==============
+#define ANALYZER_CHANNEL_MAX         4   // Must fit GAS_READING_CHANNEL_MASK
+#define ANALYZER_CHANNEL_PREFIX_MAX  3   // "#3 "
+#define ANALYZER_CHANNEL_TEXT_MAX    (LINE_RING_LINE_MAX + ANALYZER_CHANNEL_PREFIX_MAX)
+
+// ============== CHANNEL TYPES ==============
+typedef struct {
+    uint8_t id;                 // Channel ID, 0..ANALYZER_CHANNEL_MAX - 1
+    line_ring_t *ring;          // Where completed lines are queued
+    analyzer_stream_t stream;   // This device's line assembler
+} analyzer_channel_t;
+
+typedef struct {
+    char text[ANALYZER_CHANNEL_TEXT_MAX];  // Latest line as sent on the text characteristic
+    uint16_t text_len;
+    gas_reading_t reading;      // Latest parsed reading, channel bits set
+    bool has_reading;           // false until a line parses
+    reading_filter_t filter;    // Deadband state for this analyzer only
+    uint32_t lines;             // Lines taken
+    uint32_t parse_failures;    // Lines that were not a reading
+} analyzer_channel_latest_t;
+
+/**
+ * What the notify task does with a taken line, see analyzer_channel_take().
+ * Every hook is optional; they run in the caller's task.
+ */
+typedef struct {
+    // Every line that parsed, sent or filtered out; returns the sequence
+    // number handed to send_reading
+    uint32_t (*parsed)(uint8_t id, const gas_reading_t *reading, void *ctx);
+    // Text of a line that is sent, channel prefix included
+    void (*send_text)(uint8_t id, const char *text, size_t len, void *ctx);
+    // Reading of a line that is sent, after its text
+    void (*send_reading)(uint8_t id, uint32_t seq, const gas_reading_t *reading, void *ctx);
+    void *ctx;
+} analyzer_channel_hooks_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Set up the device side of a channel with an empty line.
+ *
+ * @param channel Channel to initialize
+ * @param id      Channel ID
+ * @param ring    Line ring shared by all channels
+ */
+void analyzer_channel_init(analyzer_channel_t *channel, uint8_t id, line_ring_t *ring);
+
+/**
+ * Drop any partial line, keeping the counters. Call when the device closes
+ * so a half-received line does not prefix the next device's output.
+ *
+ * @param channel Channel
+ */
+void analyzer_channel_reset(analyzer_channel_t *channel);
+
+/**
+ * Feed a chunk of raw bytes from the channel's device and queue every
+ * completed line on the ring (lines that do not fit are counted there).
+ *
+ * @param channel Channel
+ * @param data    Raw bytes
+ * @param len     Number of bytes
+ * @return Number of lines completed by this chunk
+ */
+size_t analyzer_channel_feed(analyzer_channel_t *channel, const uint8_t *data, size_t len);
+
+/**
+ * Clear the latest line and reading and set up the filter.
+ *
+ * @param latest Per-channel state to initialize
+ * @param config Filter configuration
+ */
+void analyzer_channel_latest_init(analyzer_channel_latest_t *latest, const reading_filter_config_t *config);
+
+/**
+ * Take one queued line: keep it as the channel's latest text, parse it and
+ * run the channel's filter. Lines flagged ANALYZER_LINE_TRUNCATED are only
+ * kept as text and counted as parse failures.
+ *
+ * @param latest  State of the channel the line came from
+ * @param slot    Line from the ring
+ * @param now_ms  Current time in milliseconds (wrapping is fine)
+ * @param reading Parsed reading with the channel bits set, only written if parsed
+ * @param parsed  Set to whether the line was a reading
+ * @return true if the line (and reading, if parsed) should be sent
+ */
+bool analyzer_channel_accept(analyzer_channel_latest_t *latest, const line_ring_slot_t *slot,
+                             uint32_t now_ms, gas_reading_t *reading, bool *parsed);
+
+/**
+ * Take one queued line the way the notify task does: accept it on the
+ * channel it came from (IDs out of range count as channel 0), then pass
+ * it to the hooks. The caller still pops the line.
+ *
+ * @param latest Per-channel state, ANALYZER_CHANNEL_MAX entries
+ * @param slot   Line from the ring
+ * @param now_ms Current time in milliseconds (wrapping is fine)
+ * @param hooks  What to do with the line
+ * @return Channel ID the line was taken for
+ */
+uint8_t analyzer_channel_take(analyzer_channel_latest_t *latest, const line_ring_slot_t *slot,
+                              uint32_t now_ms, const analyzer_channel_hooks_t *hooks);
+
+#endif // ANALYZER_CHANNEL_H
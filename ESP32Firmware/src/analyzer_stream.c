@@ -0,0 +1,108 @@
+/*
+ * Analyzer Stream Framer Implementation
+ *
+ * The feed loop alternates between two states driven by the byte class
+ * table: inside a run of text (scan ahead, then append the run in one copy)
+ * and at a delimiter (end the line, or drop an invalid byte).
+ */
+
+#include "analyzer_stream.h"
+
+#include <string.h>
+
+// ============== BYTE CLASSES ==============
+enum {
+    BYTE_INVALID = 0,  // Control characters and non-ASCII bytes
+    BYTE_TEXT,         // Printable ASCII
+    BYTE_EOL,          // CR or LF
+};
+
+#define TEXT_RANGE_4(c)   [c] = BYTE_TEXT, [c + 1] = BYTE_TEXT, [c + 2] = BYTE_TEXT, [c + 3] = BYTE_TEXT
+#define TEXT_RANGE_16(c)  TEXT_RANGE_4(c), TEXT_RANGE_4(c + 4), TEXT_RANGE_4(c + 8), TEXT_RANGE_4(c + 12)
+
+static const uint8_t byte_class[256] = {
+    TEXT_RANGE_16(0x20), TEXT_RANGE_16(0x30), TEXT_RANGE_16(0x40),
+    TEXT_RANGE_16(0x50), TEXT_RANGE_16(0x60),
+    TEXT_RANGE_4(0x70), TEXT_RANGE_4(0x74), TEXT_RANGE_4(0x78),
+    [0x7C] = BYTE_TEXT, [0x7D] = BYTE_TEXT, [0x7E] = BYTE_TEXT,  // 0x7F (DEL) is invalid
+    ['\r'] = BYTE_EOL, ['\n'] = BYTE_EOL,
+};
+
+// ============== LINE HELPERS ==============
+static void append_run(analyzer_stream_t *stream, const uint8_t *run, size_t n) {
+    size_t space = (ANALYZER_STREAM_LINE_MAX - 1) - stream->len;
+    if (n > space) {
+        stream->flags |= ANALYZER_LINE_TRUNCATED;
+        stream->stats.truncated_bytes += n - space;
+        n = space;
+    }
+    memcpy(&stream->line[stream->len], run, n);
+    stream->len += n;
+}
+
+static bool end_line(analyzer_stream_t *stream, analyzer_line_cb_t cb, void *ctx) {
+    bool delivered = false;
+
+    if (stream->flags & ANALYZER_LINE_FRAMING_ERROR) {
+        stream->stats.framing_errors++;
+    }
+    if (stream->len > 0) {
+        stream->line[stream->len] = '\0';
+        stream->stats.lines++;
+        if (stream->flags & ANALYZER_LINE_TRUNCATED) {
+            stream->stats.truncated_lines++;
+        }
+        if (cb != NULL) {
+            cb(stream->line, stream->len, stream->flags, ctx);
+        }
+        delivered = true;
+    }
+
+    stream->len = 0;
+    stream->flags = 0;
+    return delivered;
+}
+
+// ============== PUBLIC API ==============
+void analyzer_stream_init(analyzer_stream_t *stream) {
+    memset(stream, 0, sizeof(*stream));
+}
+
+void analyzer_stream_reset_line(analyzer_stream_t *stream) {
+    stream->len = 0;
+    stream->flags = 0;
+}
+
+size_t analyzer_stream_feed(analyzer_stream_t *stream, const uint8_t *data, size_t len,
+                            analyzer_line_cb_t cb, void *ctx) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+    size_t lines = 0;
+
+    stream->stats.bytes += len;
+
+    while (p < end) {
+        // Scan to the next delimiter, then copy the whole text run at once
+        const uint8_t *run = p;
+        while (p < end && byte_class[*p] == BYTE_TEXT) {
+            p++;
+        }
+        if (p > run) {
+            append_run(stream, run, p - run);
+        }
+        if (p == end) {
+            break;
+        }
+
+        if (byte_class[*p] == BYTE_EOL) {
+            if (end_line(stream, cb, ctx)) {
+                lines++;
+            }
+        } else {
+            stream->flags |= ANALYZER_LINE_FRAMING_ERROR;
+            stream->stats.invalid_bytes++;
+        }
+        p++;
+    }
+    return lines;
+}
@@ -0,0 +1,85 @@
+/*
+ * Analyzer Stream Framer for GasTag Bridge
+ *
+ * Incremental line assembler for raw analyzer bytes arriving in arbitrary
+ * USB chunks. Lines end at CR or LF (CRLF, LFCR and blank lines produce no
+ * empty lines). Each byte is classified through a lookup table; runs of
+ * printable text are located in one pass and copied with a single memcpy.
+ *
+ * Nothing is dropped silently: over-long lines and bytes that cannot appear
+ * in analyzer output are reported per line and accumulated in counters.
+ * No heap is used; one analyzer_stream_t holds all state.
+ */
+
+#ifndef ANALYZER_STREAM_H
+#define ANALYZER_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============== STREAM CONFIGURATION ==============
+#define ANALYZER_STREAM_LINE_MAX  256  // Max line length including null terminator
+
+// ============== LINE FLAGS ==============
+#define ANALYZER_LINE_TRUNCATED      0x01  // Line exceeded ANALYZER_STREAM_LINE_MAX - 1 bytes
+#define ANALYZER_LINE_FRAMING_ERROR  0x02  // Line contained control or non-ASCII bytes (removed)
+
+// ============== STREAM TYPES ==============
+typedef struct {
+    uint32_t bytes;            // Bytes fed in total
+    uint32_t lines;            // Lines delivered
+    uint32_t truncated_lines;  // Lines delivered with ANALYZER_LINE_TRUNCATED
+    uint32_t truncated_bytes;  // Bytes cut from over-long lines
+    uint32_t framing_errors;   // Lines that contained control/non-ASCII bytes (empty ones are discarded)
+    uint32_t invalid_bytes;    // Control/non-ASCII bytes removed
+} analyzer_stream_stats_t;
+
+/**
+ * Completed line callback.
+ *
+ * @param line  Null-terminated line text, valid only during the callback
+ * @param len   Line length, excluding null terminator
+ * @param flags ANALYZER_LINE_* bits
+ * @param ctx   User context passed to analyzer_stream_feed()
+ */
+typedef void (*analyzer_line_cb_t)(const char *line, size_t len, uint8_t flags, void *ctx);
+
+typedef struct {
+    char line[ANALYZER_STREAM_LINE_MAX];
+    uint16_t len;
+    uint8_t flags;             // Flags accumulated for the line in progress
+    analyzer_stream_stats_t stats;
+} analyzer_stream_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Reset the stream to an empty line and clear its counters.
+ *
+ * @param stream Stream to initialize
+ */
+void analyzer_stream_init(analyzer_stream_t *stream);
+
+/**
+ * Discard any partial line, keeping the counters.
+ * Call when the underlying device goes away.
+ *
+ * @param stream Stream to reset
+ */
+void analyzer_stream_reset_line(analyzer_stream_t *stream);
+
+/**
+ * Feed a chunk of raw bytes. Calls cb once per completed line.
+ *
+ * @param stream Stream state
+ * @param data   Raw bytes
+ * @param len    Number of bytes
+ * @param cb     Completed line callback
+ * @param ctx    User context for cb
+ * @return Number of lines completed by this chunk
+ */
+size_t analyzer_stream_feed(analyzer_stream_t *stream, const uint8_t *data, size_t len,
+                            analyzer_line_cb_t cb, void *ctx);
+
+#endif // ANALYZER_STREAM_H
@@ -0,0 +1,78 @@
+/*
+ * Attach Timing Implementation
+ */
+
+#include "attach_timing.h"
+
+#include <string.h>
+
+void attach_timing_init(attach_timing_t *timing) {
+    memset(timing, 0, sizeof(*timing));
+}
+
+void attach_timing_start(attach_timing_t *timing, int64_t detected_us, bool reattach) {
+    memset(timing->mark_us, 0, sizeof(timing->mark_us));
+    // 0 means "not reached"; a detection at time zero still counts
+    timing->mark_us[ATTACH_PHASE_DETECTED] = detected_us > 0 ? detected_us : 1;
+    timing->reattach = reattach;
+}
+
+bool attach_timing_mark(attach_timing_t *timing, attach_phase_t phase, int64_t at_us) {
+    if (phase <= ATTACH_PHASE_DETECTED || phase >= ATTACH_PHASE_COUNT ||
+        timing->mark_us[ATTACH_PHASE_DETECTED] == 0 || timing->mark_us[phase] != 0) {
+        return false;
+    }
+    int64_t detected = timing->mark_us[ATTACH_PHASE_DETECTED];
+    timing->mark_us[phase] = at_us > detected ? at_us : detected;
+
+    if (phase == ATTACH_PHASE_FIRST_LINE) {
+        int64_t total = timing->mark_us[phase] - detected;
+        if (timing->attaches == 0 || total < timing->first_line_best_us) {
+            timing->first_line_best_us = total;
+        }
+        if (total > timing->first_line_worst_us) {
+            timing->first_line_worst_us = total;
+        }
+        timing->first_line_sum_us += total;
+        timing->attaches++;
+    }
+    return true;
+}
+
+int64_t attach_timing_phase_us(const attach_timing_t *timing, attach_phase_t phase) {
+    if (phase <= ATTACH_PHASE_DETECTED || phase >= ATTACH_PHASE_COUNT ||
+        timing->mark_us[phase] == 0) {
+        return -1;
+    }
+    // Skipped phases (e.g. no subscriber yet) fold into the next one
+    int64_t start = timing->mark_us[ATTACH_PHASE_DETECTED];
+    for (int p = phase - 1; p > ATTACH_PHASE_DETECTED; p--) {
+        if (timing->mark_us[p] != 0) {
+            start = timing->mark_us[p];
+            break;
+        }
+    }
+    int64_t duration = timing->mark_us[phase] - start;
+    return duration > 0 ? duration : 0;  // Data can beat the DTR request back
+}
+
+int64_t attach_timing_total_us(const attach_timing_t *timing, attach_phase_t phase) {
+    if (phase < ATTACH_PHASE_DETECTED || phase >= ATTACH_PHASE_COUNT ||
+        timing->mark_us[phase] == 0) {
+        return -1;
+    }
+    return timing->mark_us[phase] - timing->mark_us[ATTACH_PHASE_DETECTED];
+}
+
+const char *attach_phase_name(attach_phase_t phase) {
+    switch (phase) {
+        case ATTACH_PHASE_DETECTED:   return "detected";
+        case ATTACH_PHASE_OPENED:     return "opened";
+        case ATTACH_PHASE_CONFIGURED: return "configured";
+        case ATTACH_PHASE_FIRST_DATA: return "first data";
+        case ATTACH_PHASE_FIRST_LINE: return "first line";
+        case ATTACH_PHASE_NOTIFIED:   return "notified";
+        case ATTACH_PHASE_COUNT:      break;
+    }
+    return "?";
+}
@@ -0,0 +1,97 @@
+/*
+ * Attach Timing for GasTag Bridge
+ *
+ * Timestamps each phase between an analyzer appearing on USB and its first
+ * line reaching a phone, so plug-in-to-first-line latency can be measured
+ * on the bench and the slow phase found:
+ *
+ *   detected -> opened -> configured -> first data -> first line -> notified
+ *
+ * The bridge task owns the record. Phases reached in other tasks are passed
+ * to it with the time they happened, so the order marks arrive in does not
+ * matter. Plug-in-to-first-line is also summarised across attaches.
+ */
+
+#ifndef ATTACH_TIMING_H
+#define ATTACH_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============== TIMING TYPES ==============
+typedef enum {
+    ATTACH_PHASE_DETECTED,      // USB new-device callback
+    ATTACH_PHASE_OPENED,        // CDC device open, IN transfers running
+    ATTACH_PHASE_CONFIGURED,    // Line coding and DTR sent
+    ATTACH_PHASE_FIRST_DATA,    // First bulk IN bytes
+    ATTACH_PHASE_FIRST_LINE,    // First complete line framed
+    ATTACH_PHASE_NOTIFIED,      // First notification sent from it
+    ATTACH_PHASE_COUNT,
+} attach_phase_t;
+
+typedef struct {
+    int64_t mark_us[ATTACH_PHASE_COUNT];  // 0 until the phase is reached
+    bool reattach;              // Same VID/PID as the previous attach
+    uint32_t attaches;          // Attaches that reached the first line
+    int64_t first_line_best_us; // Plug-in-to-first-line, over all attaches
+    int64_t first_line_worst_us;
+    int64_t first_line_sum_us;
+} attach_timing_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Clear the record and the summary.
+ *
+ * @param timing Record to initialize
+ */
+void attach_timing_init(attach_timing_t *timing);
+
+/**
+ * Start timing a new attach, dropping the marks of the previous one.
+ *
+ * @param timing      Record
+ * @param detected_us When the device was detected
+ * @param reattach    Device is the one seen last time
+ */
+void attach_timing_start(attach_timing_t *timing, int64_t detected_us, bool reattach);
+
+/**
+ * Record the time a phase was reached. Only the first mark of a phase per
+ * attach counts, and nothing is recorded before attach_timing_start().
+ * Reaching ATTACH_PHASE_FIRST_LINE updates the summary.
+ *
+ * @param timing Record
+ * @param phase  Phase reached
+ * @param at_us  When it was reached
+ * @return true if the mark was recorded
+ */
+bool attach_timing_mark(attach_timing_t *timing, attach_phase_t phase, int64_t at_us);
+
+/**
+ * Time spent in one phase: from the latest earlier phase reached to this one.
+ *
+ * @param timing Record
+ * @param phase  Phase to measure (not ATTACH_PHASE_DETECTED)
+ * @return Duration in microseconds, -1 if the phase was not reached
+ */
+int64_t attach_timing_phase_us(const attach_timing_t *timing, attach_phase_t phase);
+
+/**
+ * Time from detection to a phase.
+ *
+ * @param timing Record
+ * @param phase  Phase to measure
+ * @return Duration in microseconds, -1 if the phase was not reached
+ */
+int64_t attach_timing_total_us(const attach_timing_t *timing, attach_phase_t phase);
+
+/**
+ * Name of a phase, for logging.
+ *
+ * @param phase Phase
+ * @return Static string
+ */
+const char *attach_phase_name(attach_phase_t phase);
+
+#endif // ATTACH_TIMING_H
@@ -0,0 +1,228 @@
+/*
+ * BLE Connection Table Implementation
+ */
+
+#include "ble_conn.h"
+
+#include <string.h>
+
+void ble_conn_table_init(ble_conn_table_t *table) {
+    memset(table, 0, sizeof(*table));
+}
+
+void ble_conn_table_set_lock(ble_conn_table_t *table, ble_conn_lock_fn lock, ble_conn_lock_fn unlock, void *ctx) {
+    table->lock = lock;
+    table->unlock = unlock;
+    table->lock_ctx = ctx;
+}
+
+void ble_conn_table_lock(ble_conn_table_t *table) {
+    if (table->lock != NULL) {
+        table->lock(table->lock_ctx);
+    }
+}
+
+void ble_conn_table_unlock(ble_conn_table_t *table) {
+    if (table->unlock != NULL) {
+        table->unlock(table->lock_ctx);
+    }
+}
+
+ble_conn_t *ble_conn_add(ble_conn_table_t *table, uint16_t conn_id, const uint8_t *bda) {
+    // A repeated connect for the same id replaces the stale entry
+    ble_conn_remove(table, conn_id);
+
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        ble_conn_t *conn = &table->conns[i];
+        if (conn->in_use) {
+            continue;
+        }
+        memset(conn, 0, sizeof(*conn));
+        conn->conn_id = conn_id;
+        memcpy(conn->bda, bda, sizeof(conn->bda));
+        conn->mtu = BLE_ATT_DEFAULT_MTU;
+        conn->tx_phy = BLE_CONN_PHY_1M;
+        conn->rx_phy = BLE_CONN_PHY_1M;
+        conn->tx_data_len = BLE_LL_DEFAULT_DATA_LEN;
+        conn->rx_data_len = BLE_LL_DEFAULT_DATA_LEN;
+        conn->in_use = true;
+        return conn;
+    }
+    return NULL;
+}
+
+void ble_conn_remove(ble_conn_table_t *table, uint16_t conn_id) {
+    ble_conn_t *conn = ble_conn_find(table, conn_id);
+    if (conn != NULL) {
+        conn->in_use = false;
+    }
+}
+
+ble_conn_t *ble_conn_find(ble_conn_table_t *table, uint16_t conn_id) {
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        if (table->conns[i].in_use && table->conns[i].conn_id == conn_id) {
+            return &table->conns[i];
+        }
+    }
+    return NULL;
+}
+
+ble_conn_t *ble_conn_find_bda(ble_conn_table_t *table, const uint8_t *bda) {
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        if (table->conns[i].in_use && memcmp(table->conns[i].bda, bda, sizeof(table->conns[i].bda)) == 0) {
+            return &table->conns[i];
+        }
+    }
+    return NULL;
+}
+
+size_t ble_conn_count(const ble_conn_table_t *table) {
+    size_t count = 0;
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        if (table->conns[i].in_use) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ble_conn_subscribed(const ble_conn_t *conn, ble_conn_char_t ch) {
+    return (conn->cccd[ch] & (BLE_CONN_CCCD_NOTIFY | BLE_CONN_CCCD_INDICATE)) != 0;
+}
+
+bool ble_conn_wants_indication(const ble_conn_t *conn, ble_conn_char_t ch) {
+    return (conn->cccd[ch] & (BLE_CONN_CCCD_NOTIFY | BLE_CONN_CCCD_INDICATE)) == BLE_CONN_CCCD_INDICATE;
+}
+
+bool ble_conn_set_cccd(ble_conn_t *conn, ble_conn_char_t ch, uint16_t value) {
+    bool was_subscribed = ble_conn_subscribed(conn, ch);
+    conn->cccd[ch] = value;
+    return !was_subscribed && ble_conn_subscribed(conn, ch);
+}
+
+size_t ble_conn_subscribers(const ble_conn_table_t *table, ble_conn_char_t ch) {
+    size_t count = 0;
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        const ble_conn_t *conn = &table->conns[i];
+        if (conn->in_use && ble_conn_subscribed(conn, ch)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint16_t ble_conn_min_mtu(const ble_conn_table_t *table, ble_conn_char_t ch) {
+    uint16_t mtu = 0;
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        const ble_conn_t *conn = &table->conns[i];
+        if (conn->in_use && ble_conn_subscribed(conn, ch) && (mtu == 0 || conn->mtu < mtu)) {
+            mtu = conn->mtu;
+        }
+    }
+    return mtu != 0 ? mtu : BLE_ATT_DEFAULT_MTU;
+}
+
+bool ble_conn_all_congested(const ble_conn_table_t *table) {
+    bool any = false;
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        const ble_conn_t *conn = &table->conns[i];
+        if (!conn->in_use) {
+            continue;
+        }
+        if (!conn->congested) {
+            return false;
+        }
+        any = true;
+    }
+    return any;
+}
+
+size_t ble_conn_fanout(ble_conn_table_t *table, ble_conn_char_t ch, const uint8_t *data, size_t len,
+                       ble_conn_send_fn send, void *ctx) {
+    ble_conn_t targets[BLE_CONN_MAX];
+    size_t count = 0;
+    ble_conn_table_lock(table);
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        ble_conn_t *conn = &table->conns[i];
+        if (!conn->in_use || !ble_conn_subscribed(conn, ch)) {
+            continue;
+        }
+        if (conn->congested || len + BLE_ATT_NOTIFY_OVERHEAD > conn->mtu) {
+            conn->dropped++;
+            continue;
+        }
+        targets[count++] = *conn;
+    }
+    ble_conn_table_unlock(table);
+
+    bool ok[BLE_CONN_MAX];
+    size_t sent = 0;
+    for (size_t i = 0; i < count; i++) {
+        ok[i] = send(&targets[i], data, len, ctx);
+        if (ok[i]) {
+            sent++;
+        }
+    }
+
+    // Count against the live entries; connections gone meanwhile are skipped
+    ble_conn_table_lock(table);
+    for (size_t i = 0; i < count; i++) {
+        ble_conn_t *conn = ble_conn_find(table, targets[i].conn_id);
+        if (conn != NULL) {
+            ble_conn_account(conn, len, ok[i]);
+        }
+    }
+    ble_conn_table_unlock(table);
+    return sent;
+}
+
+void ble_conn_account(ble_conn_t *conn, size_t len, bool sent) {
+    if (sent) {
+        conn->sent++;
+        conn->tx_bytes += (uint32_t)len;
+    } else {
+        conn->dropped++;
+    }
+}
+
+void ble_conn_update_rate(ble_conn_t *conn, uint32_t now_ms) {
+    if (conn->rate_window_ms == 0) {
+        conn->rate_window_ms = now_ms;
+        conn->rate_window_bytes = conn->tx_bytes;
+        return;
+    }
+    uint32_t elapsed = now_ms - conn->rate_window_ms;
+    if (elapsed < BLE_CONN_RATE_WINDOW_MS) {
+        return;
+    }
+    conn->tx_rate = (uint32_t)((uint64_t)(conn->tx_bytes - conn->rate_window_bytes) * 1000 / elapsed);
+    conn->rate_window_ms = now_ms;
+    conn->rate_window_bytes = conn->tx_bytes;
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+size_t ble_conn_encode_diagnostics(const ble_conn_table_t *table, const ble_conn_t *conn, uint8_t *buf) {
+    buf[0] = BLE_CONN_DIAG_VERSION;
+    buf[1] = conn->tx_phy;
+    buf[2] = conn->rx_phy;
+    buf[3] = (uint8_t)ble_conn_count(table);
+    put_u16(&buf[4], conn->mtu);
+    put_u16(&buf[6], conn->tx_data_len);
+    put_u16(&buf[8], conn->rx_data_len);
+    put_u16(&buf[10], conn->interval);
+    put_u16(&buf[12], conn->latency);
+    put_u16(&buf[14], conn->timeout);
+    put_u32(&buf[16], conn->tx_rate);
+    put_u32(&buf[20], conn->sent);
+    put_u32(&buf[24], conn->dropped);
+    return BLE_CONN_DIAG_SIZE;
+}
@@ -0,0 +1,302 @@
+/*
+ * BLE Connection Table for GasTag Bridge
+ *
+ * Per-connection state for every connected central: MTU, CCCD values of the
+ * notifying characteristics, granted connection parameters, PHY and data
+ * length, congestion and measured throughput.
+ * Several phones can watch the same analyzer; each reading is fanned out to
+ * every connection subscribed to its characteristic.
+ *
+ * A table shared between tasks gets a lock (ble_conn_table_set_lock()), and
+ * every call is made with it held (ble_conn_table_lock()), except
+ * ble_conn_fanout(): it takes the lock itself and releases it around each
+ * send, so the caller's send function may block in the BLE stack. It sends
+ * from copies of the entries; a connection that drops in the middle of a
+ * fan-out only makes its send fail and is not counted.
+ *
+ * Diagnostics for one connection are read as a little-endian packet:
+ *
+ *   Offset  Size  Field
+ *   0       1     Diagnostics version (BLE_CONN_DIAG_VERSION)
+ *   1       1     TX PHY (BLE_CONN_PHY_*)
+ *   2       1     RX PHY
+ *   3       1     Connected clients
+ *   4       2     ATT MTU
+ *   6       2     LL TX data length, bytes
+ *   8       2     LL RX data length, bytes
+ *   10      2     Connection interval, 1.25 ms units
+ *   12      2     Slave latency
+ *   14      2     Supervision timeout, 10 ms units
+ *   16      4     Notification payload throughput, bytes/s
+ *   20      4     Notifications sent
+ *   24      4     Notifications dropped
+ */
+
+#ifndef BLE_CONN_H
+#define BLE_CONN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============== TABLE CONFIGURATION ==============
+#define BLE_CONN_MAX              4    // Matches CONFIG_BT_ACL_CONNECTIONS
+#define BLE_ATT_DEFAULT_MTU       23
+#define BLE_ATT_NOTIFY_OVERHEAD   3    // Opcode + handle
+
+#define BLE_LL_DEFAULT_DATA_LEN   27   // LL payload before data length extension
+#define BLE_LL_MAX_DATA_LEN       251
+#define BLE_CONN_RATE_WINDOW_MS   1000
+
+// PHY values, as reported by the controller
+#define BLE_CONN_PHY_1M           1
+#define BLE_CONN_PHY_2M           2
+#define BLE_CONN_PHY_CODED        3
+
+#define BLE_CONN_DIAG_VERSION     1
+#define BLE_CONN_DIAG_SIZE        28
+
+// CCCD value bits
+#define BLE_CONN_CCCD_NOTIFY      0x0001
+#define BLE_CONN_CCCD_INDICATE    0x0002
+
+// Characteristics a client can subscribe to
+typedef enum {
+    BLE_CONN_CHAR_TEXT,         // Gas data text line
+    BLE_CONN_CHAR_READING,      // Binary reading
+    BLE_CONN_CHAR_HISTORY,      // History backfill
+    BLE_CONN_CHAR_COUNT,
+} ble_conn_char_t;
+
+// ============== TABLE TYPES ==============
+typedef struct {
+    bool in_use;
+    bool congested;
+    uint16_t conn_id;
+    uint8_t bda[6];
+    uint16_t mtu;
+    uint16_t interval;          // Granted interval, 1.25 ms units (0 until known)
+    uint16_t latency;           // Granted slave latency, connection events
+    uint16_t timeout;           // Granted supervision timeout, 10 ms units
+    uint16_t cccd[BLE_CONN_CHAR_COUNT];
+    uint8_t tx_phy;             // BLE_CONN_PHY_*
+    uint8_t rx_phy;
+    uint16_t tx_data_len;       // LL payload bytes per packet
+    uint16_t rx_data_len;
+    uint32_t connected_ms;      // Caller's clock when the connection was made
+    uint32_t sent;              // Notifications handed to the stack
+    uint32_t dropped;           // Notifications skipped (congested or MTU too small)
+    uint32_t tx_bytes;          // Notification payload bytes handed to the stack
+    uint32_t tx_rate;           // tx_bytes per second over the last window
+    uint32_t rate_window_ms;    // Start of the current rate window
+    uint32_t rate_window_bytes; // tx_bytes at the start of the window
+} ble_conn_t;
+
+/**
+ * Take or release the table lock.
+ *
+ * @param ctx User context passed to ble_conn_table_set_lock()
+ */
+typedef void (*ble_conn_lock_fn)(void *ctx);
+
+typedef struct {
+    ble_conn_t conns[BLE_CONN_MAX];
+    ble_conn_lock_fn lock;      // NULL for a table used by a single task
+    ble_conn_lock_fn unlock;
+    void *lock_ctx;
+} ble_conn_table_t;
+
+/**
+ * Send one notification to one connection.
+ *
+ * @param conn Copy of the connection to send to, taken under the table lock
+ * @param data Notification payload
+ * @param len  Payload length
+ * @param ctx  User context passed to ble_conn_fanout()
+ * @return true if the stack accepted the notification
+ */
+typedef bool (*ble_conn_send_fn)(const ble_conn_t *conn, const uint8_t *data, size_t len, void *ctx);
+
+// ============== PUBLIC API ==============
+
+/**
+ * Empty the table. It starts without a lock.
+ *
+ * @param table Table to initialize
+ */
+void ble_conn_table_init(ble_conn_table_t *table);
+
+/**
+ * Install the lock for a table shared between tasks.
+ *
+ * @param table  Connection table
+ * @param lock   Takes the lock
+ * @param unlock Releases it
+ * @param ctx    User context for lock and unlock
+ */
+void ble_conn_table_set_lock(ble_conn_table_t *table, ble_conn_lock_fn lock, ble_conn_lock_fn unlock, void *ctx);
+
+/**
+ * Take the table lock. Does nothing for a table without one.
+ *
+ * @param table Connection table
+ */
+void ble_conn_table_lock(ble_conn_table_t *table);
+
+/**
+ * Release the table lock.
+ *
+ * @param table Connection table
+ */
+void ble_conn_table_unlock(ble_conn_table_t *table);
+
+/**
+ * Add a new connection with the default MTU and no subscriptions.
+ *
+ * @param table   Connection table
+ * @param conn_id Stack connection id
+ * @param bda     Peer address (6 bytes)
+ * @return The new entry, or NULL if the table is full
+ */
+ble_conn_t *ble_conn_add(ble_conn_table_t *table, uint16_t conn_id, const uint8_t *bda);
+
+/**
+ * Remove a connection. Does nothing if conn_id is unknown.
+ *
+ * @param table   Connection table
+ * @param conn_id Stack connection id
+ */
+void ble_conn_remove(ble_conn_table_t *table, uint16_t conn_id);
+
+/**
+ * Look up a connection by peer address, for GAP events that carry no
+ * conn_id.
+ *
+ * @param table Connection table
+ * @param bda   Peer address (6 bytes)
+ * @return The entry, or NULL if the peer is not connected
+ */
+ble_conn_t *ble_conn_find_bda(ble_conn_table_t *table, const uint8_t *bda);
+
+/**
+ * Look up a connection.
+ *
+ * @param table   Connection table
+ * @param conn_id Stack connection id
+ * @return The entry, or NULL if conn_id is not connected
+ */
+ble_conn_t *ble_conn_find(ble_conn_table_t *table, uint16_t conn_id);
+
+/**
+ * Number of connections in use.
+ *
+ * @param table Connection table
+ * @return Connection count
+ */
+size_t ble_conn_count(const ble_conn_table_t *table);
+
+/**
+ * Whether a connection has notifications or indications enabled.
+ *
+ * @param conn Connection
+ * @param ch   Characteristic
+ * @return true if subscribed
+ */
+bool ble_conn_subscribed(const ble_conn_t *conn, ble_conn_char_t ch);
+
+/**
+ * Whether a connection asked for indications rather than notifications.
+ * When a client enables both, notifications are used.
+ *
+ * @param conn Connection
+ * @param ch   Characteristic
+ * @return true if only indications are enabled
+ */
+bool ble_conn_wants_indication(const ble_conn_t *conn, ble_conn_char_t ch);
+
+/**
+ * Store a CCCD write.
+ *
+ * @param conn  Connection
+ * @param ch    Characteristic
+ * @param value CCCD value (BLE_CONN_CCCD_* bits)
+ * @return true if the write turned the subscription on, so the caller can
+ *         push the current value right away
+ */
+bool ble_conn_set_cccd(ble_conn_t *conn, ble_conn_char_t ch, uint16_t value);
+
+/**
+ * Number of connections subscribed to a characteristic.
+ *
+ * @param table Connection table
+ * @param ch    Characteristic
+ * @return Subscriber count
+ */
+size_t ble_conn_subscribers(const ble_conn_table_t *table, ble_conn_char_t ch);
+
+/**
+ * Smallest MTU among the subscribers of a characteristic, so one payload
+ * can be sent to all of them.
+ *
+ * @param table Connection table
+ * @param ch    Characteristic
+ * @return Smallest MTU, or BLE_ATT_DEFAULT_MTU if nobody is subscribed
+ */
+uint16_t ble_conn_min_mtu(const ble_conn_table_t *table, ble_conn_char_t ch);
+
+/**
+ * Whether every connection is congested. Callers hold data back only then;
+ * while any connection can take data, congested ones are skipped instead.
+ *
+ * @param table Connection table
+ * @return true if at least one connection exists and all are congested
+ */
+bool ble_conn_all_congested(const ble_conn_table_t *table);
+
+/**
+ * Send a payload to every connection subscribed to a characteristic.
+ * Congested connections, and ones whose MTU cannot carry the payload, are
+ * skipped and counted in their dropped counter. Called without the table
+ * lock: the receivers are picked and the sends counted with it held, and
+ * the sends themselves run with it released.
+ *
+ * @param table Connection table
+ * @param ch    Characteristic
+ * @param data  Notification payload
+ * @param len   Payload length
+ * @param send  Called once per receiving connection
+ * @param ctx   User context for send
+ * @return Number of connections the payload was sent to
+ */
+size_t ble_conn_fanout(ble_conn_table_t *table, ble_conn_char_t ch, const uint8_t *data, size_t len,
+                       ble_conn_send_fn send, void *ctx);
+
+/**
+ * Count one notification sent outside ble_conn_fanout().
+ *
+ * @param conn Connection
+ * @param len  Payload length
+ * @param sent true if the stack accepted it
+ */
+void ble_conn_account(ble_conn_t *conn, size_t len, bool sent);
+
+/**
+ * Close the throughput window once BLE_CONN_RATE_WINDOW_MS has passed and
+ * update tx_rate. Call regularly from the task that sends.
+ *
+ * @param conn   Connection
+ * @param now_ms Current time, same clock as connected_ms
+ */
+void ble_conn_update_rate(ble_conn_t *conn, uint32_t now_ms);
+
+/**
+ * Encode the diagnostics packet for one connection.
+ *
+ * @param table Connection table (for the client count)
+ * @param conn  Connection to describe
+ * @param buf   Output, at least BLE_CONN_DIAG_SIZE bytes
+ * @return Number of bytes written (BLE_CONN_DIAG_SIZE)
+ */
+size_t ble_conn_encode_diagnostics(const ble_conn_table_t *table, const ble_conn_t *conn, uint8_t *buf);
+
+#endif // BLE_CONN_H
@@ -0,0 +1,183 @@
+/*
+ * Bridge State Machine Implementation
+ */
+
+#include "bridge_state.h"
+
+#include <string.h>
+
+void bridge_state_init(bridge_state_t *state) {
+    memset(state, 0, sizeof(*state));
+    for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+        state->devices[i].usb = BRIDGE_USB_IDLE;
+        state->devices[i].attach_latency_us = -1;
+    }
+}
+
+// Slot for a newly attached device: the one its VID/PID had last time, else
+// one never used, else any idle one. -1 when there is none, or when the
+// device at that address is already open (a repeated attach event).
+static int pick_slot(const bridge_state_t *state, uint16_t vid, uint16_t pid, uint8_t address) {
+    int unused = -1;
+    int idle = -1;
+    for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+        const bridge_device_t *dev = &state->devices[i];
+        bool same = dev->vid == vid && dev->pid == pid;
+        if (dev->usb != BRIDGE_USB_IDLE) {
+            if (dev->address == address) {
+                return -1;
+            }
+            continue;
+        }
+        if (dev->opened && same) {
+            return i;
+        }
+        if (!dev->opened && unused < 0) {
+            unused = i;
+        }
+        if (idle < 0) {
+            idle = i;
+        }
+    }
+    return unused >= 0 ? unused : idle;
+}
+
+static uint32_t handle_attach(bridge_state_t *state, const bridge_event_t *event) {
+    uint16_t vid = (uint16_t)(event->arg >> 16);
+    uint16_t pid = (uint16_t)event->arg;
+    int slot = pick_slot(state, vid, pid, event->address);
+    if (slot < 0) {
+        state->rejected++;
+        return 0;
+    }
+
+    bridge_device_t *dev = &state->devices[slot];
+    dev->reattach = dev->opened && dev->vid == vid && dev->pid == pid;
+    dev->usb = BRIDGE_USB_OPENING;
+    dev->vid = vid;
+    dev->pid = pid;
+    dev->address = event->address;
+    dev->latency_start_us = event->time_us;
+    state->current = (uint8_t)slot;
+    return BRIDGE_ACTION_OPEN_DEVICE;
+}
+
+static uint32_t handle_device(bridge_state_t *state, const bridge_event_t *event) {
+    if (event->device >= BRIDGE_DEVICE_MAX) {
+        return 0;
+    }
+    bridge_device_t *dev = &state->devices[event->device];
+    state->current = event->device;
+
+    switch (event->type) {
+        case BRIDGE_EV_USB_OPENED:
+            if (dev->usb != BRIDGE_USB_OPENING) {
+                return 0;
+            }
+            dev->usb = BRIDGE_USB_STREAMING;
+            dev->opened = true;
+            state->attaches++;
+            return BRIDGE_ACTION_ARM_NOTIFY;
+
+        case BRIDGE_EV_USB_OPEN_FAILED:
+            if (dev->usb != BRIDGE_USB_OPENING) {
+                return 0;
+            }
+            dev->usb = BRIDGE_USB_IDLE;
+            state->open_failures++;
+            dev->latency_start_us = 0;
+            return 0;
+
+        case BRIDGE_EV_USB_DETACHED:
+            if (dev->usb != BRIDGE_USB_STREAMING) {
+                return 0;
+            }
+            dev->usb = BRIDGE_USB_IDLE;
+            dev->latency_start_us = 0;
+            return BRIDGE_ACTION_CLOSE_DEVICE;
+
+        case BRIDGE_EV_DATA_TIMEOUT:
+            // Still enumerated as far as we know: reopen instead of waiting for an attach
+            if (dev->usb != BRIDGE_USB_STREAMING) {
+                return 0;
+            }
+            state->data_timeouts++;
+            dev->usb = BRIDGE_USB_OPENING;
+            dev->reattach = true;
+            dev->latency_start_us = event->time_us;
+            return BRIDGE_ACTION_CLOSE_DEVICE | BRIDGE_ACTION_OPEN_DEVICE;
+
+        case BRIDGE_EV_NOTIFIED:
+            if (dev->usb != BRIDGE_USB_STREAMING || dev->latency_start_us == 0) {
+                return 0;
+            }
+            dev->attach_latency_us = event->time_us - dev->latency_start_us;
+            dev->latency_start_us = 0;
+            return BRIDGE_ACTION_REPORT_LATENCY;
+
+        default:
+            return 0;
+    }
+}
+
+uint32_t bridge_state_handle(bridge_state_t *state, const bridge_event_t *event) {
+    if (state->ota) {
+        return 0;  // Only a reboot leaves OTA mode
+    }
+
+    switch (event->type) {
+        case BRIDGE_EV_BLE_CONNECTED:
+            state->ble_clients++;
+            return 0;
+
+        case BRIDGE_EV_BLE_DISCONNECTED:
+            if (state->ble_clients > 0) {
+                state->ble_clients--;
+            }
+            return 0;
+
+        case BRIDGE_EV_BLE_SUBSCRIBED:
+            // Nobody could have been notified before this
+            for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+                bridge_device_t *dev = &state->devices[i];
+                if (dev->latency_start_us != 0 && event->time_us > dev->latency_start_us) {
+                    dev->latency_start_us = event->time_us;
+                }
+            }
+            return 0;
+
+        case BRIDGE_EV_OTA_REQUESTED:
+            // The caller closes whatever is open
+            for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+                state->devices[i].usb = BRIDGE_USB_IDLE;
+                state->devices[i].latency_start_us = 0;
+            }
+            state->ota = true;
+            return BRIDGE_ACTION_START_OTA;
+
+        case BRIDGE_EV_USB_ATTACHED:
+            return handle_attach(state, event);
+
+        default:
+            return handle_device(state, event);
+    }
+}
+
+uint8_t bridge_state_active_devices(const bridge_state_t *state) {
+    uint8_t active = 0;
+    for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+        if (state->devices[i].usb != BRIDGE_USB_IDLE) {
+            active++;
+        }
+    }
+    return active;
+}
+
+const char *bridge_state_name(bridge_usb_state_t usb) {
+    switch (usb) {
+        case BRIDGE_USB_IDLE:      return "idle";
+        case BRIDGE_USB_OPENING:   return "opening";
+        case BRIDGE_USB_STREAMING: return "streaming";
+    }
+    return "?";
+}
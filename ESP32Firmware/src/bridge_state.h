@@ -0,0 +1,133 @@
+/*
+ * Bridge State Machine for GasTag Bridge
+ *
+ * One place that decides what the bridge does next. USB attach/detach,
+ * the data watchdog, BLE connect/subscribe and the OTA request all arrive
+ * as bridge_event_t messages; bridge_state_handle() updates the state and
+ * returns BRIDGE_ACTION_* bits for the caller to carry out. Events carry
+ * the time they happened at their source, so queueing delay does not hide
+ * in the measurements.
+ *
+ * Up to BRIDGE_DEVICE_MAX analyzers (behind a hub) are tracked at once,
+ * each in its own device slot; the slot index is the channel ID the
+ * readings of that analyzer carry on BLE. Events about one device name its
+ * slot, and attach, detach or a timeout of one device never touches the
+ * others. A slot remembers the last device opened in it, so a replug of the
+ * same analyzer gets its channel back and is recognised as a reattach.
+ * Devices are told apart by USB address, so several analyzers of the same
+ * model (same VID/PID) can be open at once; their replugs are matched to
+ * slots by VID/PID only, so two of them may swap channels.
+ *
+ * A data timeout closes the analyzer and opens it again at once: a device
+ * that stopped talking but is still plugged in never sends another attach.
+ *
+ * The machine also measures attach-to-first-notification latency per
+ * device: from the analyzer appearing on USB (or the first subscription after that, if no
+ * phone was listening yet) to the first notification sent from its data.
+ *
+ * No FreeRTOS dependency; the caller owns the queue and the task.
+ */
+
+#ifndef BRIDGE_STATE_H
+#define BRIDGE_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============== STATE MACHINE CONFIGURATION ==============
+#define BRIDGE_DEVICE_MAX  4   // Analyzers open at once; fits the 2-bit BLE channel ID
+
+// ============== STATE MACHINE TYPES ==============
+typedef enum {
+    BRIDGE_USB_IDLE,            // No analyzer open in this slot
+    BRIDGE_USB_OPENING,         // Device seen, open in progress
+    BRIDGE_USB_STREAMING,       // Device open, data expected
+} bridge_usb_state_t;
+
+typedef enum {
+    BRIDGE_EV_USB_ATTACHED,     // arg: VID << 16 | PID, and address; the machine picks the slot
+    BRIDGE_EV_USB_OPENED,       // These name their slot in device
+    BRIDGE_EV_USB_OPEN_FAILED,
+    BRIDGE_EV_USB_DETACHED,
+    BRIDGE_EV_DATA_TIMEOUT,     // No data for the watchdog period
+    BRIDGE_EV_FIRST_LINE,       // First line framed after an open (timing only)
+    BRIDGE_EV_NOTIFIED,         // First notification after BRIDGE_ACTION_ARM_NOTIFY
+    BRIDGE_EV_BLE_CONNECTED,
+    BRIDGE_EV_BLE_DISCONNECTED,
+    BRIDGE_EV_BLE_SUBSCRIBED,
+    BRIDGE_EV_OTA_REQUESTED,
+} bridge_event_type_t;
+
+typedef struct {
+    bridge_event_type_t type;
+    uint8_t device;             // Slot, for per-device events
+    int64_t time_us;            // When the event happened
+    uint32_t arg;
+    uint8_t address;            // USB address, for BRIDGE_EV_USB_ATTACHED
+} bridge_event_t;
+
+// ============== ACTIONS ==============
+// Device actions apply to the slot in bridge_state_t.current.
+#define BRIDGE_ACTION_OPEN_DEVICE     0x01  // Open the device at address, then post OPENED or OPEN_FAILED
+#define BRIDGE_ACTION_CLOSE_DEVICE    0x02  // Before OPEN_DEVICE when both are set
+#define BRIDGE_ACTION_START_OTA       0x04  // Close every open device first
+#define BRIDGE_ACTION_ARM_NOTIFY      0x08  // Post NOTIFIED after the next notification from the device
+#define BRIDGE_ACTION_REPORT_LATENCY  0x10  // The device's attach_latency_us was just measured
+
+typedef struct {
+    bridge_usb_state_t usb;
+    uint16_t vid;               // Device being opened or open, else the last one opened here
+    uint16_t pid;
+    uint8_t address;            // USB address of the device being opened or open
+    bool opened;                // A device was opened in this slot at least once
+    bool reattach;              // Device being opened is the last one opened here
+    int64_t latency_start_us;   // Attach (or later subscription); 0 when not measuring
+    int64_t attach_latency_us;  // Last attach-to-first-notification latency, -1 if none yet
+} bridge_device_t;
+
+typedef struct {
+    bridge_device_t devices[BRIDGE_DEVICE_MAX];  // Index is the BLE channel ID
+    uint8_t current;            // Slot the last returned device actions apply to
+    bool ota;                   // Firmware update; everything else stopped
+    uint8_t ble_clients;
+    uint32_t attaches;          // Devices opened
+    uint32_t open_failures;
+    uint32_t data_timeouts;     // Each one also reopens the device
+    uint32_t rejected;          // Attaches with no free slot, or of a device already open
+} bridge_state_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Start with every slot idle and no clients.
+ *
+ * @param state State to initialize
+ */
+void bridge_state_init(bridge_state_t *state);
+
+/**
+ * Apply one event.
+ *
+ * @param state State
+ * @param event Event to apply
+ * @return BRIDGE_ACTION_* bits for the caller to carry out
+ */
+uint32_t bridge_state_handle(bridge_state_t *state, const bridge_event_t *event);
+
+/**
+ * Number of slots with a device opening or streaming.
+ *
+ * @param state State
+ * @return Active device count
+ */
+uint8_t bridge_state_active_devices(const bridge_state_t *state);
+
+/**
+ * Name of a state, for logging.
+ *
+ * @param usb State
+ * @return Static string
+ */
+const char *bridge_state_name(bridge_usb_state_t usb);
+
+#endif // BRIDGE_STATE_H
@@ -0,0 +1,97 @@
+/*
+ * Connection Parameter Policy Implementation
+ */
+
+#include "conn_policy.h"
+
+#include <stddef.h>
+
+// Interval in 1.25 ms units, timeout in 10 ms units
+#define MS_TO_INTERVAL(ms)  ((ms) * 4 / 5)
+#define MS_TO_TIMEOUT(ms)   ((ms) / 10)
+
+static const conn_params_t profile_params[] = {
+    [CONN_PROFILE_ACTIVE] = {
+        .min_int = MS_TO_INTERVAL(15),
+        .max_int = MS_TO_INTERVAL(30),
+        .latency = 0,
+        .timeout = MS_TO_TIMEOUT(4000),
+    },
+    [CONN_PROFILE_IDLE] = {
+        .min_int = MS_TO_INTERVAL(90),
+        .max_int = MS_TO_INTERVAL(120),
+        .latency = 4,
+        .timeout = MS_TO_TIMEOUT(6000),
+    },
+};
+
+void conn_policy_profile_params(conn_profile_t profile, conn_params_t *params) {
+    *params = profile_params[profile];
+}
+
+bool conn_policy_params_valid(const conn_params_t *params) {
+    // Work in microseconds to avoid unit rounding
+    uint32_t min_us = params->min_int * 1250u;
+    uint32_t max_us = params->max_int * 1250u;
+    uint32_t timeout_us = params->timeout * 10000u;
+    uint32_t effective_us = max_us * (params->latency + 1u);
+
+    return min_us >= 15000 &&
+           (max_us >= min_us + 15000 || max_us == 15000) &&
+           params->latency <= 30 &&
+           timeout_us >= 2000000 && timeout_us <= 6000000 &&
+           effective_us <= 2000000 &&
+           effective_us * 3 < timeout_us;
+}
+
+void conn_policy_init(conn_policy_t *policy, uint32_t now_ms) {
+    policy->requested = CONN_PROFILE_ACTIVE;
+    policy->pending = true;
+    policy->requested_at_ms = now_ms;
+    policy->settled = false;
+    policy->retries = 0;
+    policy->retry_at_ms = 0;
+}
+
+bool conn_policy_poll(conn_policy_t *policy, uint32_t now_ms, uint32_t idle_ms, conn_params_t *params) {
+    if (policy->pending) {
+        if (now_ms - policy->requested_at_ms < CONN_POLICY_PENDING_MS) {
+            return false;
+        }
+        conn_policy_result(policy, now_ms, false, 0);
+    }
+
+    conn_profile_t wanted = idle_ms >= CONN_POLICY_IDLE_MS ? CONN_PROFILE_IDLE : CONN_PROFILE_ACTIVE;
+    if (wanted != policy->requested) {
+        // A profile change starts a fresh set of attempts
+        policy->requested = wanted;
+        policy->settled = false;
+        policy->retries = 0;
+        policy->retry_at_ms = now_ms;
+    }
+    if (policy->settled || (int32_t)(now_ms - policy->retry_at_ms) < 0) {
+        return false;
+    }
+
+    conn_policy_profile_params(wanted, params);
+    policy->pending = true;
+    policy->requested_at_ms = now_ms;
+    return true;
+}
+
+void conn_policy_result(conn_policy_t *policy, uint32_t now_ms, bool success, uint16_t interval) {
+    const conn_params_t *wanted = &profile_params[policy->requested];
+    policy->pending = false;
+
+    if (success && interval >= wanted->min_int && interval <= wanted->max_int) {
+        policy->settled = true;
+        return;
+    }
+
+    policy->retries++;
+    if (policy->retries >= CONN_POLICY_MAX_RETRIES) {
+        policy->settled = true;  // Live with what the central chose
+        return;
+    }
+    policy->retry_at_ms = now_ms + (CONN_POLICY_RETRY_MS << (policy->retries - 1));
+}
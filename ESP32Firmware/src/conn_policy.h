@@ -0,0 +1,105 @@
+/*
+ * Connection Parameter Policy for GasTag Bridge
+ *
+ * Chooses the connection parameters to request for one BLE connection from
+ * stream activity. While readings are flowing, or a bulk transfer such as
+ * a history backfill is running, the connection uses a short interval for
+ * low latency. After CONN_POLICY_IDLE_MS without either, it steps up to a
+ * long interval with slave latency, so the radio wakes far less often.
+ *
+ * Both profiles stay inside Apple's accepted ranges (Accessory Design
+ * Guidelines, "Connection Parameters"), which conn_policy_params_valid()
+ * checks. A request that is rejected, or granted outside the requested
+ * range, is retried with a doubling back-off, up to CONN_POLICY_MAX_RETRIES
+ * times per profile change.
+ *
+ * The policy only decides; the caller issues the request and reports the
+ * outcome. All state is owned by one task.
+ */
+
+#ifndef CONN_POLICY_H
+#define CONN_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============== POLICY CONFIGURATION ==============
+#define CONN_POLICY_IDLE_MS         10000   // No readings for this long: idle profile
+#define CONN_POLICY_RETRY_MS        5000    // First retry delay, doubled per attempt
+#define CONN_POLICY_MAX_RETRIES     3
+#define CONN_POLICY_PENDING_MS      30000   // Unanswered requests count as failed after this
+
+// ============== POLICY TYPES ==============
+typedef enum {
+    CONN_PROFILE_ACTIVE,        // 15-30 ms, no latency
+    CONN_PROFILE_IDLE,          // 90-120 ms, latency 4
+} conn_profile_t;
+
+typedef struct {
+    uint16_t min_int;           // 1.25 ms units
+    uint16_t max_int;           // 1.25 ms units
+    uint16_t latency;           // Connection events the peripheral may skip
+    uint16_t timeout;           // Supervision timeout, 10 ms units
+} conn_params_t;
+
+typedef struct {
+    conn_profile_t requested;   // Profile of the last request
+    bool pending;               // Request sent, outcome not yet reported
+    uint32_t requested_at_ms;   // When the pending request was sent
+    bool settled;               // Granted, or retries exhausted
+    uint8_t retries;            // Failed attempts for the current profile
+    uint32_t retry_at_ms;       // Earliest time for the next attempt
+} conn_policy_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Get the parameters requested for a profile.
+ *
+ * @param profile Profile
+ * @param params  Output parameters
+ */
+void conn_policy_profile_params(conn_profile_t profile, conn_params_t *params);
+
+/**
+ * Check parameters against Apple's rules: interval min >= 15 ms, interval
+ * max >= min + 15 ms, latency <= 30, timeout 2-6 s, interval max x
+ * (latency + 1) <= 2 s and x 3 < timeout.
+ *
+ * @param params Parameters to check
+ * @return true if an iOS central should accept them
+ */
+bool conn_policy_params_valid(const conn_params_t *params);
+
+/**
+ * Start tracking a new connection that has just been sent an
+ * active-profile request.
+ *
+ * @param policy Policy state
+ * @param now_ms Current time
+ */
+void conn_policy_init(conn_policy_t *policy, uint32_t now_ms);
+
+/**
+ * Decide whether to send a new request. A request left unanswered for
+ * CONN_POLICY_PENDING_MS is treated as failed.
+ *
+ * @param policy  Policy state
+ * @param now_ms  Current time
+ * @param idle_ms Time since the last reading; 0 while a bulk transfer runs
+ * @param params  Parameters to request, written when returning true
+ * @return true if the caller should request params now
+ */
+bool conn_policy_poll(conn_policy_t *policy, uint32_t now_ms, uint32_t idle_ms, conn_params_t *params);
+
+/**
+ * Report the outcome of the pending request.
+ *
+ * @param policy   Policy state
+ * @param now_ms   Current time
+ * @param success  false if the request failed or was rejected
+ * @param interval Granted interval, 1.25 ms units (ignored on failure)
+ */
+void conn_policy_result(conn_policy_t *policy, uint32_t now_ms, bool success, uint16_t interval);
+
+#endif // CONN_POLICY_H
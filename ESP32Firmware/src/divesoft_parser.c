@@ -0,0 +1,245 @@
+/*
+ * Divesoft Analyzer Line Parser Implementation
+ *
+ * A small cursor walks the line once, driven by a table of field specs:
+ * literal labels are matched exactly, numbers are accumulated straight into
+ * fixed point.
+ */
+
+#include "divesoft_parser.h"
+
+#include <string.h>
+
+// ============== CURSOR HELPERS ==============
+typedef struct {
+    const char *pos;
+    const char *end;
+} cursor_t;
+
+static void skip_spaces(cursor_t *cur) {
+    while (cur->pos < cur->end && (*cur->pos == ' ' || *cur->pos == '\t')) {
+        cur->pos++;
+    }
+}
+
+// Match a literal label, allowing leading whitespace
+static bool expect_literal(cursor_t *cur, const char *literal) {
+    skip_spaces(cur);
+    size_t n = strlen(literal);
+    if ((size_t)(cur->end - cur->pos) < n || memcmp(cur->pos, literal, n) != 0) {
+        return false;
+    }
+    cur->pos += n;
+    return true;
+}
+
+// Parse a decimal number into fixed point with `decimals` fractional digits.
+// Extra fractional digits are truncated; missing ones are zero-filled.
+static bool parse_fixed(cursor_t *cur, int decimals, int32_t *out) {
+    skip_spaces(cur);
+
+    bool negative = false;
+    if (cur->pos < cur->end && *cur->pos == '-') {
+        negative = true;
+        cur->pos++;
+    }
+
+    int32_t value = 0;
+    int digits = 0;
+    int frac_digits = -1;  // -1 until the decimal point is seen
+
+    while (cur->pos < cur->end) {
+        char c = *cur->pos;
+        if (c >= '0' && c <= '9') {
+            if (frac_digits < 0 || frac_digits < decimals) {
+                if (value > 100000000) {
+                    return false;  // Not a plausible analyzer value
+                }
+                value = value * 10 + (c - '0');
+                if (frac_digits >= 0) {
+                    frac_digits++;
+                }
+            }
+            digits++;
+        } else if (c == '.' && frac_digits < 0) {
+            frac_digits = 0;
+        } else {
+            break;
+        }
+        cur->pos++;
+    }
+
+    if (digits == 0) {
+        return false;
+    }
+    for (int i = (frac_digits < 0) ? 0 : frac_digits; i < decimals; i++) {
+        value *= 10;
+    }
+    *out = negative ? -value : value;
+    return true;
+}
+
+// Parse a gas percentage, which is "***.*" when the analyzer has no reading
+static bool parse_gas(cursor_t *cur, uint16_t *out, bool *stale) {
+    skip_spaces(cur);
+    if (cur->pos < cur->end && *cur->pos == '*') {
+        while (cur->pos < cur->end && (*cur->pos == '*' || *cur->pos == '.')) {
+            cur->pos++;
+        }
+        *out = 0;
+        *stale = true;
+        return true;
+    }
+
+    int32_t value;
+    if (!parse_fixed(cur, 1, &value) || value < 0 || value > 1000) {
+        return false;
+    }
+    *out = (uint16_t)value;
+    *stale = false;
+    return true;
+}
+
+// Parse an unsigned integer field of exactly `width` digits
+static bool parse_digits(cursor_t *cur, int width, uint32_t *out) {
+    if (cur->end - cur->pos < width) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < width; i++) {
+        char c = cur->pos[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (uint32_t)(c - '0');
+    }
+    cur->pos += width;
+    *out = value;
+    return true;
+}
+
+static bool expect_char(cursor_t *cur, char c) {
+    if (cur->pos >= cur->end || *cur->pos != c) {
+        return false;
+    }
+    cur->pos++;
+    return true;
+}
+
+// Parse "YYYY/MM/DD HH:MM:SS" into the packed timestamp format
+static bool parse_timestamp(cursor_t *cur, uint32_t *out) {
+    uint32_t year, month, day, hour, minute, second;
+
+    skip_spaces(cur);
+    if (!parse_digits(cur, 4, &year) || !expect_char(cur, '/') ||
+        !parse_digits(cur, 2, &month) || !expect_char(cur, '/') ||
+        !parse_digits(cur, 2, &day)) {
+        return false;
+    }
+    skip_spaces(cur);
+    if (!parse_digits(cur, 2, &hour) || !expect_char(cur, ':') ||
+        !parse_digits(cur, 2, &minute) || !expect_char(cur, ':') ||
+        !parse_digits(cur, 2, &second)) {
+        return false;
+    }
+
+    if (year < 2000 || year > 2063 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+    *out = GAS_TIMESTAMP_PACK(year, month, day, hour, minute, second);
+    return true;
+}
+
+// ============== FIELD TABLE ==============
+// A reading is a fixed sequence of labelled numeric fields followed by the
+// timestamp. Each entry names the label before the value, how to parse the
+// value and the unit label after it; NULL labels are skipped.
+typedef enum {
+    FIELD_HE,
+    FIELD_O2,
+    FIELD_TEMP,
+    FIELD_PRESSURE,
+    FIELD_COUNT,
+} field_id_t;
+
+typedef enum {
+    KIND_GAS,       // %, one decimal, may be ***.*
+    KIND_FIXED_1,   // Signed, one decimal
+    KIND_FIXED_2,   // Signed, two decimals
+} field_kind_t;
+
+typedef struct {
+    const char *label;
+    field_kind_t kind;
+    const char *unit;
+} field_spec_t;
+
+static const field_spec_t field_specs[FIELD_COUNT] = {
+    [FIELD_HE]       = { "He", KIND_GAS,     "%"    },
+    [FIELD_O2]       = { "O2", KIND_GAS,     "%"    },
+    [FIELD_TEMP]     = { "Ti", KIND_FIXED_1, "~F"   },
+    [FIELD_PRESSURE] = { NULL, KIND_FIXED_2, "inHg" },
+};
+
+static bool parse_field(cursor_t *cur, const field_spec_t *spec, int32_t *value, bool *stale) {
+    if (spec->label != NULL && !expect_literal(cur, spec->label)) {
+        return false;
+    }
+
+    *stale = false;
+    switch (spec->kind) {
+        case KIND_GAS: {
+            uint16_t gas;
+            if (!parse_gas(cur, &gas, stale)) {
+                return false;
+            }
+            *value = gas;
+            break;
+        }
+        case KIND_FIXED_1:
+            if (!parse_fixed(cur, 1, value)) {
+                return false;
+            }
+            break;
+        case KIND_FIXED_2:
+            if (!parse_fixed(cur, 2, value)) {
+                return false;
+            }
+            break;
+    }
+
+    return expect_literal(cur, spec->unit);
+}
+
+// ============== PUBLIC API ==============
+bool divesoft_parse_line(const char *line, size_t len, gas_reading_t *out) {
+    cursor_t cur = { .pos = line, .end = line + len };
+    gas_reading_t reading = {0};
+    int32_t values[FIELD_COUNT];
+    bool stale[FIELD_COUNT];
+
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (!parse_field(&cur, &field_specs[i], &values[i], &stale[i])) {
+            return false;
+        }
+    }
+    if (!parse_timestamp(&cur, &reading.timestamp)) {
+        return false;
+    }
+
+    int32_t temp = values[FIELD_TEMP];
+    int32_t pressure = values[FIELD_PRESSURE];
+    if (temp < INT16_MIN || temp > INT16_MAX || pressure < 0 || pressure > UINT16_MAX) {
+        return false;
+    }
+    reading.he_x10 = (uint16_t)values[FIELD_HE];
+    reading.o2_x10 = (uint16_t)values[FIELD_O2];
+    reading.temp_x10 = (int16_t)temp;
+    reading.pressure_x100 = (uint16_t)pressure;
+    reading.flags = (stale[FIELD_HE] ? GAS_READING_FLAG_HE_STALE : 0) |
+                    (stale[FIELD_O2] ? GAS_READING_FLAG_O2_STALE : 0);
+
+    *out = reading;
+    return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * Divesoft Analyzer Line Parser for GasTag Bridge
+ *
+ * Parses one line of Divesoft He/O2 analyzer output, e.g.
+ *
+ *   He   0.4 %  O2  20.2 %  Ti  79.0 ~F    29.5 inHg   2025/12/15 21:36:26
+ *
+ * into fixed-point values. He and O2 read "***.*" while the analyzer has no
+ * valid measurement; those fields are flagged stale and reported as zero.
+ *
+ * The parser never allocates and does not use sscanf/strtod.
+ */
+
+#ifndef DIVESOFT_PARSER_H
+#define DIVESOFT_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============== READING FLAGS ==============
+#define GAS_READING_FLAG_HE_STALE  0x01  // He showed ***.*
+#define GAS_READING_FLAG_O2_STALE  0x02  // O2 showed ***.*
+
+// Analyzer the reading came from when several share the bridge; set by the
+// bridge, not the parser. A single analyzer is always channel 0.
+#define GAS_READING_CHANNEL_SHIFT  4
+#define GAS_READING_CHANNEL_MASK   0x30
+#define GAS_READING_CHANNEL(flags) (((flags) & GAS_READING_CHANNEL_MASK) >> GAS_READING_CHANNEL_SHIFT)
+
+// ============== PARSED READING ==============
+typedef struct {
+    uint16_t he_x10;          // Helium, % x 10
+    uint16_t o2_x10;          // Oxygen, % x 10
+    int16_t  temp_x10;        // Temperature, deg F x 10
+    uint16_t pressure_x100;   // Ambient pressure, inHg x 100
+    uint32_t timestamp;       // Analyzer clock, packed with GAS_TIMESTAMP_PACK()
+    uint8_t  flags;           // GAS_READING_FLAG_* bits and channel
+} gas_reading_t;
+
+// Analyzer wall-clock time packed into 32 bits (no timezone, years 2000-2063):
+//   bits 31..26 year-2000, 25..22 month, 21..17 day, 16..12 hour, 11..6 minute, 5..0 second
+#define GAS_TIMESTAMP_PACK(y, mo, d, h, mi, s) \
+    ((((uint32_t)(y) - 2000) << 26) | ((uint32_t)(mo) << 22) | ((uint32_t)(d) << 17) | \
+     ((uint32_t)(h) << 12) | ((uint32_t)(mi) << 6) | (uint32_t)(s))
+
+// ============== PUBLIC API ==============
+
+/**
+ * Parse one analyzer line.
+ *
+ * @param line Line text (need not be null-terminated)
+ * @param len  Number of bytes in line
+ * @param out  Parsed reading, only written on success
+ * @return true if the line is a complete Divesoft reading, false otherwise
+ */
+bool divesoft_parse_line(const char *line, size_t len, gas_reading_t *out);
+
+#endif // DIVESOFT_PARSER_H
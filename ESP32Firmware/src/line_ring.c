@@ -0,0 +1,80 @@
+/*
+ * Line Ring Buffer Implementation
+ *
+ * head and tail are free-running counters; the slot index is the counter
+ * masked by LINE_RING_SLOTS - 1. Only the producer stores head and only the
+ * consumer stores tail, so acquire/release ordering is all that is needed.
+ */
+
+#include "line_ring.h"
+
+#include <string.h>
+
+_Static_assert((LINE_RING_SLOTS & (LINE_RING_SLOTS - 1)) == 0,
+               "LINE_RING_SLOTS must be a power of two");
+
+#define SLOT_INDEX(counter) ((counter) & (LINE_RING_SLOTS - 1))
+
+void line_ring_init(line_ring_t *ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overflows, 0);
+    atomic_init(&ring->high_water, 0);
+}
+
+bool line_ring_push(line_ring_t *ring, uint8_t channel, uint8_t flags, const char *line, size_t len) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    unsigned used = head - tail;
+    if (used >= LINE_RING_SLOTS) {
+        atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+        return false;
+    }
+
+    if (len > LINE_RING_LINE_MAX - 1) {
+        len = LINE_RING_LINE_MAX - 1;
+    }
+
+    line_ring_slot_t *slot = &ring->slots[SLOT_INDEX(head)];
+    memcpy(slot->text, line, len);
+    slot->text[len] = '\0';
+    slot->len = (uint16_t)len;
+    slot->channel = channel;
+    slot->flags = flags;
+
+    // Publish the slot to the consumer
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // Track peak depth (only the producer writes high_water)
+    used++;
+    if (used > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, used, memory_order_relaxed);
+    }
+    return true;
+}
+
+const line_ring_slot_t *line_ring_peek(line_ring_t *ring) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+    return &ring->slots[SLOT_INDEX(tail)];
+}
+
+void line_ring_pop(line_ring_t *ring) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    // Hand the slot back to the producer
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+void line_ring_get_stats(line_ring_t *ring, line_ring_stats_t *stats) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    stats->queued = head - tail;
+    stats->overflows = atomic_load_explicit(&ring->overflows, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+}
@@ -0,0 +1,98 @@
+/*
+ * Line Ring Buffer for GasTag Bridge
+ *
+ * Single-producer / single-consumer lock-free queue of completed analyzer
+ * lines. The USB RX task (producer) pushes each assembled line and
+ * returns immediately; the BLE notify task (consumer) drains it at its own
+ * pace. Neither side ever blocks on the other.
+ *
+ * Each line carries the channel (analyzer) it came from. All analyzers
+ * share the ring: the USB RX task drains every device's RX buffer, so there
+ * is still a single producer.
+ *
+ * When the ring is full the newest line is dropped and counted, so the USB
+ * path never waits on a slow or congested BLE link.
+ */
+
+#ifndef LINE_RING_H
+#define LINE_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============== RING CONFIGURATION ==============
+#define LINE_RING_SLOTS     16   // Must be a power of two
+#define LINE_RING_LINE_MAX  256  // Max line length including null terminator
+
+// ============== RING TYPES ==============
+typedef struct {
+    uint8_t channel;                 // Analyzer the line came from
+    uint8_t flags;                   // Producer's line flags (ANALYZER_LINE_* for analyzer lines)
+    uint16_t len;                    // Line length, excluding null terminator
+    char text[LINE_RING_LINE_MAX];   // Null-terminated line
+} line_ring_slot_t;
+
+typedef struct {
+    line_ring_slot_t slots[LINE_RING_SLOTS];
+    atomic_uint head;                // Next slot to write (producer only)
+    atomic_uint tail;                // Next slot to read (consumer only)
+    atomic_uint overflows;           // Lines dropped because the ring was full
+    atomic_uint high_water;          // Max number of queued lines ever observed
+} line_ring_t;
+
+typedef struct {
+    uint32_t queued;                 // Lines currently waiting
+    uint32_t overflows;              // Lines dropped since init
+    uint32_t high_water;             // Peak queue depth since init
+} line_ring_stats_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Reset the ring to empty and clear its counters.
+ * Must not be called while producer or consumer are active.
+ *
+ * @param ring Ring to initialize
+ */
+void line_ring_init(line_ring_t *ring);
+
+/**
+ * Queue a completed line (producer side).
+ * Lines longer than LINE_RING_LINE_MAX - 1 are truncated.
+ *
+ * @param ring    Ring to push into
+ * @param channel Analyzer the line came from
+ * @param flags   Line flags, passed through to the consumer
+ * @param line    Line bytes (need not be null-terminated)
+ * @param len     Number of bytes in line
+ * @return true if queued, false if the ring was full and the line was dropped
+ */
+bool line_ring_push(line_ring_t *ring, uint8_t channel, uint8_t flags, const char *line, size_t len);
+
+/**
+ * Get the oldest queued line without removing it (consumer side).
+ * The slot stays valid until line_ring_pop() is called.
+ *
+ * @param ring Ring to read from
+ * @return Pointer to the oldest slot, or NULL if the ring is empty
+ */
+const line_ring_slot_t *line_ring_peek(line_ring_t *ring);
+
+/**
+ * Release the slot returned by line_ring_peek() (consumer side).
+ *
+ * @param ring Ring to pop from
+ */
+void line_ring_pop(line_ring_t *ring);
+
+/**
+ * Snapshot the ring counters. Safe to call from any task.
+ *
+ * @param ring  Ring to inspect
+ * @param stats Output counters
+ */
+void line_ring_get_stats(line_ring_t *ring, line_ring_stats_t *stats);
+
+#endif // LINE_RING_H
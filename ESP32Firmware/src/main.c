@@ -12,14 +12,19 @@
  *   USB Cable Red   -> NOT CONNECTED (powered by iPhone USB-C)
  */
 
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 
 // BLE includes
 #include "esp_bt.h"
@@ -34,21 +39,77 @@
 
 // OTA Update includes
 #include "ota_update.h"
+#include "power_mgmt.h"
+
+// Line queue between USB RX and BLE notify
+#include "line_ring.h"
+#include "ble_conn.h"
+#include "bridge_state.h"
+#include "attach_timing.h"
+#include "conn_policy.h"
+#include "analyzer_channel.h"
+#include "usb_rx.h"
+#include "rx_trace.h"
+
+// On-device reading parser and binary BLE format
+#include "divesoft_parser.h"
+#include "reading_format.h"
+#include "reading_filter.h"
+#include "reading_history.h"
+#include "reading_log_writer.h"
 
 static const char *TAG = "GasTag";
 
 // ============== FIRMWARE VERSION ==============
 #define FIRMWARE_VERSION "1.0.3"
 
-// ============== USB DEVICE DETECTION ==============
-// No longer restricted to specific VID/PID - accepts any USB CDC device
-static volatile uint16_t detected_vid = 0;
-static volatile uint16_t detected_pid = 0;
-static volatile bool device_available = false;
+// ============== BRIDGE EVENTS ==============
+// USB attach/detach, BLE connect/subscribe and the OTA request are queued
+// to the bridge task, which runs the state machine in bridge_state.h and
+// opens an analyzer, closes it or enters OTA mode. Any CDC device is
+// accepted, whatever its VID/PID, and up to BRIDGE_DEVICE_MAX of them can
+// be open at once behind a hub; each gets the channel of its device slot.
+// Senders never block.
+#define BRIDGE_EVENT_QUEUE_DEPTH  16
+#define BRIDGE_TASK_STACK         6144  // Also runs the OTA start-up
+#define BRIDGE_TASK_PRIORITY      3     // Below the BLE notify task
+#define BRIDGE_TASK_CORE          1
+
+_Static_assert(BRIDGE_DEVICE_MAX == ANALYZER_CHANNEL_MAX, "Every device slot needs a channel");
+
+static QueueHandle_t bridge_queue = NULL;
+
+// Set by the bridge task once a device is open; the notify task clears it
+// with the first notification it sends from that channel and reports the time
+static atomic_bool first_notify_armed[ANALYZER_CHANNEL_MAX];
+
+// ============== USB ATTACH ==============
+// new_dev_cb fires once the device is enumerated and passes its USB address
+// along; the device is opened at that address, so several analyzers of the
+// same model can be open at once. Transfers of a closed device are kept by
+// the driver for the next open.
+#define USB_INTERFACE_INDEX   0     // Analyzers expose a single CDC function
+
+// ============== RX TRACE ==============
+// Commands on the OTA control characteristic: RX_TRACE_CMD_START captures
+// the analyzer bytes as the USB RX path frames them (rx_trace.h) until
+// RX_TRACE_CMD_EXPORT, which stops and prints the trace on the console
+// between RX_TRACE_BEGIN and RX_TRACE_END, for tools/rx_trace.py. The
+// buffer is allocated at the first capture, in PSRAM when there is some.
+#define RX_TRACE_CMD_START          0x10
+#define RX_TRACE_CMD_EXPORT         0x11
+#define RX_TRACE_PSRAM_BYTES        (1024 * 1024)  // ~90 s of one analyzer at full line rate
+#define RX_TRACE_INTERNAL_BYTES     (16 * 1024)
+#define RX_TRACE_EXPORT_LINE        32             // Trace bytes per console line
+#define RX_TRACE_EXPORT_TASK_STACK  3072
+#define RX_TRACE_EXPORT_PRIORITY    1              // Below everything that moves readings
+
+static rx_trace_t rx_trace;
+static atomic_bool rx_trace_exporting;
 
 // ============== BLE CONFIGURATION ==============
 #define DEVICE_NAME "GasTag Bridge"
-#define GATTS_NUM_HANDLE     10  // Increased for version and OTA characteristics
+#define GATTS_NUM_HANDLE     24  // Service + 7 characteristics + 3 CCCDs, with headroom
 
 // Full 128-bit UUIDs for iOS compatibility (little-endian byte order)
 // Service UUID: A1B2C3D4-E5F6-7890-ABCD-EF1234567890
@@ -75,26 +136,130 @@ static uint8_t ota_char_uuid128[16] = {
     0x90, 0x78, 0xF6, 0xE5, 0xD7, 0xC3, 0xB2, 0xA1
 };
 
+// Binary Reading Characteristic UUID: A1B2C3D8-E5F6-7890-ABCD-EF1234567890 (READ + NOTIFY)
+static uint8_t reading_char_uuid128[16] = {
+    0x90, 0x78, 0x56, 0x34, 0x12, 0xEF, 0xCD, 0xAB,
+    0x90, 0x78, 0xF6, 0xE5, 0xD8, 0xC3, 0xB2, 0xA1
+};
+
+// Control Characteristic UUID: A1B2C3D9-E5F6-7890-ABCD-EF1234567890 (READ + WRITE)
+static uint8_t control_char_uuid128[16] = {
+    0x90, 0x78, 0x56, 0x34, 0x12, 0xEF, 0xCD, 0xAB,
+    0x90, 0x78, 0xF6, 0xE5, 0xD9, 0xC3, 0xB2, 0xA1
+};
+
+// History Characteristic UUID: A1B2C3DA-E5F6-7890-ABCD-EF1234567890 (WRITE + NOTIFY)
+static uint8_t history_char_uuid128[16] = {
+    0x90, 0x78, 0x56, 0x34, 0x12, 0xEF, 0xCD, 0xAB,
+    0x90, 0x78, 0xF6, 0xE5, 0xDA, 0xC3, 0xB2, 0xA1
+};
+
+// Diagnostics Characteristic UUID: A1B2C3DB-E5F6-7890-ABCD-EF1234567890 (READ)
+static uint8_t diag_char_uuid128[16] = {
+    0x90, 0x78, 0x56, 0x34, 0x12, 0xEF, 0xCD, 0xAB,
+    0x90, 0x78, 0xF6, 0xE5, 0xDB, 0xC3, 0xB2, 0xA1
+};
+
 // ============== GLOBALS ==============
 static uint16_t gatts_if = ESP_GATT_IF_NONE;
-static uint16_t conn_id = 0;
-static bool device_connected = false;
 static uint16_t char_handle = 0;
+static uint16_t char_cccd_handle = 0;
 static uint16_t version_char_handle = 0;
 static uint16_t ota_char_handle = 0;
+static uint16_t reading_char_handle = 0;
+static uint16_t reading_cccd_handle = 0;
+static uint16_t control_char_handle = 0;
+static uint16_t history_char_handle = 0;
+static uint16_t history_cccd_handle = 0;
+static uint16_t diag_char_handle = 0;
 static uint16_t service_handle = 0;
 
-// OTA mode flag - set when BLE client writes 0x01 to OTA characteristic
-static volatile bool ota_mode_requested = false;
-
-static char last_reading[256] = "";
-static char line_buffer[256] = "";
-static int line_buffer_pos = 0;
-
-static SemaphoreHandle_t device_disconnected_sem;
-
-// Watchdog: track last data time to detect stale connections
-static volatile uint32_t last_data_time_ms = 0;
+// Latest line and reading per analyzer (notify task). Reads of the text and
+// binary characteristics return the channel that reported last.
+static analyzer_channel_latest_t channel_latest[ANALYZER_CHANNEL_MAX];
+static volatile uint8_t latest_channel = 0;
+
+// ============== BLE CONNECTIONS ==============
+// Every connected phone gets an entry; readings fan out to all subscribers
+// and advertising continues until the table is full. The BLE stack
+// callbacks (core 0) add, remove and update entries while the notify task
+// (core 1) reads them and counts what it sends, so every access holds
+// conn_table_mutex. The notify task never calls into the BLE stack with it
+// held; it sends from copies of the entries (ble_conn.h).
+_Static_assert(BLE_CONN_MAX <= CONFIG_BT_ACL_CONNECTIONS, "BLE_CONN_MAX exceeds the stack's ACL limit");
+
+static ble_conn_table_t conn_table;
+static SemaphoreHandle_t conn_table_mutex = NULL;
+static bool advertising = false;  // BLE stack callbacks only
+
+// After connect the bridge asks for the 2M PHY and the largest LL data
+// length. The data length completion event carries no peer address, so
+// requests are issued one at a time (BLE stack callbacks only).
+static bool dle_pending = false;
+static esp_bd_addr_t dle_pending_bda;
+static bool dle_wanted[BLE_CONN_MAX];
+
+// Subscriptions just enabled, one bit per ble_conn_char_t, indexed by
+// connection table slot. The notify task answers each with the cached
+// reading so a new client does not wait for the next analyzer line.
+static atomic_uchar initial_pending[BLE_CONN_MAX];
+
+// Connection parameter events for the notify task, which runs the
+// per-connection conn_policy controllers
+#define POLICY_EVENT_CONNECTED       0x01
+#define POLICY_EVENT_UPDATED         0x02
+#define POLICY_EVENT_UPDATE_FAILED   0x04
+
+static atomic_uchar policy_events[BLE_CONN_MAX];
+
+// ============== BLE NOTIFY TASK ==============
+// Completed lines are handed from the USB RX task to this task through
+// a lock-free ring, so USB polling never waits on the BLE stack or logging.
+#define BLE_NOTIFY_TASK_STACK     6144  // Two reading batches, BLE calls and logging
+#define BLE_NOTIFY_TASK_PRIORITY  4     // Below USB host (5) and CDC driver (10)
+#define BLE_NOTIFY_TASK_CORE      1     // Bluedroid and the CDC driver run on core 0
+
+static line_ring_t line_ring;  // Shared by all channels, filled by the USB RX task (usb_rx.h)
+static TaskHandle_t ble_notify_task_handle = NULL;
+
+// Binary readings are coalesced into batch notifications sized to the
+// smallest MTU among subscribed clients. A batch is sent when the next
+// reading would not fit or when its oldest reading has waited
+// READING_BATCH_LATENCY_MS (rounded up to a whole tick). Set to 0 to send
+// one READING_FORMAT_VERSION packet per reading instead.
+#define READING_BATCH_LATENCY_MS  10
+
+// Every parsed reading is also kept in the history ring (whether or not a
+// client is connected or the deadband filter sends it live) and numbered
+// there, so readings the filter held back can be backfilled too. A client
+// writes "send everything after sequence N" to the history characteristic
+// and the notify task streams the backlog back to that client in MTU-sized
+// packets, a few per wake-up so live readings keep flowing. The same
+// readings are also queued to the flash reading log (reading_log_writer.h),
+// which keeps its own persistent sequence numbers and survives power loss.
+#define READING_HISTORY_PSRAM_CAPACITY     65536  // ~1 MB, 18 h at one reading per second
+#define READING_HISTORY_INTERNAL_CAPACITY  512    // Fallback when no PSRAM is fitted
+#define HISTORY_PACKETS_PER_WAKE           4
+#define HISTORY_SYNC_ONLY                  0xFFFFFFFFu  // Request: just report the next sequence number
+
+static reading_history_t reading_history;          // Owned by the notify task
+
+// Backfill requests, indexed by connection table slot
+static volatile bool history_requested[BLE_CONN_MAX];
+static volatile uint32_t history_request_after[BLE_CONN_MAX];
+
+// Deadband filter: the config is written by the BLE stack and picked up by
+// the notify task, which owns the filter state (one filter per channel).
+// Both sides copy the config under filter_config_lock.
+#define FILTER_NVS_NAMESPACE  "gastag"
+#define FILTER_NVS_KEY        "filter"
+
+static portMUX_TYPE filter_config_lock = portMUX_INITIALIZER_UNLOCKED;
+static reading_filter_config_t filter_config;
+static bool filter_config_changed = false;
+
+// Watchdog: the USB RX task tracks the last data time per analyzer to
+// detect stale connections, and the latest of them for the connection policies
 #define DATA_TIMEOUT_MS 5000  // 5 seconds without data = assume disconnected
 
 // ============== BLE ADVERTISING ==============
@@ -146,73 +311,608 @@ static esp_attr_value_t char_val = {
     .attr_value = (uint8_t *)"GasTag Bridge Ready",
 };
 
-// ============== USB CDC HOST CALLBACKS ==============
-static bool handle_rx(const uint8_t *data, size_t data_len, void *arg) {
-    // Update watchdog timestamp on any data received
-    last_data_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-
-    for (size_t i = 0; i < data_len; i++) {
-        char c = (char)data[i];
+// Characteristics are added one at a time: each ADD_CHAR_EVT (or
+// ADD_CHAR_DESCR_EVT for characteristics with a CCCD) adds the next entry.
+typedef struct {
+    const uint8_t *uuid128;
+    esp_gatt_perm_t perm;
+    esp_gatt_char_prop_t property;
+    esp_attr_value_t *initial_value;
+    uint16_t *handle;
+    uint16_t *cccd_handle;  // NULL if the characteristic has no CCCD
+    const char *name;
+} gatt_char_def_t;
+
+static const gatt_char_def_t gatt_chars[] = {
+    { char_uuid128, ESP_GATT_PERM_READ,
+      ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_NOTIFY,
+      &char_val, &char_handle, &char_cccd_handle, "Gas data" },
+    { version_char_uuid128, ESP_GATT_PERM_READ,
+      ESP_GATT_CHAR_PROP_BIT_READ,
+      NULL, &version_char_handle, NULL, "Version" },
+    { ota_char_uuid128, ESP_GATT_PERM_WRITE,
+      ESP_GATT_CHAR_PROP_BIT_WRITE,
+      NULL, &ota_char_handle, NULL, "OTA control" },
+    { reading_char_uuid128, ESP_GATT_PERM_READ,
+      ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_NOTIFY,
+      NULL, &reading_char_handle, &reading_cccd_handle, "Binary reading" },
+    { control_char_uuid128, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+      ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE,
+      NULL, &control_char_handle, NULL, "Control" },
+    { history_char_uuid128, ESP_GATT_PERM_WRITE,
+      ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_NOTIFY,
+      NULL, &history_char_handle, &history_cccd_handle, "History" },
+    { diag_char_uuid128, ESP_GATT_PERM_READ,
+      ESP_GATT_CHAR_PROP_BIT_READ,
+      NULL, &diag_char_handle, NULL, "Diagnostics" },
+};
+#define GATT_CHAR_COUNT (sizeof(gatt_chars) / sizeof(gatt_chars[0]))
+static size_t gatt_char_index = 0;
 
-        if (c == '\n' || c == '\r') {
-            if (line_buffer_pos > 0) {
-                line_buffer[line_buffer_pos] = '\0';
+static void post_event(const bridge_event_t *event) {
+    if (bridge_queue == NULL || xQueueSend(bridge_queue, event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Bridge event %d dropped", event->type);
+    }
+}
 
-                // Copy to last_reading with guaranteed null termination
-                strncpy(last_reading, line_buffer, sizeof(last_reading) - 1);
-                last_reading[sizeof(last_reading) - 1] = '\0';
+static void post_device_event(bridge_event_type_t type, uint8_t device, uint32_t arg) {
+    bridge_event_t event = { .type = type, .device = device, .time_us = esp_timer_get_time(), .arg = arg };
+    post_event(&event);
+}
 
-                // Send via BLE if connected
-                if (device_connected && gatts_if != ESP_GATT_IF_NONE && char_handle != 0) {
-                    esp_ble_gatts_send_indicate(gatts_if, conn_id, char_handle,
-                        line_buffer_pos, (uint8_t *)line_buffer, false);
-                }
+static void post_bridge_event(bridge_event_type_t type, uint32_t arg) {
+    post_device_event(type, 0, arg);
+}
 
-                ESP_LOGI(TAG, "Data: %s", line_buffer);
+// ============== USB RX HOOKS ==============
+// Run in the USB RX task (usb_rx.h), which frames every open device's bytes
+static void usb_rx_busy(bool busy, void *ctx) {
+    if (busy) {
+        power_mgmt_boost_begin();
+    } else {
+        power_mgmt_boost_end();
+    }
+}
 
-                // Clear buffer for next line
-                line_buffer_pos = 0;
-                line_buffer[0] = '\0';
-            }
-        } else if (c >= 32 && c < 127) {  // Only printable ASCII
-            if (line_buffer_pos < sizeof(line_buffer) - 1) {
-                line_buffer[line_buffer_pos++] = c;
-            }
-        }
-        // Ignore non-printable characters
+// Hand each completed line to the BLE notify task
+static void usb_rx_lines(uint8_t id, size_t lines, bool first, void *ctx) {
+    if (first) {
+        post_device_event(BRIDGE_EV_FIRST_LINE, id, 0);
+    }
+    if (ble_notify_task_handle != NULL) {
+        xTaskNotifyGive(ble_notify_task_handle);
     }
-    return true;
 }
 
+// ============== USB CDC HOST CALLBACKS ==============
+// Runs in the CDC driver task. The device's user_arg is its analyzer_channel_t.
 static void handle_event(const cdc_acm_host_dev_event_data_t *event, void *user_ctx) {
+    const analyzer_channel_t *channel = (const analyzer_channel_t *)user_ctx;
+
     switch (event->type) {
+        case CDC_ACM_HOST_RX_DATA:
+            usb_rx_notify();
+            break;
         case CDC_ACM_HOST_NETWORK_CONNECTION:
         case CDC_ACM_HOST_SERIAL_STATE:
-            ESP_LOGI(TAG, "USB CDC device event");
+            ESP_LOGI(TAG, "USB CDC device event (channel %d)", channel->id);
             break;
         case CDC_ACM_HOST_DEVICE_DISCONNECTED:
-            ESP_LOGI(TAG, "USB device disconnected");
-            xSemaphoreGive(device_disconnected_sem);
+            ESP_LOGI(TAG, "USB device disconnected (channel %d)", channel->id);
+            post_device_event(BRIDGE_EV_USB_DETACHED, channel->id, 0);
             break;
         default:
             break;
     }
 }
 
+// ============== FILTER CONFIG ==============
+// Store a new config (or NULL to keep the current one) and have the notify
+// task restart the filters with it
+static void set_filter_config(const reading_filter_config_t *config) {
+    portENTER_CRITICAL(&filter_config_lock);
+    if (config != NULL) {
+        filter_config = *config;
+    }
+    filter_config_changed = true;
+    portEXIT_CRITICAL(&filter_config_lock);
+}
+
+static void get_filter_config(reading_filter_config_t *config) {
+    portENTER_CRITICAL(&filter_config_lock);
+    *config = filter_config;
+    portEXIT_CRITICAL(&filter_config_lock);
+}
+
+// Copy the config if it changed since the last call
+static bool take_filter_config(reading_filter_config_t *config) {
+    portENTER_CRITICAL(&filter_config_lock);
+    bool changed = filter_config_changed;
+    if (changed) {
+        *config = filter_config;
+        filter_config_changed = false;
+    }
+    portEXIT_CRITICAL(&filter_config_lock);
+    return changed;
+}
+
+// ============== BLE CONNECTION TABLE LOCK ==============
+static void lock_conn_table(void *ctx) {
+    xSemaphoreTake(conn_table_mutex, portMAX_DELAY);
+}
+
+static void unlock_conn_table(void *ctx) {
+    xSemaphoreGive(conn_table_mutex);
+}
+
+// Snapshot of one table slot, to send to without holding the lock
+static ble_conn_t copy_conn(int slot) {
+    ble_conn_table_lock(&conn_table);
+    ble_conn_t conn = conn_table.conns[slot];
+    ble_conn_table_unlock(&conn_table);
+    return conn;
+}
+
+// Count a send made outside ble_conn_fanout(), unless the client left meanwhile
+static void account_send(uint16_t conn_id, size_t len, bool sent) {
+    ble_conn_table_lock(&conn_table);
+    ble_conn_t *conn = ble_conn_find(&conn_table, conn_id);
+    if (conn != NULL) {
+        ble_conn_account(conn, len, sent);
+    }
+    ble_conn_table_unlock(&conn_table);
+}
+
+// ============== BLE NOTIFY TASK ==============
+typedef struct {
+    ble_conn_char_t ch;
+    uint16_t handle;
+} notify_target_t;
+
+// Notify, or indicate for a client that enabled only indications
+static bool send_notification(const ble_conn_t *conn, const uint8_t *data, size_t len, void *ctx) {
+    const notify_target_t *target = (const notify_target_t *)ctx;
+    bool confirm = ble_conn_wants_indication(conn, target->ch);
+    return esp_ble_gatts_send_indicate(gatts_if, conn->conn_id, target->handle,
+                                       len, (uint8_t *)data, confirm) == ESP_OK;
+}
+
+// Send to every client subscribed to ch. channels has a bit for each
+// analyzer whose data is in the packet.
+static size_t notify_subscribers(ble_conn_char_t ch, uint16_t handle, const uint8_t *data, size_t len,
+                                 uint8_t channels) {
+    if (gatts_if == ESP_GATT_IF_NONE || handle == 0) {
+        return 0;
+    }
+    notify_target_t target = { ch, handle };
+    size_t sent = ble_conn_fanout(&conn_table, ch, data, len, send_notification, &target);
+    for (uint8_t id = 0; sent > 0 && id < ANALYZER_CHANNEL_MAX; id++) {
+        if ((channels & (1 << id)) && atomic_load(&first_notify_armed[id]) &&
+            atomic_exchange(&first_notify_armed[id], false)) {
+            post_device_event(BRIDGE_EV_NOTIFIED, id, 0);
+        }
+    }
+    return sent;
+}
+
+// Answer a fresh subscription with the latest reading of every analyzer
+static void send_cached_reading(int slot, uint8_t pending) {
+    ble_conn_t conn = copy_conn(slot);
+    if (!conn.in_use || conn.congested || gatts_if == ESP_GATT_IF_NONE) {
+        return;
+    }
+
+    bool sent = false;
+    for (int id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+        const analyzer_channel_latest_t *latest = &channel_latest[id];
+        if ((pending & (1 << BLE_CONN_CHAR_TEXT)) && char_handle != 0 && latest->text_len > 0) {
+            notify_target_t target = { BLE_CONN_CHAR_TEXT, char_handle };
+            size_t max_len = conn.mtu - BLE_ATT_NOTIFY_OVERHEAD;
+            size_t len = latest->text_len < max_len ? latest->text_len : max_len;
+            bool ok = send_notification(&conn, (const uint8_t *)latest->text, len, &target);
+            account_send(conn.conn_id, len, ok);
+            sent |= ok;
+        }
+        if ((pending & (1 << BLE_CONN_CHAR_READING)) && reading_char_handle != 0 && latest->has_reading) {
+            notify_target_t target = { BLE_CONN_CHAR_READING, reading_char_handle };
+            uint8_t buf[READING_FORMAT_SIZE];
+            size_t len = reading_format_encode(&latest->reading, buf);
+            bool ok = send_notification(&conn, buf, len, &target);
+            account_send(conn.conn_id, len, ok);
+            sent |= ok;
+        }
+    }
+    if (sent) {
+        ESP_LOGI(TAG, "Conn %d: cached reading sent %lu ms after connect", conn.conn_id,
+                 (uint32_t)(esp_timer_get_time() / 1000) - conn.connected_ms);
+    }
+}
+
+// Send a pending batch (or drop it when nobody is subscribed) and start a
+// new one sized for the current subscribers. *channels tracks the analyzers
+// with readings in the batch.
+static void flush_reading_batch(reading_batch_t *batch, uint8_t *channels) {
+    if (reading_batch_count(batch) > 0) {
+        notify_subscribers(BLE_CONN_CHAR_READING, reading_char_handle, batch->buf, batch->len, *channels);
+    }
+    ble_conn_table_lock(&conn_table);
+    uint16_t mtu = ble_conn_min_mtu(&conn_table, BLE_CONN_CHAR_READING);
+    ble_conn_table_unlock(&conn_table);
+    reading_batch_init(batch, mtu - BLE_ATT_NOTIFY_OVERHEAD);
+    *channels = 0;
+}
+
+static void send_reading(reading_batch_t *batch, uint8_t *channels, TickType_t *deadline,
+                         uint32_t seq, const gas_reading_t *reading) {
+    uint8_t channel = (uint8_t)(1 << GAS_READING_CHANNEL(reading->flags));
+
+    if (READING_BATCH_LATENCY_MS == 0) {
+        uint8_t buf[READING_FORMAT_SIZE];
+        size_t len = reading_format_encode(reading, buf);
+        notify_subscribers(BLE_CONN_CHAR_READING, reading_char_handle, buf, len, channel);
+        return;
+    }
+
+    if (!reading_batch_add(batch, seq, reading)) {
+        flush_reading_batch(batch, channels);
+        reading_batch_add(batch, seq, reading);
+    }
+    *channels |= channel;
+    if (reading_batch_count(batch) == 1) {
+        TickType_t latency = pdMS_TO_TICKS(READING_BATCH_LATENCY_MS);
+        *deadline = xTaskGetTickCount() + (latency > 0 ? latency : 1);
+    }
+}
+
+// ============== LINE HOOKS ==============
+// What the notify task lends analyzer_channel_take() for one line
+typedef struct {
+    reading_batch_t *batch;
+    uint8_t *batch_channels;
+    TickType_t *batch_deadline;
+    uint16_t text_mtu;          // Smallest text MTU among subscribers
+    uint32_t fanout_us;         // Time spent sending this line
+} notify_line_t;
+
+static uint32_t line_parsed(uint8_t id, const gas_reading_t *reading, void *ctx) {
+    uint32_t seq = reading_history_append(&reading_history, reading);
+    reading_log_writer_submit(reading);
+    return seq;
+}
+
+// Fan out to every subscribed client. The text line is cut to the smallest
+// client MTU, as the stack would for a single link.
+static void line_send_text(uint8_t id, const char *text, size_t len, void *ctx) {
+    notify_line_t *line = (notify_line_t *)ctx;
+    int64_t start = esp_timer_get_time();
+    size_t max_len = line->text_mtu - BLE_ATT_NOTIFY_OVERHEAD;
+    notify_subscribers(BLE_CONN_CHAR_TEXT, char_handle, (const uint8_t *)text,
+                       len < max_len ? len : max_len, (uint8_t)(1 << id));
+    line->fanout_us += (uint32_t)(esp_timer_get_time() - start);
+}
+
+static void line_send_reading(uint8_t id, uint32_t seq, const gas_reading_t *reading, void *ctx) {
+    notify_line_t *line = (notify_line_t *)ctx;
+    int64_t start = esp_timer_get_time();
+    send_reading(line->batch, line->batch_channels, line->batch_deadline, seq, reading);
+    line->fanout_us += (uint32_t)(esp_timer_get_time() - start);
+}
+
+// ============== HISTORY BACKFILL ==============
+typedef struct {
+    bool active;
+    uint16_t conn_id;           // Client that asked for the backlog
+    uint32_t next;              // Next sequence number to send
+    uint32_t end;               // First sequence number sent live instead
+} history_backfill_t;
+
+static void start_history_backfill(history_backfill_t *backfill, uint16_t conn_id, uint32_t after) {
+    uint32_t oldest = reading_history_oldest_seq(&reading_history);
+
+    backfill->active = true;
+    backfill->conn_id = conn_id;
+    backfill->end = reading_history.next_seq;
+    if (after == HISTORY_SYNC_ONLY) {
+        backfill->next = backfill->end;
+    } else if (after >= backfill->end) {
+        backfill->next = oldest;  // Client numbering predates a bridge restart
+    } else {
+        backfill->next = (after + 1 > oldest) ? after + 1 : oldest;
+    }
+    ESP_LOGI(TAG, "History backfill for conn %d: %lu readings after seq %lu",
+             conn_id, backfill->end - backfill->next, after);
+}
+
+// Send one packet of the backlog, or the end marker once it is exhausted
+static void send_history_packet(history_backfill_t *backfill) {
+    ble_conn_t conn = {0};
+    ble_conn_table_lock(&conn_table);
+    ble_conn_t *entry = ble_conn_find(&conn_table, backfill->conn_id);
+    if (entry != NULL) {
+        conn = *entry;
+    }
+    ble_conn_table_unlock(&conn_table);
+    if (!conn.in_use || !ble_conn_subscribed(&conn, BLE_CONN_CHAR_HISTORY) ||
+        gatts_if == ESP_GATT_IF_NONE || history_char_handle == 0) {
+        backfill->active = false;
+        return;
+    }
+    if (conn.congested) {
+        return;  // Resume once this client's link drains
+    }
+
+    // Readings overwritten since the request are skipped; the client sees
+    // the jump in sequence numbers
+    uint32_t oldest = reading_history_oldest_seq(&reading_history);
+    if ((int32_t)(backfill->next - oldest) < 0) {
+        backfill->next = oldest;
+    }
+
+    reading_batch_t packet;
+    reading_history_batch_init(&packet, conn.mtu - BLE_ATT_NOTIFY_OVERHEAD);
+    gas_reading_t reading;
+    while (backfill->next != backfill->end &&
+           reading_history_get(&reading_history, backfill->next, &reading) &&
+           reading_batch_add(&packet, backfill->next, &reading)) {
+        backfill->next++;
+    }
+
+    notify_target_t target = { BLE_CONN_CHAR_HISTORY, history_char_handle };
+    if (reading_batch_count(&packet) > 0) {
+        account_send(conn.conn_id, packet.len, send_notification(&conn, packet.buf, packet.len, &target));
+    } else {
+        uint8_t end[READING_HISTORY_END_SIZE];
+        size_t len = reading_history_encode_end(backfill->end, end);
+        account_send(conn.conn_id, len, send_notification(&conn, end, len, &target));
+        backfill->active = false;
+    }
+}
+
+// ============== CONNECTION PARAMETERS ==============
+// Short interval while readings flow or a backfill runs for the client,
+// long interval with latency once the analyzer has been quiet a while
+static void run_conn_policies(conn_policy_t *policies, const history_backfill_t *backfills) {
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint32_t quiet_ms = now_ms - usb_rx_last_data_time_ms();
+
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        ble_conn_t conn = copy_conn(i);
+        uint8_t events = atomic_exchange(&policy_events[i], 0);
+        if (!conn.in_use) {
+            continue;
+        }
+
+        conn_policy_t *policy = &policies[i];
+        if (events & POLICY_EVENT_CONNECTED) {
+            conn_policy_init(policy, now_ms);
+        }
+        if ((events & (POLICY_EVENT_UPDATED | POLICY_EVENT_UPDATE_FAILED)) && policy->pending) {
+            bool ok = (events & POLICY_EVENT_UPDATED) != 0;
+            conn_policy_result(policy, now_ms, ok, conn.interval);
+            if (!policy->settled) {
+                ESP_LOGW(TAG, "Conn %d: %s, retry %d", conn.conn_id,
+                         ok ? "interval granted outside the requested range" : "parameter update rejected",
+                         policy->retries);
+            }
+        }
+
+        conn_params_t params;
+        uint32_t idle_ms = backfills[i].active ? 0 : quiet_ms;
+        if (conn_policy_poll(policy, now_ms, idle_ms, &params)) {
+            ESP_LOGI(TAG, "Conn %d: requesting %s profile (%d-%d x 1.25 ms, latency %d)", conn.conn_id,
+                     policy->requested == CONN_PROFILE_IDLE ? "idle" : "active",
+                     params.min_int, params.max_int, params.latency);
+            esp_ble_conn_update_params_t update = {
+                .min_int = params.min_int,
+                .max_int = params.max_int,
+                .latency = params.latency,
+                .timeout = params.timeout,
+            };
+            memcpy(update.bda, conn.bda, sizeof(esp_bd_addr_t));
+            if (esp_ble_gap_update_conn_params(&update) != ESP_OK) {
+                atomic_fetch_or(&policy_events[i], POLICY_EVENT_UPDATE_FAILED);
+            }
+        }
+    }
+}
+
+static bool any_backfill_active(const history_backfill_t *backfills) {
+    for (int i = 0; i < BLE_CONN_MAX; i++) {
+        if (backfills[i].active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ble_notify_task(void *arg) {
+    uint32_t reported_overflows = 0;
+    uint32_t reported_parse_failures = 0;
+    analyzer_stream_stats_t reported_stream[ANALYZER_CHANNEL_MAX] = {0};
+    reading_batch_t batch;
+    uint8_t batch_channels = 0;
+    TickType_t batch_deadline = 0;
+    history_backfill_t backfills[BLE_CONN_MAX] = {0};
+    conn_policy_t policies[BLE_CONN_MAX] = {0};
+    size_t reported_clients = 0;
+    uint32_t fanout_max_us = 0;
+
+    reading_batch_init(&batch, BLE_ATT_DEFAULT_MTU - BLE_ATT_NOTIFY_OVERHEAD);
+    reading_filter_config_t config;
+    get_filter_config(&config);
+    for (int id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+        analyzer_channel_latest_init(&channel_latest[id], &config);
+    }
+
+    while (true) {
+        // Sleep until more lines arrive, or until the open batch is due.
+        // While every client is congested, the congestion-cleared event
+        // wakes us instead.
+        ble_conn_table_lock(&conn_table);
+        bool congested = ble_conn_all_congested(&conn_table);
+        size_t connected = ble_conn_count(&conn_table);
+        ble_conn_table_unlock(&conn_table);
+        TickType_t wait = portMAX_DELAY;
+        if (reading_batch_count(&batch) > 0 && !congested) {
+            int32_t remaining = (int32_t)(batch_deadline - xTaskGetTickCount());
+            wait = remaining > 0 ? (TickType_t)remaining : 0;
+        }
+        if (any_backfill_active(backfills) && !congested && wait > 1) {
+            wait = 1;  // Keep streaming the backlog
+        }
+        if (connected > 0 && wait > pdMS_TO_TICKS(BLE_CONN_RATE_WINDOW_MS)) {
+            wait = pdMS_TO_TICKS(BLE_CONN_RATE_WINDOW_MS);  // Keep throughput figures current
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+        power_mgmt_boost_begin();
+
+        if (take_filter_config(&config)) {
+            for (int id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+                reading_filter_set_config(&channel_latest[id].filter, &config);
+            }
+        }
+
+        // New subscribers get the latest reading before any queued lines
+        for (int i = 0; i < BLE_CONN_MAX; i++) {
+            uint8_t pending = atomic_exchange(&initial_pending[i], 0);
+            if (pending != 0) {
+                send_cached_reading(i, pending);
+            }
+        }
+
+        const line_ring_slot_t *slot;
+        while ((slot = line_ring_peek(&line_ring)) != NULL) {
+            // Hold lines in the ring while no client can take data; the
+            // congestion-cleared event wakes us up again. Clients that are
+            // congested while others are not miss the line instead.
+            ble_conn_table_lock(&conn_table);
+            congested = ble_conn_all_congested(&conn_table);
+            uint16_t text_mtu = ble_conn_min_mtu(&conn_table, BLE_CONN_CHAR_TEXT);
+            ble_conn_table_unlock(&conn_table);
+            if (congested) {
+                break;
+            }
+
+            // Parse once here so clients can skip text parsing; each
+            // analyzer has its own latest reading and deadband filter
+            notify_line_t line = {
+                .batch = &batch,
+                .batch_channels = &batch_channels,
+                .batch_deadline = &batch_deadline,
+                .text_mtu = text_mtu,
+            };
+            const analyzer_channel_hooks_t hooks = {
+                .parsed = line_parsed,
+                .send_text = line_send_text,
+                .send_reading = line_send_reading,
+                .ctx = &line,
+            };
+            uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            uint8_t id = analyzer_channel_take(channel_latest, slot, now_ms, &hooks);
+            latest_channel = id;
+            if (line.fanout_us > fanout_max_us) {
+                fanout_max_us = line.fanout_us;
+            }
+
+            ESP_LOGD(TAG, "Data %d: %s", id, slot->text);
+            line_ring_pop(&line_ring);
+        }
+
+        ble_conn_table_lock(&conn_table);
+        congested = ble_conn_all_congested(&conn_table);
+        ble_conn_table_unlock(&conn_table);
+        if (reading_batch_count(&batch) > 0 && !congested &&
+            (int32_t)(xTaskGetTickCount() - batch_deadline) >= 0) {
+            flush_reading_batch(&batch, &batch_channels);
+        }
+
+        for (int i = 0; i < BLE_CONN_MAX; i++) {
+            if (history_requested[i]) {
+                history_requested[i] = false;
+                start_history_backfill(&backfills[i], copy_conn(i).conn_id, history_request_after[i]);
+            }
+            for (int n = 0; n < HISTORY_PACKETS_PER_WAKE && backfills[i].active; n++) {
+                send_history_packet(&backfills[i]);
+                if (copy_conn(i).congested) {
+                    break;
+                }
+            }
+        }
+
+        run_conn_policies(policies, backfills);
+
+        line_ring_stats_t stats;
+        line_ring_get_stats(&line_ring, &stats);
+        if (stats.overflows != reported_overflows) {
+            ESP_LOGW(TAG, "Line ring overflow: %lu lines dropped (high-water %lu/%d)",
+                     stats.overflows - reported_overflows, stats.high_water, LINE_RING_SLOTS);
+            reported_overflows = stats.overflows;
+        }
+
+        // Framer counters are written by the USB RX task; 32-bit reads are
+        // atomic here and a slightly stale snapshot is fine for logging
+        uint32_t parse_failures = 0;
+        for (int id = 0; id < ANALYZER_CHANNEL_MAX; id++) {
+            analyzer_stream_stats_t stream = usb_rx_channel(id)->stream.stats;
+            if (stream.truncated_lines != reported_stream[id].truncated_lines ||
+                stream.framing_errors != reported_stream[id].framing_errors) {
+                ESP_LOGW(TAG, "Analyzer stream %d: %lu truncated lines (%lu bytes), %lu framing errors (%lu bytes)",
+                         id, stream.truncated_lines, stream.truncated_bytes,
+                         stream.framing_errors, stream.invalid_bytes);
+                reported_stream[id] = stream;
+            }
+            parse_failures += channel_latest[id].parse_failures;
+        }
+        if (parse_failures != reported_parse_failures) {
+            ESP_LOGW(TAG, "Unparsed analyzer lines: %lu", parse_failures);
+            reported_parse_failures = parse_failures;
+        }
+
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        ble_conn_table_lock(&conn_table);
+        for (int i = 0; i < BLE_CONN_MAX; i++) {
+            if (conn_table.conns[i].in_use) {
+                ble_conn_update_rate(&conn_table.conns[i], now_ms);
+            }
+        }
+        size_t clients = ble_conn_count(&conn_table);
+        size_t reading_subscribers = ble_conn_subscribers(&conn_table, BLE_CONN_CHAR_READING);
+        ble_conn_table_unlock(&conn_table);
+
+        // Fan-out cost grows with the number of clients; report it per client count
+        if (clients != reported_clients) {
+            ESP_LOGI(TAG, "BLE clients: %u (%u subscribed to readings), fan-out max %lu us with %u, "
+                     "stack headroom %u bytes",
+                     (unsigned)clients, (unsigned)reading_subscribers,
+                     fanout_max_us, (unsigned)reported_clients, (unsigned)uxTaskGetStackHighWaterMark(NULL));
+            reported_clients = clients;
+            fanout_max_us = 0;
+        }
+        power_mgmt_boost_end();
+    }
+}
+
 // ============== USB DEVICE DETECTION CALLBACK ==============
 static void new_device_cb(usb_device_handle_t usb_dev) {
     const usb_device_desc_t *desc;
+    usb_device_info_t info;
     usb_host_get_device_descriptor(usb_dev, &desc);
-    ESP_LOGI(TAG, "*** USB Device detected! VID=0x%04X, PID=0x%04X ***",
-             desc->idVendor, desc->idProduct);
-
-    // Store detected device info for the USB task to use
-    detected_vid = desc->idVendor;
-    detected_pid = desc->idProduct;
-    device_available = true;
+    usb_host_device_info(usb_dev, &info);
+    ESP_LOGI(TAG, "*** USB Device detected! VID=0x%04X, PID=0x%04X at address %d ***",
+             desc->idVendor, desc->idProduct, info.dev_addr);
+
+    bridge_event_t event = {
+        .type = BRIDGE_EV_USB_ATTACHED,
+        .time_us = esp_timer_get_time(),
+        .arg = ((uint32_t)desc->idVendor << 16) | desc->idProduct,
+        .address = info.dev_addr,
+    };
+    post_event(&event);
 }
 
 // ============== USB HOST TASK ==============
+// Installs the host stack and the CDC driver, then services USB host
+// library events. Devices are opened and closed by the bridge task.
 static void usb_host_task(void *arg) {
     ESP_LOGI(TAG, "Initializing USB Host...");
 
@@ -234,6 +934,8 @@ static void usb_host_task(void *arg) {
         .driver_task_priority = 10,
         .xCoreID = 0,
         .new_dev_cb = new_device_cb,  // Log any new device
+        .keep_transfers = true,       // Reuse them when the analyzer is replugged
+        .cache_descriptors = true,    // And skip descriptor parsing on the replug
     };
     err = cdc_acm_host_install(&driver_config);
     if (err != ESP_OK) {
@@ -243,102 +945,322 @@ static void usb_host_task(void *arg) {
     }
     ESP_LOGI(TAG, "CDC ACM driver installed - waiting for USB devices...");
 
-    device_disconnected_sem = xSemaphoreCreateBinary();
+    while (true) {
+        uint32_t event_flags = 0;
+        usb_host_lib_handle_events(portMAX_DELAY, &event_flags);
+    }
+}
 
-    ESP_LOGI(TAG, "Starting USB host event processing...");
+// ============== BRIDGE TASK ==============
+// Devices open in each bridge device slot (usb_rx.h); the slot index is the channel
+static bool open_device(uint8_t id, const bridge_device_t *dev, attach_timing_t *timing) {
+    ESP_LOGI(TAG, "Attempting to open USB device VID=0x%04X PID=0x%04X at address %d on channel %d",
+             dev->vid, dev->pid, dev->address, id);
+    cdc_acm_dev_hdl_t cdc_dev = NULL;
 
-    // Brief wait for USB device enumeration - process events without blocking too long
-    ESP_LOGI(TAG, "Waiting for USB device enumeration...");
-    for (int i = 0; i < 20; i++) {  // 2 seconds max (20 * 100ms)
-        uint32_t event_flags = 0;
-        usb_host_lib_handle_events(100, &event_flags);
+    // Data can arrive as soon as the IN transfer is submitted inside the open
+    usb_rx_arm(id);
+
+    cdc_acm_host_device_config_t dev_config = {
+        .event_cb = handle_event,
+    };
+    usb_rx_device_config(id, &dev_config);
+
+    esp_err_t err = cdc_acm_host_open_by_address(dev->address, USB_INTERFACE_INDEX, &dev_config, &cdc_dev);
+    if (err != ESP_OK || cdc_dev == NULL) {
+        ESP_LOGW(TAG, "Failed to open USB device (may not be CDC-compatible): %s", esp_err_to_name(err));
+        usb_rx_disarm(id);
+        return false;
     }
 
-    while (true) {
-        // Handle USB host library events
-        uint32_t event_flags = 0;
-        usb_host_lib_handle_events(100, &event_flags);
+    // Hand the device to the USB RX task, which also restarts its watchdog
+    usb_rx_attach(id, cdc_dev);
 
-        // Check if a device was detected by the callback
-        if (!device_available) {
-            vTaskDelay(pdMS_TO_TICKS(100));
-            continue;
-        }
+    attach_timing_mark(timing, ATTACH_PHASE_OPENED, esp_timer_get_time());
+    ESP_LOGI(TAG, "USB CDC device connected (VID=0x%04X PID=0x%04X) on channel %d!", dev->vid, dev->pid, id);
+    power_mgmt_set_usb_device(true);
 
-        // Capture the detected VID/PID (volatile, so copy locally)
-        uint16_t vid = detected_vid;
-        uint16_t pid = detected_pid;
-        device_available = false;  // Reset flag
+    // Set line coding: 115200 8N1
+    cdc_acm_line_coding_t line_coding = {
+        .dwDTERate = 115200,
+        .bCharFormat = 0,  // 1 stop bit
+        .bParityType = 0,  // No parity
+        .bDataBits = 8,
+    };
+    cdc_acm_host_line_coding_set(cdc_dev, &line_coding);
+
+    // Enable DTR
+    cdc_acm_host_set_control_line_state(cdc_dev, true, false);
+    attach_timing_mark(timing, ATTACH_PHASE_CONFIGURED, esp_timer_get_time());
+    return true;
+}
+
+// Also drops the channel's half-received line. No settle delay: the next
+// open waits for the device's attach event.
+static void close_device(uint8_t id) {
+    atomic_store(&first_notify_armed[id], false);
+    if (!usb_rx_close(id)) {
+        return;
+    }
+    ESP_LOGI(TAG, "USB device on channel %d closed", id);
+
+    // Light sleep stays blocked while any analyzer is still open
+    power_mgmt_set_usb_device(usb_rx_any_open());
+}
+
+// Stop BLE, run the WiFi update server and wait for it to finish.
+// Never returns: the device reboots on success, failure or timeout.
+static void run_ota_mode(void) {
+    ESP_LOGI(TAG, "OTA mode requested, stopping BLE and starting WiFi...");
+
+    // Stop BLE advertising before starting WiFi
+    esp_ble_gap_stop_advertising();
+    esp_bluedroid_disable();
+    esp_bluedroid_deinit();
+    esp_bt_controller_disable();
+    esp_bt_controller_deinit();
 
-        ESP_LOGI(TAG, "Attempting to open USB device VID=0x%04X PID=0x%04X", vid, pid);
+    ESP_LOGI(TAG, "BLE stopped, starting OTA update mode...");
 
-        // CDC device configuration - shorter timeout for faster retries
-        cdc_acm_host_device_config_t dev_config = {
-            .connection_timeout_ms = 1000,  // 1 second timeout
-            .out_buffer_size = 512,
-            .in_buffer_size = 512,
-            .event_cb = handle_event,
-            .data_cb = handle_rx,
-            .user_arg = NULL,
-        };
+    // Start OTA update mode
+    esp_err_t err = ota_start_update_mode();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "OTA update mode failed: %s", esp_err_to_name(err));
+        // On failure, restart to restore normal operation
+        ESP_LOGI(TAG, "Restarting to restore normal operation...");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        esp_restart();
+    }
 
-        cdc_acm_dev_hdl_t cdc_dev = NULL;
+    // OTA mode started successfully - wait for update to complete or timeout
+    // The HTTP server handles the actual update.
+    ESP_LOGI(TAG, "Waiting for OTA update (timeout: 5 minutes)...");
+    uint32_t ota_start_time = xTaskGetTickCount();
+    const uint32_t OTA_TIMEOUT_TICKS = pdMS_TO_TICKS(5 * 60 * 1000);  // 5 minutes
+
+    while (ota_get_state() != OTA_STATE_SUCCESS &&
+           ota_get_state() != OTA_STATE_FAILED) {
+        // Check for timeout
+        if ((xTaskGetTickCount() - ota_start_time) > OTA_TIMEOUT_TICKS) {
+            ESP_LOGW(TAG, "OTA timeout - no update received");
+            ota_stop_update_mode();
+            ESP_LOGI(TAG, "Restarting to restore normal operation...");
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            esp_restart();
+        }
+        vTaskDelay(pdMS_TO_TICKS(1000));  // Check every second
+    }
 
-        // Try to open the detected device
-        esp_err_t err = cdc_acm_host_open(vid, pid, 0, &dev_config, &cdc_dev);
+    // If we get here with SUCCESS state, device will reboot in the HTTP handler
+    // If FAILED, restart to restore normal operation
+    if (ota_get_state() == OTA_STATE_FAILED) {
+        ESP_LOGE(TAG, "OTA update failed");
+    }
+    ESP_LOGI(TAG, "Restarting to restore normal operation...");
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    esp_restart();
+}
 
-        if (err == ESP_OK && cdc_dev != NULL) {
-            ESP_LOGI(TAG, "USB CDC device connected (VID=0x%04X PID=0x%04X)!", vid, pid);
+// Streaming device that has been quiet longest, or -1 if none is streaming
+static int quietest_device(const bridge_state_t *state, uint32_t *quiet_ms) {
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    int quietest = -1;
+    for (int id = 0; id < BRIDGE_DEVICE_MAX; id++) {
+        uint32_t quiet = now_ms - usb_rx_data_time_ms(id);
+        if (state->devices[id].usb == BRIDGE_USB_STREAMING && (quietest < 0 || quiet > *quiet_ms)) {
+            quietest = id;
+            *quiet_ms = quiet;
+        }
+    }
+    return quietest;
+}
 
-            // Set line coding: 115200 8N1
-            cdc_acm_line_coding_t line_coding = {
-                .dwDTERate = 115200,
-                .bCharFormat = 0,  // 1 stop bit
-                .bParityType = 0,  // No parity
-                .bDataBits = 8,
+// Wait for the next event. While any device is streaming, the wait also
+// ends when its data watchdog is due, which turns into a DATA_TIMEOUT event
+// for that device.
+static void next_bridge_event(const bridge_state_t *state, bridge_event_t *event) {
+    while (true) {
+        TickType_t wait = portMAX_DELAY;
+        uint32_t quiet_ms = 0;
+        if (quietest_device(state, &quiet_ms) >= 0) {
+            wait = quiet_ms > DATA_TIMEOUT_MS ? 0 : pdMS_TO_TICKS(DATA_TIMEOUT_MS - quiet_ms) + 1;
+        }
+        if (xQueueReceive(bridge_queue, event, wait) == pdTRUE) {
+            return;
+        }
+
+        int id = quietest_device(state, &quiet_ms);
+        if (id >= 0 && quiet_ms > DATA_TIMEOUT_MS) {
+            ESP_LOGW(TAG, "No data on channel %d for %lu ms - reopening device", id, quiet_ms);
+            *event = (bridge_event_t){
+                .type = BRIDGE_EV_DATA_TIMEOUT, .device = (uint8_t)id, .time_us = esp_timer_get_time(),
             };
-            cdc_acm_host_line_coding_set(cdc_dev, &line_coding);
+            return;
+        }
+        // Data arrived meanwhile; wait for the new deadline
+    }
+}
 
-            // Enable DTR
-            cdc_acm_host_set_control_line_state(cdc_dev, true, false);
+// One line per attach: time spent in each phase up to the first line
+static void log_attach_timing(uint8_t id, const attach_timing_t *timing) {
+    char phases[160] = "";
+    size_t n = 0;
+    for (int p = ATTACH_PHASE_OPENED; p <= ATTACH_PHASE_FIRST_LINE && n < sizeof(phases); p++) {
+        int64_t us = attach_timing_phase_us(timing, (attach_phase_t)p);
+        if (us >= 0) {
+            n += snprintf(phases + n, sizeof(phases) - n, "%s%s %lu.%lu ms", n > 0 ? ", " : "",
+                          attach_phase_name((attach_phase_t)p),
+                          (uint32_t)(us / 1000), (uint32_t)(us % 1000) / 100);
+        }
+    }
+    ESP_LOGI(TAG, "Channel %d: %s to first line: %lu ms (%s)", id, timing->reattach ? "reattach" : "attach",
+             (uint32_t)(attach_timing_total_us(timing, ATTACH_PHASE_FIRST_LINE) / 1000), phases);
+    ESP_LOGI(TAG, "First line over %lu attaches: best %lu ms, mean %lu ms, worst %lu ms",
+             timing->attaches, (uint32_t)(timing->first_line_best_us / 1000),
+             (uint32_t)(timing->first_line_sum_us / timing->attaches / 1000),
+             (uint32_t)(timing->first_line_worst_us / 1000));
+}
 
-            // Initialize watchdog timestamp
-            last_data_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+static void bridge_task(void *arg) {
+    bridge_state_t state;
+    bridge_state_init(&state);
+    attach_timing_t timing[BRIDGE_DEVICE_MAX];
+    for (int id = 0; id < BRIDGE_DEVICE_MAX; id++) {
+        attach_timing_init(&timing[id]);
+    }
 
-            // Wait for disconnection - use timeout to allow watchdog checking
-            bool device_active = true;
-            while (device_active) {
-                // Check for explicit disconnect event (1 second timeout)
-                if (xSemaphoreTake(device_disconnected_sem, pdMS_TO_TICKS(1000)) == pdTRUE) {
-                    ESP_LOGI(TAG, "USB disconnect event received");
-                    device_active = false;
-                } else {
-                    // No disconnect event - check data watchdog
-                    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-                    uint32_t elapsed = now_ms - last_data_time_ms;
+    while (true) {
+        bridge_event_t event;
+        next_bridge_event(&state, &event);
 
-                    if (elapsed > DATA_TIMEOUT_MS) {
-                        ESP_LOGW(TAG, "No data for %lu ms - assuming device disconnected", elapsed);
-                        device_active = false;
-                    }
-                }
+        bridge_usb_state_t before[BRIDGE_DEVICE_MAX];
+        for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+            before[i] = state.devices[i].usb;
+        }
+        uint32_t actions = bridge_state_handle(&state, &event);
+        uint8_t id = state.current;
+        bridge_device_t *dev = &state.devices[id];
+
+        if (event.type == BRIDGE_EV_USB_ATTACHED && actions == 0) {
+            ESP_LOGW(TAG, "USB device VID=0x%04X PID=0x%04X ignored: no free channel or already open",
+                     (uint16_t)(event.arg >> 16), (uint16_t)event.arg);
+        }
+        if (actions & BRIDGE_ACTION_CLOSE_DEVICE) {
+            close_device(id);
+        }
+        if (actions & BRIDGE_ACTION_OPEN_DEVICE) {
+            attach_timing_start(&timing[id], event.time_us, dev->reattach);
+            bool opened = open_device(id, dev, &timing[id]);
+            bridge_event_t result = {
+                .type = opened ? BRIDGE_EV_USB_OPENED : BRIDGE_EV_USB_OPEN_FAILED,
+                .device = id,
+                .time_us = esp_timer_get_time(),
+            };
+            actions |= bridge_state_handle(&state, &result);
+        }
+        if (actions & BRIDGE_ACTION_ARM_NOTIFY) {
+            atomic_store(&first_notify_armed[id], true);
+        }
+        for (int i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+            if (state.devices[i].usb != before[i]) {
+                ESP_LOGI(TAG, "Bridge channel %d: %s -> %s (%u analyzers)", i, bridge_state_name(before[i]),
+                         bridge_state_name(state.devices[i].usb), bridge_state_active_devices(&state));
             }
+        }
+        if (event.type == BRIDGE_EV_FIRST_LINE && event.device < BRIDGE_DEVICE_MAX &&
+            state.devices[event.device].usb == BRIDGE_USB_STREAMING) {
+            attach_timing_t *t = &timing[event.device];
+            attach_timing_mark(t, ATTACH_PHASE_FIRST_DATA, usb_rx_first_rx_time_us(event.device));
+            if (attach_timing_mark(t, ATTACH_PHASE_FIRST_LINE, event.time_us)) {
+                log_attach_timing(event.device, t);
+            }
+        }
+        if (actions & BRIDGE_ACTION_REPORT_LATENCY) {
+            attach_timing_mark(&timing[id], ATTACH_PHASE_NOTIFIED, event.time_us);
+            ESP_LOGI(TAG, "Channel %d: attach to first notification: %lu ms (%u clients)", id,
+                     (uint32_t)(dev->attach_latency_us / 1000), state.ble_clients);
+        }
+        if (actions & BRIDGE_ACTION_START_OTA) {
+            for (uint8_t i = 0; i < BRIDGE_DEVICE_MAX; i++) {
+                close_device(i);
+            }
+            run_ota_mode();
+        }
+    }
+}
 
-            // Close device and prepare for reconnection
-            ESP_LOGI(TAG, "Closing USB device...");
-            cdc_acm_host_close(cdc_dev);
-            cdc_dev = NULL;
+// ============== RX TRACE ==============
+static void start_rx_trace(void) {
+    if (atomic_load(&rx_trace_exporting)) {
+        ESP_LOGW(TAG, "RX trace export in progress, capture not started");
+        return;
+    }
+    if (rx_trace.buf == NULL) {
+        size_t size = RX_TRACE_PSRAM_BYTES;
+        uint8_t *storage = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+        if (storage == NULL) {
+            size = RX_TRACE_INTERNAL_BYTES;
+            storage = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+        if (storage == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate RX trace");
+            return;
+        }
+        rx_trace_init(&rx_trace, storage, size);
+    }
+    usb_rx_trace_start(&rx_trace);
+    ESP_LOGI(TAG, "RX trace capture started (%u bytes)", (unsigned)rx_trace.size);
+}
+
+// Prints the stopped trace as hex; console output paces it
+static void rx_trace_export_task(void *arg) {
+    char hex[2 * RX_TRACE_EXPORT_LINE + 1];
 
-            // Allow USB stack to settle before accepting new device
-            vTaskDelay(pdMS_TO_TICKS(500));
-        } else {
-            ESP_LOGW(TAG, "Failed to open USB device (may not be CDC-compatible): %s", esp_err_to_name(err));
+    printf("RX_TRACE_BEGIN bytes=%u records=%lu dropped=%lu\n",
+           (unsigned)rx_trace.used, rx_trace.records, rx_trace.dropped);
+    for (size_t offset = 0; offset < rx_trace.used; offset += RX_TRACE_EXPORT_LINE) {
+        size_t len = rx_trace.used - offset < RX_TRACE_EXPORT_LINE ? rx_trace.used - offset : RX_TRACE_EXPORT_LINE;
+        for (size_t i = 0; i < len; i++) {
+            snprintf(&hex[2 * i], 3, "%02x", rx_trace.buf[offset + i]);
         }
-        // Loop will wait for next device_available signal
+        printf("RX_TRACE %06x %s\n", (unsigned)offset, hex);
+    }
+    printf("RX_TRACE_END\n");
+
+    atomic_store(&rx_trace_exporting, false);
+    vTaskDelete(NULL);
+}
+
+static void export_rx_trace(void) {
+    if (rx_trace.buf == NULL || atomic_exchange(&rx_trace_exporting, true)) {
+        return;
+    }
+    usb_rx_trace_stop();
+    ESP_LOGI(TAG, "RX trace: %lu records (%u bytes), %lu dropped; exporting",
+             rx_trace.records, (unsigned)rx_trace.used, rx_trace.dropped);
+    if (xTaskCreate(rx_trace_export_task, "rx_trace", RX_TRACE_EXPORT_TASK_STACK, NULL,
+                    RX_TRACE_EXPORT_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start RX trace export");
+        atomic_store(&rx_trace_exporting, false);
     }
 }
 
 // ============== BLE GAP EVENT HANDLER ==============
+// Ask for the largest data length for the next connection that wants it
+static void request_data_length(void) {
+    for (int i = 0; i < BLE_CONN_MAX && !dle_pending; i++) {
+        if (!dle_wanted[i]) {
+            continue;
+        }
+        dle_wanted[i] = false;
+        ble_conn_t conn = copy_conn(i);
+        if (conn.in_use && esp_ble_gap_set_pkt_data_len(conn.bda, BLE_LL_MAX_DATA_LEN) == ESP_OK) {
+            memcpy(dle_pending_bda, conn.bda, sizeof(esp_bd_addr_t));
+            dle_pending = true;
+        }
+    }
+}
+
 static bool adv_config_done = false;
 static bool scan_rsp_config_done = false;
 
@@ -358,17 +1280,159 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
             break;
         case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
             if (param->adv_start_cmpl.status == ESP_BT_STATUS_SUCCESS) {
+                advertising = true;
                 ESP_LOGI(TAG, "BLE advertising started");
             } else {
                 ESP_LOGE(TAG, "BLE advertising failed to start");
             }
             break;
+        case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT: {
+            // Record what the central actually granted
+            bool granted = param->update_conn_params.status == ESP_BT_STATUS_SUCCESS;
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = ble_conn_find_bda(&conn_table, param->update_conn_params.bda);
+            if (conn != NULL && granted) {
+                conn->interval = param->update_conn_params.conn_int;
+                conn->latency = param->update_conn_params.latency;
+                conn->timeout = param->update_conn_params.timeout;
+            }
+            int slot = conn != NULL ? (int)(conn - conn_table.conns) : -1;
+            uint16_t conn_id = conn != NULL ? conn->conn_id : 0;
+            ble_conn_table_unlock(&conn_table);
+            if (slot < 0) {
+                break;
+            }
+            if (granted) {
+                ESP_LOGI(TAG, "Conn %d parameters: interval=%d latency=%d timeout=%d",
+                         conn_id, param->update_conn_params.conn_int, param->update_conn_params.latency,
+                         param->update_conn_params.timeout);
+                atomic_fetch_or(&policy_events[slot], POLICY_EVENT_UPDATED);
+            } else {
+                ESP_LOGW(TAG, "Conn %d parameter update failed: %d",
+                         conn_id, param->update_conn_params.status);
+                atomic_fetch_or(&policy_events[slot], POLICY_EVENT_UPDATE_FAILED);
+            }
+            if (ble_notify_task_handle != NULL) {
+                xTaskNotifyGive(ble_notify_task_handle);
+            }
+            break;
+        }
+        case ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT: {
+            if (param->phy_update.status != ESP_BT_STATUS_SUCCESS) {
+                break;
+            }
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = ble_conn_find_bda(&conn_table, param->phy_update.bda);
+            if (conn != NULL) {
+                conn->tx_phy = param->phy_update.tx_phy;
+                conn->rx_phy = param->phy_update.rx_phy;
+            }
+            int conn_id = conn != NULL ? conn->conn_id : -1;
+            ble_conn_table_unlock(&conn_table);
+            if (conn_id >= 0) {
+                ESP_LOGI(TAG, "Conn %d PHY: tx=%d rx=%d", conn_id, param->phy_update.tx_phy, param->phy_update.rx_phy);
+            }
+            break;
+        }
+        case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT: {
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = dle_pending ? ble_conn_find_bda(&conn_table, dle_pending_bda) : NULL;
+            bool ok = conn != NULL && param->pkt_data_length_cmpl.status == ESP_BT_STATUS_SUCCESS;
+            if (ok) {
+                conn->tx_data_len = param->pkt_data_length_cmpl.params.tx_len;
+                conn->rx_data_len = param->pkt_data_length_cmpl.params.rx_len;
+            }
+            int conn_id = ok ? conn->conn_id : -1;
+            ble_conn_table_unlock(&conn_table);
+            dle_pending = false;
+            if (conn_id >= 0) {
+                ESP_LOGI(TAG, "Conn %d data length: tx=%d rx=%d", conn_id,
+                         param->pkt_data_length_cmpl.params.tx_len, param->pkt_data_length_cmpl.params.rx_len);
+            }
+            request_data_length();
+            break;
+        }
         default:
             break;
     }
 }
 
 // ============== BLE GATTS EVENT HANDLER ==============
+// Connectable advertising stops when a central connects; keep advertising
+// while there is room for another client
+static void update_advertising(void) {
+    ble_conn_table_lock(&conn_table);
+    size_t clients = ble_conn_count(&conn_table);
+    ble_conn_table_unlock(&conn_table);
+    if (!advertising && clients < BLE_CONN_MAX) {
+        esp_ble_gap_start_advertising(&adv_params);
+    }
+}
+
+// Map a CCCD handle to the characteristic it controls
+static bool cccd_char(uint16_t handle, ble_conn_char_t *ch) {
+    if (handle != 0 && handle == char_cccd_handle) {
+        *ch = BLE_CONN_CHAR_TEXT;
+    } else if (handle != 0 && handle == reading_cccd_handle) {
+        *ch = BLE_CONN_CHAR_READING;
+    } else if (handle != 0 && handle == history_cccd_handle) {
+        *ch = BLE_CONN_CHAR_HISTORY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void add_gatt_char(size_t index) {
+    if (index >= GATT_CHAR_COUNT) {
+        ESP_LOGI(TAG, "All BLE characteristics registered successfully");
+        return;
+    }
+
+    const gatt_char_def_t *def = &gatt_chars[index];
+    esp_bt_uuid_t uuid = {
+        .len = ESP_UUID_LEN_128,
+    };
+    memcpy(uuid.uuid.uuid128, def->uuid128, 16);
+    esp_ble_gatts_add_char(service_handle, &uuid, def->perm, def->property,
+                           def->initial_value, NULL);
+}
+
+// ============== FILTER CONFIG STORAGE ==============
+static void load_filter_config(void) {
+    reading_filter_config_t config;
+    uint8_t buf[READING_FILTER_CONFIG_SIZE];
+    size_t len = sizeof(buf);
+    nvs_handle_t nvs;
+
+    if (nvs_open(FILTER_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        esp_err_t err = nvs_get_blob(nvs, FILTER_NVS_KEY, buf, &len);
+        nvs_close(nvs);
+        if (err == ESP_OK && reading_filter_config_decode(buf, len, &config)) {
+            ESP_LOGI(TAG, "Loaded filter config: mode=%d", config.mode);
+            set_filter_config(&config);
+        }
+    }
+}
+
+static void save_filter_config(const reading_filter_config_t *config) {
+    uint8_t buf[READING_FILTER_CONFIG_SIZE];
+    size_t len = reading_filter_config_encode(config, buf);
+    nvs_handle_t nvs;
+
+    esp_err_t err = nvs_open(FILTER_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, FILTER_NVS_KEY, buf, len);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save filter config: %s", esp_err_to_name(err));
+    }
+}
+
 static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatt_if,
                                  esp_ble_gatts_cb_param_t *param) {
     switch (event) {
@@ -396,26 +1460,20 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatt_i
             service_handle = param->create.service_handle;
             esp_ble_gatts_start_service(service_handle);
 
-            // Add gas data characteristic (READ + NOTIFY)
-            esp_bt_uuid_t gas_char_uuid = {
-                .len = ESP_UUID_LEN_128,
-            };
-            memcpy(gas_char_uuid.uuid.uuid128, char_uuid128, 16);
-            esp_ble_gatts_add_char(service_handle, &gas_char_uuid,
-                ESP_GATT_PERM_READ,
-                ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_NOTIFY,
-                &char_val, NULL);
+            // Add the first characteristic; the rest follow from ADD_CHAR events
+            gatt_char_index = 0;
+            add_gatt_char(gatt_char_index);
             break;
 
         case ESP_GATTS_ADD_CHAR_EVT: {
-            // Determine which characteristic was just added based on UUID
-            uint8_t *added_uuid = param->add_char.char_uuid.uuid.uuid128;
-
-            if (memcmp(added_uuid, char_uuid128, 16) == 0) {
-                // Gas data characteristic added - store handle and add CCCD
-                char_handle = param->add_char.attr_handle;
-                ESP_LOGI(TAG, "Gas data characteristic added, handle=%d", char_handle);
+            if (gatt_char_index >= GATT_CHAR_COUNT) {
+                break;
+            }
+            const gatt_char_def_t *def = &gatt_chars[gatt_char_index];
+            *def->handle = param->add_char.attr_handle;
+            ESP_LOGI(TAG, "%s characteristic added, handle=%d", def->name, *def->handle);
 
+            if (def->cccd_handle != NULL) {
                 // Add CCCD descriptor for notifications
                 esp_bt_uuid_t descr_uuid = {
                     .len = ESP_UUID_LEN_16,
@@ -423,61 +1481,96 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatt_i
                 };
                 esp_ble_gatts_add_char_descr(service_handle, &descr_uuid,
                     ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE, NULL, NULL);
-            } else if (memcmp(added_uuid, version_char_uuid128, 16) == 0) {
-                // Version characteristic added
-                version_char_handle = param->add_char.attr_handle;
-                ESP_LOGI(TAG, "Version characteristic added, handle=%d", version_char_handle);
-
-                // Add OTA control characteristic (WRITE only)
-                esp_bt_uuid_t ota_uuid = {
-                    .len = ESP_UUID_LEN_128,
-                };
-                memcpy(ota_uuid.uuid.uuid128, ota_char_uuid128, 16);
-                esp_ble_gatts_add_char(service_handle, &ota_uuid,
-                    ESP_GATT_PERM_WRITE,
-                    ESP_GATT_CHAR_PROP_BIT_WRITE,
-                    NULL, NULL);
-            } else if (memcmp(added_uuid, ota_char_uuid128, 16) == 0) {
-                // OTA control characteristic added
-                ota_char_handle = param->add_char.attr_handle;
-                ESP_LOGI(TAG, "OTA control characteristic added, handle=%d", ota_char_handle);
-                ESP_LOGI(TAG, "All BLE characteristics registered successfully");
+            } else {
+                add_gatt_char(++gatt_char_index);
             }
             break;
         }
 
         case ESP_GATTS_ADD_CHAR_DESCR_EVT:
-            // CCCD descriptor added - now add version characteristic
-            ESP_LOGI(TAG, "CCCD descriptor added, adding version characteristic");
-            esp_bt_uuid_t ver_uuid = {
-                .len = ESP_UUID_LEN_128,
-            };
-            memcpy(ver_uuid.uuid.uuid128, version_char_uuid128, 16);
-            esp_ble_gatts_add_char(service_handle, &ver_uuid,
-                ESP_GATT_PERM_READ,
-                ESP_GATT_CHAR_PROP_BIT_READ,
-                NULL, NULL);
+            if (gatt_char_index >= GATT_CHAR_COUNT) {
+                break;
+            }
+            *gatt_chars[gatt_char_index].cccd_handle = param->add_char_descr.attr_handle;
+            ESP_LOGI(TAG, "CCCD descriptor added for %s", gatt_chars[gatt_char_index].name);
+            add_gatt_char(++gatt_char_index);
             break;
 
-        case ESP_GATTS_CONNECT_EVT:
-            conn_id = param->connect.conn_id;
-            device_connected = true;
-            ESP_LOGI(TAG, "BLE Client connected");
-
-            // Request connection parameter update for iOS compatibility
-            esp_ble_conn_update_params_t conn_params = {0};
+        case ESP_GATTS_CONNECT_EVT: {
+            advertising = false;
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = ble_conn_add(&conn_table, param->connect.conn_id, param->connect.remote_bda);
+            if (conn != NULL) {
+                conn->connected_ms = (uint32_t)(esp_timer_get_time() / 1000);
+                conn->interval = param->connect.conn_params.interval;
+                conn->latency = param->connect.conn_params.latency;
+                conn->timeout = param->connect.conn_params.timeout;
+            }
+            int slot = conn != NULL ? (int)(conn - conn_table.conns) : -1;
+            size_t clients = ble_conn_count(&conn_table);
+            ble_conn_table_unlock(&conn_table);
+            if (slot < 0) {
+                ESP_LOGW(TAG, "Connection table full, rejecting conn %d", param->connect.conn_id);
+                esp_ble_gatts_close(gatt_if, param->connect.conn_id);
+                break;
+            }
+            post_bridge_event(BRIDGE_EV_BLE_CONNECTED, param->connect.conn_id);
+            atomic_store(&initial_pending[slot], 0);
+            ESP_LOGI(TAG, "BLE Client connected (conn %d, %u/%d clients)",
+                     param->connect.conn_id, (unsigned)clients, BLE_CONN_MAX);
+            update_advertising();
+
+            // Restart the filter so the new client gets the next reading
+            set_filter_config(NULL);
+
+            // Start on the active profile; the notify task's policy takes
+            // over from here (see conn_policy.h)
+            conn_params_t active;
+            conn_policy_profile_params(CONN_PROFILE_ACTIVE, &active);
+            esp_ble_conn_update_params_t conn_params = {
+                .min_int = active.min_int,
+                .max_int = active.max_int,
+                .latency = active.latency,
+                .timeout = active.timeout,
+            };
             memcpy(conn_params.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
-            conn_params.min_int = 0x10;  // 20ms (0x10 * 1.25ms)
-            conn_params.max_int = 0x20;  // 40ms (0x20 * 1.25ms)
-            conn_params.latency = 0;
-            conn_params.timeout = 400;   // 4000ms (400 * 10ms)
             esp_ble_gap_update_conn_params(&conn_params);
+            atomic_store(&policy_events[slot], POLICY_EVENT_CONNECTED);
+
+            // Shorter air time per reading: 2M PHY and full-size LL packets
+            esp_ble_gap_set_preferred_phy(param->connect.remote_bda, 0,
+                                          ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                          ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+            dle_wanted[slot] = true;
+            request_data_length();
             // Don't send data here - wait for MTU negotiation and notification subscription
             break;
+        }
+
+        case ESP_GATTS_MTU_EVT: {
+            ESP_LOGI(TAG, "MTU negotiated: %d (conn %d)", param->mtu.mtu, param->mtu.conn_id);
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = ble_conn_find(&conn_table, param->mtu.conn_id);
+            if (conn != NULL) {
+                conn->mtu = param->mtu.mtu;
+            }
+            ble_conn_table_unlock(&conn_table);
+            break;
+        }
 
-        case ESP_GATTS_MTU_EVT:
-            ESP_LOGI(TAG, "MTU negotiated: %d", param->mtu.mtu);
+        case ESP_GATTS_CONGEST_EVT: {
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = ble_conn_find(&conn_table, param->congest.conn_id);
+            if (conn != NULL) {
+                conn->congested = param->congest.congested;
+            }
+            ble_conn_table_unlock(&conn_table);
+            if (!param->congest.congested && ble_notify_task_handle != NULL) {
+                // Link drained - resume sending queued lines
+                xTaskNotifyGive(ble_notify_task_handle);
+            }
             break;
+        }
 
         case ESP_GATTS_WRITE_EVT:
             ESP_LOGI(TAG, "Write event: handle=%d, len=%d", param->write.handle, param->write.len);
@@ -490,25 +1583,102 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatt_i
                 if (command == 0x01) {
                     // Enter OTA update mode
                     ESP_LOGI(TAG, "OTA mode requested via BLE");
-                    ota_mode_requested = true;
+                    post_bridge_event(BRIDGE_EV_OTA_REQUESTED, 0);
+                } else if (command == RX_TRACE_CMD_START) {
+                    start_rx_trace();
+                } else if (command == RX_TRACE_CMD_EXPORT) {
+                    export_rx_trace();
+                }
+            }
+
+            // Deadband filter configuration
+            esp_gatt_status_t write_status = ESP_GATT_OK;
+            if (param->write.handle == control_char_handle) {
+                reading_filter_config_t config;
+                if (reading_filter_config_decode(param->write.value, param->write.len, &config)) {
+                    ESP_LOGI(TAG, "Filter config: mode=%d heartbeat=%dms", config.mode, config.heartbeat_ms);
+                    set_filter_config(&config);
+                    save_filter_config(&config);
+                } else {
+                    ESP_LOGW(TAG, "Rejected filter config (len=%d)", param->write.len);
+                    write_status = ESP_GATT_OUT_OF_RANGE;
+                }
+            }
+
+            // History backfill request: everything after a sequence number
+            ble_conn_table_lock(&conn_table);
+            ble_conn_t *conn = ble_conn_find(&conn_table, param->write.conn_id);
+            int slot = conn != NULL ? (int)(conn - conn_table.conns) : -1;
+            ble_conn_table_unlock(&conn_table);
+            if (param->write.handle == history_char_handle) {
+                if (param->write.len >= 4 && slot >= 0) {
+                    const uint8_t *v = param->write.value;
+                    history_request_after[slot] = (uint32_t)v[0] | ((uint32_t)v[1] << 8) |
+                                                  ((uint32_t)v[2] << 16) | ((uint32_t)v[3] << 24);
+                    history_requested[slot] = true;
+                    if (ble_notify_task_handle != NULL) {
+                        xTaskNotifyGive(ble_notify_task_handle);
+                    }
+                } else {
+                    write_status = ESP_GATT_INVALID_ATTR_LEN;
+                }
+            }
+
+            // Notification subscriptions are tracked per client
+            ble_conn_char_t ch;
+            bool subscribed = false;
+            if (cccd_char(param->write.handle, &ch)) {
+                if (param->write.len == 2 && slot >= 0) {
+                    uint16_t value = param->write.value[0] | (param->write.value[1] << 8);
+                    ble_conn_table_lock(&conn_table);
+                    subscribed = ble_conn_set_cccd(&conn_table.conns[slot], ch, value);
+                    ble_conn_table_unlock(&conn_table);
+                    ESP_LOGI(TAG, "Conn %d CCCD %d = 0x%04X", param->write.conn_id, ch, value);
+                } else {
+                    write_status = ESP_GATT_INVALID_ATTR_LEN;
                 }
             }
 
             // Send response if needed
             if (param->write.need_rsp) {
                 esp_ble_gatts_send_response(gatt_if, param->write.conn_id,
-                    param->write.trans_id, ESP_GATT_OK, NULL);
+                    param->write.trans_id, write_status, NULL);
+            }
+
+            // Push the cached reading only after the response, so the
+            // client has seen its subscription confirmed when it arrives
+            if (subscribed && (ch == BLE_CONN_CHAR_TEXT || ch == BLE_CONN_CHAR_READING)) {
+                post_bridge_event(BRIDGE_EV_BLE_SUBSCRIBED, param->write.conn_id);
+                atomic_fetch_or(&initial_pending[slot], (uint8_t)(1 << ch));
+                if (ble_notify_task_handle != NULL) {
+                    xTaskNotifyGive(ble_notify_task_handle);
+                }
             }
             break;
 
-        case ESP_GATTS_DISCONNECT_EVT:
-            device_connected = false;
-            ESP_LOGI(TAG, "BLE Client disconnected, restarting advertising");
-            esp_ble_gap_start_advertising(&adv_params);
+        case ESP_GATTS_DISCONNECT_EVT: {
+            ble_conn_table_lock(&conn_table);
+            bool known = ble_conn_find(&conn_table, param->disconnect.conn_id) != NULL;
+            ble_conn_remove(&conn_table, param->disconnect.conn_id);
+            size_t clients = ble_conn_count(&conn_table);
+            ble_conn_table_unlock(&conn_table);
+            if (known) {
+                post_bridge_event(BRIDGE_EV_BLE_DISCONNECTED, param->disconnect.conn_id);
+            }
+            ESP_LOGI(TAG, "BLE Client disconnected (conn %d, %u/%d clients)",
+                     param->disconnect.conn_id, (unsigned)clients, BLE_CONN_MAX);
+            update_advertising();
+            if (ble_notify_task_handle != NULL) {
+                // A congested client may have been the one holding data back
+                xTaskNotifyGive(ble_notify_task_handle);
+            }
             break;
+        }
 
         case ESP_GATTS_READ_EVT: {
             // Handle read request
+            ble_conn_t *conn;
+            ble_conn_char_t ch;
             esp_gatt_rsp_t rsp;
             memset(&rsp, 0, sizeof(esp_gatt_rsp_t));
             rsp.attr_value.handle = param->read.handle;
@@ -519,14 +1689,49 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatt_i
                 memcpy(rsp.attr_value.value, FIRMWARE_VERSION, rsp.attr_value.len);
                 ESP_LOGI(TAG, "Version read: %s", FIRMWARE_VERSION);
             } else if (param->read.handle == char_handle) {
-                // Return last gas reading
-                rsp.attr_value.len = strlen(last_reading);
-                memcpy(rsp.attr_value.value, last_reading, rsp.attr_value.len);
+                // Return last gas reading, from whichever analyzer reported last
+                const analyzer_channel_latest_t *latest = &channel_latest[latest_channel];
+                rsp.attr_value.len = latest->text_len;
+                memcpy(rsp.attr_value.value, latest->text, latest->text_len);
+            } else if (param->read.handle == reading_char_handle) {
+                // Return last parsed reading in binary format (empty until the first parse)
+                const analyzer_channel_latest_t *latest = &channel_latest[latest_channel];
+                if (latest->has_reading) {
+                    rsp.attr_value.len = reading_format_encode(&latest->reading, rsp.attr_value.value);
+                }
+            } else if (param->read.handle == control_char_handle) {
+                reading_filter_config_t config;
+                get_filter_config(&config);
+                rsp.attr_value.len = reading_filter_config_encode(&config, rsp.attr_value.value);
+            } else if (param->read.handle == diag_char_handle) {
+                // Link diagnostics for the reading client
+                ble_conn_table_lock(&conn_table);
+                if ((conn = ble_conn_find(&conn_table, param->read.conn_id)) != NULL) {
+                    rsp.attr_value.len = ble_conn_encode_diagnostics(&conn_table, conn, rsp.attr_value.value);
+                }
+                ble_conn_table_unlock(&conn_table);
+            } else if (cccd_char(param->read.handle, &ch)) {
+                // Each client reads back its own subscription
+                ble_conn_table_lock(&conn_table);
+                if ((conn = ble_conn_find(&conn_table, param->read.conn_id)) != NULL) {
+                    rsp.attr_value.len = 2;
+                    rsp.attr_value.value[0] = (uint8_t)conn->cccd[ch];
+                    rsp.attr_value.value[1] = (uint8_t)(conn->cccd[ch] >> 8);
+                }
+                ble_conn_table_unlock(&conn_table);
             } else {
                 // Unknown handle - return empty
                 rsp.attr_value.len = 0;
             }
 
+            // Values longer than MTU - 1 are fetched with follow-up reads at an offset
+            if (param->read.is_long) {
+                uint16_t offset = param->read.offset < rsp.attr_value.len ? param->read.offset : rsp.attr_value.len;
+                rsp.attr_value.len -= offset;
+                memmove(rsp.attr_value.value, rsp.attr_value.value + offset, rsp.attr_value.len);
+                rsp.attr_value.offset = param->read.offset;
+            }
+
             esp_ble_gatts_send_response(gatt_if, param->read.conn_id,
                 param->read.trans_id, ESP_GATT_OK, &rsp);
             break;
@@ -537,6 +1742,26 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatt_i
     }
 }
 
+// ============== READING HISTORY ==============
+static void init_reading_history(void) {
+    uint32_t capacity = READING_HISTORY_PSRAM_CAPACITY;
+    gas_reading_t *storage = heap_caps_malloc(capacity * sizeof(gas_reading_t), MALLOC_CAP_SPIRAM);
+
+    if (storage == NULL) {
+        capacity = READING_HISTORY_INTERNAL_CAPACITY;
+        storage = heap_caps_malloc(capacity * sizeof(gas_reading_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        ESP_LOGW(TAG, "No PSRAM available, reading history limited to %lu readings", capacity);
+    }
+    if (storage == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate reading history");
+        capacity = 0;
+    }
+
+    reading_history_init(&reading_history, storage, capacity);
+    ESP_LOGI(TAG, "Reading history: %lu readings (%u bytes)",
+             capacity, (unsigned)(capacity * sizeof(gas_reading_t)));
+}
+
 // ============== BLE SETUP ==============
 static void setup_ble(void) {
     esp_err_t ret;
@@ -549,6 +1774,8 @@ static void setup_ble(void) {
     }
     ESP_ERROR_CHECK(ret);
 
+    load_filter_config();
+
     // Release memory for classic BT (we only use BLE)
     ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT));
 
@@ -577,74 +1804,41 @@ void app_main(void) {
     ESP_LOGI(TAG, "\n\nGasTag Bridge Starting...");
     ESP_LOGI(TAG, "Firmware version: %s", FIRMWARE_VERSION);
 
+    // DFS and light sleep first, so the locks exist before any task runs
+    power_mgmt_init();
+
     // Initialize OTA module
     ota_init();
 
+    // Events can be posted as soon as BLE or USB is up
+    bridge_queue = xQueueCreate(BRIDGE_EVENT_QUEUE_DEPTH, sizeof(bridge_event_t));
+
+    // Start BLE notify task before any USB data can arrive
+    line_ring_init(&line_ring);
+    conn_table_mutex = xSemaphoreCreateMutex();
+    ble_conn_table_init(&conn_table);
+    ble_conn_table_set_lock(&conn_table, lock_conn_table, unlock_conn_table, NULL);
+    init_reading_history();
+    reading_log_writer_start();
+    reading_filter_config_t config;
+    reading_filter_default_config(&config);
+    set_filter_config(&config);
+    xTaskCreatePinnedToCore(ble_notify_task, "ble_notify", BLE_NOTIFY_TASK_STACK, NULL,
+                            BLE_NOTIFY_TASK_PRIORITY, &ble_notify_task_handle, BLE_NOTIFY_TASK_CORE);
+
     // Setup BLE
     setup_ble();
 
-    // Start USB Host task on core 1
+    // USB host stack, RX framing and the bridge state machine, all on core 1
+    const usb_rx_hooks_t usb_rx_hooks = {
+        .busy = usb_rx_busy,
+        .lines = usb_rx_lines,
+    };
+    ESP_ERROR_CHECK(usb_rx_start(&line_ring, &usb_rx_hooks));
+    xTaskCreatePinnedToCore(bridge_task, "bridge", BRIDGE_TASK_STACK, NULL,
+                            BRIDGE_TASK_PRIORITY, NULL, BRIDGE_TASK_CORE);
     xTaskCreatePinnedToCore(usb_host_task, "usb_host", 8192, NULL, 5, NULL, 1);
 
+    // Everything from here on is event driven; the main task is done
     ESP_LOGI(TAG, "=== GasTag Bridge Ready ===");
-
-    // Main loop - check for OTA mode request
-    while (1) {
-        if (ota_mode_requested) {
-            // Clear flag immediately to prevent re-entry
-            ota_mode_requested = false;
-
-            ESP_LOGI(TAG, "OTA mode requested, stopping BLE and starting WiFi...");
-
-            // Stop BLE advertising before starting WiFi
-            esp_ble_gap_stop_advertising();
-            esp_bluedroid_disable();
-            esp_bluedroid_deinit();
-            esp_bt_controller_disable();
-            esp_bt_controller_deinit();
-
-            ESP_LOGI(TAG, "BLE stopped, starting OTA update mode...");
-
-            // Start OTA update mode
-            esp_err_t err = ota_start_update_mode();
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "OTA update mode failed: %s", esp_err_to_name(err));
-                // On failure, restart to restore normal operation
-                ESP_LOGI(TAG, "Restarting to restore normal operation...");
-                vTaskDelay(pdMS_TO_TICKS(1000));
-                esp_restart();
-            }
-
-            // OTA mode started successfully - wait for update to complete or timeout
-            // The HTTP server handles the actual update. We wait here to prevent
-            // the main loop from doing anything else while OTA is active.
-            ESP_LOGI(TAG, "Waiting for OTA update (timeout: 5 minutes)...");
-            uint32_t ota_start_time = xTaskGetTickCount();
-            const uint32_t OTA_TIMEOUT_TICKS = pdMS_TO_TICKS(5 * 60 * 1000);  // 5 minutes
-
-            while (ota_get_state() != OTA_STATE_SUCCESS &&
-                   ota_get_state() != OTA_STATE_FAILED) {
-                // Check for timeout
-                if ((xTaskGetTickCount() - ota_start_time) > OTA_TIMEOUT_TICKS) {
-                    ESP_LOGW(TAG, "OTA timeout - no update received");
-                    ota_stop_update_mode();
-                    ESP_LOGI(TAG, "Restarting to restore normal operation...");
-                    vTaskDelay(pdMS_TO_TICKS(1000));
-                    esp_restart();
-                }
-                vTaskDelay(pdMS_TO_TICKS(1000));  // Check every second
-            }
-
-            // If we get here with SUCCESS state, device will reboot in the HTTP handler
-            // If FAILED, restart to restore normal operation
-            if (ota_get_state() == OTA_STATE_FAILED) {
-                ESP_LOGE(TAG, "OTA update failed");
-                ESP_LOGI(TAG, "Restarting to restore normal operation...");
-                vTaskDelay(pdMS_TO_TICKS(1000));
-                esp_restart();
-            }
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(100));  // Check every 100ms
-    }
 }
@@ -0,0 +1,160 @@
+/*
+ * Power Management Implementation
+ *
+ * The counters are shared between the sleep callback (idle task, interrupts
+ * off), the boosting tasks and the report timer, so every access goes
+ * through one spinlock.
+ */
+
+#include "power_mgmt.h"
+
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "POWER";
+
+// ============== STATE ==============
+static esp_pm_lock_handle_t cpu_lock = NULL;    // ESP_PM_CPU_FREQ_MAX
+static esp_pm_lock_handle_t usb_lock = NULL;    // ESP_PM_NO_LIGHT_SLEEP
+static bool usb_lock_held = false;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static power_stats_t power_stats;
+static uint32_t boost_depth = 0;
+static int64_t boost_start_us = 0;
+static int64_t start_us = 0;
+
+static esp_timer_handle_t report_timer = NULL;
+static power_stats_t reported_stats;
+static int64_t reported_us = 0;
+
+// ============== SLEEP ACCOUNTING ==============
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static IRAM_ATTR esp_err_t on_light_sleep_exit(int64_t sleep_time_us, void *arg) {
+    portENTER_CRITICAL_SAFE(&stats_lock);
+    power_stats.sleep_us += (uint64_t)sleep_time_us;
+    power_stats.sleeps++;
+    portEXIT_CRITICAL_SAFE(&stats_lock);
+    return ESP_OK;
+}
+#endif
+
+// ============== REPORT ==============
+static void log_report(void *arg) {
+    power_stats_t stats;
+    uint64_t elapsed_us;
+    power_mgmt_get_stats(&stats, &elapsed_us);
+    int64_t now_us = start_us + (int64_t)elapsed_us;
+
+    power_report_t window;
+    power_report_t total;
+    power_stats_t zero = {0};
+    power_stats_report(&stats, &reported_stats, (uint64_t)(now_us - reported_us), &window);
+    power_stats_report(&stats, &zero, elapsed_us, &total);
+    reported_stats = stats;
+    reported_us = now_us;
+
+    ESP_LOGI(TAG, "Last %lu s: %u.%u%% light sleep (%lu sleeps), %u.%u%% min clock, "
+             "%u.%u%% full clock, ~%lu.%lu mA; since boot ~%lu.%lu mA",
+             window.elapsed_ms / 1000,
+             window.sleep_permille / 10, window.sleep_permille % 10, window.sleeps,
+             window.awake_permille / 10, window.awake_permille % 10,
+             window.boost_permille / 10, window.boost_permille % 10,
+             window.avg_current_ua / 1000, (window.avg_current_ua % 1000) / 100,
+             total.avg_current_ua / 1000, (total.avg_current_ua % 1000) / 100);
+}
+
+// ============== PUBLIC API ==============
+esp_err_t power_mgmt_init(void) {
+    start_us = esp_timer_get_time();
+    reported_us = start_us;
+
+    esp_err_t err = ESP_OK;
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP_ENABLE,
+    };
+    err = esp_pm_configure(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "rx_notify", &cpu_lock));
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "usb_device", &usb_lock));
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = on_light_sleep_exit,
+    };
+    ESP_ERROR_CHECK(esp_pm_light_sleep_register_cbs(&cbs));
+#endif
+
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", POWER_MIN_CPU_FREQ_MHZ,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, POWER_LIGHT_SLEEP_ENABLE ? "on" : "off");
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is off, running at full clock");
+#endif
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = log_report,
+        .name = "power_report",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &report_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(report_timer, POWER_REPORT_INTERVAL_MS * 1000ULL));
+    return err;
+}
+
+void power_mgmt_boost_begin(void) {
+    if (cpu_lock != NULL) {
+        esp_pm_lock_acquire(cpu_lock);
+    }
+    portENTER_CRITICAL(&stats_lock);
+    if (boost_depth++ == 0) {
+        boost_start_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void power_mgmt_boost_end(void) {
+    portENTER_CRITICAL(&stats_lock);
+    if (boost_depth > 0 && --boost_depth == 0) {
+        power_stats.boost_us += (uint64_t)(esp_timer_get_time() - boost_start_us);
+    }
+    portEXIT_CRITICAL(&stats_lock);
+    if (cpu_lock != NULL) {
+        esp_pm_lock_release(cpu_lock);
+    }
+}
+
+void power_mgmt_set_usb_device(bool present) {
+    // Only the USB host task calls this
+    if (usb_lock == NULL || present == usb_lock_held) {
+        return;
+    }
+    if (present) {
+        esp_pm_lock_acquire(usb_lock);
+    } else {
+        esp_pm_lock_release(usb_lock);
+    }
+    usb_lock_held = present;
+}
+
+void power_mgmt_get_stats(power_stats_t *stats, uint64_t *elapsed_us) {
+    portENTER_CRITICAL(&stats_lock);
+    int64_t now_us = esp_timer_get_time();
+    *stats = power_stats;
+    if (boost_depth > 0) {
+        stats->boost_us += (uint64_t)(now_us - boost_start_us);  // Count the boost in progress
+    }
+    portEXIT_CRITICAL(&stats_lock);
+
+    if (elapsed_us != NULL) {
+        *elapsed_us = (uint64_t)(now_us - start_us);
+    }
+}
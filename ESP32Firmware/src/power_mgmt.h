@@ -0,0 +1,72 @@
+/*
+ * Power Management for GasTag Bridge
+ *
+ * Configures esp_pm for dynamic frequency scaling and automatic light sleep
+ * (with FreeRTOS tickless idle). Between BLE connection events, advertising
+ * events and analyzer data the chip sleeps.
+ *
+ * Two locks keep it awake when it matters:
+ *   - the CPU frequency lock, held only around USB RX processing and each
+ *     pass of the BLE notify task (power_mgmt_boost_begin/end)
+ *   - a no-light-sleep lock, held while an analyzer is open, because the
+ *     USB OTG controller cannot keep the bus alive through light sleep
+ *
+ * Light sleep therefore only happens while no analyzer is attached. A
+ * device plugged in during sleep is noticed on the next wake-up, which
+ * advertising or a connection event provides within tens of milliseconds.
+ *
+ * Time spent in each state is counted (power_stats.h) and logged every
+ * POWER_REPORT_INTERVAL_MS with an estimated average current.
+ */
+
+#ifndef POWER_MGMT_H
+#define POWER_MGMT_H
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "power_stats.h"
+
+// ============== POWER CONFIGURATION ==============
+#define POWER_MIN_CPU_FREQ_MHZ     80      // APB stays at 80 MHz for the USB controller
+#define POWER_LIGHT_SLEEP_ENABLE   1       // 0: DFS only
+#define POWER_REPORT_INTERVAL_MS   60000
+
+// ============== PUBLIC API ==============
+
+/**
+ * Configure DFS and light sleep, create the locks and start the periodic
+ * report. Without CONFIG_PM_ENABLE only the report runs and the lock
+ * calls do nothing.
+ *
+ * @return ESP_OK, or the esp_pm error
+ */
+esp_err_t power_mgmt_init(void);
+
+/**
+ * Run at the maximum clock until the matching power_mgmt_boost_end().
+ * Calls nest and may come from several tasks.
+ */
+void power_mgmt_boost_begin(void);
+
+/**
+ * Release one power_mgmt_boost_begin().
+ */
+void power_mgmt_boost_end(void);
+
+/**
+ * Report whether a USB device is open. Light sleep is blocked while it is.
+ *
+ * @param present true after opening the device, false after closing it
+ */
+void power_mgmt_set_usb_device(bool present);
+
+/**
+ * Snapshot the counters since boot. Safe to call from any task.
+ *
+ * @param stats      Output counters
+ * @param elapsed_us Time since power_mgmt_init(), may be NULL
+ */
+void power_mgmt_get_stats(power_stats_t *stats, uint64_t *elapsed_us);
+
+#endif // POWER_MGMT_H
@@ -0,0 +1,40 @@
+/*
+ * Power Statistics Implementation
+ */
+
+#include "power_stats.h"
+
+#include <string.h>
+
+void power_stats_report(const power_stats_t *end, const power_stats_t *start,
+                        uint64_t elapsed_us, power_report_t *report) {
+    memset(report, 0, sizeof(*report));
+    if (elapsed_us == 0) {
+        return;
+    }
+
+    uint64_t sleep_us = end->sleep_us - start->sleep_us;
+    uint64_t boost_us = end->boost_us - start->boost_us;
+
+    // The counters come from different sources and can overshoot the
+    // wall clock by a little; the awake time absorbs the difference
+    if (sleep_us > elapsed_us) {
+        sleep_us = elapsed_us;
+    }
+    if (boost_us > elapsed_us - sleep_us) {
+        boost_us = elapsed_us - sleep_us;
+    }
+    uint64_t awake_us = elapsed_us - sleep_us - boost_us;
+
+    report->elapsed_ms = (uint32_t)(elapsed_us / 1000);
+    report->sleep_permille = (uint16_t)(sleep_us * 1000 / elapsed_us);
+    report->boost_permille = (uint16_t)(boost_us * 1000 / elapsed_us);
+    report->awake_permille = (uint16_t)(1000 - report->sleep_permille - report->boost_permille);
+    report->sleeps = end->sleeps - start->sleeps;
+
+    // Charge in uA*us, then divide by the interval
+    uint64_t charge = sleep_us * POWER_CURRENT_SLEEP_UA +
+                      awake_us * POWER_CURRENT_AWAKE_UA +
+                      boost_us * POWER_CURRENT_BOOST_UA;
+    report->avg_current_ua = (uint32_t)(charge / elapsed_us);
+}
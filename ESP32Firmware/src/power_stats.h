@@ -0,0 +1,54 @@
+/*
+ * Power Statistics for GasTag Bridge
+ *
+ * Splits wall-clock time into three states and turns them into an average
+ * current estimate:
+ *   - light sleep, as reported by the power management sleep callbacks
+ *   - full clock, while the firmware holds its CPU frequency lock
+ *   - awake at the DFS minimum clock, everything else
+ *
+ * The per-state currents are datasheet-level estimates for the module
+ * alone; the radio's TX bursts and the analyzer on the USB port are not
+ * included. Calibrate them against a meter before quoting battery life.
+ */
+
+#ifndef POWER_STATS_H
+#define POWER_STATS_H
+
+#include <stdint.h>
+
+// ============== CURRENT ESTIMATES ==============
+#define POWER_CURRENT_BOOST_UA  40000   // CPU at the maximum clock
+#define POWER_CURRENT_AWAKE_UA  22000   // CPU at the DFS minimum, mostly in WAITI
+#define POWER_CURRENT_SLEEP_UA  2000    // Light sleep, main crystal kept on for BLE
+
+// ============== STATS TYPES ==============
+typedef struct {
+    uint64_t sleep_us;          // Time spent in light sleep
+    uint64_t boost_us;          // Time with the CPU frequency lock held
+    uint32_t sleeps;            // Light sleep entries
+} power_stats_t;
+
+typedef struct {
+    uint32_t elapsed_ms;        // Length of the reported interval
+    uint16_t sleep_permille;    // Share of the interval in light sleep
+    uint16_t awake_permille;    // Share awake at the minimum clock
+    uint16_t boost_permille;    // Share at the maximum clock
+    uint32_t sleeps;            // Light sleep entries in the interval
+    uint32_t avg_current_ua;    // Estimated average current
+} power_report_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Summarise the interval between two counter snapshots.
+ *
+ * @param end        Counters at the end of the interval
+ * @param start      Counters at the start of the interval (zeroed for since boot)
+ * @param elapsed_us Wall-clock length of the interval
+ * @param report     Output summary
+ */
+void power_stats_report(const power_stats_t *end, const power_stats_t *start,
+                        uint64_t elapsed_us, power_report_t *report);
+
+#endif // POWER_STATS_H
@@ -0,0 +1,107 @@
+/*
+ * Reading Filter Implementation
+ */
+
+#include "reading_filter.h"
+
+// ============== DEFAULTS ==============
+#define DEFAULT_HE_DEADBAND         1    // 0.1 %
+#define DEFAULT_O2_DEADBAND         1    // 0.1 %
+#define DEFAULT_TEMP_DEADBAND       5    // 0.5 deg F
+#define DEFAULT_PRESSURE_DEADBAND   5    // 0.05 inHg
+#define DEFAULT_HEARTBEAT_MS        2000 // Well inside the app's 5 s receiving timeout
+
+// ============== HELPERS ==============
+static bool beyond(int32_t a, int32_t b, uint16_t deadband) {
+    int32_t delta = a - b;
+    return (delta < 0 ? -delta : delta) > deadband;
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+// ============== PUBLIC API ==============
+void reading_filter_default_config(reading_filter_config_t *config) {
+    config->mode = READING_FILTER_MODE_ALL;
+    config->he_x10 = DEFAULT_HE_DEADBAND;
+    config->o2_x10 = DEFAULT_O2_DEADBAND;
+    config->temp_x10 = DEFAULT_TEMP_DEADBAND;
+    config->pressure_x100 = DEFAULT_PRESSURE_DEADBAND;
+    config->heartbeat_ms = DEFAULT_HEARTBEAT_MS;
+}
+
+void reading_filter_init(reading_filter_t *filter, const reading_filter_config_t *config) {
+    filter->config = *config;
+    filter->have_last = false;
+    filter->last_sent_ms = 0;
+    filter->suppressed = 0;
+}
+
+void reading_filter_set_config(reading_filter_t *filter, const reading_filter_config_t *config) {
+    filter->config = *config;
+    filter->have_last = false;
+}
+
+bool reading_filter_accept(reading_filter_t *filter, const gas_reading_t *reading, uint32_t now_ms) {
+    const reading_filter_config_t *cfg = &filter->config;
+    const gas_reading_t *last = &filter->last_sent;
+
+    bool send = cfg->mode != READING_FILTER_MODE_DEADBAND ||
+                !filter->have_last ||
+                reading->flags != last->flags ||
+                (uint32_t)(now_ms - filter->last_sent_ms) >= cfg->heartbeat_ms ||
+                beyond(reading->he_x10, last->he_x10, cfg->he_x10) ||
+                beyond(reading->o2_x10, last->o2_x10, cfg->o2_x10) ||
+                beyond(reading->temp_x10, last->temp_x10, cfg->temp_x10) ||
+                beyond(reading->pressure_x100, last->pressure_x100, cfg->pressure_x100);
+
+    if (!send) {
+        filter->suppressed++;
+        return false;
+    }
+    filter->last_sent = *reading;
+    filter->last_sent_ms = now_ms;
+    filter->have_last = true;
+    return true;
+}
+
+size_t reading_filter_config_encode(const reading_filter_config_t *config, uint8_t *buf) {
+    buf[0] = READING_FILTER_CONFIG_VERSION;
+    buf[1] = config->mode;
+    put_u16(&buf[2], config->he_x10);
+    put_u16(&buf[4], config->o2_x10);
+    put_u16(&buf[6], config->temp_x10);
+    put_u16(&buf[8], config->pressure_x100);
+    put_u16(&buf[10], config->heartbeat_ms);
+    return READING_FILTER_CONFIG_SIZE;
+}
+
+bool reading_filter_config_decode(const uint8_t *buf, size_t len, reading_filter_config_t *config) {
+    if (len < READING_FILTER_CONFIG_SIZE || buf[0] != READING_FILTER_CONFIG_VERSION) {
+        return false;
+    }
+
+    reading_filter_config_t decoded = {
+        .mode = buf[1],
+        .he_x10 = get_u16(&buf[2]),
+        .o2_x10 = get_u16(&buf[4]),
+        .temp_x10 = get_u16(&buf[6]),
+        .pressure_x100 = get_u16(&buf[8]),
+        .heartbeat_ms = get_u16(&buf[10]),
+    };
+    if (decoded.mode != READING_FILTER_MODE_ALL && decoded.mode != READING_FILTER_MODE_DEADBAND) {
+        return false;
+    }
+    if (decoded.heartbeat_ms < READING_FILTER_HEARTBEAT_MIN_MS) {
+        return false;
+    }
+
+    *config = decoded;
+    return true;
+}
@@ -0,0 +1,114 @@
+/*
+ * Reading Filter for GasTag Bridge
+ *
+ * Deadband ("change-only") notification filter. The Divesoft repeats nearly
+ * identical lines about once a second; in deadband mode a reading is only
+ * sent when a value moves beyond its deadband, when a stale flag changes,
+ * or when the heartbeat interval has passed since the last sent reading, so
+ * clients still see regular traffic while the analyzer is attached.
+ *
+ * The configuration is exchanged with clients on the control characteristic
+ * as a little-endian packet:
+ *
+ *   Offset  Size  Field
+ *   0       1     Config version (READING_FILTER_CONFIG_VERSION)
+ *   1       1     Mode (READING_FILTER_MODE_*)
+ *   2       2     He deadband, % x 10
+ *   4       2     O2 deadband, % x 10
+ *   6       2     Temperature deadband, deg F x 10
+ *   8       2     Pressure deadband, inHg x 100
+ *   10      2     Heartbeat interval, ms
+ */
+
+#ifndef READING_FILTER_H
+#define READING_FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "divesoft_parser.h"
+
+// ============== FILTER CONFIGURATION ==============
+#define READING_FILTER_CONFIG_VERSION  1
+#define READING_FILTER_CONFIG_SIZE     12
+
+#define READING_FILTER_MODE_ALL        0   // Send every reading
+#define READING_FILTER_MODE_DEADBAND   1   // Send on change beyond deadband or heartbeat
+
+#define READING_FILTER_HEARTBEAT_MIN_MS  500
+
+// ============== FILTER TYPES ==============
+typedef struct {
+    uint8_t mode;               // READING_FILTER_MODE_*
+    uint16_t he_x10;            // Deadbands, same units as gas_reading_t
+    uint16_t o2_x10;
+    uint16_t temp_x10;
+    uint16_t pressure_x100;
+    uint16_t heartbeat_ms;      // Max time between sent readings
+} reading_filter_config_t;
+
+typedef struct {
+    reading_filter_config_t config;
+    gas_reading_t last_sent;
+    uint32_t last_sent_ms;
+    bool have_last;             // false until the first reading is sent
+    uint32_t suppressed;        // Readings held back since init
+} reading_filter_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Fill in the default configuration (send every reading, deadbands preset
+ * for when deadband mode is switched on).
+ *
+ * @param config Config to fill
+ */
+void reading_filter_default_config(reading_filter_config_t *config);
+
+/**
+ * Initialize a filter with a configuration.
+ *
+ * @param filter Filter to initialize
+ * @param config Configuration to apply
+ */
+void reading_filter_init(reading_filter_t *filter, const reading_filter_config_t *config);
+
+/**
+ * Replace the configuration. The next reading is always sent.
+ *
+ * @param filter Filter to update
+ * @param config New configuration
+ */
+void reading_filter_set_config(reading_filter_t *filter, const reading_filter_config_t *config);
+
+/**
+ * Decide whether a reading should be sent, and remember it if so.
+ *
+ * @param filter  Filter state
+ * @param reading Newly parsed reading
+ * @param now_ms  Current time in milliseconds (wrapping is fine)
+ * @return true if the reading should be notified
+ */
+bool reading_filter_accept(reading_filter_t *filter, const gas_reading_t *reading, uint32_t now_ms);
+
+/**
+ * Encode a configuration for the control characteristic.
+ *
+ * @param config Configuration
+ * @param buf    Output buffer, at least READING_FILTER_CONFIG_SIZE bytes
+ * @return Number of bytes written (READING_FILTER_CONFIG_SIZE)
+ */
+size_t reading_filter_config_encode(const reading_filter_config_t *config, uint8_t *buf);
+
+/**
+ * Decode and validate a configuration written by a client.
+ *
+ * @param buf    Packet bytes
+ * @param len    Packet length
+ * @param config Decoded configuration, only written on success
+ * @return true if the packet is a valid configuration
+ */
+bool reading_filter_config_decode(const uint8_t *buf, size_t len, reading_filter_config_t *config);
+
+#endif // READING_FILTER_H
@@ -0,0 +1,78 @@
+/*
+ * Binary Reading Format Implementation
+ */
+
+#include "reading_format.h"
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// Everything after the version byte; shared by single and batched formats
+static void encode_body(const gas_reading_t *reading, uint8_t *p) {
+    p[0] = reading->flags;
+    put_u16(&p[1], reading->he_x10);
+    put_u16(&p[3], reading->o2_x10);
+    put_u16(&p[5], (uint16_t)reading->temp_x10);
+    put_u16(&p[7], reading->pressure_x100);
+    put_u32(&p[9], reading->timestamp);
+}
+
+size_t reading_format_encode(const gas_reading_t *reading, uint8_t *buf) {
+    buf[0] = READING_FORMAT_VERSION;
+    encode_body(reading, &buf[1]);
+    return READING_FORMAT_SIZE;
+}
+
+static void batch_init(reading_batch_t *batch, size_t limit, uint8_t version, size_t record_size) {
+    batch->limit = limit < READING_BATCH_MAX_SIZE ? limit : READING_BATCH_MAX_SIZE;
+    batch->record_size = record_size;
+    batch->buf[0] = version;
+    batch->buf[1] = 0;
+    batch->len = READING_BATCH_HEADER_SIZE;
+}
+
+void reading_batch_init(reading_batch_t *batch, size_t limit) {
+    batch_init(batch, limit, READING_BATCH_VERSION, READING_BATCH_RECORD_SIZE);
+}
+
+void reading_history_batch_init(reading_batch_t *batch, size_t limit) {
+    batch_init(batch, limit, READING_HISTORY_VERSION, READING_HISTORY_RECORD_SIZE);
+}
+
+bool reading_batch_add(reading_batch_t *batch, uint32_t seq, const gas_reading_t *reading) {
+    if (batch->len + batch->record_size > batch->limit) {
+        return false;
+    }
+    uint8_t *p = &batch->buf[batch->len];
+    if (batch->record_size == READING_HISTORY_RECORD_SIZE) {
+        put_u32(p, seq);
+        p += 4;
+    } else {
+        put_u16(p, (uint16_t)seq);
+        p += 2;
+    }
+    encode_body(reading, p);
+    batch->len += batch->record_size;
+    batch->buf[1]++;
+    return true;
+}
+
+uint8_t reading_batch_count(const reading_batch_t *batch) {
+    return batch->buf[1];
+}
+
+size_t reading_history_encode_end(uint32_t next_seq, uint8_t *buf) {
+    buf[0] = READING_HISTORY_VERSION;
+    buf[1] = 0;
+    put_u32(&buf[2], next_seq);
+    return READING_HISTORY_END_SIZE;
+}
@@ -0,0 +1,121 @@
+/*
+ * Binary Reading Format for GasTag Bridge
+ *
+ * Compact encoding of a parsed analyzer reading, sent on the binary reading
+ * characteristic alongside the original text line. All multi-byte fields
+ * are little-endian.
+ *
+ *   Offset  Size  Field
+ *   0       1     Format version (READING_FORMAT_VERSION)
+ *   1       1     Flags (GAS_READING_FLAG_*; bits 4-5 are the channel)
+ *   2       2     He, % x 10
+ *   4       2     O2, % x 10
+ *   6       2     Temperature, deg F x 10 (signed)
+ *   8       2     Pressure, inHg x 100
+ *   10      4     Analyzer timestamp (see GAS_TIMESTAMP_PACK)
+ *
+ * Batched notifications (READING_BATCH_VERSION) pack several readings into
+ * one packet sized to the negotiated ATT MTU:
+ *
+ *   Offset  Size  Field
+ *   0       1     Format version (READING_BATCH_VERSION)
+ *   1       1     Record count
+ *   2       15*n  Records, each:
+ *                   0   2  Sequence number (increments per reading, wraps)
+ *                   2   13 Bytes 1..13 of the single-reading format above
+ *
+ * History backfill packets (READING_HISTORY_VERSION) use the same layout with
+ * 4-byte sequence numbers (17-byte records). A history packet with a record
+ * count of 0 ends a backfill; it carries the sequence number the next live
+ * reading will get as a 4-byte value at offset 2.
+ *
+ * Clients must check the version byte and ignore formats they don't know.
+ */
+
+#ifndef READING_FORMAT_H
+#define READING_FORMAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "divesoft_parser.h"
+
+// ============== FORMAT CONSTANTS ==============
+#define READING_FORMAT_VERSION  1
+#define READING_FORMAT_SIZE     14
+
+#define READING_BATCH_VERSION       2
+#define READING_BATCH_HEADER_SIZE   2
+#define READING_BATCH_RECORD_SIZE   (2 + READING_FORMAT_SIZE - 1)
+#define READING_BATCH_MAX_RECORDS   16   // 242 bytes, fits the 256 byte local MTU
+#define READING_BATCH_MAX_SIZE      (READING_BATCH_HEADER_SIZE + \
+                                     READING_BATCH_MAX_RECORDS * READING_BATCH_RECORD_SIZE)
+
+#define READING_HISTORY_VERSION     3
+#define READING_HISTORY_RECORD_SIZE (4 + READING_FORMAT_SIZE - 1)
+#define READING_HISTORY_END_SIZE    (READING_BATCH_HEADER_SIZE + 4)
+
+// ============== BATCH TYPES ==============
+typedef struct {
+    uint8_t buf[READING_BATCH_MAX_SIZE];
+    size_t len;                // Bytes used, including header
+    size_t limit;              // Max packet size for the current link
+    size_t record_size;        // READING_BATCH_RECORD_SIZE or READING_HISTORY_RECORD_SIZE
+} reading_batch_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Encode a reading into its binary wire format.
+ *
+ * @param reading Parsed reading
+ * @param buf     Output buffer, at least READING_FORMAT_SIZE bytes
+ * @return Number of bytes written (READING_FORMAT_SIZE)
+ */
+size_t reading_format_encode(const gas_reading_t *reading, uint8_t *buf);
+
+/**
+ * Start an empty batch.
+ *
+ * @param batch Batch to reset
+ * @param limit Max packet size (ATT MTU - 3); clamped to READING_BATCH_MAX_SIZE
+ */
+void reading_batch_init(reading_batch_t *batch, size_t limit);
+
+/**
+ * Start an empty history backfill packet.
+ *
+ * @param batch Batch to reset
+ * @param limit Max packet size (ATT MTU - 3); clamped to READING_BATCH_MAX_SIZE
+ */
+void reading_history_batch_init(reading_batch_t *batch, size_t limit);
+
+/**
+ * Append a reading to a batch.
+ *
+ * @param batch   Batch to append to
+ * @param seq     Sequence number of the reading (low 16 bits in live batches)
+ * @param reading Parsed reading
+ * @return true if added, false if the batch has no room left
+ */
+bool reading_batch_add(reading_batch_t *batch, uint32_t seq, const gas_reading_t *reading);
+
+/**
+ * Number of readings in a batch.
+ *
+ * @param batch Batch to inspect
+ * @return Record count (0 if empty)
+ */
+uint8_t reading_batch_count(const reading_batch_t *batch);
+
+/**
+ * Encode the packet that ends a history backfill.
+ *
+ * @param next_seq Sequence number the next live reading will get
+ * @param buf      Output buffer, at least READING_HISTORY_END_SIZE bytes
+ * @return Number of bytes written (READING_HISTORY_END_SIZE)
+ */
+size_t reading_history_encode_end(uint32_t next_seq, uint8_t *buf);
+
+#endif // READING_FORMAT_H
@@ -0,0 +1,41 @@
+/*
+ * Reading History Implementation
+ */
+
+#include "reading_history.h"
+
+#include <stddef.h>
+
+void reading_history_init(reading_history_t *history, gas_reading_t *storage, uint32_t capacity) {
+    history->entries = storage;
+    history->capacity = storage != NULL ? capacity : 0;
+    history->count = 0;
+    history->next_seq = 1;
+}
+
+uint32_t reading_history_append(reading_history_t *history, const gas_reading_t *reading) {
+    uint32_t seq = history->next_seq++;
+
+    if (history->capacity > 0) {
+        history->entries[seq % history->capacity] = *reading;
+        if (history->count < history->capacity) {
+            history->count++;
+        }
+    }
+    return seq;
+}
+
+uint32_t reading_history_oldest_seq(const reading_history_t *history) {
+    return history->next_seq - history->count;
+}
+
+bool reading_history_get(const reading_history_t *history, uint32_t seq, gas_reading_t *out) {
+    // Unsigned distance back from the newest; anything outside the window
+    // (older than the ring, or not yet written) lands >= count
+    uint32_t age = history->next_seq - 1 - seq;
+    if (age >= history->count) {
+        return false;
+    }
+    *out = history->entries[seq % history->capacity];
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * Reading History for GasTag Bridge
+ *
+ * Ring of every reading the bridge has parsed, kept whether or not a client
+ * is connected or the deadband filter sent it live, so the app can backfill
+ * what it missed.
+ *
+ * Every appended reading gets the next 32-bit sequence number (starting at
+ * 1). Since numbers are consecutive, the slot of a reading is derived from
+ * its sequence number and only the readings themselves are stored. When the
+ * ring is full the oldest reading is overwritten.
+ *
+ * Storage is supplied by the caller (PSRAM on the bridge); the ring is only
+ * touched from one task and has no locking.
+ */
+
+#ifndef READING_HISTORY_H
+#define READING_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "divesoft_parser.h"
+
+// ============== HISTORY TYPES ==============
+typedef struct {
+    gas_reading_t *entries;     // Caller-owned storage
+    uint32_t capacity;          // Number of entries (0 = keep nothing, still count)
+    uint32_t count;             // Readings currently held
+    uint32_t next_seq;          // Sequence number of the next reading
+} reading_history_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Initialize an empty history.
+ *
+ * @param history  History to initialize
+ * @param storage  Array of capacity readings, or NULL
+ * @param capacity Number of readings storage holds
+ */
+void reading_history_init(reading_history_t *history, gas_reading_t *storage, uint32_t capacity);
+
+/**
+ * Append a reading, overwriting the oldest one when full.
+ *
+ * @param history History to append to
+ * @param reading Reading to store
+ * @return Sequence number assigned to the reading
+ */
+uint32_t reading_history_append(reading_history_t *history, const gas_reading_t *reading);
+
+/**
+ * Sequence number of the oldest reading still held.
+ * Equals next_seq when the history is empty.
+ *
+ * @param history History to inspect
+ * @return Oldest sequence number
+ */
+uint32_t reading_history_oldest_seq(const reading_history_t *history);
+
+/**
+ * Look up a reading by sequence number.
+ *
+ * @param history History to read
+ * @param seq     Sequence number
+ * @param out     Reading, only written on success
+ * @return true if the reading is still held
+ */
+bool reading_history_get(const reading_history_t *history, uint32_t seq, gas_reading_t *out);
+
+#endif // READING_HISTORY_H
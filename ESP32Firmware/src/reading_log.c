@@ -0,0 +1,405 @@
+/*
+ * Reading Log Implementation
+ *
+ * Blocks are addressed physically (0..block_count-1) and logically
+ * (0..used_blocks-1, oldest first). The used blocks are always a contiguous
+ * run of the ring ending at head, so logical block k is physical block
+ * (oldest + k) % block_count and binary searches run over k.
+ */
+
+#include "reading_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// ============== ON-FLASH FORMAT ==============
+#define LOG_MAGIC           0x474C5447u  // "GTLG"
+#define HEADER_CRC_OFFSET   (READING_LOG_HEADER_SIZE - 2)
+#define RECORD_MARKER       0x5A
+#define RECORD_CRC_OFFSET   (READING_LOG_RECORD_SIZE - 2)
+#define ERASED_BYTE         0xFF
+
+// ============== ENCODING HELPERS ==============
+static uint16_t crc16(const uint8_t *data, size_t len) {
+    // CRC-16/CCITT-FALSE
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static void encode_record(const gas_reading_t *r, uint8_t *p) {
+    p[0] = RECORD_MARKER;
+    p[1] = r->flags;
+    put_u16(&p[2], r->he_x10);
+    put_u16(&p[4], r->o2_x10);
+    put_u16(&p[6], (uint16_t)r->temp_x10);
+    put_u16(&p[8], r->pressure_x100);
+    put_u32(&p[10], r->timestamp);
+    put_u16(&p[RECORD_CRC_OFFSET], crc16(p, RECORD_CRC_OFFSET));
+}
+
+static bool decode_record(const uint8_t *p, gas_reading_t *r) {
+    if (p[0] != RECORD_MARKER || get_u16(&p[RECORD_CRC_OFFSET]) != crc16(p, RECORD_CRC_OFFSET)) {
+        return false;
+    }
+    r->flags = p[1];
+    r->he_x10 = get_u16(&p[2]);
+    r->o2_x10 = get_u16(&p[4]);
+    r->temp_x10 = (int16_t)get_u16(&p[6]);
+    r->pressure_x100 = get_u16(&p[8]);
+    r->timestamp = get_u32(&p[10]);
+    return true;
+}
+
+static bool record_is_erased(const uint8_t *p) {
+    for (int i = 0; i < READING_LOG_RECORD_SIZE; i++) {
+        if (p[i] != ERASED_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============== BLOCK HELPERS ==============
+static size_t block_offset(uint32_t block) {
+    return (size_t)block * READING_LOG_BLOCK_SIZE;
+}
+
+static size_t record_offset(uint32_t block, uint32_t slot) {
+    return block_offset(block) + READING_LOG_HEADER_SIZE + (size_t)slot * READING_LOG_RECORD_SIZE;
+}
+
+static uint32_t oldest_block(const reading_log_t *log) {
+    return (log->head + log->block_count + 1 - log->used_blocks) % log->block_count;
+}
+
+static uint32_t logical_to_block(const reading_log_t *log, uint32_t k) {
+    return (oldest_block(log) + k) % log->block_count;
+}
+
+static uint32_t block_fill(const reading_log_t *log, uint32_t block) {
+    return block == log->head ? log->head_fill : READING_LOG_RECORDS_PER_BLOCK;
+}
+
+static esp_err_t erase_block(reading_log_t *log, uint32_t block) {
+    // Erasing the oldest used block drops it from the log
+    if (log->used_blocks > 0 && block == oldest_block(log)) {
+        log->used_blocks--;
+    }
+    log->blocks[block].generation = 0;
+    log->stats.erases++;
+    return log->flash.erase_block(log->flash.ctx, block_offset(block));
+}
+
+static esp_err_t open_block(reading_log_t *log, uint32_t first_timestamp) {
+    uint32_t block = (log->head + 1) % log->block_count;
+    esp_err_t err;
+
+    if (!log->ahead_erased) {
+        log->stats.inline_erases++;
+        err = erase_block(log, block);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    uint8_t header[READING_LOG_HEADER_SIZE];
+    memset(header, ERASED_BYTE, sizeof(header));
+    put_u32(&header[0], LOG_MAGIC);
+    put_u32(&header[4], log->next_generation);
+    put_u32(&header[8], log->next_seq);
+    put_u32(&header[12], first_timestamp);
+    put_u16(&header[HEADER_CRC_OFFSET], crc16(header, HEADER_CRC_OFFSET));
+
+    err = log->flash.write(log->flash.ctx, block_offset(block), header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    log->blocks[block] = (reading_log_block_t) {
+        .generation = log->next_generation,
+        .first_seq = log->next_seq,
+        .first_timestamp = first_timestamp,
+    };
+    log->next_generation++;
+    log->head = block;
+    log->head_fill = 0;
+    log->used_blocks++;
+    log->ahead_erased = false;
+    return ESP_OK;
+}
+
+// Largest logical block k whose key is <= value, or -1 if all keys are greater
+static int32_t search_blocks(const reading_log_t *log, uint32_t value, bool by_time) {
+    int32_t lo = 0;
+    int32_t hi = (int32_t)log->used_blocks - 1;
+    int32_t found = -1;
+
+    while (lo <= hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        const reading_log_block_t *b = &log->blocks[logical_to_block(log, (uint32_t)mid)];
+        uint32_t key = by_time ? b->first_timestamp : b->first_seq;
+        if (key <= value) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
+// ============== MOUNT ==============
+static esp_err_t find_head_fill(reading_log_t *log) {
+    uint8_t chunk[READING_LOG_WRITE_RECORDS * READING_LOG_RECORD_SIZE];
+
+    for (uint32_t slot = 0; slot < READING_LOG_RECORDS_PER_BLOCK; slot += READING_LOG_WRITE_RECORDS) {
+        uint32_t n = READING_LOG_RECORDS_PER_BLOCK - slot;
+        if (n > READING_LOG_WRITE_RECORDS) {
+            n = READING_LOG_WRITE_RECORDS;
+        }
+        esp_err_t err = log->flash.read(log->flash.ctx, record_offset(log->head, slot),
+                                        chunk, n * READING_LOG_RECORD_SIZE);
+        if (err != ESP_OK) {
+            return err;
+        }
+        // A slot is free only if fully erased; a torn write keeps its slot
+        for (uint32_t i = 0; i < n; i++) {
+            if (record_is_erased(&chunk[i * READING_LOG_RECORD_SIZE])) {
+                log->head_fill = slot + i;
+                return ESP_OK;
+            }
+        }
+    }
+    log->head_fill = READING_LOG_RECORDS_PER_BLOCK;
+    return ESP_OK;
+}
+
+esp_err_t reading_log_mount(reading_log_t *log, const reading_log_flash_t *flash) {
+    memset(log, 0, sizeof(*log));
+    log->flash = *flash;
+    log->block_count = (uint32_t)(flash->size / READING_LOG_BLOCK_SIZE);
+    if (log->block_count < READING_LOG_MIN_BLOCKS) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    log->blocks = calloc(log->block_count, sizeof(reading_log_block_t));
+    if (log->blocks == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Index every block header and find the newest block
+    uint32_t newest = 0;
+    bool any = false;
+    for (uint32_t b = 0; b < log->block_count; b++) {
+        uint8_t header[READING_LOG_HEADER_SIZE];
+        esp_err_t err = flash->read(flash->ctx, block_offset(b), header, sizeof(header));
+        if (err != ESP_OK) {
+            reading_log_unmount(log);
+            return err;
+        }
+        if (get_u32(&header[0]) != LOG_MAGIC ||
+            get_u16(&header[HEADER_CRC_OFFSET]) != crc16(header, HEADER_CRC_OFFSET)) {
+            continue;
+        }
+        log->blocks[b] = (reading_log_block_t) {
+            .generation = get_u32(&header[4]),
+            .first_seq = get_u32(&header[8]),
+            .first_timestamp = get_u32(&header[12]),
+        };
+        if (!any || log->blocks[b].generation > log->blocks[newest].generation) {
+            newest = b;
+            any = true;
+        }
+    }
+
+    if (!any) {
+        // Empty log: the first append opens block 0
+        log->head = log->block_count - 1;
+        log->head_fill = READING_LOG_RECORDS_PER_BLOCK;
+        log->next_seq = 1;
+        log->next_generation = 1;
+        return ESP_OK;
+    }
+
+    // Count back the contiguous run of generations ending at the newest block
+    log->head = newest;
+    uint32_t generation = log->blocks[newest].generation;
+    log->used_blocks = 1;
+    while (log->used_blocks < log->block_count) {
+        uint32_t prev = (newest + log->block_count - log->used_blocks) % log->block_count;
+        uint32_t expected = generation - log->used_blocks;
+        if (expected == 0 || log->blocks[prev].generation != expected) {
+            break;
+        }
+        log->used_blocks++;
+    }
+
+    esp_err_t err = find_head_fill(log);
+    if (err != ESP_OK) {
+        reading_log_unmount(log);
+        return err;
+    }
+    log->next_seq = log->blocks[newest].first_seq + log->head_fill;
+    log->next_generation = generation + 1;
+    return ESP_OK;
+}
+
+void reading_log_unmount(reading_log_t *log) {
+    free(log->blocks);
+    log->blocks = NULL;
+}
+
+// ============== APPEND ==============
+esp_err_t reading_log_append(reading_log_t *log, const gas_reading_t *readings, size_t count) {
+    uint8_t chunk[READING_LOG_WRITE_RECORDS * READING_LOG_RECORD_SIZE];
+
+    while (count > 0) {
+        if (log->head_fill == READING_LOG_RECORDS_PER_BLOCK) {
+            esp_err_t err = open_block(log, readings[0].timestamp);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+
+        // Records that fit in the head block and in one write
+        uint32_t n = READING_LOG_RECORDS_PER_BLOCK - log->head_fill;
+        if (n > count) {
+            n = (uint32_t)count;
+        }
+        if (n > READING_LOG_WRITE_RECORDS) {
+            n = READING_LOG_WRITE_RECORDS;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            encode_record(&readings[i], &chunk[i * READING_LOG_RECORD_SIZE]);
+        }
+
+        esp_err_t err = log->flash.write(log->flash.ctx, record_offset(log->head, log->head_fill),
+                                         chunk, n * READING_LOG_RECORD_SIZE);
+        if (err != ESP_OK) {
+            return err;
+        }
+        log->head_fill += n;
+        log->next_seq += n;
+        log->stats.appended += n;
+        log->stats.write_calls++;
+        readings += n;
+        count -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t reading_log_prepare(reading_log_t *log) {
+    if (log->ahead_erased) {
+        return ESP_OK;
+    }
+    esp_err_t err = erase_block(log, (log->head + 1) % log->block_count);
+    if (err == ESP_OK) {
+        log->ahead_erased = true;
+    }
+    return err;
+}
+
+// ============== QUERIES ==============
+uint32_t reading_log_oldest_seq(const reading_log_t *log) {
+    if (log->used_blocks == 0) {
+        return log->next_seq;
+    }
+    return log->blocks[oldest_block(log)].first_seq;
+}
+
+esp_err_t reading_log_read(reading_log_t *log, uint32_t seq, gas_reading_t *out) {
+    if ((int32_t)(seq - reading_log_oldest_seq(log)) < 0 || (int32_t)(seq - log->next_seq) >= 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int32_t k = search_blocks(log, seq, false);
+    if (k < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    uint32_t block = logical_to_block(log, (uint32_t)k);
+    uint32_t slot = seq - log->blocks[block].first_seq;
+    if (slot >= block_fill(log, block)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t record[READING_LOG_RECORD_SIZE];
+    esp_err_t err = log->flash.read(log->flash.ctx, record_offset(block, slot), record, sizeof(record));
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (!decode_record(record, out)) {
+        log->stats.corrupt_records++;
+        return ESP_ERR_INVALID_CRC;
+    }
+    return ESP_OK;
+}
+
+esp_err_t reading_log_find_time(reading_log_t *log, uint32_t timestamp, uint32_t *seq) {
+    if (log->used_blocks == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Earlier than the whole log: the oldest record is the answer
+    int32_t k = search_blocks(log, timestamp, true);
+    if (k < 0) {
+        *seq = reading_log_oldest_seq(log);
+        return ESP_OK;
+    }
+
+    // Scan only the chosen block for the first record at or after timestamp
+    uint32_t block = logical_to_block(log, (uint32_t)k);
+    uint32_t fill = block_fill(log, block);
+    uint8_t chunk[READING_LOG_WRITE_RECORDS * READING_LOG_RECORD_SIZE];
+
+    for (uint32_t slot = 0; slot < fill; slot += READING_LOG_WRITE_RECORDS) {
+        uint32_t n = fill - slot;
+        if (n > READING_LOG_WRITE_RECORDS) {
+            n = READING_LOG_WRITE_RECORDS;
+        }
+        esp_err_t err = log->flash.read(log->flash.ctx, record_offset(block, slot),
+                                        chunk, n * READING_LOG_RECORD_SIZE);
+        if (err != ESP_OK) {
+            return err;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            // Compare the raw timestamp first; only a candidate pays for the CRC
+            const uint8_t *record = &chunk[i * READING_LOG_RECORD_SIZE];
+            gas_reading_t r;
+            if (get_u32(&record[10]) >= timestamp && decode_record(record, &r)) {
+                *seq = log->blocks[block].first_seq + slot + i;
+                return ESP_OK;
+            }
+        }
+    }
+
+    // Everything in this block is earlier; the next block starts the range
+    if ((uint32_t)k + 1 < log->used_blocks) {
+        *seq = log->blocks[logical_to_block(log, (uint32_t)k + 1)].first_seq;
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
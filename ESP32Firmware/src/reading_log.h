@@ -0,0 +1,156 @@
+/*
+ * Reading Log for GasTag Bridge
+ *
+ * Append-only log of readings in a dedicated flash partition, so readings
+ * survive power loss. The partition is a ring of erase blocks (one flash
+ * sector each) written strictly in order and erased one block ahead of the
+ * writer; every block is erased once per trip around the ring, which spreads
+ * wear evenly without a separate wear-levelling layer.
+ *
+ * Block layout:
+ *
+ *   Offset  Size  Field
+ *   0       32    Header: magic, generation, first sequence number,
+ *                 first analyzer timestamp, CRC
+ *   32      16*n  Records: valid marker, reading body (bytes 1..13 of the
+ *                 binary reading format), CRC
+ *
+ * Sequence numbers are persistent and consecutive, so a record's number is
+ * implied by its block header and slot. At mount only block headers are
+ * read; they form a sparse index in RAM that lets lookups by sequence number
+ * or by time go straight to one block.
+ *
+ * Flash access goes through reading_log_flash_t so the log can run on a
+ * partition on the bridge and on a RAM image in host tests. The log itself
+ * does no locking; the bridge drives it from a single writer task.
+ */
+
+#ifndef READING_LOG_H
+#define READING_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "divesoft_parser.h"
+
+// ============== LOG LAYOUT ==============
+#define READING_LOG_BLOCK_SIZE         4096  // One flash sector
+#define READING_LOG_HEADER_SIZE        32
+#define READING_LOG_RECORD_SIZE        16
+#define READING_LOG_RECORDS_PER_BLOCK  ((READING_LOG_BLOCK_SIZE - READING_LOG_HEADER_SIZE) / \
+                                        READING_LOG_RECORD_SIZE)
+#define READING_LOG_MIN_BLOCKS         3     // Head, one erased ahead, one of history
+#define READING_LOG_WRITE_RECORDS      32    // Max records per flash write (512 bytes of stack)
+
+// ============== FLASH ACCESS ==============
+typedef struct {
+    esp_err_t (*read)(void *ctx, size_t offset, void *dst, size_t len);
+    esp_err_t (*write)(void *ctx, size_t offset, const void *src, size_t len);
+    esp_err_t (*erase_block)(void *ctx, size_t offset);  // Erases READING_LOG_BLOCK_SIZE bytes
+    size_t size;                                         // Bytes available
+    void *ctx;
+} reading_log_flash_t;
+
+// ============== LOG TYPES ==============
+typedef struct {
+    uint32_t generation;        // 0 = block is erased
+    uint32_t first_seq;
+    uint32_t first_timestamp;   // Analyzer timestamp of the first record
+} reading_log_block_t;
+
+typedef struct {
+    uint32_t appended;          // Records written since mount
+    uint32_t write_calls;       // Flash write calls for records
+    uint32_t erases;            // Blocks erased since mount
+    uint32_t inline_erases;     // Erases done while appending (not ahead of time)
+    uint32_t corrupt_records;   // Records with a bad CRC seen while reading
+} reading_log_stats_t;
+
+typedef struct {
+    reading_log_flash_t flash;
+    reading_log_block_t *blocks;  // Sparse index, one entry per block
+    uint32_t block_count;
+    uint32_t head;              // Block being filled
+    uint32_t head_fill;         // Records in the head block
+    uint32_t used_blocks;       // Blocks holding records, ending at head
+    uint32_t next_seq;          // Sequence number of the next record
+    uint32_t next_generation;
+    bool ahead_erased;          // Block after head is erased and ready
+    reading_log_stats_t stats;
+} reading_log_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Mount the log, reading only block headers to rebuild the index and find
+ * the append position. An unformatted partition mounts as an empty log.
+ *
+ * @param log   Log state
+ * @param flash Flash access; size must hold at least READING_LOG_MIN_BLOCKS blocks
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE, ESP_ERR_NO_MEM or a flash error
+ */
+esp_err_t reading_log_mount(reading_log_t *log, const reading_log_flash_t *flash);
+
+/**
+ * Release the index allocated by reading_log_mount().
+ *
+ * @param log Log state
+ */
+void reading_log_unmount(reading_log_t *log);
+
+/**
+ * Append readings, writing runs of consecutive records with one flash
+ * write each (up to READING_LOG_WRITE_RECORDS per write). Starting a new
+ * block erases the oldest block if it was not erased ahead of time by
+ * reading_log_prepare().
+ *
+ * @param log      Log state
+ * @param readings Readings to append, oldest first
+ * @param count    Number of readings
+ * @return ESP_OK or a flash error
+ */
+esp_err_t reading_log_append(reading_log_t *log, const gas_reading_t *readings, size_t count);
+
+/**
+ * Erase the block after the head so the next block switch needs no erase.
+ * Call while idle; does nothing if that block is already erased.
+ *
+ * @param log Log state
+ * @return ESP_OK or a flash error
+ */
+esp_err_t reading_log_prepare(reading_log_t *log);
+
+/**
+ * Sequence number of the oldest record still in the log.
+ * Equals next_seq when the log is empty.
+ *
+ * @param log Log state
+ * @return Oldest sequence number
+ */
+uint32_t reading_log_oldest_seq(const reading_log_t *log);
+
+/**
+ * Read a record by sequence number.
+ *
+ * @param log Log state
+ * @param seq Sequence number
+ * @param out Reading, only written on success
+ * @return ESP_OK, ESP_ERR_NOT_FOUND (not in the log), ESP_ERR_INVALID_CRC or a flash error
+ */
+esp_err_t reading_log_read(reading_log_t *log, uint32_t seq, gas_reading_t *out);
+
+/**
+ * Find the first record at or after an analyzer timestamp. Uses the block
+ * index to pick one block, then reads only that block's records.
+ * Assumes the analyzer clock only moves forward.
+ *
+ * @param log       Log state
+ * @param timestamp Packed analyzer timestamp (GAS_TIMESTAMP_PACK)
+ * @param seq       Sequence number found
+ * @return ESP_OK, ESP_ERR_NOT_FOUND (no record that late) or a flash error
+ */
+esp_err_t reading_log_find_time(reading_log_t *log, uint32_t timestamp, uint32_t *seq);
+
+#endif // READING_LOG_H
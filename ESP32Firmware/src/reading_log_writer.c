@@ -0,0 +1,194 @@
+/*
+ * Reading Log Writer Implementation
+ *
+ * The writer task owns the reading_log_t; other tasks only touch the queue
+ * and the stats snapshot.
+ */
+
+#include "reading_log_writer.h"
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+
+#include "reading_log.h"
+
+static const char *TAG = "READLOG";
+
+// ============== STATE ==============
+static const esp_partition_t *log_partition = NULL;
+static reading_log_t reading_log;                  // Owned by the writer task
+static QueueHandle_t reading_queue = NULL;
+static reading_log_writer_stats_t writer_stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ============== PARTITION ACCESS ==============
+static esp_err_t partition_read(void *ctx, size_t offset, void *dst, size_t len) {
+    return esp_partition_read((const esp_partition_t *)ctx, offset, dst, len);
+}
+
+static esp_err_t partition_write(void *ctx, size_t offset, const void *src, size_t len) {
+    return esp_partition_write((const esp_partition_t *)ctx, offset, src, len);
+}
+
+static esp_err_t partition_erase_block(void *ctx, size_t offset) {
+    return esp_partition_erase_range((const esp_partition_t *)ctx, offset, READING_LOG_BLOCK_SIZE);
+}
+
+// ============== WRITER TASK ==============
+static void flush_batch(const gas_reading_t *batch, size_t count) {
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = reading_log_append(&reading_log, batch, count);
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Append of %u readings failed: %s", (unsigned)count, esp_err_to_name(err));
+    }
+
+    taskENTER_CRITICAL(&stats_lock);
+    writer_stats.batches++;
+    if (err != ESP_OK) {
+        writer_stats.write_errors++;
+    }
+    writer_stats.last_write_us = elapsed;
+    if (elapsed > writer_stats.max_write_us) {
+        writer_stats.max_write_us = elapsed;
+    }
+    writer_stats.oldest_seq = reading_log_oldest_seq(&reading_log);
+    writer_stats.next_seq = reading_log.next_seq;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+static void log_writer_stats(uint32_t *last_appended, TickType_t *last_log) {
+    TickType_t now = xTaskGetTickCount();
+    if (now - *last_log < pdMS_TO_TICKS(READING_LOG_STATS_INTERVAL_MS)) {
+        return;
+    }
+
+    reading_log_writer_stats_t stats;
+    reading_log_writer_get_stats(&stats);
+    uint32_t appended = reading_log.stats.appended;
+    float seconds = (float)(now - *last_log) / configTICK_RATE_HZ;
+
+    ESP_LOGI(TAG, "%.2f readings/s, %lu batches, last write %lu us (max %lu us), "
+             "%lu erases (%lu inline), %lu dropped, seq %lu..%lu",
+             (appended - *last_appended) / seconds, stats.batches,
+             stats.last_write_us, stats.max_write_us,
+             reading_log.stats.erases, reading_log.stats.inline_erases,
+             stats.dropped, stats.oldest_seq, stats.next_seq);
+
+    *last_appended = appended;
+    *last_log = now;
+}
+
+static void reading_log_task(void *arg) {
+    gas_reading_t batch[READING_LOG_BATCH_RECORDS];
+    size_t count = 0;
+    TickType_t flush_at = 0;
+    uint32_t last_appended = 0;
+    TickType_t last_log = xTaskGetTickCount();
+
+    while (1) {
+        // With readings pending, wait no longer than their flush deadline;
+        // otherwise wait for the next reading (after erasing ahead if needed)
+        TickType_t wait = portMAX_DELAY;
+        if (count > 0) {
+            TickType_t now = xTaskGetTickCount();
+            wait = (int32_t)(flush_at - now) > 0 ? flush_at - now : 0;
+        } else if (!reading_log.ahead_erased) {
+            esp_err_t err = reading_log_prepare(&reading_log);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Erase ahead failed: %s", esp_err_to_name(err));
+            }
+        }
+
+        if (xQueueReceive(reading_queue, &batch[count], wait) == pdTRUE) {
+            if (count == 0) {
+                flush_at = xTaskGetTickCount() + pdMS_TO_TICKS(READING_LOG_FLUSH_MS);
+            }
+            count++;
+        }
+
+        if (count == READING_LOG_BATCH_RECORDS ||
+            (count > 0 && (int32_t)(xTaskGetTickCount() - flush_at) >= 0)) {
+            flush_batch(batch, count);
+            count = 0;
+        }
+
+        log_writer_stats(&last_appended, &last_log);
+    }
+}
+
+// ============== PUBLIC API ==============
+esp_err_t reading_log_writer_start(void) {
+    log_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                             READING_LOG_PARTITION_SUBTYPE,
+                                             READING_LOG_PARTITION_LABEL);
+    if (log_partition == NULL) {
+        ESP_LOGW(TAG, "No '%s' partition, reading log disabled", READING_LOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    reading_log_flash_t flash = {
+        .read = partition_read,
+        .write = partition_write,
+        .erase_block = partition_erase_block,
+        .size = log_partition->size,
+        .ctx = (void *)log_partition,
+    };
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = reading_log_mount(&reading_log, &flash);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Mount failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "Mounted %lu blocks in %lld ms: %lu blocks used, seq %lu..%lu",
+             reading_log.block_count, (esp_timer_get_time() - start) / 1000,
+             reading_log.used_blocks, reading_log_oldest_seq(&reading_log), reading_log.next_seq);
+
+    writer_stats.oldest_seq = reading_log_oldest_seq(&reading_log);
+    writer_stats.next_seq = reading_log.next_seq;
+
+    reading_queue = xQueueCreate(READING_LOG_QUEUE_DEPTH, sizeof(gas_reading_t));
+    if (reading_queue == NULL) {
+        reading_log_unmount(&reading_log);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreatePinnedToCore(reading_log_task, "reading_log", READING_LOG_TASK_STACK, NULL,
+                                READING_LOG_TASK_PRIORITY, NULL, READING_LOG_TASK_CORE) != pdPASS) {
+        vQueueDelete(reading_queue);
+        reading_queue = NULL;
+        reading_log_unmount(&reading_log);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+bool reading_log_writer_submit(const gas_reading_t *reading) {
+    if (reading_queue == NULL) {
+        return false;
+    }
+
+    bool queued = xQueueSend(reading_queue, reading, 0) == pdTRUE;
+
+    taskENTER_CRITICAL(&stats_lock);
+    if (queued) {
+        writer_stats.submitted++;
+    } else {
+        writer_stats.dropped++;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+    return queued;
+}
+
+void reading_log_writer_get_stats(reading_log_writer_stats_t *stats) {
+    taskENTER_CRITICAL(&stats_lock);
+    *stats = writer_stats;
+    taskEXIT_CRITICAL(&stats_lock);
+}
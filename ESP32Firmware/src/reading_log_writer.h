@@ -0,0 +1,70 @@
+/*
+ * Reading Log Writer for GasTag Bridge
+ *
+ * Runs the flash reading log (reading_log.h) on the "readlog" data
+ * partition from a dedicated low-priority task. Producers hand readings
+ * over through a queue without ever waiting: when the queue is full the
+ * reading is dropped from the log and counted. The task collects readings
+ * into batches so each flash write covers many records, and erases the next
+ * block while idle so appends rarely pay for an erase.
+ */
+
+#ifndef READING_LOG_WRITER_H
+#define READING_LOG_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "divesoft_parser.h"
+
+// ============== WRITER CONFIGURATION ==============
+#define READING_LOG_PARTITION_LABEL    "readlog"
+#define READING_LOG_PARTITION_SUBTYPE  0x40   // First custom data subtype
+#define READING_LOG_QUEUE_DEPTH        64
+#define READING_LOG_BATCH_RECORDS      16     // Write once this many readings are queued...
+#define READING_LOG_FLUSH_MS           5000   // ...or the oldest has waited this long
+#define READING_LOG_STATS_INTERVAL_MS  60000
+#define READING_LOG_TASK_STACK         4096
+#define READING_LOG_TASK_PRIORITY      2      // Below the BLE notify task
+#define READING_LOG_TASK_CORE          1
+
+// ============== WRITER TYPES ==============
+typedef struct {
+    uint32_t submitted;         // Readings queued for the log
+    uint32_t dropped;           // Readings dropped because the queue was full
+    uint32_t write_errors;      // Failed appends (the batch is lost)
+    uint32_t batches;           // Appends performed
+    uint32_t last_write_us;     // Duration of the most recent append
+    uint32_t max_write_us;      // Longest append since start
+    uint32_t oldest_seq;        // Oldest sequence number in the log
+    uint32_t next_seq;          // Sequence number of the next record
+} reading_log_writer_stats_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Mount the log partition and start the writer task.
+ * Without a "readlog" partition the writer stays disabled and submissions
+ * are ignored.
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the partition is missing, or a mount error
+ */
+esp_err_t reading_log_writer_start(void);
+
+/**
+ * Queue a reading for the log. Never blocks.
+ *
+ * @param reading Reading to store
+ * @return true if queued, false if the writer is disabled or the queue was full
+ */
+bool reading_log_writer_submit(const gas_reading_t *reading);
+
+/**
+ * Snapshot the writer counters. Safe to call from any task.
+ *
+ * @param stats Output counters
+ */
+void reading_log_writer_get_stats(reading_log_writer_stats_t *stats);
+
+#endif // READING_LOG_WRITER_H
@@ -0,0 +1,116 @@
+/*
+ * Analyzer RX Trace Implementation
+ */
+
+#include "rx_trace.h"
+
+#include <string.h>
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void reset(rx_trace_t *trace) {
+    trace->used = 0;
+    trace->full = false;
+    trace->records = 0;
+    trace->dropped = 0;
+    if (trace->buf != NULL) {
+        memcpy(trace->buf, RX_TRACE_MAGIC, 4);
+        trace->buf[4] = RX_TRACE_VERSION;
+        memset(&trace->buf[5], 0, 3);
+        trace->used = RX_TRACE_HEADER_SIZE;
+    }
+}
+
+void rx_trace_init(rx_trace_t *trace, uint8_t *storage, size_t size) {
+    bool usable = storage != NULL && size >= RX_TRACE_HEADER_SIZE;
+    trace->buf = usable ? storage : NULL;
+    trace->size = usable ? size : 0;
+    trace->last_us = 0;
+    trace->running = false;
+    reset(trace);
+}
+
+void rx_trace_start(rx_trace_t *trace, int64_t now_us) {
+    reset(trace);
+    trace->last_us = now_us;
+    trace->running = true;
+}
+
+void rx_trace_stop(rx_trace_t *trace) {
+    trace->running = false;
+}
+
+bool rx_trace_record(rx_trace_t *trace, rx_trace_rec_type_t type, uint8_t channel,
+                     int64_t time_us, const uint8_t *data, size_t len) {
+    if (!trace->running || len > RX_TRACE_DATA_MAX) {
+        return false;
+    }
+    if (trace->full || trace->buf == NULL || trace->size - trace->used < RX_TRACE_RECORD_HEADER_SIZE + len) {
+        trace->full = true;
+        trace->dropped++;
+        return false;
+    }
+
+    int64_t delta = time_us - trace->last_us;
+    trace->last_us = time_us;
+
+    uint8_t *p = &trace->buf[trace->used];
+    p[0] = (uint8_t)type;
+    p[1] = channel;
+    put_u16(&p[2], (uint16_t)len);
+    put_u32(&p[4], delta < 0 ? 0 : (delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta));
+    if (len > 0) {
+        memcpy(&p[RX_TRACE_RECORD_HEADER_SIZE], data, len);
+    }
+    trace->used += RX_TRACE_RECORD_HEADER_SIZE + len;
+    trace->records++;
+    return true;
+}
+
+bool rx_trace_reader_init(rx_trace_reader_t *reader, const uint8_t *buf, size_t len) {
+    bool valid = buf != NULL && len >= RX_TRACE_HEADER_SIZE &&
+                 memcmp(buf, RX_TRACE_MAGIC, 4) == 0 && buf[4] == RX_TRACE_VERSION;
+    reader->buf = buf;
+    reader->len = len;
+    reader->pos = valid ? RX_TRACE_HEADER_SIZE : len;  // An invalid trace reads as empty
+    reader->truncated = false;
+    return valid;
+}
+
+bool rx_trace_next(rx_trace_reader_t *reader, rx_trace_record_t *record) {
+    size_t left = reader->len - reader->pos;
+    if (left == 0) {
+        return false;
+    }
+    const uint8_t *p = &reader->buf[reader->pos];
+    if (left < RX_TRACE_RECORD_HEADER_SIZE || left - RX_TRACE_RECORD_HEADER_SIZE < get_u16(&p[2])) {
+        reader->truncated = true;
+        return false;
+    }
+
+    record->type = (rx_trace_rec_type_t)p[0];
+    record->channel = p[1];
+    record->len = get_u16(&p[2]);
+    record->delta_us = get_u32(&p[4]);
+    record->data = record->len > 0 ? &p[RX_TRACE_RECORD_HEADER_SIZE] : NULL;
+    reader->pos += RX_TRACE_RECORD_HEADER_SIZE + record->len;
+    return true;
+}
@@ -0,0 +1,132 @@
+/*
+ * Analyzer RX Trace for GasTag Bridge
+ *
+ * Records the analyzer bytes exactly as the USB RX path framed them: one
+ * record per chunk handed to handle_rx(), with its channel and the time
+ * since the previous record, plus a record for every device open and
+ * close. Fed back chunk by chunk, a trace reproduces the framer's and
+ * parser's input exactly, chunk boundaries included.
+ *
+ * The storage is the trace file itself, little-endian:
+ *
+ *   header  "GTRX", version, 3 reserved bytes
+ *   record  type (1), channel (1), data length (2), delta_us (4), data
+ *
+ * delta_us is the time since the previous record (since the start for the
+ * first one), saturating at UINT32_MAX. A record that does not fit stops
+ * the capture: every later record is counted as dropped, so a trace is
+ * always a complete prefix of what the bridge saw, with no holes.
+ *
+ * Storage is supplied by the caller (PSRAM on the bridge). There is no
+ * locking; the bridge only records with the USB RX mutex held.
+ */
+
+#ifndef RX_TRACE_H
+#define RX_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============== TRACE FORMAT ==============
+#define RX_TRACE_MAGIC               "GTRX"
+#define RX_TRACE_VERSION             1
+#define RX_TRACE_HEADER_SIZE         8
+#define RX_TRACE_RECORD_HEADER_SIZE  8
+#define RX_TRACE_DATA_MAX            UINT16_MAX
+
+typedef enum {
+    RX_TRACE_REC_DATA = 0,      // A chunk of analyzer bytes
+    RX_TRACE_REC_OPEN = 1,      // A device was opened on the channel (no data)
+    RX_TRACE_REC_CLOSE = 2,     // The channel's device was closed (no data)
+} rx_trace_rec_type_t;
+
+// ============== TRACE TYPES ==============
+typedef struct {
+    uint8_t *buf;               // Caller-owned storage, starts with the header
+    size_t size;                // Storage size in bytes
+    size_t used;                // Header and records written so far
+    int64_t last_us;            // Time of the previous record
+    bool running;               // Recording
+    bool full;                  // A record did not fit; the rest are dropped
+    uint32_t records;           // Records written
+    uint32_t dropped;           // Records that did not fit
+} rx_trace_t;
+
+typedef struct {
+    rx_trace_rec_type_t type;
+    uint8_t channel;
+    uint32_t delta_us;          // Time since the previous record
+    const uint8_t *data;        // Points into the trace; NULL without data
+    uint16_t len;
+} rx_trace_record_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;                 // Offset of the next record
+    bool truncated;             // Ended inside a record
+} rx_trace_reader_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Initialize a stopped, empty trace.
+ *
+ * @param trace   Trace to initialize
+ * @param storage Storage of size bytes, or NULL
+ * @param size    Storage size; below RX_TRACE_HEADER_SIZE nothing is ever recorded
+ */
+void rx_trace_init(rx_trace_t *trace, uint8_t *storage, size_t size);
+
+/**
+ * Drop what was recorded and start recording.
+ *
+ * @param trace  Trace to start
+ * @param now_us Start time, the reference of the first record's delta
+ */
+void rx_trace_start(rx_trace_t *trace, int64_t now_us);
+
+/**
+ * Stop recording. What was recorded stays readable until the next start.
+ *
+ * @param trace Trace to stop
+ */
+void rx_trace_stop(rx_trace_t *trace);
+
+/**
+ * Append a record while running.
+ *
+ * @param trace   Trace to append to
+ * @param type    Record type
+ * @param channel Analyzer channel
+ * @param time_us Time of the record, same clock as rx_trace_start()
+ * @param data    Chunk for RX_TRACE_REC_DATA, else NULL
+ * @param len     Chunk length, at most RX_TRACE_DATA_MAX
+ * @return true if recorded; false if stopped, full (counted as dropped)
+ *         or len is too long
+ */
+bool rx_trace_record(rx_trace_t *trace, rx_trace_rec_type_t type, uint8_t channel,
+                     int64_t time_us, const uint8_t *data, size_t len);
+
+/**
+ * Start reading a trace file or a trace's storage (buf, used).
+ *
+ * @param reader Reader to initialize
+ * @param buf    Trace bytes, starting with the header
+ * @param len    Number of bytes
+ * @return false if the header is missing or of another version
+ */
+bool rx_trace_reader_init(rx_trace_reader_t *reader, const uint8_t *buf, size_t len);
+
+/**
+ * Read the next record. Records of unknown type are returned as they are,
+ * for the caller to skip.
+ *
+ * @param reader Reader
+ * @param record Filled in with the record
+ * @return false at the end, or at a truncated record (reader->truncated)
+ */
+bool rx_trace_next(rx_trace_reader_t *reader, rx_trace_record_t *record);
+
+#endif // RX_TRACE_H
@@ -0,0 +1,263 @@
+/*
+ * USB RX Path Implementation
+ *
+ * The RX task owns the channels' framers. Device slots and the trace are
+ * written with rx_mutex held, which the task holds while it drains them;
+ * replays take it too, so they frame as the task would.
+ */
+
+#include "usb_rx.h"
+
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "USB_RX";
+
+// The host build runs FreeRTOS on a single core
+#if configNUMBER_OF_CORES > 1
+#define USB_RX_TASK_AFFINITY  USB_RX_TASK_CORE
+#else
+#define USB_RX_TASK_AFFINITY  tskNO_AFFINITY
+#endif
+
+// ============== STATE ==============
+static analyzer_channel_t channels[USB_RX_DEVICE_MAX];  // Owned by the USB RX task
+static cdc_acm_dev_hdl_t devs[USB_RX_DEVICE_MAX];       // Written with rx_mutex held
+static usb_rx_hooks_t rx_hooks;
+static TaskHandle_t rx_task_handle = NULL;
+static SemaphoreHandle_t rx_mutex = NULL;
+static rx_trace_t *trace = NULL;                        // Recording, written with rx_mutex held
+
+// Watchdog: last data time per device; last_data_time_ms is the latest of them
+static volatile uint32_t last_data_time_ms = 0;
+static volatile uint32_t data_time_ms[USB_RX_DEVICE_MAX];
+
+// Set by usb_rx_arm() before each open; the RX task clears them at the
+// first chunk and the first lines, for the attach timing
+static atomic_bool first_rx_pending[USB_RX_DEVICE_MAX];
+static atomic_bool first_line_pending[USB_RX_DEVICE_MAX];
+static int64_t first_rx_time_us[USB_RX_DEVICE_MAX];  // Published by the first lines hook
+
+// ============== RX TASK ==============
+// Assemble lines from one chunk of a device's bytes and queue them.
+// Called with rx_mutex held
+static void handle_rx(analyzer_channel_t *channel, const uint8_t *data, size_t data_len) {
+    uint8_t id = channel->id;
+    if (trace != NULL) {
+        rx_trace_record(trace, RX_TRACE_REC_DATA, id, esp_timer_get_time(), data, data_len);
+    }
+
+    // Update watchdog timestamp on any data received
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    data_time_ms[id] = now_ms;
+    last_data_time_ms = now_ms;
+    if (atomic_load(&first_rx_pending[id]) && atomic_exchange(&first_rx_pending[id], false)) {
+        first_rx_time_us[id] = esp_timer_get_time();
+    }
+
+    if (rx_hooks.busy != NULL) {
+        rx_hooks.busy(true, rx_hooks.ctx);
+    }
+    size_t lines = analyzer_channel_feed(channel, data, data_len);
+    if (rx_hooks.busy != NULL) {
+        rx_hooks.busy(false, rx_hooks.ctx);
+    }
+
+    if (lines > 0 && rx_hooks.lines != NULL) {
+        bool first = atomic_load(&first_line_pending[id]) && atomic_exchange(&first_line_pending[id], false);
+        rx_hooks.lines(id, lines, first, rx_hooks.ctx);
+    }
+}
+
+static void usb_rx_task(void *arg) {
+    static uint8_t chunk[USB_RX_CHUNK];
+    uint32_t reported_losses[USB_RX_DEVICE_MAX] = {0};
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xSemaphoreTake(rx_mutex, portMAX_DELAY);
+        for (int id = 0; id < USB_RX_DEVICE_MAX; id++) {
+            if (devs[id] == NULL) {
+                reported_losses[id] = 0;
+                continue;
+            }
+            size_t len;
+            while (cdc_acm_host_data_rx_blocking(devs[id], chunk, sizeof(chunk), &len, 0) == ESP_OK) {
+                handle_rx(&channels[id], chunk, len);
+            }
+
+            // Report where data was lost: our RX ring, the analyzer's own buffer
+            // (it signals overruns) or the USB transfers themselves
+            cdc_acm_host_stats_t usb;
+            cdc_acm_host_rx_buffer_stats_t ring;
+            if (cdc_acm_host_get_stats(devs[id], &usb) != ESP_OK ||
+                cdc_acm_host_rx_buffer_stats_get(devs[id], &ring) != ESP_OK) {
+                continue;
+            }
+            uint32_t errors = 0;
+            for (int s = 0; s < CDC_ACM_STATS_STATUS_MAX; s++) {
+                errors += usb.errors[s];
+            }
+            uint32_t losses = usb.in.overflows + usb.in.serial_overruns + errors;
+            if (losses != reported_losses[id]) {
+                ESP_LOGW(TAG, "USB channel %d: %lu ring overflows (%lu bytes, high-water %u/%u), "
+                         "%lu analyzer overruns, %lu transfer errors; %lu transfers, resubmit gap max %lu us",
+                         id, usb.in.overflows, ring.dropped_bytes, (unsigned)ring.high_water, (unsigned)ring.size,
+                         usb.in.serial_overruns, errors, usb.in.transfers, usb.in.resubmit_gap_max_us);
+                reported_losses[id] = losses;
+            }
+        }
+        xSemaphoreGive(rx_mutex);
+    }
+}
+
+// ============== PUBLIC API ==============
+esp_err_t usb_rx_start(line_ring_t *ring, const usb_rx_hooks_t *hooks) {
+    for (uint8_t id = 0; id < USB_RX_DEVICE_MAX; id++) {
+        analyzer_channel_init(&channels[id], id, ring);
+    }
+    rx_hooks = *hooks;
+
+    rx_mutex = xSemaphoreCreateMutex();
+    if (rx_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreatePinnedToCore(usb_rx_task, "usb_rx", USB_RX_TASK_STACK, NULL,
+                                USB_RX_TASK_PRIORITY, &rx_task_handle, USB_RX_TASK_AFFINITY) != pdPASS) {
+        vSemaphoreDelete(rx_mutex);
+        rx_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void usb_rx_device_config(uint8_t id, cdc_acm_host_device_config_t *config) {
+    config->out_buffer_size = 512;
+    config->in_buffer_size = 512;
+    config->user_arg = &channels[id];
+    config->in_xfer_count = USB_IN_XFER_COUNT;
+    config->rx_buffer_size = USB_RX_BUFFER_SIZE;
+}
+
+analyzer_channel_t *usb_rx_channel(uint8_t id) {
+    return &channels[id];
+}
+
+void usb_rx_arm(uint8_t id) {
+    atomic_store(&first_rx_pending[id], true);
+    atomic_store(&first_line_pending[id], true);
+}
+
+void usb_rx_disarm(uint8_t id) {
+    atomic_store(&first_rx_pending[id], false);
+    atomic_store(&first_line_pending[id], false);
+}
+
+void usb_rx_attach(uint8_t id, cdc_acm_dev_hdl_t dev) {
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    devs[id] = dev;
+    if (trace != NULL) {
+        rx_trace_record(trace, RX_TRACE_REC_OPEN, id, esp_timer_get_time(), NULL, 0);
+    }
+    xSemaphoreGive(rx_mutex);
+    xTaskNotifyGive(rx_task_handle);
+
+    data_time_ms[id] = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    last_data_time_ms = data_time_ms[id];
+}
+
+bool usb_rx_close(uint8_t id) {
+    usb_rx_disarm(id);
+    if (devs[id] == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    cdc_acm_host_close(devs[id]);
+    devs[id] = NULL;
+    if (trace != NULL) {
+        rx_trace_record(trace, RX_TRACE_REC_CLOSE, id, esp_timer_get_time(), NULL, 0);
+    }
+    xSemaphoreGive(rx_mutex);
+
+    // Not framing now: the RX task only does that with rx_mutex held
+    analyzer_channel_reset(&channels[id]);
+    return true;
+}
+
+bool usb_rx_any_open(void) {
+    bool any_open = false;
+    for (int id = 0; id < USB_RX_DEVICE_MAX; id++) {
+        any_open |= devs[id] != NULL;
+    }
+    return any_open;
+}
+
+void usb_rx_notify(void) {
+    xTaskNotifyGive(rx_task_handle);
+}
+
+uint32_t usb_rx_data_time_ms(uint8_t id) {
+    return data_time_ms[id];
+}
+
+uint32_t usb_rx_last_data_time_ms(void) {
+    return last_data_time_ms;
+}
+
+int64_t usb_rx_first_rx_time_us(uint8_t id) {
+    return first_rx_time_us[id];
+}
+
+// ============== TRACE ==============
+void usb_rx_trace_start(rx_trace_t *new_trace) {
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    int64_t now_us = esp_timer_get_time();
+    rx_trace_start(new_trace, now_us);
+    for (uint8_t id = 0; id < USB_RX_DEVICE_MAX; id++) {
+        if (devs[id] != NULL) {
+            rx_trace_record(new_trace, RX_TRACE_REC_OPEN, id, now_us, NULL, 0);
+        }
+    }
+    trace = new_trace;
+    xSemaphoreGive(rx_mutex);
+}
+
+void usb_rx_trace_stop(void) {
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    if (trace != NULL) {
+        rx_trace_stop(trace);
+        trace = NULL;
+    }
+    xSemaphoreGive(rx_mutex);
+}
+
+bool usb_rx_replay(const rx_trace_record_t *record) {
+    if (record->channel >= USB_RX_DEVICE_MAX) {
+        return false;
+    }
+    uint8_t id = record->channel;
+    switch (record->type) {
+        case RX_TRACE_REC_DATA:
+            xSemaphoreTake(rx_mutex, portMAX_DELAY);
+            handle_rx(&channels[id], record->data, record->len);
+            xSemaphoreGive(rx_mutex);
+            return true;
+        case RX_TRACE_REC_OPEN:
+            usb_rx_arm(id);
+            data_time_ms[id] = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            return true;
+        case RX_TRACE_REC_CLOSE:
+            usb_rx_disarm(id);
+            xSemaphoreTake(rx_mutex, portMAX_DELAY);
+            analyzer_channel_reset(&channels[id]);
+            xSemaphoreGive(rx_mutex);
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ * USB RX Path for GasTag Bridge
+ *
+ * Turns the bytes of every open analyzer into queued lines. The CDC
+ * driver only copies received bytes into each device's RX ring
+ * (USB_RX_BUFFER_SIZE) and raises CDC_ACM_HOST_RX_DATA whenever it adds
+ * data to one. The USB RX task then drains every open device, assembles
+ * its lines on the device's analyzer channel and queues them on the shared
+ * line ring, so framing never holds up USB polling, and it stays the line
+ * ring's only producer however many analyzers are open.
+ *
+ * Only the cdc_acm_host.h API, FreeRTOS and the channel modules are used,
+ * so the same path also runs natively against the Linux CDC-ACM backend
+ * (host_test/components/cdc_acm_host_linux). What happens to the lines is
+ * up to the hooks.
+ *
+ * A device is attached to a slot after its open and only closed through
+ * usb_rx_close(), which keeps the RX task out while it closes; the slot
+ * index is the channel ID.
+ *
+ * The chunks handed to the framers can be recorded into an rx_trace, and
+ * a trace fed back through the same framing with usb_rx_replay(), chunk by
+ * chunk, for reproducing field captures on the host build.
+ */
+
+#ifndef USB_RX_H
+#define USB_RX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "usb/cdc_acm_host.h"
+#include "analyzer_channel.h"
+#include "line_ring.h"
+#include "rx_trace.h"
+
+// ============== USB RX CONFIGURATION ==============
+#define USB_RX_DEVICE_MAX     ANALYZER_CHANNEL_MAX
+#define USB_IN_XFER_COUNT     2     // A second IN transfer keeps polling while the driver handles the first
+#define USB_RX_BUFFER_SIZE    2048  // Driver-side RX ring per device, drained by the USB RX task
+#define USB_RX_CHUNK          256
+#define USB_RX_TASK_STACK     3072
+#define USB_RX_TASK_PRIORITY  5     // Above the BLE notify task (4), below the CDC driver (10)
+#define USB_RX_TASK_CORE      1
+
+// ============== USB RX TYPES ==============
+typedef struct {
+    // Called around the framing of each chunk (CPU frequency boost). May be NULL
+    void (*busy)(bool busy, void *ctx);
+    // Called when a chunk completed lines. first is true once per
+    // usb_rx_arm(), with the device's first lines. May be NULL
+    void (*lines)(uint8_t id, size_t lines, bool first, void *ctx);
+    void *ctx;
+} usb_rx_hooks_t;
+
+// ============== PUBLIC API ==============
+
+/**
+ * Set up one analyzer channel per device slot, queuing on ring, and start
+ * the USB RX task. The hooks run in that task.
+ *
+ * @param ring  Line ring shared by all channels
+ * @param hooks Hooks, copied
+ * @return ESP_OK, or ESP_ERR_NO_MEM
+ */
+esp_err_t usb_rx_start(line_ring_t *ring, const usb_rx_hooks_t *hooks);
+
+/**
+ * Fill in the bridge's device configuration for slot id: buffer sizes, IN
+ * transfers and the RX ring, with the slot's channel as user_arg.
+ * event_cb is left to the caller; its CDC_ACM_HOST_RX_DATA must call
+ * usb_rx_notify().
+ *
+ * @param id     Device slot
+ * @param config Configuration to fill in, other fields are left as they are
+ */
+void usb_rx_device_config(uint8_t id, cdc_acm_host_device_config_t *config);
+
+/**
+ * Channel of a device slot, whose framer counters may be read from any task.
+ *
+ * @param id Device slot
+ * @return Channel
+ */
+analyzer_channel_t *usb_rx_channel(uint8_t id);
+
+/**
+ * Time the next first chunk and report the next first lines of slot id.
+ * Call before opening its device: data can arrive inside the open.
+ *
+ * @param id Device slot
+ */
+void usb_rx_arm(uint8_t id);
+
+/**
+ * Stop timing the first chunk and lines of slot id, after a failed open.
+ *
+ * @param id Device slot
+ */
+void usb_rx_disarm(uint8_t id);
+
+/**
+ * Hand an opened device to the USB RX task and drain it at once: anything
+ * received during the open is already in its ring, which raised RX_DATA
+ * before the task could see the device. Restarts the slot's data watchdog.
+ *
+ * @param id  Device slot
+ * @param dev Opened device
+ */
+void usb_rx_attach(uint8_t id, cdc_acm_dev_hdl_t dev);
+
+/**
+ * Disarm slot id, close its device with the USB RX task kept out and drop
+ * any half-received line, so it does not prefix the next device's output.
+ *
+ * @param id Device slot
+ * @return true if a device was open
+ */
+bool usb_rx_close(uint8_t id);
+
+/**
+ * @return true while any device slot has a device attached
+ */
+bool usb_rx_any_open(void);
+
+/**
+ * Wake the USB RX task. Call from the CDC event callback on
+ * CDC_ACM_HOST_RX_DATA.
+ */
+void usb_rx_notify(void);
+
+/**
+ * Tick time in ms of the latest data from slot id (or of its attach).
+ *
+ * @param id Device slot
+ * @return Time in ms, wrapping
+ */
+uint32_t usb_rx_data_time_ms(uint8_t id);
+
+/**
+ * Tick time in ms of the latest data from any device.
+ *
+ * @return Time in ms, wrapping
+ */
+uint32_t usb_rx_last_data_time_ms(void);
+
+/**
+ * esp_timer time of the first chunk since usb_rx_arm(). Valid once the
+ * lines hook has reported the first lines.
+ *
+ * @param id Device slot
+ * @return Time in us
+ */
+int64_t usb_rx_first_rx_time_us(uint8_t id);
+
+/**
+ * Record every chunk handed to the framers, and every device attach and
+ * close, into trace until usb_rx_trace_stop(). Devices already attached
+ * get an open record first. Restarts trace.
+ *
+ * @param trace Trace with storage, owned by the caller
+ */
+void usb_rx_trace_start(rx_trace_t *trace);
+
+/**
+ * Stop recording. Once this returns the trace is no longer written and
+ * can be read or exported.
+ */
+void usb_rx_trace_stop(void);
+
+/**
+ * Feed one trace record back as a device would have: a chunk goes through
+ * the same framing and hooks as live data, an open arms the channel as
+ * usb_rx_arm() does and a close drops its half-received line as
+ * usb_rx_close() does. For replays, with no device attached to the
+ * channel.
+ *
+ * @param record Record from rx_trace_next()
+ * @return false for a channel out of range or an unknown record type
+ */
+bool usb_rx_replay(const rx_trace_record_t *record);
+
+#endif // USB_RX_H
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Feed analyzer data to the linux bridge build (host_test/bridge_linux).
+
+Each connection to the bridge's socket is one USB device plugged in; closing
+it unplugs the device. The data is a capture file or, by default, a generated
+Divesoft session shaped like host_test/parser_tests/main/analyzer_streams.hpp.
+
+    tools/cdc_feed.py --readings 600 --baud 115200     # real time
+    tools/cdc_feed.py --readings 100000                # as fast as possible
+    tools/cdc_feed.py --devices 2 capture.txt          # two analyzers at once
+
+A pty or a real serial port can be bridged instead with socat:
+
+    socat UNIX-CONNECT:/tmp/gastag_cdc.sock /dev/ttyUSB0,raw,b115200
+"""
+
+import argparse
+import os
+import socket
+import sys
+import threading
+import time
+
+DEFAULT_SOCKET = '/tmp/gastag_cdc.sock'
+
+
+def reading_line(he, o2, temp_f, inhg, second):
+    return 'He %5s %%  O2 %5s %%  Ti %5.1f ~F    %5.2f inHg   2025/12/15 21:%02d:%02d' % (
+        he, o2, temp_f, inhg, (second // 60) % 60, second % 60)
+
+
+def session(readings):
+    """Attach noise, 5 warm-up lines, then `readings` live readings, CRLF terminated."""
+    lines = [reading_line('***.*', '***.*', 78.5 + i * 0.1, 29.52, i) for i in range(5)]
+    for i in range(readings):
+        he = '%.1f' % (35.0 + (i % 7) * 0.1)
+        o2 = '%.1f' % (21.0 - (i % 5) * 0.1)
+        lines.append(reading_line(he, o2, 79.0 + (i % 3) * 0.1, 29.50, 5 + i))
+    return b'\xff\xfe\x00\r\n' + ''.join(line + '\r\n' for line in lines).encode('ascii')
+
+
+def feed(path, data, chunk, baud, hold, results, index):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+    # 10 bits per byte on the wire (8N1)
+    byte_time = 10.0 / baud if baud else 0.0
+    start = time.monotonic()
+    sent = 0
+    while sent < len(data):
+        if byte_time:
+            ahead = start + sent * byte_time - time.monotonic()
+            if ahead > 0:
+                time.sleep(ahead)
+        sent += sock.send(data[sent:sent + chunk])
+    elapsed = time.monotonic() - start
+    time.sleep(hold)
+    sock.close()
+    results[index] = (sent, elapsed)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture', nargs='?', help='bytes to send; a generated session if omitted')
+    parser.add_argument('--socket', default=os.environ.get('GASTAG_CDC_SOCKET', DEFAULT_SOCKET),
+                        help='bridge socket (default: $GASTAG_CDC_SOCKET or %s)' % DEFAULT_SOCKET)
+    parser.add_argument('--readings', type=int, default=60, help='live readings in a generated session')
+    parser.add_argument('--baud', type=int, default=0, help='pace like a serial line at this rate; 0 sends as fast as possible')
+    parser.add_argument('--chunk', type=int, default=64, help='bytes per write, like one USB packet')
+    parser.add_argument('--devices', type=int, default=1, help='connections fed at the same time')
+    parser.add_argument('--hold', type=float, default=0.0, help='seconds to stay connected after the data')
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, 'rb') as f:
+            data = f.read()
+    else:
+        data = session(args.readings)
+
+    results = [None] * args.devices
+    threads = [threading.Thread(target=feed, args=(args.socket, data, args.chunk, args.baud, args.hold, results, i))
+               for i in range(args.devices)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    for i, result in enumerate(results):
+        if result is None:
+            sys.exit('device %d: feed failed' % i)
+        sent, elapsed = result
+        rate = sent / elapsed / 1000 if elapsed > 0 else 0
+        print('device %d: %d bytes in %.3f s (%.1f kB/s)' % (i, sent, elapsed, rate))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Extract, inspect and build analyzer RX traces (src/rx_trace.h).
+
+A bridge captures a trace after the RX_TRACE_CMD_START command and prints
+it on the console after RX_TRACE_CMD_EXPORT (both on the OTA control
+characteristic). Save the console output, then:
+
+    tools/rx_trace.py extract console.log -o field.rxt
+    tools/rx_trace.py info field.rxt
+    GASTAG_REPLAY=field.rxt build/host_test_gastag_bridge.elf   # host_test/bridge_linux
+
+`make` builds a trace from raw analyzer bytes (a capture file, or the
+generated session of cdc_feed.py) with fixed chunks, for a corpus without
+field data.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MAGIC = b'GTRX'
+VERSION = 1
+HEADER = MAGIC + bytes([VERSION, 0, 0, 0])
+RECORD = struct.Struct('<BBHI')  # type, channel, data length, delta_us
+TYPES = {0: 'data', 1: 'open', 2: 'close'}
+
+
+def records(trace):
+    """Yield (type, channel, delta_us, data); raises ValueError on a bad trace."""
+    if trace[:5] != HEADER[:5]:
+        raise ValueError('not an RX trace (version %d)' % VERSION)
+    pos = len(HEADER)
+    while pos < len(trace):
+        if len(trace) - pos < RECORD.size:
+            raise ValueError('truncated record at offset %d' % pos)
+        rec_type, channel, length, delta_us = RECORD.unpack_from(trace, pos)
+        pos += RECORD.size
+        if len(trace) - pos < length:
+            raise ValueError('truncated record at offset %d' % (pos - RECORD.size))
+        yield rec_type, channel, delta_us, trace[pos:pos + length]
+        pos += length
+
+
+def extract(args):
+    with open(args.log, 'r', errors='replace') as f:
+        log = f.read()
+    # The last complete export in the log
+    exports = re.findall(r'RX_TRACE_BEGIN bytes=(\d+) records=(\d+) dropped=(\d+)(.*?)RX_TRACE_END', log, re.S)
+    if not exports:
+        sys.exit('%s: no RX_TRACE_BEGIN ... RX_TRACE_END export' % args.log)
+    size, count, dropped, body = exports[-1]
+
+    trace = bytearray()
+    for offset, hex_bytes in re.findall(r'RX_TRACE ([0-9a-f]+) ([0-9a-f]*)', body):
+        if int(offset, 16) != len(trace):
+            sys.exit('line for offset 0x%s missing or repeated (expected 0x%x)' % (offset, len(trace)))
+        trace += bytes.fromhex(hex_bytes)
+    if len(trace) != int(size):
+        sys.exit('export has %d of %s bytes' % (len(trace), size))
+
+    n = sum(1 for _ in records(trace))
+    if n != int(count):
+        sys.exit('export has %d of %s records' % (n, count))
+    with open(args.output, 'wb') as f:
+        f.write(trace)
+    print('%s: %d records, %d bytes' % (args.output, n, len(trace)))
+    if int(dropped):
+        print('capture buffer was full: %s records after the end were dropped' % dropped)
+
+
+def info(args):
+    with open(args.trace, 'rb') as f:
+        trace = f.read()
+    per_channel = {}
+    total_us = 0
+    for rec_type, channel, delta_us, data in records(trace):
+        total_us += delta_us
+        stats = per_channel.setdefault(channel, {'data': 0, 'open': 0, 'close': 0, 'bytes': 0, 'sizes': []})
+        stats[TYPES.get(rec_type, 'data')] += 1
+        if rec_type == 0:
+            stats['bytes'] += len(data)
+            stats['sizes'].append(len(data))
+
+    print('%s: %d bytes, %.3f s' % (args.trace, len(trace), total_us / 1e6))
+    for channel, stats in sorted(per_channel.items()):
+        sizes = stats['sizes'] or [0]
+        print('channel %d: %d opens, %d closes, %d chunks, %d bytes, chunk min/avg/max %d/%d/%d' % (
+            channel, stats['open'], stats['close'], stats['data'], stats['bytes'],
+            min(sizes), sum(sizes) // len(sizes), max(sizes)))
+
+
+def make(args):
+    if args.capture:
+        with open(args.capture, 'rb') as f:
+            data = f.read()
+    else:
+        sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+        from cdc_feed import session
+        data = session(args.readings)
+
+    # 10 bits per byte on the wire (8N1); a chunk is taken when it is complete
+    byte_us = 10e6 / args.baud
+    out = bytearray(HEADER)
+    out += RECORD.pack(1, args.channel, 0, 0)
+    for start in range(0, len(data), args.chunk):
+        chunk = data[start:start + args.chunk]
+        out += RECORD.pack(0, args.channel, len(chunk), int(round(len(chunk) * byte_us)))
+        out += chunk
+    out += RECORD.pack(2, args.channel, 0, 0)
+    with open(args.output, 'wb') as f:
+        f.write(out)
+    print('%s: %d bytes of analyzer data in %d-byte chunks' % (args.output, len(data), args.chunk))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    p = commands.add_parser('extract', help='write the last exported trace in a console log to a file')
+    p.add_argument('log')
+    p.add_argument('-o', '--output', required=True)
+    p.set_defaults(func=extract)
+
+    p = commands.add_parser('info', help='summarize a trace')
+    p.add_argument('trace')
+    p.set_defaults(func=info)
+
+    p = commands.add_parser('make', help='build a trace from raw analyzer bytes')
+    p.add_argument('capture', nargs='?', help='raw bytes; a generated session if omitted')
+    p.add_argument('-o', '--output', required=True)
+    p.add_argument('--readings', type=int, default=60, help='live readings in a generated session')
+    p.add_argument('--chunk', type=int, default=64, help='bytes per record')
+    p.add_argument('--baud', type=int, default=115200, help='line rate the record times follow')
+    p.add_argument('--channel', type=int, default=0)
+    p.set_defaults(func=make)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except ValueError as e:
+        sys.exit(str(e))
+
+
+if __name__ == '__main__':
+    main()
@@ -41,6 +41,8 @@ class BluetoothManager: NSObject, ObservableObject {
     @Published var isReceivingData: Bool = false
     @Published var isSimulating: Bool = false
     @Published var firmwareVersion: String?
+    /// Bridge sends only changed readings plus a heartbeat; nil if the firmware has no control characteristic
+    @Published var changeOnlyMode: Bool?
 
     // Track when data was last received (for "Receiving" status)
     private var lastDataReceivedTime: Date?
@@ -63,6 +65,24 @@ class BluetoothManager: NSObject, ObservableObject {
     static let characteristicUUID = CBUUID(string: "A1B2C3D5-E5F6-7890-ABCD-EF1234567890")
     static let versionCharacteristicUUID = CBUUID(string: "A1B2C3D6-E5F6-7890-ABCD-EF1234567890")
     static let otaControlCharacteristicUUID = CBUUID(string: "A1B2C3D7-E5F6-7890-ABCD-EF1234567890")
+    static let binaryReadingCharacteristicUUID = CBUUID(string: "A1B2C3D8-E5F6-7890-ABCD-EF1234567890")
+    static let controlCharacteristicUUID = CBUUID(string: "A1B2C3D9-E5F6-7890-ABCD-EF1234567890")
+    static let historyCharacteristicUUID = CBUUID(string: "A1B2C3DA-E5F6-7890-ABCD-EF1234567890")
+
+    // Binary reading format understood by this app (first byte of each packet)
+    static let binaryReadingFormatVersion: UInt8 = 1
+    static let binaryReadingFormatSize = 14
+    static let binaryBatchFormatVersion: UInt8 = 2
+    static let binaryBatchRecordSize = 15
+    static let historyFormatVersion: UInt8 = 3
+    static let historyRecordSize = 17
+    static let historySyncOnly: UInt32 = 0xFFFF_FFFF
+
+    // Reading filter config on the control characteristic:
+    // version, mode, He/O2/temp/pressure deadbands, heartbeat ms (little-endian UInt16s)
+    static let filterConfigVersion: UInt8 = 1
+    static let filterConfigSize = 12
+    static let defaultFilterConfig: [UInt8] = [1, 0, 1, 0, 1, 0, 5, 0, 5, 0, 0xD0, 0x07]
 
     // MARK: - Private Properties
     private var centralManager: CBCentralManager!
@@ -70,6 +90,14 @@ class BluetoothManager: NSObject, ObservableObject {
     private var gasReadingCharacteristic: CBCharacteristic?
     private var versionCharacteristic: CBCharacteristic?
     private var otaControlCharacteristic: CBCharacteristic?
+    private var binaryReadingCharacteristic: CBCharacteristic?
+    private var lastReadingSequence: UInt16?
+    private var controlCharacteristic: CBCharacteristic?
+    private var historyCharacteristic: CBCharacteristic?
+    /// Last reading sequence number seen from the bridge (kept across reconnects to the same bridge)
+    private var lastHistorySequence: UInt32?
+    private var historyPeripheralIdentifier: UUID?
+    private var filterConfig: [UInt8]?
     private var rssiTimer: Timer?
     private var shouldReconnect = false
     private var lastConnectedPeripheralIdentifier: UUID?
@@ -131,6 +159,10 @@ class BluetoothManager: NSObject, ObservableObject {
         stopScanning()
         connectionState = .connecting
         lastConnectedPeripheralIdentifier = device.peripheral.identifier
+        if historyPeripheralIdentifier != device.peripheral.identifier {
+            historyPeripheralIdentifier = device.peripheral.identifier
+            lastHistorySequence = nil
+        }
         shouldReconnect = true
         addRawLine("[Info] Connecting to \(device.name)...")
 
@@ -159,6 +191,12 @@ class BluetoothManager: NSObject, ObservableObject {
         gasReadingCharacteristic = nil
         versionCharacteristic = nil
         otaControlCharacteristic = nil
+        binaryReadingCharacteristic = nil
+        lastReadingSequence = nil
+        controlCharacteristic = nil
+        historyCharacteristic = nil
+        filterConfig = nil
+        changeOnlyMode = nil
         connectedDeviceName = nil
         firmwareVersion = nil
         signalStrength = 0
@@ -314,8 +352,34 @@ class BluetoothManager: NSObject, ObservableObject {
         }
     }
 
+    /// Switch the bridge between sending every reading and sending only changes.
+    /// Deadbands and heartbeat keep the values last read from the bridge.
+    func setChangeOnlyMode(_ enabled: Bool) {
+        guard connectionState == .connected,
+              let peripheral = connectedPeripheral,
+              let characteristic = controlCharacteristic else {
+            return
+        }
+
+        var config = filterConfig ?? BluetoothManager.defaultFilterConfig
+        config[1] = enabled ? 1 : 0
+        peripheral.writeValue(Data(config), for: characteristic, type: .withResponse)
+        filterConfig = config
+        changeOnlyMode = enabled
+    }
+
     // MARK: - Private Methods
 
+    private func parseFilterConfig(_ data: Data) {
+        let bytes = [UInt8](data)
+        guard bytes.count >= BluetoothManager.filterConfigSize,
+              bytes[0] == BluetoothManager.filterConfigVersion else {
+            return
+        }
+        filterConfig = Array(bytes.prefix(BluetoothManager.filterConfigSize))
+        changeOnlyMode = bytes[1] == 1
+    }
+
     private func parseReading(_ line: String) {
         // Skip internal status messages (already displayed in raw log)
         if line.hasPrefix("[") {
@@ -345,25 +409,145 @@ class BluetoothManager: NSObject, ObservableObject {
         let heString = String(line[heRange])
         let o2String = String(line[o2Range])
 
-        let heliumIsStale = heString.contains("*")
-        let oxygenIsStale = o2String.contains("*")
+        applyReading(
+            helium: heString.contains("*") ? nil : Double(heString),
+            oxygen: o2String.contains("*") ? nil : Double(o2String),
+            temperature: temperature,
+            pressure: pressure,
+            timestamp: String(line[timestampRange]).trimmingCharacters(in: .whitespaces)
+        )
+    }
+
+    /// Decode a packet from the binary reading characteristic (parsed on the bridge).
+    /// Version 1 carries one reading; version 2 is a batch of sequence-numbered readings.
+    private func parseBinaryReading(_ data: Data) {
+        let bytes = [UInt8](data)
+        guard let version = bytes.first else { return }
+
+        switch version {
+        case BluetoothManager.binaryReadingFormatVersion:
+            guard bytes.count >= BluetoothManager.binaryReadingFormatSize else { return }
+            applyBinaryReading(bytes, at: 1)
+
+        case BluetoothManager.binaryBatchFormatVersion:
+            guard bytes.count >= 2 else { return }
+            let count = Int(bytes[1])
+            guard bytes.count >= 2 + count * BluetoothManager.binaryBatchRecordSize else { return }
+            for index in 0..<count {
+                let offset = 2 + index * BluetoothManager.binaryBatchRecordSize
+                let sequence = UInt16(bytes[offset]) | (UInt16(bytes[offset + 1]) << 8)
+                if let last = lastReadingSequence, sequence != last &+ 1 {
+                    addRawLine("(\(sequence &- last &- 1) readings missed)")
+                }
+                lastReadingSequence = sequence
+                trackLiveSequence(sequence)
+                applyBinaryReading(bytes, at: offset + 2)
+            }
+
+        default:
+            return  // Unknown format version - ignore
+        }
+    }
+
+    /// Ask the bridge for every reading since the last one we saw
+    private func requestHistory(from peripheral: CBPeripheral, characteristic: CBCharacteristic) {
+        let after = lastHistorySequence ?? BluetoothManager.historySyncOnly
+        let request = withUnsafeBytes(of: after.littleEndian) { Data($0) }
+        peripheral.writeValue(request, for: characteristic, type: .withResponse)
+    }
+
+    /// Decode a history backfill packet: 32-bit sequence numbers, or an end marker
+    /// carrying the sequence number of the next live reading
+    private func parseHistoryPacket(_ data: Data) {
+        let bytes = [UInt8](data)
+        guard bytes.count >= 2, bytes[0] == BluetoothManager.historyFormatVersion else { return }
+
+        func u32(_ offset: Int) -> UInt32 {
+            (0..<4).reduce(0) { $0 | (UInt32(bytes[offset + $1]) << (8 * $1)) }
+        }
+
+        let count = Int(bytes[1])
+        if count == 0 {
+            guard bytes.count >= 6 else { return }
+            lastHistorySequence = u32(2) &- 1
+            return
+        }
+
+        guard bytes.count >= 2 + count * BluetoothManager.historyRecordSize else { return }
+        for index in 0..<count {
+            let offset = 2 + index * BluetoothManager.historyRecordSize
+            lastHistorySequence = u32(offset)
+            applyBinaryReading(bytes, at: offset + 4, live: false)
+        }
+    }
+
+    /// Widen a 16-bit live sequence number using the last full one we know
+    private func trackLiveSequence(_ sequence: UInt16) {
+        guard let last = lastHistorySequence else { return }
+        var full = (last & 0xFFFF_0000) | UInt32(sequence)
+        if full < last && last - full > 0x8000 {
+            full &+= 0x1_0000
+        }
+        lastHistorySequence = full
+    }
 
+    /// Decode one reading body starting at `base`.
+    /// Layout: flags, He x10, O2 x10, temp x10 (signed), inHg x100, packed timestamp (little-endian)
+    /// Backfilled (non-live) readings are only logged; they never replace the current reading.
+    private func applyBinaryReading(_ bytes: [UInt8], at base: Int, live: Bool = true) {
+        func u16(_ offset: Int) -> UInt16 {
+            UInt16(bytes[base + offset]) | (UInt16(bytes[base + offset + 1]) << 8)
+        }
+        let flags = bytes[base]
+        let packedTime = UInt32(u16(9)) | (UInt32(u16(11)) << 16)
+
+        let timestamp = String(format: "%04d/%02d/%02d %02d:%02d:%02d",
+                               2000 + Int(packedTime >> 26),
+                               Int((packedTime >> 22) & 0x0F),
+                               Int((packedTime >> 17) & 0x1F),
+                               Int((packedTime >> 12) & 0x1F),
+                               Int((packedTime >> 6) & 0x3F),
+                               Int(packedTime & 0x3F))
+
+        let helium: Double? = (flags & 0x01) != 0 ? nil : Double(u16(1)) / 10.0
+        let oxygen: Double? = (flags & 0x02) != 0 ? nil : Double(u16(3)) / 10.0
+        let temperature = Double(Int16(bitPattern: u16(5))) / 10.0
+        let pressure = Double(u16(7)) / 100.0
+        // Analyzer behind a hub on the bridge; 0 when there is only one
+        let channel = Int((flags >> 4) & 0x03)
+
+        // Keep the raw log readable in the analyzer's own format, with the
+        // same "#<channel> " prefix the bridge puts on text lines
+        addRawLine(String(format: "%@%@He %@ %%  O2 %@ %%  Ti %.1f ~F  %.2f inHg  %@",
+                          live ? "" : "[History] ",
+                          channel == 0 ? "" : "#\(channel) ",
+                          helium.map { String(format: "%.1f", $0) } ?? "***.*",
+                          oxygen.map { String(format: "%.1f", $0) } ?? "***.*",
+                          temperature, pressure, timestamp))
+
+        guard live else { return }
+        applyReading(helium: helium, oxygen: oxygen, temperature: temperature,
+                     pressure: pressure, timestamp: timestamp)
+    }
+
+    /// Publish a reading; nil gas values mean the analyzer showed ***.*
+    private func applyReading(helium: Double?, oxygen: Double?, temperature: Double, pressure: Double, timestamp: String) {
         // Use current value or fall back to last known
-        let helium = Double(heString) ?? lastKnownHelium
-        let oxygen = Double(o2String) ?? lastKnownOxygen
+        let heliumIsStale = helium == nil
+        let oxygenIsStale = oxygen == nil
 
         // Update last known values when we get good readings
-        if !heliumIsStale { lastKnownHelium = helium }
-        if !oxygenIsStale { lastKnownOxygen = oxygen }
+        if let helium = helium { lastKnownHelium = helium }
+        if let oxygen = oxygen { lastKnownOxygen = oxygen }
 
         let reading = GasReading(
-            helium: helium,
+            helium: helium ?? lastKnownHelium,
             heliumIsStale: heliumIsStale,
-            oxygen: oxygen,
+            oxygen: oxygen ?? lastKnownOxygen,
             oxygenIsStale: oxygenIsStale,
             temperature: temperature,
             pressure: pressure,
-            timestamp: String(line[timestampRange]).trimmingCharacters(in: .whitespaces)
+            timestamp: timestamp
         )
 
         // Mark that we received valid analyzer data (for "Receiving" status)
@@ -523,6 +707,12 @@ extension BluetoothManager: CBCentralManagerDelegate {
             gasReadingCharacteristic = nil
             versionCharacteristic = nil
             otaControlCharacteristic = nil
+            binaryReadingCharacteristic = nil
+            lastReadingSequence = nil
+            controlCharacteristic = nil
+            historyCharacteristic = nil
+            filterConfig = nil
+            changeOnlyMode = nil
             connectedDeviceName = nil
             firmwareVersion = nil
             signalStrength = 0
@@ -556,7 +746,10 @@ extension BluetoothManager: CBPeripheralDelegate {
                     peripheral.discoverCharacteristics([
                         BluetoothManager.characteristicUUID,
                         BluetoothManager.versionCharacteristicUUID,
-                        BluetoothManager.otaControlCharacteristicUUID
+                        BluetoothManager.otaControlCharacteristicUUID,
+                        BluetoothManager.binaryReadingCharacteristicUUID,
+                        BluetoothManager.controlCharacteristicUUID,
+                        BluetoothManager.historyCharacteristicUUID
                     ], for: service)
                 }
             }
@@ -572,13 +765,26 @@ extension BluetoothManager: CBPeripheralDelegate {
 
             guard let characteristics = service.characteristics else { return }
 
+            // Prefer the compact binary format when the bridge firmware supports it
+            let hasBinaryReadings = characteristics.contains {
+                $0.uuid == BluetoothManager.binaryReadingCharacteristicUUID && $0.properties.contains(.notify)
+            }
+
             for characteristic in characteristics {
-                if characteristic.uuid == BluetoothManager.characteristicUUID {
+                if characteristic.uuid == BluetoothManager.binaryReadingCharacteristicUUID {
+                    addRawLine("[Info] Found binary reading characteristic")
+                    binaryReadingCharacteristic = characteristic
+
+                    if characteristic.properties.contains(.notify) {
+                        peripheral.setNotifyValue(true, for: characteristic)
+                        addRawLine("[Info] Enabled binary notifications")
+                    }
+                } else if characteristic.uuid == BluetoothManager.characteristicUUID {
                     addRawLine("[Info] Found gas reading characteristic")
                     gasReadingCharacteristic = characteristic
 
-                    // Enable notifications
-                    if characteristic.properties.contains(.notify) {
+                    // Enable text notifications only if binary readings are unavailable
+                    if !hasBinaryReadings && characteristic.properties.contains(.notify) {
                         peripheral.setNotifyValue(true, for: characteristic)
                         addRawLine("[Info] Enabled notifications")
                     }
@@ -598,6 +804,15 @@ extension BluetoothManager: CBPeripheralDelegate {
                 } else if characteristic.uuid == BluetoothManager.otaControlCharacteristicUUID {
                     addRawLine("[Info] Found OTA control characteristic")
                     otaControlCharacteristic = characteristic
+                } else if characteristic.uuid == BluetoothManager.controlCharacteristicUUID {
+                    addRawLine("[Info] Found control characteristic")
+                    controlCharacteristic = characteristic
+                    peripheral.readValue(for: characteristic)
+                } else if characteristic.uuid == BluetoothManager.historyCharacteristicUUID {
+                    addRawLine("[Info] Found history characteristic")
+                    historyCharacteristic = characteristic
+                    // Backfill is requested once notifications are enabled
+                    peripheral.setNotifyValue(true, for: characteristic)
                 }
             }
         }
@@ -616,6 +831,27 @@ extension BluetoothManager: CBPeripheralDelegate {
                 return
             }
 
+            if characteristic.uuid == BluetoothManager.binaryReadingCharacteristicUUID {
+                if let data = characteristic.value {
+                    parseBinaryReading(data)
+                }
+                return
+            }
+
+            if characteristic.uuid == BluetoothManager.controlCharacteristicUUID {
+                if let data = characteristic.value {
+                    parseFilterConfig(data)
+                }
+                return
+            }
+
+            if characteristic.uuid == BluetoothManager.historyCharacteristicUUID {
+                if let data = characteristic.value {
+                    parseHistoryPacket(data)
+                }
+                return
+            }
+
             guard let data = characteristic.value,
                   let message = String(data: data, encoding: .utf8) else {
                 return
@@ -645,6 +881,9 @@ extension BluetoothManager: CBPeripheralDelegate {
 
             if characteristic.isNotifying {
                 addRawLine("[Info] Subscribed to notifications")
+                if characteristic.uuid == BluetoothManager.historyCharacteristicUUID {
+                    requestHistory(from: peripheral, characteristic: characteristic)
+                }
             } else {
                 addRawLine("[Info] Unsubscribed from notifications")
             }
@@ -661,6 +900,15 @@ extension BluetoothManager: CBPeripheralDelegate {
 
     nonisolated func peripheral(_ peripheral: CBPeripheral, didWriteValueFor characteristic: CBCharacteristic, error: Error?) {
         MainActor.assumeIsolated {
+            if characteristic.uuid == BluetoothManager.controlCharacteristicUUID {
+                if let error = error {
+                    addRawLine("[Error] Failed to update bridge settings: \(error.localizedDescription)")
+                    // Re-read so the UI shows what the bridge actually uses
+                    peripheral.readValue(for: characteristic)
+                }
+                return
+            }
+
             if characteristic.uuid == BluetoothManager.otaControlCharacteristicUUID {
                 if let continuation = otaModeContinuation {
                     otaModeContinuation = nil
@@ -47,6 +47,13 @@ struct SettingsView: View {
                                 .frame(width: 10, height: 10)
                         }
 
+                        if let changeOnly = bluetoothManager.changeOnlyMode {
+                            Toggle("Send Only Changes", isOn: Binding(
+                                get: { changeOnly },
+                                set: { bluetoothManager.setChangeOnlyMode($0) }
+                            ))
+                        }
+
                         Button("Change Device") {
                             showingDeviceSearch = true
                         }